@@ -14,9 +14,44 @@
 #define AFE_LOG_LEVEL_SPILOG 3  /*SPI-level messages */
 #define AFE_LOG_LEVEL_DEBUG 4   /*debug-level messages */
 
+/* Highest log level compiled in. Log calls above it are removed with their arguments, so they cost nothing on the
+   SPI path. Set it on the compiler command line, for example -DAFE_LOG_MAX_LEVEL=AFE_LOG_LEVEL_INFO drops the SPI
+   and debug logs. Errors are always compiled in. */
+#ifndef AFE_LOG_MAX_LEVEL
+#define AFE_LOG_MAX_LEVEL AFE_LOG_LEVEL_DEBUG
+#endif
+
+/* The level is checked before afeLogmsg is called, so filtered messages are never formatted. */
+#define afeLogAtLevel(level, ...)             \
+    do                                        \
+    {                                         \
+        if ((level) <= getAfeLogLvl())        \
+            afeLogmsg((level), __VA_ARGS__);  \
+    } while (0)
+/* Keeps the arguments referenced so removed calls don't leave unused variables, the compiler drops the call. */
+#define afeLogRemoved(...)                    \
+    do                                        \
+    {                                         \
+        if (0)                                \
+            afeLogmsg(0, __VA_ARGS__);        \
+    } while (0)
+
+/* Errors pass every runtime level, no check needed. */
 #define afeLogErr(fmt, ...) afeLogmsg(AFE_LOG_LEVEL_ERROR, "[%s][%s][%d]ERROR:" fmt "\r\n", __FILE__, __func__, __LINE__, __VA_ARGS__)
-#define afeLogDbg(fmt, ...) afeLogmsg(AFE_LOG_LEVEL_DEBUG, "[%s][%s][%d]DEBUG:" fmt "\r\n", __FILE__, __func__, __LINE__, __VA_ARGS__)
-#define afeLogSpiLog(fmt, ...) afeLogmsg(AFE_LOG_LEVEL_SPILOG, "[%s][%s][%d]SPI " fmt "\r\n", __FILE__, __func__, __LINE__, __VA_ARGS__)
-#define afeLogInfo(fmt, ...) afeLogmsg(AFE_LOG_LEVEL_INFO, "[%s][%s][%d]INFO:" fmt "\r\n", __FILE__, __func__, __LINE__, __VA_ARGS__)
+#if AFE_LOG_MAX_LEVEL >= AFE_LOG_LEVEL_DEBUG
+#define afeLogDbg(fmt, ...) afeLogAtLevel(AFE_LOG_LEVEL_DEBUG, "[%s][%s][%d]DEBUG:" fmt "\r\n", __FILE__, __func__, __LINE__, __VA_ARGS__)
+#else
+#define afeLogDbg(fmt, ...) afeLogRemoved(fmt, __VA_ARGS__)
+#endif
+#if AFE_LOG_MAX_LEVEL >= AFE_LOG_LEVEL_SPILOG
+#define afeLogSpiLog(fmt, ...) afeLogAtLevel(AFE_LOG_LEVEL_SPILOG, "[%s][%s][%d]SPI " fmt "\r\n", __FILE__, __func__, __LINE__, __VA_ARGS__)
+#else
+#define afeLogSpiLog(fmt, ...) afeLogRemoved(fmt, __VA_ARGS__)
+#endif
+#if AFE_LOG_MAX_LEVEL >= AFE_LOG_LEVEL_INFO
+#define afeLogInfo(fmt, ...) afeLogAtLevel(AFE_LOG_LEVEL_INFO, "[%s][%s][%d]INFO:" fmt "\r\n", __FILE__, __func__, __LINE__, __VA_ARGS__)
+#else
+#define afeLogInfo(fmt, ...) afeLogRemoved(fmt, __VA_ARGS__)
+#endif
 
 #endif
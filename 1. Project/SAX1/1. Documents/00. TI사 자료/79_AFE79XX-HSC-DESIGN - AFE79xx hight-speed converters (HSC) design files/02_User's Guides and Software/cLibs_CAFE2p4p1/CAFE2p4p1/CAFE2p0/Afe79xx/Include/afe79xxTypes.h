@@ -33,6 +33,27 @@ typedef enum RET_TYPE
 /*PAGE INFO*/
 #define AFE_PAGE_START_ADDR 0x10
 #define AFE_PAGE_END_ADDR 0x19
+#define AFE_NUM_PAGE_REGS (AFE_PAGE_END_ADDR - AFE_PAGE_START_ADDR + 1)
+
+/*  PAGE TRACKING MODES (afePageTrackingSetMode)   */
+#define AFE_PAGE_TRACK_OFF 0
+#define AFE_PAGE_TRACK_SKIP_REDUNDANT 1
+#define AFE_PAGE_TRACK_LAZY_CLOSE 2
+
+/*  SCRIPT OPTIMIZER PASSES (optimizeAfeScript)   */
+#define AFE_SCRIPT_OPT_MERGE_FIELDS 0x1
+#define AFE_SCRIPT_OPT_PAGE_SELECTS 0x2
+#define AFE_SCRIPT_OPT_DEAD_WRITES 0x4
+#define AFE_SCRIPT_OPT_SAFE (AFE_SCRIPT_OPT_MERGE_FIELDS | AFE_SCRIPT_OPT_PAGE_SELECTS)
+#define AFE_SCRIPT_OPT_ALL (AFE_SCRIPT_OPT_SAFE | AFE_SCRIPT_OPT_DEAD_WRITES)
+
+/*  MACRO COMPLETION WAIT MODES (afeMacroSetWaitMode)   */
+#define AFE_MACRO_WAIT_FIXED_POLL 0
+#define AFE_MACRO_WAIT_BACKOFF 1
+#define AFE_MACRO_WAIT_EVENT 2
+#define AFE_MACRO_WAIT_HINT 3
+/*  Returned by waitForAfeAlarmPin when the host can't watch the alarm pin.   */
+#define AFE_ALARM_PIN_UNSUPPORTED 2
 
 /*  MACRO ERROR STATUS TYPES   */
 #define AFE_MACRO_NO_ERROR 0
@@ -80,6 +101,114 @@ typedef enum RET_TYPE
 #define AFE_MACRO_OPCODE_FLOATING_POINT_CONFIG_ALC 0x6A
 #define AFE_MACRO_OPCODE_COARSE_FINE_MODE_ALC 0x6B
 
+/*  PLL STATUS BITS (getPllLockState)   */
+#define AFE_PLL_STATUS_LOCKED 0x10
+#define AFE_PLL_STATUS_LOCK_LOST_STICKY 0x40
+
+/*  SPI ALARM BITS (getSpiAlarmBits)   */
+#define AFE_SPI_ALARM_A_B1_GLOBAL_PAGE 0x001
+#define AFE_SPI_ALARM_A_B1_SAME_PAGE 0x002
+#define AFE_SPI_ALARM_A_B2_GLOBAL_PAGE 0x004
+#define AFE_SPI_ALARM_A_B2_SAME_PAGE 0x008
+#define AFE_SPI_ALARM_B1_B2_GLOBAL_PAGE 0x010
+#define AFE_SPI_ALARM_B1_B2_SAME_PAGE 0x020
+#define AFE_SPI_ALARM_A_INVALID_ADDR 0x040
+#define AFE_SPI_ALARM_B1_INVALID_ADDR 0x080
+#define AFE_SPI_ALARM_B2_INVALID_ADDR 0x100
+
+/*  PAP ALARM CAUSE BITS (papGetAlarmStatus)   */
+#define AFE_PAP_TX_ALARM_PLL 0x01
+#define AFE_PAP_TX_ALARM_JESD_SERDES 0x20
+#define AFE_PAP_TX_ALARM_ASYNC_FIFO 0x40
+#define AFE_PAP_TX_ALARM_SATURATION 0x80
+#define AFE_PAP_TX_ALARM_ALL 0xE1
+#define AFE_PAP_DET_MOVING_AVERAGE 0x1
+#define AFE_PAP_DET_HPF 0x2
+
+/*  DEVICE HEALTH FAULT BITS (getDeviceHealth)   */
+#define AFE_HEALTH_FAULT_PLL 0x01
+#define AFE_HEALTH_FAULT_DAC_JESD 0x02
+#define AFE_HEALTH_FAULT_ADC_JESD 0x04
+#define AFE_HEALTH_FAULT_SPI 0x08
+#define AFE_HEALTH_FAULT_MCU 0x10
+#define AFE_HEALTH_FAULT_PAP 0x20
+
+/* The result structures below have no padding, two results can be compared with memcmp. */
+typedef struct AFE_PAP_ALARM_STATUS
+{
+    /// txN_pap_alarm_sts (0x55c-0x55d), AFE_PAP_TX_ALARM_* bits.
+    uint16_t txAlarm;
+    /// pap_alarm_sts (0x558), bit n for the PAP of TX n.
+    uint8_t papAlarm;
+    /// Mode detectors triggered (0x584), AFE_PAP_DET_* bits.
+    uint8_t detector;
+    /// 1 if any of the above alarms is set, as returned by papAlarmStatus.
+    uint8_t triggered;
+    uint8_t reserved[3];
+} AfePapAlarmStatus_t;
+
+typedef struct AFE_JESD_RX_LINK_STATE
+{
+    /// Lane enables of the AB and CD instances, bit n for lane n of the instance.
+    uint8_t laneEna[2];
+    /// Code group sync state, 2 bits per lane. 2 once the lane passed CGS.
+    uint8_t csState[2];
+    /// JESD204B: frame sync state, 1 per lane when synced. JESD204C: buffer state, 3 per lane when the EMB is aligned.
+    uint8_t fsState[2];
+    /// Enabled lanes that passed both states, bit n for lane n. Lanes 0-3 are on AB and 4-7 on CD.
+    uint8_t laneUp;
+    /// Same as getJesdRxLinkStatus, 2 bits per instance. 10 when both are up.
+    uint8_t linkStatus;
+} AfeJesdRxLinkState_t;
+
+typedef struct AFE_DEVICE_HEALTH
+{
+    /// Register 0x66 of the PLL page, AFE_PLL_STATUS_* bits.
+    uint8_t pllStatus;
+    /// 1 if the MCU responded (checkMcuHealth).
+    uint8_t mcuOk;
+    /// AFE_SPI_ALARM_* bits.
+    uint16_t spiAlarms;
+    AfeJesdRxLinkState_t jesdRx;
+    /// Non-zero if any DAC JESD alarm is set (getJesdRxAlarms).
+    uint8_t jesdRxAlarms;
+    /// ADC JESD FIFO errors of the AB and CD instances, bit n for lane n of the instance.
+    uint8_t jesdTxFifo[2];
+    /// AFE_HEALTH_FAULT_* bits, the allOk interpretation of checkDeviceHealth.
+    uint8_t faults;
+    AfePapAlarmStatus_t pap[AFE_NUM_TX_CHANNELS];
+} AfeDeviceHealth_t;
+
+typedef struct AFE_TX_POWER_SAMPLE
+{
+    /// getTimeUs when the measurement was triggered.
+    uint32_t timeUs;
+    /// TX channel, 0 for TXA to 3 for TXD.
+    uint8_t chNo;
+    uint8_t reserved[3];
+    /// Power meter readings of band 0 and band 1 (0x5a0-0x5a2 and 0x5b0-0x5b2).
+    uint32_t powerRaw[AFE_NUM_BANDS_PER_TX];
+    /// The readings in dBFS, as returned by readTxPower.
+    double powerDb[AFE_NUM_BANDS_PER_TX];
+} AfeTxPowerSample_t;
+
+/*  CALIBRATION STORE PACKET TYPES (afeCalibStoreAdd)   */
+#define AFE_CALIB_PACKET_RX_DSA 0
+#define AFE_CALIB_PACKET_TX_DSA 1
+#define AFE_CALIB_NUM_PACKET_TYPES 2
+
+typedef struct AFE_CALIB_KEY
+{
+    /// systemParams chipId.
+    uint32_t chipId;
+    /// Frequency plan the packets were calibrated for, afeCalibStoreGetKey hashes the clocks, rates and NCOs of systemParams. Any other plan ID of the host can be used.
+    uint32_t freqPlan;
+    /// systemParams chipVersion, as read by getChipVersion.
+    uint8_t chipVersion;
+    uint8_t afeId;
+    uint8_t reserved[2];
+} AfeCalibKey_t;
+
 /* DSA Related */
 #define AFE_RX_DSA_MAX_ANA_DSA_DB 25
 #define AFE_TX_DSA_MAX_ANA_DSA_DB 34
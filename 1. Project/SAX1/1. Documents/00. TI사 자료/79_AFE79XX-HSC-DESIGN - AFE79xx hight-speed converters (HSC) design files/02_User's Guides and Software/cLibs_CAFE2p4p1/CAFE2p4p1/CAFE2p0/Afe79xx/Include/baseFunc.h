@@ -4,8 +4,13 @@
 
 uint8_t dev_spi_write(uint8_t afeId, uint16_t addr, uint8_t data);
 uint8_t dev_spi_read(uint8_t afeId, uint16_t addr, uint8_t *readVal);
+uint8_t dev_spi_write_batch(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count);
+uint8_t dev_spi_write_burst(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count);
+uint8_t dev_spi_read_burst(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count);
 uint8_t wait(uint32_t wait_s);
 uint8_t waitMs(uint32_t wait_ms);
+uint64_t getTimeUs(void);
+uint8_t waitForAfeAlarmPin(uint8_t afeId, uint32_t timeout_ms);
 void afeLogmsg(uint32_t level, const char *pcLogFmt, ...);
 void setAfeLogLvl(uint32_t level);
 uint32_t getAfeLogLvl();
@@ -5,7 +5,10 @@
 uint8_t serdesRawRead(uint8_t afeId, uint16_t addr, uint16_t *readVal);
 uint8_t serdesRawWrite(uint8_t afeId, uint16_t addr, uint16_t data);
 uint8_t afeSpiWriteWrapper(uint8_t afeId, uint16_t addr, uint8_t data, uint8_t lsb, uint8_t msb);
+uint8_t afeSpiWriteBatchWrapper(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count);
 uint8_t afeSpiReadWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint8_t *readVal);
+uint8_t afeSpiBurstWriteWrapper(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count);
+uint8_t afeSpiBurstReadWrapper(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count);
 uint8_t serdesWriteWrapper(uint8_t afeId, uint16_t addr, uint16_t data, uint8_t lsb, uint8_t msb);
 uint8_t serdesReadWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint16_t *readVal);
 uint8_t serdesLaneWriteWrapper(uint8_t afeId, uint16_t addr, uint8_t laneNo, uint16_t data, uint8_t lsb, uint8_t msb);
@@ -16,5 +19,16 @@ uint8_t afeSpiPollLogWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t
 uint8_t requestPllSpiAccess(uint8_t afeId, uint32_t regType);
 uint8_t readTopMem(uint8_t afeId, uint32_t addr, uint64_t *readVal, uint32_t noBytes);
 uint8_t closeAllPages(uint8_t afeId);
+uint8_t afeShadowCacheEnable(uint8_t afeId, uint8_t enable);
+uint8_t afeShadowCacheAddRange(uint8_t afeId, uint16_t startAddr, uint16_t endAddr);
+uint8_t afeShadowCacheClearRanges(uint8_t afeId);
+uint8_t afeShadowCacheInvalidate(uint8_t afeId);
+uint8_t afeShadowCacheGetStats(uint8_t afeId, uint32_t *hits, uint32_t *misses);
+uint8_t afePageTrackingSetMode(uint8_t afeId, uint8_t mode);
+uint8_t afePageFlushPendingCloses(uint8_t afeId);
+uint8_t afePageTrackingGetStats(uint8_t afeId, uint32_t *skippedWrites, uint32_t *lazySavedWrites, uint8_t reset);
+uint8_t afeSpiBurstEnable(uint8_t afeId, uint8_t enable);
+uint8_t afeSpiGetTransactionCount(uint8_t afeId, uint32_t *count, uint8_t reset);
+uint32_t afeGetDeviceStateEpoch(uint8_t afeId);
 
 #endif
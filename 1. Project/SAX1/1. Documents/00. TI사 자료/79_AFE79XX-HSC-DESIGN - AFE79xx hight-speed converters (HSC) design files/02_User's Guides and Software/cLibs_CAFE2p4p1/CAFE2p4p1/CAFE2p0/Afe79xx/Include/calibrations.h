@@ -2,6 +2,12 @@
 #define CALIBRATIONS_H
 uint8_t doRxDsaCalib(uint8_t afeId, uint8_t rxChainForCalib, uint8_t fbChainForCalib, uint8_t useTxForCalib, uint8_t rxDsaBandCalibMode, uint8_t *readPacket, uint16_t *readPacketSize);
 uint8_t doTxDsaCalib(uint8_t afeId, uint8_t txChainForCalib, uint8_t txDsaCalibMode, uint8_t txDsaBandCalibMode, uint8_t *readPacket, uint16_t *readPacketSize);
-uint8_t loadTxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize);
-uint8_t loadRxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize);
+uint8_t loadTxDsaPacket(uint8_t afeId, const uint8_t *array, uint16_t arraySize);
+uint8_t loadRxDsaPacket(uint8_t afeId, const uint8_t *array, uint16_t arraySize);
+uint8_t afeCalibStoreGetKey(uint8_t afeId, AfeCalibKey_t *key);
+uint8_t afeCalibStoreAdd(uint8_t *image, uint32_t imageSize, uint32_t *imageLen, const AfeCalibKey_t *key, uint8_t packetType, const uint8_t *packet, uint16_t packetSize);
+uint8_t afeCalibStoreFind(const uint8_t *image, uint32_t imageLen, const AfeCalibKey_t *key, uint8_t packetType, const uint8_t **packet, uint16_t *packetSize);
+uint8_t afeCalibStoreApply(uint8_t afeId, const uint8_t *image, uint32_t imageLen, uint8_t packetMask, uint32_t *applyUs, uint32_t *applyTransactions);
+uint8_t afeCalibStoreSave(char *file, const uint8_t *image, uint32_t imageLen);
+uint8_t afeCalibStoreLoad(char *file, uint8_t *image, uint32_t imageSize, uint32_t *imageLen);
 #endif
@@ -4,12 +4,21 @@
 uint8_t splitToByte(uint64_t val, uint8_t numBytes, uint8_t *splitByteList);
 uint8_t writeOperandList(uint8_t afeId, uint8_t *operandList, uint8_t numOfOperands);
 uint8_t readResultRegSpi(uint8_t afeId, uint8_t regNum, uint32_t *result);
+uint8_t afeMacroOperandBurstCheck(uint8_t afeId, uint8_t numBytes, uint32_t *singleTransactions, uint32_t *burstTransactions);
 uint8_t waitForMacroReady(uint8_t afeId);
 uint8_t waitForMacroDone(uint8_t afeId);
 uint8_t waitForMacroAck(uint8_t afeId);
 uint8_t checkForMacroError(uint8_t afeId, uint8_t *errorReg);
 uint8_t executeMacro(uint8_t afeId, uint8_t *byteList, uint8_t numOfOperands, uint8_t opcode);
 uint8_t triggerMacro(uint8_t afeId, uint8_t opcode);
+uint8_t macroSubmit(uint8_t afeId, uint8_t *byteList, uint8_t numOfOperands, uint8_t opcode, uint32_t *handle);
+uint8_t macroPoll(uint8_t afeId, uint32_t handle, uint8_t *done, uint8_t *macroErrorFlags);
+uint8_t macroWait(uint8_t afeId, uint32_t handle, uint8_t *macroErrorFlags);
+uint8_t afeMacroSetWaitMode(uint8_t afeId, uint8_t waitMode);
+uint8_t afeMacroSetDurationHint(uint8_t opcode, uint16_t durationMs);
+uint8_t afeMacroGetLatencyStats(uint8_t afeId, uint8_t opcode, uint32_t *count, uint64_t *totalUs, uint32_t *maxUs, uint32_t *bins);
+uint8_t afeMacroLogLatencyStats(uint8_t afeId);
+uint8_t afeMacroClearLatencyStats(uint8_t afeId);
 uint8_t enableMemAccess(uint8_t afeId, uint8_t en);
 uint8_t doSystemTuneSelective(uint8_t afeId, uint8_t rxChList, uint8_t fbChList, uint8_t txChList, uint8_t sectionEnable);
 uint8_t updateSystemTxChannelFreqConfig(uint8_t afeId, uint8_t txChList, uint8_t listNCO, uint32_t txNCO, uint8_t immUpdt, uint8_t reload);
@@ -0,0 +1,46 @@
+
+#ifndef HEALTH_MONITOR_H
+#define HEALTH_MONITOR_H
+
+/*  HEALTH MONITOR CHECKS (afeHealthMonitorConfig), bit n of the masks is check n   */
+#define AFE_HEALTH_CHECK_PLL 0
+#define AFE_HEALTH_CHECK_JESD_RX_LINK 1
+#define AFE_HEALTH_CHECK_JESD_RX_ALARMS 2
+#define AFE_HEALTH_CHECK_JESD_TX_FIFO_AB 3
+#define AFE_HEALTH_CHECK_JESD_TX_FIFO_CD 4
+#define AFE_HEALTH_CHECK_SPI_ALARMS 5
+#define AFE_HEALTH_CHECK_MCU 6
+#define AFE_HEALTH_CHECK_PAP_TXA 7
+#define AFE_HEALTH_CHECK_PAP_TXB 8
+#define AFE_HEALTH_CHECK_PAP_TXC 9
+#define AFE_HEALTH_CHECK_PAP_TXD 10
+#define AFE_HEALTH_NUM_CHECKS 11
+#define AFE_HEALTH_CHECK_ALL ((1 << AFE_HEALTH_NUM_CHECKS) - 1)
+
+typedef struct AFE_HEALTH_SNAPSHOT
+{
+    /// Number of afeHealthMonitorTick calls.
+    uint32_t tick;
+    /// Checks that have run at least once.
+    uint16_t validMask;
+    /// Checks whose last run found a fault.
+    uint16_t faultMask;
+    /// Checks whose last run failed on the SPI. They keep their previous value and fault state.
+    uint16_t errorMask;
+    /// Last state read by each check. state.faults has the AFE_HEALTH_FAULT_* bits of faultMask.
+    AfeDeviceHealth_t state;
+    /// Tick of the last run.
+    uint32_t lastTick[AFE_HEALTH_NUM_CHECKS];
+    uint32_t runs[AFE_HEALTH_NUM_CHECKS];
+    /// SPI transactions (afeSpiGetTransactionCount) of the last run and of all the runs.
+    uint32_t lastSpiCost[AFE_HEALTH_NUM_CHECKS];
+    uint32_t totalSpiCost[AFE_HEALTH_NUM_CHECKS];
+} AfeHealthSnapshot_t;
+
+uint8_t afeHealthMonitorConfig(uint8_t afeId, uint16_t enableMask, uint8_t checksPerTick);
+uint8_t afeHealthMonitorTick(uint8_t afeId, uint16_t *changedMask);
+uint8_t afeHealthMonitorRunAll(uint8_t afeId, uint16_t *changedMask);
+uint8_t afeHealthMonitorGetSnapshot(uint8_t afeId, AfeHealthSnapshot_t *snapshot);
+uint8_t afeHealthMonitorReset(uint8_t afeId);
+
+#endif
@@ -6,5 +6,9 @@
 int8_t configAfeFromFileFormat0(uint8_t afeId, char *file, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail);
 int8_t configAfeFromFileFormat5(uint8_t afeId, char *file, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail);
 int8_t configAfeFromFile(uint8_t afeId, uint8_t logFormat, char *file, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail);
+int8_t compileAfeScript(uint8_t logFormat, char *file, char *binFile);
+int8_t configAfeFromBinaryBuffer(uint8_t afeId, const uint8_t *image, uint32_t imageLen, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint32_t *parseTimeUs, uint32_t *spiTimeUs);
+int8_t configAfeFromBinary(uint8_t afeId, char *file, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint32_t *parseTimeUs, uint32_t *spiTimeUs);
+int8_t optimizeAfeScript(char *binFile, char *optFile, uint32_t flags, uint32_t *removedTransactions);
 
 #endif
@@ -8,6 +8,7 @@ uint8_t getJesdRxLaneFifoErrors(uint8_t afeId, uint8_t laneNo, uint8_t *error);
 uint8_t getJesdRxMiscSerdesErrors(uint8_t afeId, uint8_t jesdNo, uint8_t *errorValue);
 uint8_t getJesdRxAlarms(uint8_t afeId, uint8_t *error);
 uint8_t getJesdRxLinkStatus(uint8_t afeId, uint16_t *linkStatus);
+uint8_t getJesdRxLinkState(uint8_t afeId, AfeJesdRxLinkState_t *state);
 uint8_t getJesdRxLinkStatus204B(uint8_t afeId, uint16_t *linkStatus);
 uint8_t getJesdRxLinkStatus204C(uint8_t afeId, uint16_t *linkStatus);
 uint8_t clearJesdTxAlarms(uint8_t afeId);
@@ -10,6 +10,7 @@ uint8_t configurePap(uint8_t afeId, uint8_t chno, uint8_t enable, uint8_t multMo
 					 float waitCounter, float triggerClearToRampUp, float amplUpdateCycles, float alarmPulseGPIO,
 					 uint8_t alarmMask, uint8_t alarmChannelMask, uint8_t alarmPinDynamicMode, uint8_t rampStickyMode);
 uint8_t rampStickyClear(uint8_t afeId, uint8_t chno);
+uint8_t papGetAlarmStatus(uint8_t afeId, uint8_t chno, AfePapAlarmStatus_t *status);
 uint8_t papAlarmStatus(uint8_t afeId, uint8_t chno, uint8_t *alarmTriggered);
 uint8_t clearPapAlarms(uint8_t afeId, uint8_t chno);
 uint8_t configLaneErrorsForTxPap(uint8_t afeId, uint8_t chno, uint8_t laneMask);
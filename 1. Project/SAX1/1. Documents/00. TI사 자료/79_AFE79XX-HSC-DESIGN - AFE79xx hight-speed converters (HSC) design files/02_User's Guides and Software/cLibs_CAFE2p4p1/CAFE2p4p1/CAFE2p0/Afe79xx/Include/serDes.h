@@ -1,6 +1,36 @@
 #ifndef SERDES_H
 #define SERDES_H
 
+/*  SERDES MAILBOX (afeSerdesMailboxGetStats)   */
+/// Number of mailbox command types with statistics, the type is bits 15:12 of the command.
+#define AFE_SERDES_MAILBOX_NUM_CMDS 5
+
+/*  SERDES EYE SCAN (getSerdesEyeMulti)   */
+#define AFE_SERDES_EYE_NUM_PHASES 33
+#define AFE_SERDES_EYE_NUM_MARGINS 95
+#define AFE_SERDES_EYE_BER_EXP 7
+/// Phase and margin step of the quick eye.
+#define AFE_SERDES_EYE_QUICK_STEP 4
+
+typedef struct AFE_SERDES_EYE
+{
+    uint8_t laneNo;
+    uint8_t result;
+    uint8_t numPhases;
+    uint8_t numMargins;
+    int8_t firstPhase;
+    uint8_t phaseStep;
+    int8_t firstMargin;
+    uint8_t marginStep;
+    uint16_t extent;
+    uint32_t scanTimeUs;
+    uint16_t threshold;
+    uint16_t eyeHeight;
+    uint16_t eyeWidth;
+    uint16_t openArea;
+    uint16_t ber[AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS];
+} AfeSerdesEye_t;
+
 uint8_t serdesTx1010Pattern(uint8_t afeId, uint8_t laneNo);
 uint8_t serdesTxSendData(uint8_t afeId, uint8_t laneNo);
 uint8_t SetSerdesTxCursor(uint8_t afeId, uint8_t laneNo, uint8_t mainCursorSetting, uint8_t preCursorSetting, uint8_t postCursorSetting);
@@ -14,5 +44,12 @@ uint8_t reAdaptSerDesLane(uint8_t afeId, uint8_t laneNo);
 uint8_t resetSerDesDfeAllLanes(uint8_t afeId);
 uint8_t reAdaptSerDesAllLanes(uint8_t afeId);
 uint8_t getSerdesEye(uint8_t afeId, uint8_t laneNo, uint16_t *ber, uint16_t *extent);
+uint8_t afeSerdesMailboxGetStats(uint8_t afeId, uint8_t cmdType, uint32_t *count, uint32_t *timeouts, uint32_t *reads, uint64_t *totalUs, uint32_t *maxUs);
+uint8_t afeSerdesMailboxClearStats(uint8_t afeId);
+uint8_t getSerdesEyeMulti(uint8_t afeId, uint8_t laneList, uint8_t quick, AfeSerdesEye_t *eye);
+uint8_t afeSerdesEyeFromBer(AfeSerdesEye_t *eye, uint8_t laneNo, const uint16_t *ber, uint16_t extent);
+uint8_t afeSerdesEyeMetrics(AfeSerdesEye_t *eye, uint16_t threshold);
+uint8_t afeSerdesEyeSave(char *file, char *csvFile, uint32_t boardId, const AfeSerdesEye_t *eye, uint8_t numEyes);
+uint8_t afeSerdesEyeLoad(char *file, uint32_t *boardId, AfeSerdesEye_t *eye, uint8_t maxEyes, uint8_t *numEyes);
 
 #endif
@@ -0,0 +1,22 @@
+
+#ifndef SPI_TRACE_H
+#define SPI_TRACE_H
+
+/*  SPI TRACE OPERATIONS   */
+#define AFE_SPI_TRACE_OP_WRITE 1
+#define AFE_SPI_TRACE_OP_READ 2
+#define AFE_SPI_TRACE_OP_CHECK 3
+#define AFE_SPI_TRACE_OP_POLL 4
+#define AFE_SPI_TRACE_OP_SERDES_WRITE 5
+#define AFE_SPI_TRACE_OP_SERDES_READ 6
+/// Set in the result of a CHECK entry when the read value didn't match.
+#define AFE_SPI_TRACE_RESULT_MISMATCH 0x80
+
+void afeSpiTraceRecord(uint8_t afeId, uint8_t op, uint16_t addr, uint16_t data, uint8_t lsb, uint8_t msb, uint8_t result);
+uint8_t afeSpiTraceEnable(uint8_t afeId, uint8_t enable);
+uint8_t afeSpiTraceClear(uint8_t afeId);
+uint8_t afeSpiTraceGetStats(uint8_t afeId, uint32_t *recorded, uint32_t *dropped);
+uint8_t afeSpiTraceSave(uint8_t afeId, char *file);
+int8_t afeSpiTraceDecode(char *traceFile, char *scriptFile, uint32_t minWaitUs);
+
+#endif
@@ -18,22 +18,366 @@
 #include "baseFunc.h"
 #include "basicFunctions.h"
 #include "afeParameters.h"
+#include "spiTrace.h"
 
 #define MASK_BYTE(lsb, msb) (uint8_t)(((1 << ((msb) - (lsb) + 1)) - 1) << lsb)
 #define MASK_SHORT(lsb, msb) (uint16_t)(((1 << ((msb) - (lsb) + 1)) - 1) << lsb)
 #define CFG_SPI_READ_POLL_MAX_COUNT 500
 #define AFE_REQ_SPI_ACCESS_MAX_COUNT 100
+#define AFE_SHADOW_TAG_INVALID 0xFFFF
 static const uint16_t jesdToSerdesLaneMappingLocal[8] = jesdToSerdesLaneMapping;
 
-/**
-		@brief SerDes Read
-		@details SerDes registers are 16-bit wide while SPI is 8-bit. This necessitates a translation between SPI and SerDes. This function reads SerDes registers and returns the read value as a pointer.
-		@param afeId AFE ID
-		@param addr SerDes address
-		@param readVal Pointer returning the read value 
-		@return Returns if the function execution passed or failed.
-*/
-uint8_t serdesRawRead(uint8_t afeId, uint16_t addr, uint16_t *readVal)
+/* Last value written to each page select register, so that writes which don't change it can be dropped. */
+typedef struct AFE_PAGE_TRACKER
+{
+    uint8_t mode;
+    uint16_t known;
+    uint16_t pendingClose;
+    uint8_t state[AFE_NUM_PAGE_REGS];
+    uint32_t skippedWrites;
+    uint32_t lazySavedWrites;
+} AfePageTracker_t;
+
+/* Host-side copy of registers that only change through host writes. Entries are only valid for the page-select state they were filled in. */
+typedef struct AFE_SHADOW_CACHE
+{
+    uint8_t enabled;
+    uint8_t numRanges;
+    uint16_t rangeStart[AFE_SHADOW_CACHE_MAX_RANGES];
+    uint16_t rangeEnd[AFE_SHADOW_CACHE_MAX_RANGES];
+    uint16_t tag[AFE_SHADOW_CACHE_SIZE];
+    uint8_t value[AFE_SHADOW_CACHE_SIZE];
+    uint32_t hits;
+    uint32_t misses;
+} AfeShadowCache_t;
+
+static AfePageTracker_t afePageTracker[NUM_OF_AFE];
+static AfeShadowCache_t afeShadowCache[NUM_OF_AFE];
+/* SPI transactions the driver completed: one per single write or read, one per batch entry and one per burst. A failed call counts none. */
+static uint32_t afeSpiTransactions[NUM_OF_AFE];
+/* Set once the AFE and the driver are known to step the address through a burst, see afeSpiBurstEnable. */
+static uint8_t afeSpiBurstEnabled[NUM_OF_AFE];
+/* Counts the times the library stopped trusting what it knows of the device registers, see afeGetDeviceStateEpoch. */
+static uint32_t afeDeviceStateEpoch[NUM_OF_AFE];
+
+static void spiCountTransactions(uint8_t afeId, uint16_t count)
+{
+    if (afeId < NUM_OF_AFE)
+        afeSpiTransactions[afeId] += count;
+}
+
+static AfeShadowCache_t *shadowGet(uint8_t afeId)
+{
+    if ((afeId >= NUM_OF_AFE) || (afeShadowCache[afeId].enabled == 0))
+        return NULL;
+    return &afeShadowCache[afeId];
+}
+
+static void shadowClearEntries(AfeShadowCache_t *cache)
+{
+    for (uint16_t i = 0; i < AFE_SHADOW_CACHE_SIZE; i++)
+    {
+        cache->tag[i] = AFE_SHADOW_TAG_INVALID;
+    }
+}
+
+static uint8_t shadowIsCacheable(AfeShadowCache_t *cache, uint16_t addr)
+{
+    if ((addr >= AFE_PAGE_START_ADDR) && (addr <= AFE_PAGE_END_ADDR))
+        return 0;
+    for (uint8_t i = 0; i < cache->numRanges; i++)
+    {
+        if ((addr >= cache->rangeStart[i]) && (addr <= cache->rangeEnd[i]))
+            return 1;
+    }
+    return 0;
+}
+
+/* Records a register value that is now on the device, either written or read back. Keeps the page-select state and the shadow cache in line with it. */
+static void trackDeviceValue(uint8_t afeId, uint16_t addr, uint8_t data)
+{
+    AfeShadowCache_t *cache = shadowGet(afeId);
+    if (afeId >= NUM_OF_AFE)
+        return;
+    if ((addr >= AFE_PAGE_START_ADDR) && (addr <= AFE_PAGE_END_ADDR))
+    {
+        AfePageTracker_t *pages = &afePageTracker[afeId];
+        uint8_t index = addr - AFE_PAGE_START_ADDR;
+        if ((cache != NULL) && ((((pages->known >> index) & 1) == 0) || (pages->state[index] != data)))
+        {
+            shadowClearEntries(cache);
+        }
+        pages->state[index] = data;
+        pages->known |= (uint16_t)(1 << index);
+        return;
+    }
+    if ((cache != NULL) && shadowIsCacheable(cache, addr))
+    {
+        cache->tag[addr % AFE_SHADOW_CACHE_SIZE] = addr;
+        cache->value[addr % AFE_SHADOW_CACHE_SIZE] = data;
+    }
+}
+
+/* After a failed SPI transfer nothing is known about what reached the device. */
+static void trackDeviceLost(uint8_t afeId)
+{
+    AfeShadowCache_t *cache = shadowGet(afeId);
+    if (afeId >= NUM_OF_AFE)
+        return;
+    afeDeviceStateEpoch[afeId]++;
+    afePageTracker[afeId].known = 0;
+    afePageTracker[afeId].pendingClose = 0;
+    if (cache != NULL)
+        shadowClearEntries(cache);
+}
+
+static uint8_t shadowLookup(uint8_t afeId, uint16_t addr, uint8_t *readVal)
+{
+    AfeShadowCache_t *cache = shadowGet(afeId);
+    if ((cache == NULL) || (shadowIsCacheable(cache, addr) == 0))
+        return 0;
+    if (cache->tag[addr % AFE_SHADOW_CACHE_SIZE] == addr)
+    {
+        cache->hits++;
+        *readVal = cache->value[addr % AFE_SHADOW_CACHE_SIZE];
+        return 1;
+    }
+    cache->misses++;
+    return 0;
+}
+
+static uint8_t pageEmit(uint8_t afeId, uint16_t addr, uint8_t data, uint16_t *emitAddr, uint8_t *emitData, uint8_t numEmit)
+{
+    emitAddr[numEmit] = addr;
+    emitData[numEmit] = data;
+    trackDeviceValue(afeId, addr, data);
+    return numEmit + 1;
+}
+
+/* Appends the page closes held back by the lazy close mode. */
+static uint8_t pageEmitPendingCloses(uint8_t afeId, uint16_t *emitAddr, uint8_t *emitData, uint8_t numEmit)
+{
+    AfePageTracker_t *pages = &afePageTracker[afeId];
+    for (uint8_t index = 0; (index < AFE_NUM_PAGE_REGS) && (pages->pendingClose != 0); index++)
+    {
+        if ((pages->pendingClose >> index) & 1)
+        {
+            pages->pendingClose &= (uint16_t)~(1 << index);
+            numEmit = pageEmit(afeId, AFE_PAGE_START_ADDR + index, 0, emitAddr, emitData, numEmit);
+        }
+    }
+    return numEmit;
+}
+
+/* Turns one register write into the SPI writes that have to reach the device, at most AFE_NUM_PAGE_REGS + 1 of them.
+   Page writes that don't change the page are dropped. In lazy close mode, closing a page is held back until another page or a non-page register is accessed, and re-opening the same page cancels it. */
+static uint8_t pageFilterWrite(uint8_t afeId, uint16_t addr, uint8_t data, uint16_t *emitAddr, uint8_t *emitData)
+{
+    AfePageTracker_t *pages;
+    uint8_t numEmit = 0;
+
+    if ((afeId >= NUM_OF_AFE) || (afePageTracker[afeId].mode == AFE_PAGE_TRACK_OFF))
+        return pageEmit(afeId, addr, data, emitAddr, emitData, 0);
+    pages = &afePageTracker[afeId];
+    if ((addr < AFE_PAGE_START_ADDR) || (addr > AFE_PAGE_END_ADDR))
+    {
+        numEmit = pageEmitPendingCloses(afeId, emitAddr, emitData, 0);
+        return pageEmit(afeId, addr, data, emitAddr, emitData, numEmit);
+    }
+
+    uint8_t index = addr - AFE_PAGE_START_ADDR;
+    uint16_t bit = (uint16_t)(1 << index);
+    uint8_t known = (pages->known & bit) != 0;
+    if (pages->mode == AFE_PAGE_TRACK_LAZY_CLOSE)
+    {
+        if ((data == 0) && known && (pages->state[index] != 0))
+        {
+            pages->pendingClose |= bit;
+            return 0;
+        }
+        if (pages->pendingClose & bit)
+        {
+            pages->pendingClose &= (uint16_t)~bit;
+            if (pages->state[index] == data)
+            {
+                /* Close and re-open of the same page both dropped. */
+                pages->lazySavedWrites += 2;
+                return 0;
+            }
+            /* The new page value replaces the close. */
+            pages->lazySavedWrites++;
+        }
+        /* Another page is about to be opened, so the held back closes have to happen first. */
+        numEmit = pageEmitPendingCloses(afeId, emitAddr, emitData, 0);
+    }
+    if (known && (pages->state[index] == data))
+    {
+        pages->skippedWrites++;
+        return numEmit;
+    }
+    return pageEmit(afeId, addr, data, emitAddr, emitData, numEmit);
+}
+
+/* SPI write that goes through the page tracking and keeps the shadow cache up to date. */
+static uint8_t spiWriteTracked(uint8_t afeId, uint16_t addr, uint8_t data)
+{
+    uint16_t emitAddr[AFE_NUM_PAGE_REGS + 1];
+    uint8_t emitData[AFE_NUM_PAGE_REGS + 1];
+    uint8_t numEmit = pageFilterWrite(afeId, addr, data, emitAddr, emitData);
+    for (uint8_t i = 0; i < numEmit; i++)
+    {
+        if (RET_OK != dev_spi_write(afeId, emitAddr[i], emitData[i]))
+        {
+            trackDeviceLost(afeId);
+            return RET_EXEC_FAIL;
+        }
+        spiCountTransactions(afeId, 1);
+    }
+    return RET_OK;
+}
+
+static uint8_t spiWriteBatchTracked(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count)
+{
+    if (count == 0)
+        return RET_OK;
+    /* The driver doesn't say how much of a failed batch was sent, so only a complete batch is counted. */
+    if (RET_OK != dev_spi_write_batch(afeId, addr, data, count))
+    {
+        trackDeviceLost(afeId);
+        return RET_EXEC_FAIL;
+    }
+    spiCountTransactions(afeId, count);
+    return RET_OK;
+}
+
+/* Writes the page closes held back by the lazy close mode, so that the next access sees the pages the caller expects. */
+static uint8_t spiWritePendingCloses(uint8_t afeId)
+{
+    if ((afeId < NUM_OF_AFE) && (afePageTracker[afeId].pendingClose != 0))
+    {
+        uint16_t emitAddr[AFE_NUM_PAGE_REGS];
+        uint8_t emitData[AFE_NUM_PAGE_REGS];
+        uint8_t numEmit = pageEmitPendingCloses(afeId, emitAddr, emitData, 0);
+        return spiWriteBatchTracked(afeId, emitAddr, emitData, numEmit);
+    }
+    return RET_OK;
+}
+
+static uint8_t spiReadTracked(uint8_t afeId, uint16_t addr, uint8_t *readVal)
+{
+    if (RET_OK != spiWritePendingCloses(afeId))
+        return RET_EXEC_FAIL;
+    if (RET_OK != dev_spi_read(afeId, addr, readVal))
+    {
+        trackDeviceLost(afeId);
+        return RET_EXEC_FAIL;
+    }
+    spiCountTransactions(afeId, 1);
+    trackDeviceValue(afeId, addr, *readVal);
+    return RET_OK;
+}
+
+/* The range of a burst holds a page select register, so the writes to it have to go through the page tracking one by one. */
+static uint8_t spiRangeHasPageRegs(uint16_t addr, uint16_t count)
+{
+    return (addr <= AFE_PAGE_END_ADDR) && (((uint32_t)addr + count - 1) >= AFE_PAGE_START_ADDR);
+}
+
+static uint8_t spiBurstEnabled(uint8_t afeId)
+{
+    return (afeId < NUM_OF_AFE) && afeSpiBurstEnabled[afeId];
+}
+
+/* Burst write of registers outside the page select range. Until the bursts are enabled, every register gets its own frame, still sent in batches. */
+static uint8_t spiWriteBurstTracked(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count)
+{
+    uint16_t addrList[AFE_SPI_BATCH_MAX_LEN];
+    uint16_t batchLen = 0;
+
+    if (RET_OK != spiWritePendingCloses(afeId))
+        return RET_EXEC_FAIL;
+    if (spiBurstEnabled(afeId))
+    {
+        if (RET_OK != dev_spi_write_burst(afeId, addr, data, count))
+        {
+            trackDeviceLost(afeId);
+            return RET_EXEC_FAIL;
+        }
+        spiCountTransactions(afeId, 1);
+    }
+    else
+    {
+        for (uint16_t done = 0; done < count; done += batchLen)
+        {
+            batchLen = ((count - done) < AFE_SPI_BATCH_MAX_LEN) ? (count - done) : AFE_SPI_BATCH_MAX_LEN;
+            for (uint16_t i = 0; i < batchLen; i++)
+            {
+                addrList[i] = addr + done + i;
+            }
+            if (RET_OK != spiWriteBatchTracked(afeId, addrList, &data[done], batchLen))
+                return RET_EXEC_FAIL;
+        }
+    }
+    for (uint16_t i = 0; i < count; i++)
+    {
+        trackDeviceValue(afeId, addr + i, data[i]);
+    }
+    return RET_OK;
+}
+
+/* Burst read, or one read per register until the bursts are enabled. */
+static uint8_t spiReadBurstTracked(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count)
+{
+    if (RET_OK != spiWritePendingCloses(afeId))
+        return RET_EXEC_FAIL;
+    if (spiBurstEnabled(afeId))
+    {
+        if (RET_OK != dev_spi_read_burst(afeId, addr, data, count))
+        {
+            trackDeviceLost(afeId);
+            return RET_EXEC_FAIL;
+        }
+        spiCountTransactions(afeId, 1);
+    }
+    else
+    {
+        for (uint16_t i = 0; i < count; i++)
+        {
+            if (RET_OK != dev_spi_read(afeId, addr + i, &data[i]))
+            {
+                trackDeviceLost(afeId);
+                return RET_EXEC_FAIL;
+            }
+            spiCountTransactions(afeId, 1);
+        }
+    }
+    for (uint16_t i = 0; i < count; i++)
+    {
+        trackDeviceValue(afeId, addr + i, data[i]);
+    }
+    return RET_OK;
+}
+
+/* Read for read-modify-write. Served from the shadow cache when the register is marked non-volatile, otherwise a SPI read that fills the cache. */
+static uint8_t spiReadForUpdate(uint8_t afeId, uint16_t addr, uint8_t *readVal)
+{
+    if (shadowLookup(afeId, addr, readVal))
+        return RET_OK;
+    return spiReadTracked(afeId, addr, readVal);
+}
+
+static uint8_t serdesRawReadByte(uint8_t afeId, uint16_t addr, uint8_t useShadow, uint8_t *readVal)
+{
+    uint8_t errorStatus = 0;
+    if (useShadow && shadowLookup(afeId, addr, readVal))
+        return RET_OK;
+    /* It is important to read each Byte twice, but only the second matters. */
+    AFE_SPI_EXEC(spiReadTracked(afeId, addr, readVal));
+    AFE_SPI_EXEC(spiReadTracked(afeId, addr, readVal));
+    return RET_OK;
+}
+
+static uint8_t serdesRawReadShadow(uint8_t afeId, uint16_t addr, uint8_t useShadow, uint16_t *readVal)
 {
     uint8_t errorStatus = 0;
     uint8_t ucValueHigh = 0;
@@ -42,11 +386,8 @@ uint8_t serdesRawRead(uint8_t afeId, uint16_t addr, uint16_t *readVal)
 
     AFE_PARAMS_VALID(readVal != NULL)
 
-    /* It is important to read each Byte twice, but only the second matters. */
-    AFE_SPI_EXEC(dev_spi_read(afeId, (usAddr + 1), &ucValueHigh));
-    AFE_SPI_EXEC(dev_spi_read(afeId, (usAddr + 1), &ucValueHigh));
-    AFE_SPI_EXEC(dev_spi_read(afeId, usAddr, &ucValueLow));
-    AFE_SPI_EXEC(dev_spi_read(afeId, usAddr, &ucValueLow));
+    AFE_FUNC_EXEC(serdesRawReadByte(afeId, (usAddr + 1), useShadow, &ucValueHigh));
+    AFE_FUNC_EXEC(serdesRawReadByte(afeId, usAddr, useShadow, &ucValueLow));
 
     *readVal = ((uint16_t)ucValueHigh << 8) | (uint16_t)ucValueLow;
     afeLogSpiLog("SerDes Raw READ: AFEID:%d: ADDR: 0X%X, Read Val: 0X%X", afeId, addr, *readVal);
@@ -54,33 +395,46 @@ uint8_t serdesRawRead(uint8_t afeId, uint16_t addr, uint16_t *readVal)
 }
 
 /**
-		@brief SerDes Write
-		@details SerDes registers are 16-bit wide while SPI is 8-bit. This necessitates a translation between SPI and SerDes. This function writes SerDes registers.
+		@brief SerDes Read
+		@details SerDes registers are 16-bit wide while SPI is 8-bit. This necessitates a translation between SPI and SerDes. This function reads SerDes registers and returns the read value as a pointer.
 		@param afeId AFE ID
 		@param addr SerDes address
-		@param data Value to be written.
+		@param readVal Pointer returning the read value 
 		@return Returns if the function execution passed or failed.
 */
-uint8_t serdesRawWrite(uint8_t afeId, uint16_t addr, uint16_t data)
+uint8_t serdesRawRead(uint8_t afeId, uint16_t addr, uint16_t *readVal)
+{
+    uint8_t result = serdesRawReadShadow(afeId, addr, 0, readVal);
+    afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_SERDES_READ, addr, (result == RET_OK) ? *readVal : 0, 0, 15, result);
+    return result;
+}
+
+/* The public SPI wrappers run the operation in a static function and then add it to the SPI trace, so failures returned early by AFE_SPI_EXEC are traced too. */
+static uint8_t serdesRawWriteBytes(uint8_t afeId, uint16_t addr, uint16_t data)
 {
     uint8_t errorStatus = 0;
     afeLogSpiLog("SerDes Raw Write: AFEID:%d: ADDR: 0X%X, Write Val: 0X%X", afeId, addr, data);
-    AFE_SPI_EXEC(dev_spi_write(afeId, (((addr + 0x2000) << 1) + 1) & 0x7fff, (uint8_t)((data >> 8) & 0xFF)));
-    AFE_SPI_EXEC(dev_spi_write(afeId, ((addr + 0x2000) << 1) & 0x7fff, (uint8_t)(data & 0xff)));
+    AFE_SPI_EXEC(spiWriteTracked(afeId, (((addr + 0x2000) << 1) + 1) & 0x7fff, (uint8_t)((data >> 8) & 0xFF)));
+    AFE_SPI_EXEC(spiWriteTracked(afeId, ((addr + 0x2000) << 1) & 0x7fff, (uint8_t)(data & 0xff)));
     return RET_OK;
 }
 
 /**
-		@brief SPI Write Wrapper
-		@details Writes the value to the specified bits of the register.
+		@brief SerDes Write
+		@details SerDes registers are 16-bit wide while SPI is 8-bit. This necessitates a translation between SPI and SerDes. This function writes SerDes registers.
 		@param afeId AFE ID
-		@param addr SPI address
+		@param addr SerDes address
 		@param data Value to be written.
-		@param lsb lsb of the field.
-		@param msb msb of the field.
 		@return Returns if the function execution passed or failed.
 */
-uint8_t afeSpiWriteWrapper(uint8_t afeId, uint16_t addr, uint8_t data, uint8_t lsb, uint8_t msb)
+uint8_t serdesRawWrite(uint8_t afeId, uint16_t addr, uint16_t data)
+{
+    uint8_t result = serdesRawWriteBytes(afeId, addr, data);
+    afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_SERDES_WRITE, addr, data, 0, 15, result);
+    return result;
+}
+
+static uint8_t spiWriteField(uint8_t afeId, uint16_t addr, uint8_t data, uint8_t lsb, uint8_t msb)
 {
     uint8_t errorStatus = 0;
     uint8_t readValue = 0;
@@ -91,29 +445,121 @@ uint8_t afeSpiWriteWrapper(uint8_t afeId, uint16_t addr, uint8_t data, uint8_t l
     afeLogSpiLog("WRITE: afeId: %d, addr: 0x%X, data: 0x%X, lsb: %d, msb: %d", afeId, addr, data, lsb, msb);
     if ((msb == 7) && (lsb == 0))
     {
-        AFE_SPI_EXEC(dev_spi_write(afeId, addr, data));
+        AFE_SPI_EXEC(spiWriteTracked(afeId, addr, data));
         return RET_OK;
     }
 
-    AFE_SPI_EXEC(dev_spi_read(afeId, addr, &readValue));
+    AFE_SPI_EXEC(spiReadForUpdate(afeId, addr, &readValue));
     mask = MASK_BYTE(lsb, msb);
     writeValue = (readValue & (0xFF ^ mask)) | (data & mask);
-    AFE_SPI_EXEC(dev_spi_write(afeId, addr, writeValue));
+    AFE_SPI_EXEC(spiWriteTracked(afeId, addr, writeValue));
 
     return RET_OK;
 }
 
 /**
-		@brief SPI Read Wrapper
-		@details Reads the value to the specified bits of the register and returns as a pointer.
+		@brief SPI Write Wrapper
+		@details Writes the value to the specified bits of the register.
 		@param afeId AFE ID
 		@param addr SPI address
+		@param data Value to be written.
 		@param lsb lsb of the field.
 		@param msb msb of the field.
-		@param readVal pointer of the read value.
 		@return Returns if the function execution passed or failed.
 */
-uint8_t afeSpiReadWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint8_t *readVal)
+uint8_t afeSpiWriteWrapper(uint8_t afeId, uint16_t addr, uint8_t data, uint8_t lsb, uint8_t msb)
+{
+    uint8_t result = spiWriteField(afeId, addr, data, lsb, msb);
+    afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_WRITE, addr, data, lsb, msb, result);
+    return result;
+}
+
+static uint8_t spiWriteBatchFull(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count)
+{
+    uint8_t errorStatus = 0;
+
+    uint16_t emitAddr[AFE_SPI_BATCH_MAX_LEN + AFE_NUM_PAGE_REGS + 1];
+    uint8_t emitData[AFE_SPI_BATCH_MAX_LEN + AFE_NUM_PAGE_REGS + 1];
+    uint16_t numEmit = 0;
+
+    AFE_PARAMS_VALID((addr != NULL) && (data != NULL));
+    for (uint16_t i = 0; i < count; i++)
+    {
+        afeLogSpiLog("WRITE: afeId: %d, addr: 0x%X, data: 0x%X, lsb: %d, msb: %d", afeId, addr[i], data[i], 0, 7);
+        numEmit += pageFilterWrite(afeId, addr[i], data[i], &emitAddr[numEmit], &emitData[numEmit]);
+        if (numEmit >= AFE_SPI_BATCH_MAX_LEN)
+        {
+            AFE_SPI_EXEC(spiWriteBatchTracked(afeId, emitAddr, emitData, numEmit));
+            numEmit = 0;
+        }
+    }
+    AFE_SPI_EXEC(spiWriteBatchTracked(afeId, emitAddr, emitData, numEmit));
+    return RET_OK;
+}
+
+/**
+		@brief SPI Batch Write Wrapper
+		@details Writes full bytes to a list of registers in order. The list is handed to dev_spi_write_batch so the driver can send it as one transfer.
+		@param afeId AFE ID
+		@param addr Array of SPI addresses.
+		@param data Array of values to be written.
+		@param count Number of entries in addr and data.
+		@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiWriteBatchWrapper(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count)
+{
+    uint8_t result = spiWriteBatchFull(afeId, addr, data, count);
+    if ((addr != NULL) && (data != NULL))
+    {
+        for (uint16_t i = 0; i < count; i++)
+            afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_WRITE, addr[i], data[i], 0, 7, result);
+    }
+    return result;
+}
+
+static uint8_t spiWriteBurstFull(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count)
+{
+    uint8_t errorStatus = 0;
+
+    AFE_PARAMS_VALID(data != NULL);
+    AFE_PARAMS_VALID((count != 0) && (((uint32_t)addr + count) <= 0x8000));
+    for (uint16_t i = 0; i < count; i++)
+    {
+        afeLogSpiLog("WRITE: afeId: %d, addr: 0x%X, data: 0x%X, lsb: %d, msb: %d", afeId, addr + i, data[i], 0, 7);
+    }
+    if (spiRangeHasPageRegs(addr, count))
+    {
+        for (uint16_t i = 0; i < count; i++)
+        {
+            AFE_SPI_EXEC(spiWriteTracked(afeId, addr + i, data[i]));
+        }
+        return RET_OK;
+    }
+    AFE_SPI_EXEC(spiWriteBurstTracked(afeId, addr, data, count));
+    return RET_OK;
+}
+
+/**
+		@brief SPI Burst Write Wrapper
+		@details Writes full bytes to count consecutive registers starting at addr. Once enabled with afeSpiBurstEnable, the block is handed to dev_spi_write_burst, so the driver can send the address once followed by all the data in one chip select window. Until then, and for a block that holds a page select register, the registers are written one frame each.
+		@param afeId AFE ID
+		@param addr SPI address of the first register.
+		@param data Array of values to be written.
+		@param count Number of registers.
+		@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiBurstWriteWrapper(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count)
+{
+    uint8_t result = spiWriteBurstFull(afeId, addr, data, count);
+    if (data != NULL)
+    {
+        for (uint16_t i = 0; i < count; i++)
+            afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_WRITE, addr + i, data[i], 0, 7, result);
+    }
+    return result;
+}
+
+static uint8_t spiReadField(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint8_t *readVal)
 {
     uint8_t errorStatus = 0;
     uint8_t readValue = 0;
@@ -121,12 +567,63 @@ uint8_t afeSpiReadWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb
     AFE_PARAMS_VALID((msb < 8) && (lsb <= msb));
     AFE_PARAMS_VALID(readVal != NULL)
 
-    AFE_SPI_EXEC(dev_spi_read(afeId, addr, &readValue));
+    AFE_SPI_EXEC(spiReadTracked(afeId, addr, &readValue));
     *readVal = (readValue & MASK_BYTE(lsb, msb)) >> lsb;
     afeLogSpiLog("READ: afeId: %d, addr: 0x%X, Read Value: 0x%X, lsb: %d, msb: %d", afeId, addr, *readVal, lsb, msb);
     return RET_OK;
 }
 
+/**
+		@brief SPI Read Wrapper
+		@details Reads the value to the specified bits of the register and returns as a pointer.
+		@param afeId AFE ID
+		@param addr SPI address
+		@param lsb lsb of the field.
+		@param msb msb of the field.
+		@param readVal pointer of the read value.
+		@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiReadWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint8_t *readVal)
+{
+    uint8_t result = spiReadField(afeId, addr, lsb, msb, readVal);
+    afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_READ, addr, (result == RET_OK) ? *readVal : 0, lsb, msb, result);
+    return result;
+}
+
+static uint8_t spiReadBurstFull(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count)
+{
+    uint8_t errorStatus = 0;
+
+    AFE_PARAMS_VALID(data != NULL);
+    AFE_PARAMS_VALID((count != 0) && (((uint32_t)addr + count) <= 0x8000));
+    AFE_SPI_EXEC(spiReadBurstTracked(afeId, addr, data, count));
+    for (uint16_t i = 0; i < count; i++)
+    {
+        afeLogSpiLog("READ: afeId: %d, addr: 0x%X, Read Value: 0x%X, lsb: %d, msb: %d", afeId, addr + i, data[i], 0, 7);
+    }
+    return RET_OK;
+}
+
+/**
+		@brief SPI Burst Read Wrapper
+		@details Reads full bytes from count consecutive registers starting at addr. Once enabled with afeSpiBurstEnable, the block is handed to dev_spi_read_burst, so the driver can send the address once and read all the data in one chip select window. Until then, the registers are read one frame each.
+		@param afeId AFE ID
+		@param addr SPI address of the first register.
+		@param data Array returning the values read.
+		@param count Number of registers.
+		@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiBurstReadWrapper(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count)
+{
+    uint8_t result = spiReadBurstFull(afeId, addr, data, count);
+    if (data != NULL)
+    {
+        for (uint16_t i = 0; i < count; i++)
+            afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_READ, addr + i, (result == RET_OK) ? data[i] : 0, 0, 7, result);
+    }
+    return result;
+}
+
 /**
 		@brief SerDes Write Wrapper
 		@details Writes the value to the specified bits of the SerDes register.
@@ -152,7 +649,7 @@ uint8_t serdesWriteWrapper(uint8_t afeId, uint16_t addr, uint16_t data, uint8_t
         return RET_OK;
     }
 
-    AFE_FUNC_EXEC(serdesRawRead(afeId, addr, &readValue));
+    AFE_FUNC_EXEC(serdesRawReadShadow(afeId, addr, 1, &readValue));
     mask = MASK_SHORT(lsb, msb);
     writeValue = (readValue & (0xFFFF ^ mask)) | (data & mask);
     AFE_SPI_EXEC(serdesRawWrite(afeId, addr, writeValue));
@@ -214,7 +711,7 @@ uint8_t serdesLaneWriteWrapper(uint8_t afeId, uint16_t addr, uint8_t laneNo, uin
         return RET_OK;
     }
 
-    AFE_FUNC_EXEC(serdesRawRead(afeId, usAddr, &readValue));
+    AFE_FUNC_EXEC(serdesRawReadShadow(afeId, usAddr, 1, &readValue));
     mask = MASK_SHORT(lsb, msb);
     writeValue = (readValue & (0xFFFF ^ mask)) | (data & mask);
     AFE_SPI_EXEC(serdesRawWrite(afeId, usAddr, writeValue));
@@ -249,18 +746,7 @@ uint8_t serdesLaneReadWrapper(uint8_t afeId, uint16_t addr, uint32_t laneNo, uin
     return RET_OK;
 }
 
-/**
-    @brief AFE SPI Check Wrapper
-    @details Reads and checks if the value of the field is as expected. Check Pass condition is (readValue&mask)==(data&mask) where mask = (((1 << ((msb) - (lsb) + 1)) - 1) << lsb);
-    @param afeId AFE ID
-    @param addr SPI address
-    @param data Expected Value.
-    @param lsb lsb of the field.
-    @param msb msb of the field.
-    @param pbSame Pointer return. Returns 0 if the check passes and if check fails.
-    @return Returns if the function execution passed or failed.
-*/
-uint8_t afeSpiCheckWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint8_t data, uint8_t *pbSame)
+static uint8_t spiCheckField(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint8_t data, uint8_t *pbSame, uint8_t *readVal)
 {
     uint8_t errorStatus = 0;
     uint8_t readValue = 0;
@@ -269,8 +755,9 @@ uint8_t afeSpiCheckWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t ms
     AFE_PARAMS_VALID((msb < 8) && (lsb <= msb));
     AFE_PARAMS_VALID(pbSame != NULL)
 
-    AFE_SPI_EXEC(dev_spi_read(afeId, addr, &readValue));
+    AFE_SPI_EXEC(spiReadTracked(afeId, addr, &readValue));
 
+    *readVal = readValue;
     mask = MASK_BYTE(lsb, msb);
     afeLogSpiLog("READ Check: afeId: %d, addr: 0x%X, lsb: %d, msb: %d, Read Value: 0x%X, Expected Value:0x%X", afeId, addr, lsb, msb, readValue & mask, data & mask);
     if ((readValue & mask) != (data & mask))
@@ -285,21 +772,29 @@ uint8_t afeSpiCheckWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t ms
 }
 
 /**
-    @brief AFE SPI Poll Wrapper
-    @details Polls and checks if the value of the field is as expected. Check Pass condition is (readValue&mask)==(data&mask) where mask = (((1 << ((msb) - (lsb) + 1)) - 1) << lsb);
+    @brief AFE SPI Check Wrapper
+    @details Reads and checks if the value of the field is as expected. Check Pass condition is (readValue&mask)==(data&mask) where mask = (((1 << ((msb) - (lsb) + 1)) - 1) << lsb);
     @param afeId AFE ID
     @param addr SPI address
-    @param expectedData Expected Value.
+    @param data Expected Value.
     @param lsb lsb of the field.
     @param msb msb of the field.
-    @return Returns if the function execution passed or failed. It returns fail even when the read data didn't match the expected value.
+    @param pbSame Pointer return. Returns 0 if the check passes and if check fails.
+    @return Returns if the function execution passed or failed.
 */
-uint8_t afeSpiPollWrapper(uint8_t afeId, uint16_t addr, uint8_t expectedData, uint8_t lsb, uint8_t msb)
+uint8_t afeSpiCheckWrapper(uint8_t afeId, uint16_t addr, uint8_t lsb, uint8_t msb, uint8_t data, uint8_t *pbSame)
+{
+    uint8_t readValue = 0;
+    uint8_t result = spiCheckField(afeId, addr, lsb, msb, data, pbSame, &readValue);
+    afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_CHECK, addr, (uint16_t)(data | (readValue << 8)), lsb, msb, ((result == RET_OK) && (*pbSame != 0)) ? (result | AFE_SPI_TRACE_RESULT_MISMATCH) : result);
+    return result;
+}
+
+static uint8_t spiPollField(uint8_t afeId, uint16_t addr, uint8_t expectedData, uint8_t lsb, uint8_t msb, uint8_t *readValue)
 {
     uint8_t errorStatus = 0;
     uint32_t count = 0;
     uint8_t mask = 0;
-    uint8_t readValue = 0;
 
     AFE_PARAMS_VALID((msb < 8) && (lsb <= msb));
 
@@ -308,8 +803,8 @@ uint8_t afeSpiPollWrapper(uint8_t afeId, uint16_t addr, uint8_t expectedData, ui
 
     for (count = 0; count < CFG_SPI_READ_POLL_MAX_COUNT; count++)
     {
-        AFE_SPI_EXEC(dev_spi_read(afeId, addr, &readValue));
-        if ((readValue & mask) == (expectedData & mask))
+        AFE_SPI_EXEC(spiReadTracked(afeId, addr, readValue));
+        if ((*readValue & mask) == (expectedData & mask))
             break;
         AFE_FUNC_EXEC(waitMs(2));
     }
@@ -322,6 +817,24 @@ uint8_t afeSpiPollWrapper(uint8_t afeId, uint16_t addr, uint8_t expectedData, ui
     return RET_OK;
 }
 
+/**
+    @brief AFE SPI Poll Wrapper
+    @details Polls and checks if the value of the field is as expected. Check Pass condition is (readValue&mask)==(data&mask) where mask = (((1 << ((msb) - (lsb) + 1)) - 1) << lsb);
+    @param afeId AFE ID
+    @param addr SPI address
+    @param expectedData Expected Value.
+    @param lsb lsb of the field.
+    @param msb msb of the field.
+    @return Returns if the function execution passed or failed. It returns fail even when the read data didn't match the expected value.
+*/
+uint8_t afeSpiPollWrapper(uint8_t afeId, uint16_t addr, uint8_t expectedData, uint8_t lsb, uint8_t msb)
+{
+    uint8_t readValue = 0;
+    uint8_t result = spiPollField(afeId, addr, expectedData, lsb, msb, &readValue);
+    afeSpiTraceRecord(afeId, AFE_SPI_TRACE_OP_POLL, addr, (uint16_t)(expectedData | (readValue << 8)), lsb, msb, result);
+    return result;
+}
+
 /**
     @brief AFE SPI Poll Wrapper
     @details Polls and checks if the value of the field is as expected. Check Pass condition is (readValue&mask)==(data&mask) where mask = (((1 << ((msb) - (lsb) + 1)) - 1) << lsb); Function definition reordered from afeSpiPollWrapper to suit the log format.
@@ -447,7 +960,7 @@ static const uint32_t ausAddr[] =
 
 /**
     @brief Reads the MCU Memory
-    @details This reads the MCU memory and returns the value as a pointer.
+    @details This reads the MCU memory and returns the value as a pointer. The bytes are read in one SPI burst.
     @param afeId AFE ID
     @param addr Memory Address.
     @param readVal Value read returned as a pointer.
@@ -460,7 +973,7 @@ uint8_t readTopMem(uint8_t afeId, uint32_t addr, uint64_t *readVal, uint32_t noB
     uint16_t usAddr = 0;
     uint32_t count = 0;
     uint8_t errorStatus = 0;
-    uint8_t readValue8 = 0;
+    uint8_t readBytes[8];
     AFE_PARAMS_VALID(addr < ausAddr[ARRAY_SIZE(ausAddr) - 1]);
     AFE_PARAMS_VALID(readVal != NULL)
     AFE_PARAMS_VALID(noBytes != 0 && noBytes <= 8);
@@ -477,12 +990,10 @@ uint8_t readTopMem(uint8_t afeId, uint32_t addr, uint64_t *readVal, uint32_t noB
     AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x18, 0x20, 0, 7));
     AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x144, (addr_high << 2), 2, 4));
     AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x18, 0x08, 0, 7));
+    AFE_FUNC_EXEC(afeSpiBurstReadWrapper(afeId, usAddr, readBytes, (uint16_t)noBytes));
     for (count = 0; count < noBytes; count++)
     {
-        AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, (usAddr + count), 0, 7, &readValue8));
-        *readVal = *readVal | (readValue8 << (8 * count));
-        if (errorStatus != 0)
-            break;
+        *readVal = *readVal | ((uint64_t)readBytes[count] << (8 * count));
     }
     AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x18, 0x00, 0x0, 0x7));
     if (errorStatus != 0)
@@ -500,12 +1011,210 @@ uint8_t readTopMem(uint8_t afeId, uint32_t addr, uint64_t *readVal, uint32_t noB
 uint8_t closeAllPages(uint8_t afeId)
 {
     uint8_t errorStatus = 0;
+    uint16_t addrList[AFE_PAGE_END_ADDR - AFE_PAGE_START_ADDR + 1];
+    uint8_t dataList[AFE_PAGE_END_ADDR - AFE_PAGE_START_ADDR + 1] = {0};
+    /* Called for recovery, so nothing known about the device state is trusted any more. */
+    AFE_ID_VALIDITY();
+    trackDeviceLost(afeId);
+    AFE_FUNC_EXEC(afeShadowCacheInvalidate(afeId));
     for (uint8_t addr = AFE_PAGE_START_ADDR; addr <= AFE_PAGE_END_ADDR; addr += 1)
     {
-        AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, addr, 0x00, 0, 7));
+        addrList[addr - AFE_PAGE_START_ADDR] = addr;
     }
+    AFE_FUNC_EXEC(afeSpiWriteBatchWrapper(afeId, addrList, dataList, ARRAY_SIZE(addrList)));
     if (errorStatus != 0)
         return RET_EXEC_FAIL;
     else
         return RET_OK;
 }
+
+/**
+    @brief Enables the Shadow Register Cache
+    @details Enables or disables the host-side shadow register cache of the AFE. When enabled, the read part of the read-modify-write done by afeSpiWriteWrapper, serdesWriteWrapper and serdesLaneWriteWrapper is served from the cache for registers marked with afeShadowCacheAddRange. The cache is cleared and the counters are reset in both cases. Disabled by default.
+    @param afeId AFE ID
+    @param enable 1 to enable, 0 to disable.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeShadowCacheEnable(uint8_t afeId, uint8_t enable)
+{
+    AFE_ID_VALIDITY();
+    afeShadowCache[afeId].enabled = (enable != 0);
+    afeShadowCache[afeId].hits = 0;
+    afeShadowCache[afeId].misses = 0;
+    shadowClearEntries(&afeShadowCache[afeId]);
+    afeLogInfo("Shadow register cache of AFE %d %s", afeId, enable ? "enabled" : "disabled");
+    return RET_OK;
+}
+
+/**
+    @brief Marks Registers as Non-Volatile
+    @details Marks the SPI address range [startAddr, endAddr] as non-volatile, which means the registers only change through host writes and their value can be cached. Status, readback and MCU shared registers must not be marked. For SerDes registers, the SPI addresses are ((addr + 0x2000) & 0x3fff) << 1 and the next one. Page select registers are never cached.
+    @param afeId AFE ID
+    @param startAddr First SPI address of the range.
+    @param endAddr Last SPI address of the range.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeShadowCacheAddRange(uint8_t afeId, uint16_t startAddr, uint16_t endAddr)
+{
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID(startAddr <= endAddr);
+    AFE_PARAMS_VALID(afeShadowCache[afeId].numRanges < AFE_SHADOW_CACHE_MAX_RANGES);
+    afeShadowCache[afeId].rangeStart[afeShadowCache[afeId].numRanges] = startAddr;
+    afeShadowCache[afeId].rangeEnd[afeShadowCache[afeId].numRanges] = endAddr;
+    afeShadowCache[afeId].numRanges++;
+    return RET_OK;
+}
+
+/**
+    @brief Clears the Non-Volatile Register Ranges
+    @details Removes all the ranges added by afeShadowCacheAddRange and clears the cache.
+    @param afeId AFE ID
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeShadowCacheClearRanges(uint8_t afeId)
+{
+    AFE_ID_VALIDITY();
+    afeShadowCache[afeId].numRanges = 0;
+    shadowClearEntries(&afeShadowCache[afeId]);
+    return RET_OK;
+}
+
+/**
+    @brief Invalidates the Shadow Register Cache
+    @details Drops all the cached values, and the other register state kept by the library, see afeGetDeviceStateEpoch. Called on closeAllPages and macro execution. Needs to be called by the user when registers are changed outside this library, for example after a device reset.
+    @param afeId AFE ID
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeShadowCacheInvalidate(uint8_t afeId)
+{
+    AFE_ID_VALIDITY();
+    afeDeviceStateEpoch[afeId]++;
+    shadowClearEntries(&afeShadowCache[afeId]);
+    return RET_OK;
+}
+
+/**
+    @brief Shadow Register Cache Counters
+    @details Returns the number of read-modify-write reads served from the cache (hits) and read from the device (misses) since the cache was enabled. Only registers marked non-volatile are counted.
+    @param afeId AFE ID
+    @param hits Pointer returning the hit count.
+    @param misses Pointer returning the miss count.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeShadowCacheGetStats(uint8_t afeId, uint32_t *hits, uint32_t *misses)
+{
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID((hits != NULL) && (misses != NULL));
+    *hits = afeShadowCache[afeId].hits;
+    *misses = afeShadowCache[afeId].misses;
+    return RET_OK;
+}
+
+/**
+    @brief Page Select Tracking Mode
+    @details The last value written to each page select register (0x10-0x19) is always tracked. This sets what is done with it.<br>
+        AFE_PAGE_TRACK_OFF: every page write is sent. Default.<br>
+        AFE_PAGE_TRACK_SKIP_REDUNDANT: page writes that don't change the page register are dropped.<br>
+        AFE_PAGE_TRACK_LAZY_CLOSE: like AFE_PAGE_TRACK_SKIP_REDUNDANT, and closing a page is held back until another page or a non-page register is accessed. Re-opening the same page cancels the close, so back to back functions using the same page (e.g. the steps of executeMacro) don't close and re-open it. A page can stay open after the function returns. Call afePageFlushPendingCloses before handing the SPI bus to another master.<br>
+        Changing the mode writes any held back closes and forgets the tracked page values.
+    @param afeId AFE ID
+    @param mode One of AFE_PAGE_TRACK_OFF, AFE_PAGE_TRACK_SKIP_REDUNDANT and AFE_PAGE_TRACK_LAZY_CLOSE.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afePageTrackingSetMode(uint8_t afeId, uint8_t mode)
+{
+    uint8_t errorStatus = 0;
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID(mode <= AFE_PAGE_TRACK_LAZY_CLOSE);
+    AFE_FUNC_EXEC(afePageFlushPendingCloses(afeId));
+    afePageTracker[afeId].mode = mode;
+    afePageTracker[afeId].known = 0;
+    return RET_OK;
+}
+
+/**
+    @brief Writes the Held Back Page Closes
+    @details In AFE_PAGE_TRACK_LAZY_CLOSE mode, writes the page closes that are still held back, so that all pages the functions have closed are closed on the device.
+    @param afeId AFE ID
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afePageFlushPendingCloses(uint8_t afeId)
+{
+    uint8_t errorStatus = 0;
+    uint16_t emitAddr[AFE_NUM_PAGE_REGS];
+    uint8_t emitData[AFE_NUM_PAGE_REGS];
+    uint8_t numEmit = 0;
+    AFE_ID_VALIDITY();
+    numEmit = pageEmitPendingCloses(afeId, emitAddr, emitData, 0);
+    AFE_SPI_EXEC(spiWriteBatchTracked(afeId, emitAddr, emitData, numEmit));
+    return RET_OK;
+}
+
+/**
+    @brief Page Select Tracking Counters
+    @details Returns the number of SPI writes saved by the page tracking since the last reset.
+    @param afeId AFE ID
+    @param skippedWrites Pointer returning the number of page writes dropped because they didn't change the page register.
+    @param lazySavedWrites Pointer returning the number of page writes saved by the lazy close mode.
+    @param reset 1 resets the counters after reading them.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afePageTrackingGetStats(uint8_t afeId, uint32_t *skippedWrites, uint32_t *lazySavedWrites, uint8_t reset)
+{
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID((skippedWrites != NULL) && (lazySavedWrites != NULL));
+    *skippedWrites = afePageTracker[afeId].skippedWrites;
+    *lazySavedWrites = afePageTracker[afeId].lazySavedWrites;
+    if (reset)
+    {
+        afePageTracker[afeId].skippedWrites = 0;
+        afePageTracker[afeId].lazySavedWrites = 0;
+    }
+    return RET_OK;
+}
+
+/**
+    @brief Enables the SPI Bursts
+    @details A burst sends the address of the first register once and then the data of all the registers in the same chip select window. The AFE has to step the address after every data byte, and dev_spi_write_burst and dev_spi_read_burst have to clock the data that way. afeMacroOperandBurstCheck checks both and enables the bursts when they pass.<br>
+        While disabled, afeSpiBurstWriteWrapper and afeSpiBurstReadWrapper send every register in its own frame, through dev_spi_write_batch and dev_spi_read. Disabled by default.
+    @param afeId AFE ID
+    @param enable 1 to enable, 0 to disable.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiBurstEnable(uint8_t afeId, uint8_t enable)
+{
+    AFE_ID_VALIDITY();
+    afeSpiBurstEnabled[afeId] = (enable != 0);
+    return RET_OK;
+}
+
+/**
+    @brief SPI Transaction Counter
+    @details Returns the number of SPI transactions the driver completed since the last reset. A single write or read counts as one, a batch as one per entry and an enabled burst as one, as it needs a single chip select window. A driver call that fails counts none, since the driver does not say how much of it was sent.
+    @param afeId AFE ID
+    @param count Pointer returning the transaction count.
+    @param reset 1 resets the counter after reading it.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiGetTransactionCount(uint8_t afeId, uint32_t *count, uint8_t reset)
+{
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID(count != NULL);
+    *count = afeSpiTransactions[afeId];
+    if (reset)
+        afeSpiTransactions[afeId] = 0;
+    return RET_OK;
+}
+
+/**
+    @brief Device State Epoch
+    @details Returns a number that changes whenever the library stops trusting what it knows of the device registers: on afeShadowCacheInvalidate, and so on closeAllPages and macro execution, and after a failed SPI transfer. Functions that keep a setup of the device across calls, such as the RMS power detector setup of getRmsPowerSweep, redo it when the epoch has changed.
+    @param afeId AFE ID
+    @return Returns the epoch, 0 for an invalid AFE ID.
+*/
+uint32_t afeGetDeviceStateEpoch(uint8_t afeId)
+{
+    if (afeId >= NUM_OF_AFE)
+        return 0;
+    return afeDeviceStateEpoch[afeId];
+}
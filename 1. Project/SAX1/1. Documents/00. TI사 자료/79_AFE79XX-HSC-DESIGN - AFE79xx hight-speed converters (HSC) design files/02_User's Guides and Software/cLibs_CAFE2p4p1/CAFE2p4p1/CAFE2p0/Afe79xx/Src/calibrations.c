@@ -5,9 +5,12 @@
  * 		2. Added documentation and improved the parameter validity checks.<br>
  * 		3. Modified the RX DSA calibration function to add placeholder function for channel inputs.<br>
  * 		4. Added TX DSA calibration function.<br>
+ * 		5. Added the DSA calibration packet store: afeCalibStoreGetKey, afeCalibStoreAdd, afeCalibStoreFind, afeCalibStoreApply, afeCalibStoreSave and afeCalibStoreLoad.<br>
 */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <math.h>
 
@@ -224,10 +227,9 @@ uint8_t doRxDsaCalib(uint8_t afeId, uint8_t rxChainForCalib, uint8_t fbChainForC
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0144, 0x00, 0x0, 0x7));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0018, 0x01, 0x0, 0x7));
 	*readPacketSize = packetSize;
-	for (uint16_t i = 0; i < packetSize; i++)
+	if (packetSize != 0)
 	{
-		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0020 + i, 0x0, 0x7, &tempVal));
-		readPacket[i] = tempVal;
+		AFE_FUNC_EXEC(afeSpiBurstReadWrapper(afeId, 0x0020, readPacket, packetSize));
 	}
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0018, 0x00, 0x0, 0x7));
 
@@ -415,10 +417,9 @@ uint8_t doTxDsaCalib(uint8_t afeId, uint8_t txChainForCalib, uint8_t txDsaCalibM
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0144, 0x00, 0x0, 0x7));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0018, 0x01, 0x0, 0x7));
 	*readPacketSize = packetSize;
-	for (uint16_t i = 0; i < packetSize; i++)
+	if (packetSize != 0)
 	{
-		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0020 + i, 0x0, 0x7, &tempVal));
-		readPacket[i] = tempVal;
+		AFE_FUNC_EXEC(afeSpiBurstReadWrapper(afeId, 0x0020, readPacket, packetSize));
 	}
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0018, 0x00, 0x0, 0x7));
 	/*Apply the calibrated packet.*/
@@ -433,6 +434,29 @@ uint8_t doTxDsaCalib(uint8_t afeId, uint8_t txChainForCalib, uint8_t txDsaCalibM
 	else
 		return RET_OK;
 }
+/**
+    @brief Writes the DSA Calibration Packet to the MCU memory.
+    @details Writes the DSA Calibration Packet to the MCU memory. The packet goes to consecutive addresses, so it is written in one SPI burst once enabled (afeSpiBurstEnable). Used by loadTxDsaPacket and loadRxDsaPacket.
+    @param afeId AFE ID
+    @param array Pointer of array of the packet which was stored in host after calibration.
+    @param arraySize Value of the size of the array.
+	@return Returns if the function execution passed or failed.
+*/
+static uint8_t writeDsaPacket(uint8_t afeId, const uint8_t *array, uint16_t arraySize)
+{
+	uint8_t errorStatus = 0;
+	uint16_t addrList[3] = {0x018, 0x0144, 0x018};
+	uint8_t dataList[3] = {0x20, 0x00, 0x01};
+
+	AFE_FUNC_EXEC(afeSpiWriteBatchWrapper(afeId, addrList, dataList, ARRAY_SIZE(addrList)));
+	if (arraySize != 0)
+	{
+		AFE_FUNC_EXEC(afeSpiBurstWriteWrapper(afeId, 0x020, array, arraySize));
+	}
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x018, 0x00, 0, 7));
+	return RET_OK;
+}
+
 /**
     @brief Load the TX DSA Calibration Packet
     @details This function loads the TX DSA Calibration Packet
@@ -441,7 +465,7 @@ uint8_t doTxDsaCalib(uint8_t afeId, uint8_t txChainForCalib, uint8_t txDsaCalibM
     @param arraySize Value of the size of the array.
 	@return Returns if the function execution passed or failed.
 */
-uint8_t loadTxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize)
+uint8_t loadTxDsaPacket(uint8_t afeId, const uint8_t *array, uint16_t arraySize)
 {
 	/*
 	Pass the packet read back during calibration to apply it for TX DSA.
@@ -451,14 +475,7 @@ uint8_t loadTxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize)
 	uint8_t byteList[1];
 	uint8_t numOfOperands = 0;
 
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x018, 0x20, 0, 7));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0144, 0x00, 0, 7));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x018, 0x01, 0, 7));
-	for (uint16_t i = 0; i < arraySize; i++)
-	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x020 + i, array[i], 0, 7));
-	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x018, 0x00, 0, 7));
+	AFE_FUNC_EXEC(writeDsaPacket(afeId, array, arraySize));
 	byteList[numOfOperands] = (0);
 	numOfOperands++;
 	AFE_FUNC_EXEC(executeMacro(afeId, byteList, numOfOperands, AFE_MACRO_OPCODE_APPLY_DSA_GAIN_PHASE_COMPENSATION));
@@ -476,7 +493,7 @@ uint8_t loadTxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize)
     @param arraySize Value of the size of the array.
 	@return Returns if the function execution passed or failed.
 */
-uint8_t loadRxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize)
+uint8_t loadRxDsaPacket(uint8_t afeId, const uint8_t *array, uint16_t arraySize)
 {
 	/*
 	Pass the packet read back during calibration to apply it for TX DSA.
@@ -486,14 +503,7 @@ uint8_t loadRxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize)
 	uint8_t numOfOperands = 0;
 
 	AFE_ID_VALIDITY();
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x018, 0x20, 0, 7));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0144, 0x00, 0, 7));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x018, 0x01, 0, 7));
-	for (uint16_t i = 0; i < arraySize; i++)
-	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x020 + i, array[i], 0, 7));
-	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x018, 0x00, 0, 7));
+	AFE_FUNC_EXEC(writeDsaPacket(afeId, array, arraySize));
 	byteList[numOfOperands] = (1);
 	numOfOperands++;
 	AFE_FUNC_EXEC(executeMacro(afeId, byteList, numOfOperands, AFE_MACRO_OPCODE_APPLY_DSA_GAIN_PHASE_COMPENSATION));
@@ -502,3 +512,413 @@ uint8_t loadRxDsaPacket(uint8_t afeId, uint8_t *array, uint16_t arraySize)
 	else
 		return RET_OK;
 }
+
+/*  Calibration store image format. All fields are little endian.
+	Header (AFE_CALIB_STORE_HEADER_LEN bytes):
+	  0  magic "AFEC"     4  version (2 bytes)     6  number of entries (2 bytes)     8  image length in bytes (4 bytes)     12 CRC32 of bytes 0-11
+	Each entry is an entry header (AFE_CALIB_STORE_ENTRY_LEN bytes) followed by the packet, padded with zeros to a multiple of 4 bytes:
+	  0  chipId (4 bytes)   4  freqPlan (4 bytes)   8  chipVersion   9  afeId   10 packet type   11 reserved   12 packet size (2 bytes)   14-15 reserved
+	  16 CRC32 of entry bytes 0-15 and the packet (4 bytes)
+	The image can be used in place, for example from a memory mapped file or flash, since the packets are only read.   */
+#define AFE_CALIB_STORE_MAGIC "AFEC"
+#define AFE_CALIB_STORE_VERSION 1
+#define AFE_CALIB_STORE_HEADER_LEN 16
+#define AFE_CALIB_STORE_ENTRY_LEN 20
+
+static void calibPut16(uint8_t *buf, uint16_t val)
+{
+	buf[0] = (uint8_t)val;
+	buf[1] = (uint8_t)(val >> 8);
+}
+
+static void calibPut32(uint8_t *buf, uint32_t val)
+{
+	calibPut16(buf, (uint16_t)val);
+	calibPut16(buf + 2, (uint16_t)(val >> 16));
+}
+
+static uint16_t calibGet16(const uint8_t *buf)
+{
+	return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+static uint32_t calibGet32(const uint8_t *buf)
+{
+	return calibGet16(buf) | ((uint32_t)calibGet16(buf + 2) << 16);
+}
+
+/* CRC-32 (IEEE 802.3, reflected). Start with crc 0 and pass the previous result to continue over several buffers. */
+static uint32_t calibCrc32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+	crc = ~crc;
+	for (uint32_t i = 0; i < len; i++)
+	{
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+	}
+	return ~crc;
+}
+
+static uint32_t calibCrc32Float(uint32_t crc, const float *val, uint32_t num)
+{
+	uint8_t buf[4];
+	uint32_t bits;
+
+	for (uint32_t i = 0; i < num; i++)
+	{
+		memcpy(&bits, &val[i], sizeof(bits));
+		calibPut32(buf, bits);
+		crc = calibCrc32(crc, buf, sizeof(buf));
+	}
+	return crc;
+}
+
+static uint32_t calibStoreEntryLen(uint16_t packetSize)
+{
+	return AFE_CALIB_STORE_ENTRY_LEN + (((uint32_t)packetSize + 3) & ~3u);
+}
+
+static uint32_t calibStoreEntryCrc(const uint8_t *entry)
+{
+	uint32_t crc = calibCrc32(0, entry, 16);
+
+	return calibCrc32(crc, entry + AFE_CALIB_STORE_ENTRY_LEN, calibGet16(entry + 12));
+}
+
+static uint8_t calibStoreKeyMatch(const uint8_t *entry, const AfeCalibKey_t *key, uint8_t packetType)
+{
+	return (calibGet32(entry) == key->chipId) && (calibGet32(entry + 4) == key->freqPlan) && (entry[8] == key->chipVersion) && (entry[9] == key->afeId) && (entry[10] == packetType);
+}
+
+/* Checks the header and that the entries exactly fill the image, so that the entries can be walked safely. The packet CRCs are not checked. */
+static uint8_t calibStoreCheck(const uint8_t *image, uint32_t imageLen, uint16_t *numEntries)
+{
+	uint32_t offset = AFE_CALIB_STORE_HEADER_LEN;
+
+	if ((imageLen < AFE_CALIB_STORE_HEADER_LEN) || (memcmp(image, AFE_CALIB_STORE_MAGIC, 4) != 0))
+	{
+		afeLogErr("Calibration store has no valid header, length %u", (unsigned int)imageLen);
+		return RET_EXEC_FAIL;
+	}
+	if ((calibGet16(image + 4) != AFE_CALIB_STORE_VERSION) || (calibGet32(image + 12) != calibCrc32(0, image, 12)) || (calibGet32(image + 8) != imageLen))
+	{
+		afeLogErr("Calibration store version %d not supported or header corrupted", calibGet16(image + 4));
+		return RET_EXEC_FAIL;
+	}
+	*numEntries = calibGet16(image + 6);
+	for (uint16_t i = 0; i < *numEntries; i++)
+	{
+		if ((imageLen - offset < AFE_CALIB_STORE_ENTRY_LEN) || (imageLen - offset < calibStoreEntryLen(calibGet16(image + offset + 12))))
+		{
+			afeLogErr("Calibration store entry %d is truncated", i);
+			return RET_EXEC_FAIL;
+		}
+		offset += calibStoreEntryLen(calibGet16(image + offset + 12));
+	}
+	if (offset != imageLen)
+	{
+		afeLogErr("Calibration store has %u bytes after the last entry", (unsigned int)(imageLen - offset));
+		return RET_EXEC_FAIL;
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Gets the Calibration Store Key of the AFE
+    @details Fills the key under which the calibration packets of the AFE are stored with afeCalibStoreAdd and looked up by afeCalibStoreApply. It has the chipId and chipVersion of systemParams, the AFE ID and a frequency plan,
+			which is a CRC32 of the reference clock, converter rates, half rate modes, decimation and interpolation factors, band counts and NCO frequencies of systemParams. A packet calibrated for one of these does not match the others.<br>
+			The chipVersion should be read with getChipVersion before, for example by the init. The caller can replace freqPlan with an own plan ID.
+    @param afeId AFE ID
+    @param key Pointer returning the key.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeCalibStoreGetKey(uint8_t afeId, AfeCalibKey_t *key)
+{
+	uint32_t crc = 0;
+
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(key != NULL);
+	memset(key, 0, sizeof(*key));
+	key->chipId = systemParams[afeId].chipId;
+	key->chipVersion = systemParams[afeId].chipVersion;
+	key->afeId = afeId;
+
+	crc = calibCrc32Float(crc, &systemParams[afeId].FRef, 1);
+	crc = calibCrc32Float(crc, &systemParams[afeId].FadcRx, 1);
+	crc = calibCrc32Float(crc, &systemParams[afeId].FadcFb, 1);
+	crc = calibCrc32Float(crc, &systemParams[afeId].Fdac, 1);
+	crc = calibCrc32(crc, systemParams[afeId].halfRateModeRx, sizeof(systemParams[afeId].halfRateModeRx));
+	crc = calibCrc32(crc, systemParams[afeId].halfRateModeFb, sizeof(systemParams[afeId].halfRateModeFb));
+	crc = calibCrc32(crc, systemParams[afeId].halfRateModeTx, sizeof(systemParams[afeId].halfRateModeTx));
+	crc = calibCrc32(crc, systemParams[afeId].ddcFactorRx, sizeof(systemParams[afeId].ddcFactorRx));
+	crc = calibCrc32(crc, systemParams[afeId].numBandsRx, sizeof(systemParams[afeId].numBandsRx));
+	crc = calibCrc32Float(crc, &systemParams[afeId].rxNco[0][0][0], sizeof(systemParams[afeId].rxNco) / sizeof(float));
+	crc = calibCrc32(crc, systemParams[afeId].ddcFactorFb, sizeof(systemParams[afeId].ddcFactorFb));
+	crc = calibCrc32Float(crc, &systemParams[afeId].fbNco[0][0], sizeof(systemParams[afeId].fbNco) / sizeof(float));
+	crc = calibCrc32(crc, systemParams[afeId].ducFactorTx, sizeof(systemParams[afeId].ducFactorTx));
+	crc = calibCrc32(crc, systemParams[afeId].numBandsTx, sizeof(systemParams[afeId].numBandsTx));
+	crc = calibCrc32Float(crc, &systemParams[afeId].txNco[0][0][0], sizeof(systemParams[afeId].txNco) / sizeof(float));
+	crc = calibCrc32(crc, &systemParams[afeId].enableDacInterleavedMode, 1);
+	key->freqPlan = crc;
+	return RET_OK;
+}
+
+/**
+    @brief Adds a Packet to the Calibration Store
+    @details Stores a packet returned by doRxDsaCalib or doTxDsaCalib in a calibration store image, with a CRC32 over the packet and its key. An entry with the same key and packet type is replaced.
+			The image is built in host memory. An empty image is started when *imageLen is 0. The format is described in calibrations.c, afeCalibStoreSave writes the image to a file.<br>
+			Each entry takes 20 bytes plus the packet padded to 4 bytes, the image header 16 bytes.
+    @param image Buffer of the image.
+    @param imageSize Size of the image buffer in bytes.
+    @param imageLen Pointer of the used length of the image. Updated to the new length.
+    @param key Key of the packet, from afeCalibStoreGetKey.
+    @param packetType Type of the packet.<br>
+		AFE_CALIB_PACKET_RX_DSA - packet of doRxDsaCalib<br>
+		AFE_CALIB_PACKET_TX_DSA - packet of doTxDsaCalib
+    @param packet Array of the packet.
+    @param packetSize Size of the packet.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeCalibStoreAdd(uint8_t *image, uint32_t imageSize, uint32_t *imageLen, const AfeCalibKey_t *key, uint8_t packetType, const uint8_t *packet, uint16_t packetSize)
+{
+	uint16_t numEntries = 0;
+	uint32_t offset = AFE_CALIB_STORE_HEADER_LEN;
+	uint32_t entryLen = calibStoreEntryLen(packetSize);
+	uint32_t oldLen = 0;
+	uint8_t *entry;
+
+	AFE_PARAMS_VALID((image != NULL) && (imageLen != NULL) && (key != NULL) && ((packet != NULL) || (packetSize == 0)));
+	AFE_PARAMS_VALID(packetType < AFE_CALIB_NUM_PACKET_TYPES);
+	if (*imageLen == 0)
+	{
+		AFE_PARAMS_VALID(imageSize >= AFE_CALIB_STORE_HEADER_LEN);
+		memset(image, 0, AFE_CALIB_STORE_HEADER_LEN);
+		memcpy(image, AFE_CALIB_STORE_MAGIC, 4);
+		calibPut16(image + 4, AFE_CALIB_STORE_VERSION);
+		*imageLen = AFE_CALIB_STORE_HEADER_LEN;
+	}
+	else if (calibStoreCheck(image, *imageLen, &numEntries) != RET_OK)
+	{
+		return RET_EXEC_FAIL;
+	}
+
+	for (uint16_t i = 0; i < numEntries; i++)
+	{
+		if (calibStoreKeyMatch(image + offset, key, packetType))
+		{
+			oldLen = calibStoreEntryLen(calibGet16(image + offset + 12));
+			break;
+		}
+		offset += calibStoreEntryLen(calibGet16(image + offset + 12));
+	}
+	if (((oldLen == 0) && (numEntries == 0xFFFF)) || (imageSize < *imageLen) || (imageSize - *imageLen + oldLen < entryLen))
+	{
+		afeLogErr("Calibration store full, %u of %u bytes used, entry needs %u", (unsigned int)*imageLen, (unsigned int)imageSize, (unsigned int)entryLen);
+		return RET_EXEC_FAIL;
+	}
+	if (oldLen != 0)
+	{
+		memmove(image + offset, image + offset + oldLen, *imageLen - offset - oldLen);
+		*imageLen -= oldLen;
+		numEntries--;
+	}
+
+	entry = image + *imageLen;
+	memset(entry, 0, entryLen);
+	calibPut32(entry, key->chipId);
+	calibPut32(entry + 4, key->freqPlan);
+	entry[8] = key->chipVersion;
+	entry[9] = key->afeId;
+	entry[10] = packetType;
+	calibPut16(entry + 12, packetSize);
+	if (packetSize != 0)
+		memcpy(entry + AFE_CALIB_STORE_ENTRY_LEN, packet, packetSize);
+	calibPut32(entry + 16, calibStoreEntryCrc(entry));
+	*imageLen += entryLen;
+
+	calibPut16(image + 6, numEntries + 1);
+	calibPut32(image + 8, *imageLen);
+	calibPut32(image + 12, calibCrc32(0, image, 12));
+	return RET_OK;
+}
+
+/**
+    @brief Finds a Packet in the Calibration Store
+    @details Looks up the packet of a key and type in a calibration store image and checks its CRC32. The packet is not copied, packet points into the image.
+    @param image Calibration store image, for example a memory mapped file written by afeCalibStoreSave.
+    @param imageLen Length of the image in bytes.
+    @param key Key of the packet, from afeCalibStoreGetKey.
+    @param packetType Type of the packet. AFE_CALIB_PACKET_RX_DSA or AFE_CALIB_PACKET_TX_DSA.
+    @param packet Pointer returning the address of the packet in the image. NULL if not found.
+    @param packetSize Pointer returning the size of the packet. 0 if not found.
+	@return Returns RET_EXEC_FAIL if the image is corrupted, the packet is not in it or its CRC does not match.
+*/
+uint8_t afeCalibStoreFind(const uint8_t *image, uint32_t imageLen, const AfeCalibKey_t *key, uint8_t packetType, const uint8_t **packet, uint16_t *packetSize)
+{
+	uint16_t numEntries = 0;
+	uint32_t offset = AFE_CALIB_STORE_HEADER_LEN;
+
+	AFE_PARAMS_VALID((image != NULL) && (key != NULL) && (packet != NULL) && (packetSize != NULL));
+	*packet = NULL;
+	*packetSize = 0;
+	if (calibStoreCheck(image, imageLen, &numEntries) != RET_OK)
+		return RET_EXEC_FAIL;
+
+	for (uint16_t i = 0; i < numEntries; i++)
+	{
+		if (calibStoreKeyMatch(image + offset, key, packetType))
+		{
+			if (calibGet32(image + offset + 16) != calibStoreEntryCrc(image + offset))
+			{
+				afeLogErr("Calibration store packet type %d of AFE %d has a wrong CRC", packetType, key->afeId);
+				return RET_EXEC_FAIL;
+			}
+			*packet = image + offset + AFE_CALIB_STORE_ENTRY_LEN;
+			*packetSize = calibGet16(image + offset + 12);
+			return RET_OK;
+		}
+		offset += calibStoreEntryLen(calibGet16(image + offset + 12));
+	}
+	afeLogInfo("Calibration store has no packet type %d for AFE %d, chip 0x%X version %d, frequency plan 0x%08X", packetType, key->afeId, (unsigned int)key->chipId, key->chipVersion, (unsigned int)key->freqPlan);
+	return RET_EXEC_FAIL;
+}
+
+/**
+    @brief Applies the Stored Calibration Packets
+    @details Reloads the DSA calibration packets of the AFE from a calibration store image after the init, in place of doRxDsaCalib and doTxDsaCalib. The packets are looked up with the key of afeCalibStoreGetKey and all of them are checked before any is loaded,
+			so a missing or corrupted packet leaves the AFE as it was. Each packet is written as one block by loadRxDsaPacket and loadTxDsaPacket.<br>
+			If this fails, the calibration should be done again and the store updated with afeCalibStoreAdd.
+    @param afeId AFE ID
+    @param image Calibration store image. It is only read, so it can be a memory mapped file or flash.
+    @param imageLen Length of the image in bytes.
+    @param packetMask Bit Wise Packet Type Select.<br>
+			Bit0 for AFE_CALIB_PACKET_RX_DSA<br>
+			Bit1 for AFE_CALIB_PACKET_TX_DSA
+    @param applyUs Pointer returning the time taken to check and load the packets in us, measured with getTimeUs. It is 0 with the getTimeUs of the user template, which always returns 0. Can be NULL.
+    @param applyTransactions Pointer returning the SPI transactions taken to load the packets, counted as by afeSpiGetTransactionCount. It does not depend on getTimeUs. Can be NULL.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeCalibStoreApply(uint8_t afeId, const uint8_t *image, uint32_t imageLen, uint8_t packetMask, uint32_t *applyUs, uint32_t *applyTransactions)
+{
+	uint8_t errorStatus = 0;
+	AfeCalibKey_t key;
+	const uint8_t *packet[AFE_CALIB_NUM_PACKET_TYPES] = {NULL};
+	uint16_t packetSize[AFE_CALIB_NUM_PACKET_TYPES] = {0};
+	uint64_t startUs;
+	uint32_t startTransactions = 0;
+	uint32_t endTransactions = 0;
+
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID((image != NULL) && (packetMask != 0) && (packetMask < (1 << AFE_CALIB_NUM_PACKET_TYPES)));
+	startUs = getTimeUs();
+	AFE_FUNC_EXEC(afeSpiGetTransactionCount(afeId, &startTransactions, 0));
+	AFE_FUNC_EXEC(afeCalibStoreGetKey(afeId, &key));
+	for (uint8_t type = 0; type < AFE_CALIB_NUM_PACKET_TYPES; type++)
+	{
+		if ((packetMask >> type) & 1)
+		{
+			AFE_FUNC_EXEC(afeCalibStoreFind(image, imageLen, &key, type, &packet[type], &packetSize[type]));
+		}
+	}
+	if ((packetMask >> AFE_CALIB_PACKET_RX_DSA) & 1)
+	{
+		AFE_FUNC_EXEC(loadRxDsaPacket(afeId, packet[AFE_CALIB_PACKET_RX_DSA], packetSize[AFE_CALIB_PACKET_RX_DSA]));
+	}
+	if ((packetMask >> AFE_CALIB_PACKET_TX_DSA) & 1)
+	{
+		AFE_FUNC_EXEC(loadTxDsaPacket(afeId, packet[AFE_CALIB_PACKET_TX_DSA], packetSize[AFE_CALIB_PACKET_TX_DSA]));
+	}
+	AFE_FUNC_EXEC(afeSpiGetTransactionCount(afeId, &endTransactions, 0));
+	if (applyUs != NULL)
+		*applyUs = (uint32_t)(getTimeUs() - startUs);
+	if (applyTransactions != NULL)
+		*applyTransactions = endTransactions - startTransactions;
+	afeLogInfo("Applied stored calibration 0x%X of AFE %d in %u us and %u SPI transactions", packetMask, afeId, (unsigned int)(getTimeUs() - startUs), (unsigned int)(endTransactions - startTransactions));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/**
+    @brief Saves the Calibration Store
+    @details Writes a calibration store image built with afeCalibStoreAdd to a file. The file is the image as is, so it can be memory mapped and passed to afeCalibStoreApply without a copy.
+    @param file Path of the file to be written.
+    @param image Calibration store image.
+    @param imageLen Length of the image in bytes.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeCalibStoreSave(char *file, const uint8_t *image, uint32_t imageLen)
+{
+	uint8_t errorStatus = 0;
+	uint16_t numEntries = 0;
+	FILE *fp;
+
+	AFE_PARAMS_VALID((file != NULL) && (image != NULL));
+	if (calibStoreCheck(image, imageLen, &numEntries) != RET_OK)
+		return RET_EXEC_FAIL;
+	fp = fopen(file, "wb");
+	if (fp == NULL)
+	{
+		afeLogErr("Could not open calibration store file %s", file);
+		return RET_EXEC_FAIL;
+	}
+	if (fwrite(image, 1, imageLen, fp) != imageLen)
+		errorStatus |= 1;
+	if (fclose(fp) != 0)
+		errorStatus |= 1;
+	if (errorStatus)
+	{
+		afeLogErr("Writing calibration store file %s failed", file);
+		return RET_EXEC_FAIL;
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Loads the Calibration Store
+    @details Reads a file written by afeCalibStoreSave into a buffer and checks the header and the CRC of every packet. Hosts which can memory map the file can pass it to afeCalibStoreApply directly instead.
+    @param file Path of the file.
+    @param image Buffer returning the calibration store image.
+    @param imageSize Size of the image buffer in bytes.
+    @param imageLen Pointer returning the length of the image.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeCalibStoreLoad(char *file, uint8_t *image, uint32_t imageSize, uint32_t *imageLen)
+{
+	uint16_t numEntries = 0;
+	uint32_t offset = AFE_CALIB_STORE_HEADER_LEN;
+	size_t len;
+	FILE *fp;
+
+	AFE_PARAMS_VALID((file != NULL) && (image != NULL) && (imageLen != NULL));
+	*imageLen = 0;
+	fp = fopen(file, "rb");
+	if (fp == NULL)
+	{
+		afeLogErr("Could not open calibration store file %s", file);
+		return RET_EXEC_FAIL;
+	}
+	len = fread(image, 1, imageSize, fp);
+	if ((len == imageSize) && (fgetc(fp) != EOF))
+	{
+		afeLogErr("Calibration store file %s is larger than %u bytes", file, (unsigned int)imageSize);
+		fclose(fp);
+		return RET_EXEC_FAIL;
+	}
+	fclose(fp);
+	if (calibStoreCheck(image, (uint32_t)len, &numEntries) != RET_OK)
+		return RET_EXEC_FAIL;
+	for (uint16_t i = 0; i < numEntries; i++)
+	{
+		if (calibGet32(image + offset + 16) != calibStoreEntryCrc(image + offset))
+		{
+			afeLogErr("Calibration store file %s entry %d has a wrong CRC", file, i);
+			return RET_EXEC_FAIL;
+		}
+		offset += calibStoreEntryLen(calibGet16(image + offset + 12));
+	}
+	*imageLen = (uint32_t)len;
+	return RET_OK;
+}
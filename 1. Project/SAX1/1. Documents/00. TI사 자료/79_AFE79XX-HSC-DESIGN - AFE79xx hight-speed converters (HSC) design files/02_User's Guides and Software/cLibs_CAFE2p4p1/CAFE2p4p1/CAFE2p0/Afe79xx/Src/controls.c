@@ -15,6 +15,7 @@
 #include <stdint.h>
 
 #include <math.h>
+#include <string.h>
 
 #include "afe79xxLog.h"
 #include "afe79xxTypes.h"
@@ -299,6 +300,31 @@ uint8_t overrideTddPins(uint8_t afeId, uint8_t rx, uint8_t fb, uint8_t tx)
 		return RET_OK;
 }
 
+/**
+    @brief Reads the PLL Status bits
+    @details Reads the lock and sticky lock lost status of the PLL without logging them.
+    @param afeId AFE ID
+    @param pllStatus Pointer Return of the PLL status register. AFE_PLL_STATUS_LOCKED is set while the PLL is locked and AFE_PLL_STATUS_LOCK_LOST_STICKY if it lost lock since clearPllStickyLockStatus was called.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getPllLockState(uint8_t afeId, uint8_t *pllStatus)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(pllStatus != NULL);
+	*pllStatus = 0;
+	AFE_FUNC_EXEC(requestPllSpiAccess(afeId, systemParams[afeId].spiInUseForPllAccess));
+
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0015, 0x01, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0066, 0x0, 0x7, pllStatus));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0015, 0x00, 0x0, 0x7));
+	AFE_FUNC_EXEC(requestPllSpiAccess(afeId, 0));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
 /**
     @brief Checks the PLL Lock Status
     @details This function checks the PLL Lock Status and returns it as a pointer. 
@@ -313,14 +339,10 @@ uint8_t overrideTddPins(uint8_t afeId, uint8_t rx, uint8_t fb, uint8_t tx)
 uint8_t checkPllLockStatus(uint8_t afeId, uint8_t *pllLockStatus)
 {
 	uint8_t errorStatus = 0;
-	AFE_ID_VALIDITY();
 	uint8_t ulRegValue = 0;
 	*pllLockStatus = 0;
-	AFE_FUNC_EXEC(requestPllSpiAccess(afeId, systemParams[afeId].spiInUseForPllAccess));
-
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0015, 0x01, 0x0, 0x7));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0066, 0x0, 0x7, &ulRegValue));
-	if (((ulRegValue >> 4) & 1) == 0)
+	AFE_FUNC_EXEC(getPllLockState(afeId, &ulRegValue));
+	if ((ulRegValue & AFE_PLL_STATUS_LOCKED) == 0)
 	{
 		afeLogErr("%s", "PLL didn't lock");
 	}
@@ -329,7 +351,7 @@ uint8_t checkPllLockStatus(uint8_t afeId, uint8_t *pllLockStatus)
 		*pllLockStatus |= 1;
 		afeLogInfo("%s", "PLL locked.");
 	}
-	if (((ulRegValue >> 6) & 1) == 0)
+	if ((ulRegValue & AFE_PLL_STATUS_LOCK_LOST_STICKY) == 0)
 	{
 		*pllLockStatus |= 2;
 		afeLogInfo("%s", "PLL LOCK_LOST_STICKY is low. That is, PLL didn't lose Lock. ");
@@ -337,10 +359,7 @@ uint8_t checkPllLockStatus(uint8_t afeId, uint8_t *pllLockStatus)
 	else
 	{
 		afeLogInfo("%s", "PLL LOCK_LOST_STICKY is high. That is, PLL lost lock in between. ");
-		//errorStatus |= 1;
 	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0015, 0x00, 0x0, 0x7));
-	AFE_FUNC_EXEC(requestPllSpiAccess(afeId, 0));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -413,6 +432,29 @@ uint8_t clearSpiAlarms(uint8_t afeId)
 		return RET_OK;
 }
 
+/**
+    @brief Reads the SPI Alarm bits.
+    @details This function reads the SPI Alarm Status without logging it.
+    @param afeId AFE ID
+    @param alarms Pointer return of the SPI alarms, AFE_SPI_ALARM_* bits. 0 means there are no alarms.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getSpiAlarmBits(uint8_t afeId, uint16_t *alarms)
+{
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(alarms != NULL);
+	uint8_t errorStatus = 0;
+	uint8_t readValue_lsb, readValue_msb;
+	*alarms = 0;
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x01e, 0x0, 0x7, &readValue_lsb));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x01f, 0x0, 0x0, &readValue_msb));
+	*alarms = readValue_lsb + (readValue_msb << 8);
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
 /**
     @brief Checks the SPI Alarm Status.
     @details This function reads the Alarm Status and returns it as a pointer. It also prints the error description.
@@ -422,13 +464,11 @@ uint8_t clearSpiAlarms(uint8_t afeId)
 */
 uint8_t readSpiAlarms(uint8_t afeId, uint8_t *alarmStatus)
 {
-	AFE_ID_VALIDITY();
 	uint8_t errorStatus = 0;
 	uint16_t alarmVal = 0;
-	uint8_t readValue_lsb, readValue_msb;
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x01e, 0x0, 0x7, &readValue_lsb));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x01f, 0x0, 0x0, &readValue_msb));
-	alarmVal = readValue_lsb + (readValue_msb << 8);
+	AFE_PARAMS_VALID(alarmStatus != NULL);
+	*alarmStatus = 0;
+	AFE_FUNC_EXEC(getSpiAlarmBits(afeId, &alarmVal));
 	const char *spiAlarms[9];
 
 	spiAlarms[0] = "Both SPI-A & B1 access Global page at the same time.";
@@ -440,7 +480,6 @@ uint8_t readSpiAlarms(uint8_t afeId, uint8_t *alarmStatus)
 	spiAlarms[6] = "Invalid Address Accessed by SPI-A.";
 	spiAlarms[7] = "Invalid Address Accessed by SPI-B1.";
 	spiAlarms[8] = "Invalid Address Accessed by SPI-B2.";
-	*alarmStatus = 0;
 	for (uint8_t a = 0; a < 9; a++)
 	{
 		if (((alarmVal >> a) & 1) == 1)
@@ -455,49 +494,66 @@ uint8_t readSpiAlarms(uint8_t afeId, uint8_t *alarmStatus)
 		return RET_OK;
 }
 
-/**
-    @brief Read the TX power.
-    @details This function reads the TX Power.
-    @param afeId AFE ID
-    @param chNo Select the TX Channel<br>
-			0 for TXA<br>
-			1 for TXB<br>
-			2 for TXC<br>
-			3 for TXD
-    @param windowLen Determines the window length for number of samples. <br>
-		2^(windowLen+5) samples at the interface rate will be used for power measurement. Range of this is 0-0xfff
-    @param powerReadB0 Pointer Return of Band 0 Power Read
-    @param powerReadB1 Pointer Return of Band 1 Power Read
-	@return Returns if the function execution passed or failed.
-*/
-uint8_t readTxPower(uint8_t afeId, uint8_t chNo, uint16_t windowLen, double *powerReadB0, double *powerReadB1)
+#if (AFE_TX_POWER_STREAM_DEPTH & (AFE_TX_POWER_STREAM_DEPTH - 1)) != 0
+#error AFE_TX_POWER_STREAM_DEPTH should be a power of 2.
+#endif
+
+/* State of the TX power meter saved when it is armed and restored after the measurement. */
+typedef struct AFE_TX_POWER_METER_STATE
 {
-	AFE_ID_VALIDITY();
-	AFE_PARAMS_VALID(chNo < AFE_NUM_TX_CHANNELS);
-	AFE_PARAMS_VALID(windowLen <= 0xfff);
-	AFE_PARAMS_VALID(powerReadB0 != NULL);
-	AFE_PARAMS_VALID(powerReadB1 != NULL);
-	uint32_t powerRead = 0;
-	uint8_t errorStatus = 0;
+	uint8_t papBlk;
+	uint8_t alarmMask;
+	uint8_t single;
+	uint8_t combined;
+} AfeTxPowerMeterState_t;
 
-	uint8_t pap_blk_status, alarm_mask_status, single_status, combined_status, readValue_lsb, readValue_msb, readValue_mid;
-	
+typedef struct AFE_TX_POWER_STREAM_ENTRY
+{
+	uint32_t timeUs;
+	uint32_t powerRaw[AFE_NUM_BANDS_PER_TX];
+	uint8_t chNo;
+} AfeTxPowerStreamEntry_t;
+
+/* afeTxPowerStreamSample is the only producer and afeTxPowerStreamRead the only consumer of the ring, so it needs no lock.
+   head is written only by the producer and tail only by the consumer, both count all the samples since the start.
+   Each side publishes its counter with a release store after it is done with the entries, the other side loads it with acquire. */
+typedef struct AFE_TX_POWER_STREAM
+{
+	uint8_t txChList;
+	AfeTxPowerMeterState_t saved[AFE_NUM_TX_CHANNELS];
+	uint32_t head;
+	uint32_t tail;
+	uint32_t dropped;
+	AfeTxPowerStreamEntry_t entry[AFE_TX_POWER_STREAM_DEPTH];
+} AfeTxPowerStream_t;
+
+static AfeTxPowerStream_t afeTxPowerStream[NUM_OF_AFE];
+
+static double txPowerToDbfs(uint32_t powerRaw)
+{
+	return 10 * log10(((powerRaw == 0) ? 1 : powerRaw) * 1.0 / 0x10000);
+}
+
+/* Selects the TX channel in txdig, enables the PAP block power meter if it is off and sets the window length. The page is left selected. */
+static uint8_t txPowerMeterArm(uint8_t afeId, uint8_t chNo, uint16_t windowLen, AfeTxPowerMeterState_t *saved)
+{
+	uint8_t errorStatus = 0;
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0019, (1 << (chNo + 4)), 0, 7));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0528, 0, 0, &pap_blk_status));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x052d, 0, 3, &alarm_mask_status));
-	if (pap_blk_status == 0)
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0528, 0, 0, &saved->papBlk));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x052d, 0, 3, &saved->alarmMask));
+	if (saved->papBlk == 0)
 	{
 		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x052d, 0xf, 0, 3));
 		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0528, 0x01, 0, 0));
 	}
 
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0525, 0, 0, &single_status));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0524, 0, 0, &combined_status));
-	if (combined_status == 0)
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0525, 0, 0, &saved->single));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0524, 0, 0, &saved->combined));
+	if (saved->combined == 0)
 	{
 		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0525, 0x01, 0, 0));
 	}
-	if (single_status == 0)
+	if (saved->single == 0)
 	{
 		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0524, 0x01, 0, 0));
 	}
@@ -508,37 +564,104 @@ uint8_t readTxPower(uint8_t afeId, uint8_t chNo, uint16_t windowLen, double *pow
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0521, (windowLen >> 8) & 0xf, 0, 3));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0520, windowLen & 0xff, 0, 7));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x051c, 0x01, 0, 0));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/* Starts a measurement on the TX channel selected in txdig. */
+static uint8_t txPowerMeterTrigger(uint8_t afeId)
+{
+	uint8_t errorStatus = 0;
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x056d, 0x01, 0, 0));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x056d, 0x00, 0, 0));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x051d, 0x01, 0, 0));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x051d, 0x00, 0, 0));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/* Reads the band 0 and band 1 results of the single TX channel selected in txdig. */
+static uint8_t txPowerMeterRead(uint8_t afeId, uint32_t *powerRaw)
+{
+	uint8_t errorStatus = 0;
+	uint8_t readValue_lsb, readValue_msb, readValue_mid;
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x05a0, 0, 7, &readValue_lsb));
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x05a1, 0, 7, &readValue_mid));
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x05a2, 0, 0, &readValue_msb));
-	powerRead = readValue_lsb + (readValue_mid << 8) + (readValue_msb << 16);
-	*powerReadB0 = 10 * log10(powerRead * 1.0 / 0x10000);
-	afeLogInfo("Band 0 Power Read %lfdBFS", *powerReadB0);
+	powerRaw[0] = readValue_lsb + (readValue_mid << 8) + (readValue_msb << 16);
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x05b0, 0, 7, &readValue_lsb));
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x05b1, 0, 7, &readValue_mid));
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x05b2, 0, 0, &readValue_msb));
-	powerRead = readValue_lsb + (readValue_mid << 8) + (readValue_msb << 16);
-	*powerReadB1 = 10 * log10(powerRead * 1.0 / 0x10000);
-	afeLogInfo("Band 1 Power Read %lfdBFS", *powerReadB1);
-	
-	if (combined_status == 0)
+	powerRaw[1] = readValue_lsb + (readValue_mid << 8) + (readValue_msb << 16);
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/* Undoes txPowerMeterArm on the TX channel selected in txdig. */
+static uint8_t txPowerMeterRestore(uint8_t afeId, const AfeTxPowerMeterState_t *saved)
+{
+	uint8_t errorStatus = 0;
+	if (saved->combined == 0)
 	{
 		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0525, 0x00, 0, 0));
 	}
-	if (single_status == 0)
+	if (saved->single == 0)
 	{
 		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0524, 0x00, 0, 0));
 	}
-	if (pap_blk_status == 0)
+	if (saved->papBlk == 0)
 	{
 		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0528, 0x00, 0, 0));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x052d, alarm_mask_status, 0, 3));
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x052d, saved->alarmMask, 0, 3));
 	}
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/**
+    @brief Read the TX power.
+    @details This function reads the TX Power.
+    @param afeId AFE ID
+    @param chNo Select the TX Channel<br>
+			0 for TXA<br>
+			1 for TXB<br>
+			2 for TXC<br>
+			3 for TXD
+    @param windowLen Determines the window length for number of samples. <br>
+		2^(windowLen+5) samples at the interface rate will be used for power measurement. Range of this is 0-0xfff
+    @param powerReadB0 Pointer Return of Band 0 Power Read
+    @param powerReadB1 Pointer Return of Band 1 Power Read
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t readTxPower(uint8_t afeId, uint8_t chNo, uint16_t windowLen, double *powerReadB0, double *powerReadB1)
+{
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(chNo < AFE_NUM_TX_CHANNELS);
+	AFE_PARAMS_VALID(windowLen <= 0xfff);
+	AFE_PARAMS_VALID(powerReadB0 != NULL);
+	AFE_PARAMS_VALID(powerReadB1 != NULL);
+	AFE_PARAMS_VALID(((afeTxPowerStream[afeId].txChList >> chNo) & 1) == 0);
+	uint32_t powerRaw[AFE_NUM_BANDS_PER_TX];
+	uint8_t errorStatus = 0;
+	AfeTxPowerMeterState_t saved;
+
+	AFE_FUNC_EXEC(txPowerMeterArm(afeId, chNo, windowLen, &saved));
+	AFE_FUNC_EXEC(txPowerMeterTrigger(afeId));
+	AFE_FUNC_EXEC(txPowerMeterRead(afeId, powerRaw));
+	*powerReadB0 = txPowerToDbfs(powerRaw[0]);
+	afeLogInfo("Band 0 Power Read %lfdBFS", *powerReadB0);
+	*powerReadB1 = txPowerToDbfs(powerRaw[1]);
+	afeLogInfo("Band 1 Power Read %lfdBFS", *powerReadB1);
 
+	AFE_FUNC_EXEC(txPowerMeterRestore(afeId, &saved));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0019, 0, 0, 7));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
@@ -547,54 +670,104 @@ uint8_t readTxPower(uint8_t afeId, uint8_t chNo, uint16_t windowLen, double *pow
 }
 
 /**
-    @brief Read the RX power.
-    @details This function reads the RX Power.<br>
-			Note that this detector is near the ADC-DDC interface and needs the RX TDD to be ON.<br>
-			For reading FB power needed in ADC shared case, it should be operated in RX Mode and correponding RX channel should be read.
+    @brief Starts the TX power stream.
+    @details Arms the power meter of the selected TX channels once, as readTxPower does for every read, and clears the sample ring. afeTxPowerStreamSample then only triggers and reads the results, call it at the sample rate needed.<br>
+			The stream keeps the PAP block and the meter enabled until afeTxPowerStreamStop restores them. readTxPower can't be used on a streamed channel meanwhile.<br>
+			Clearing the ring resets the counters of the consumer too, so no thread may be in afeTxPowerStreamRead during this call. Stop the reader before restarting the stream.
     @param afeId AFE ID
-    @param chNo Select the RX Channel<br>
-			0 for RXA<br>
-			1 for RXB<br>
-			2 for RXC<br>
-			3 for RXD
-    @param avg_pwrdb Pointer Return of RX Power Read
+    @param txChList Bit wise TX Channel Select.<br>
+			Bit0 for TXA<br>
+			Bit1 for TXB<br>
+			Bit2 for TXC<br>
+			Bit3 for TXD
+    @param windowLen Determines the window length for number of samples. <br>
+		2^(windowLen+5) samples at the interface rate will be used for power measurement. Range of this is 0-0xfff
 	@return Returns if the function execution passed or failed.
 */
-uint8_t getRxRmsPower(uint8_t afeId, uint8_t chNo, double *avg_pwrdb)
+uint8_t afeTxPowerStreamStart(uint8_t afeId, uint8_t txChList, uint16_t windowLen)
 {
-	uint8_t errorStatus = 0;
 	AFE_ID_VALIDITY();
-	AFE_PARAMS_VALID(chNo < AFE_NUM_RX_CHANNELS);
-	AFE_PARAMS_VALID(avg_pwrdb != NULL);
-	uint16_t avg_pwr;
-	uint8_t pwr_det_on_state = 0;
-	uint8_t readValue, avg_pwr_lsb, avg_pwr_msb;
+	AFE_PARAMS_VALID((txChList != 0) && (txChList <= AFE_NUM_TX_CHANNELS_BITWISE));
+	AFE_PARAMS_VALID(windowLen <= 0xfff);
+	AFE_PARAMS_VALID(afeTxPowerStream[afeId].txChList == 0);
+	AfeTxPowerStream_t *stream = &afeTxPowerStream[afeId];
+	uint8_t armed = 0;
 
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 1 << chNo, 0x0, 0x7)); /*rxdig*/
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, 0x0, 0x0, 0x7));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x404, 0x5, 0x5, &readValue));
-	if (readValue == 0x0)
+	for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
 	{
-		pwr_det_on_state = 1;
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x404, 0x1 << 5, 0x5, 0x5));
+		if (((txChList >> chNo) & 1) == 0)
+			continue;
+		if (txPowerMeterArm(afeId, chNo, windowLen, &stream->saved[chNo]) != RET_OK)
+		{
+			afeLogErr("Arming the power meter of TX channel %d failed.", chNo);
+			/* Leave the channels already armed as they were. */
+			for (uint8_t ch = 0; ch < chNo; ch++)
+			{
+				if (((armed >> ch) & 1) == 0)
+					continue;
+				afeSpiWriteWrapper(afeId, 0x0019, (1 << (ch + 4)), 0, 7);
+				txPowerMeterRestore(afeId, &stream->saved[ch]);
+			}
+			afeSpiWriteWrapper(afeId, 0x0019, 0, 0, 7);
+			return RET_EXEC_FAIL;
+		}
+		armed |= 1 << chNo;
 	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0xb04, 1, 0x0, 0x0)); /*pwr_det_read_sel_agc*/
-
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x0, 0x0, 0x0));
+	if (afeSpiWriteWrapper(afeId, 0x0019, 0, 0, 7) != RET_OK)
+	{
+		return RET_EXEC_FAIL;
+	}
+	AFE_RING_STORE_RELEASE(&stream->tail, 0);
+	AFE_RING_STORE_RELEASE(&stream->dropped, 0);
+	AFE_RING_STORE_RELEASE(&stream->head, 0);
+	stream->txChList = txChList;
+	return RET_OK;
+}
 
-	AFE_FUNC_EXEC(waitMs(1));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x1, 0x0, 0x0));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x5d1, 0x0, 0x7, &avg_pwr_msb));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x5d0, 0x0, 0x7, &avg_pwr_lsb));
-	avg_pwr = (avg_pwr_msb << 8) + avg_pwr_lsb;
+/**
+    @brief Takes one TX power stream sample.
+    @details Triggers one measurement on each streamed TX channel and adds a sample per channel to the ring of the AFE, with the time of its trigger.<br>
+			Each channel costs a page select, the two trigger pulses and the six result reads, the meter is not set up again. When the ring is full the new samples are dropped and counted, read them with afeTxPowerStreamRead.
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeTxPowerStreamSample(uint8_t afeId)
+{
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(afeTxPowerStream[afeId].txChList != 0);
+	uint8_t errorStatus = 0;
+	AfeTxPowerStream_t *stream = &afeTxPowerStream[afeId];
+	AfeTxPowerStreamEntry_t *entry;
+	uint32_t powerRaw[AFE_NUM_BANDS_PER_TX];
+	uint32_t timeUs;
+	uint32_t head;
 
-	*avg_pwrdb = 10 * log10(avg_pwr / 65536.0);
-	afeLogInfo("RX channel %d, Average Power read in dbfs %lf", chNo, avg_pwrdb);
-	if (pwr_det_on_state == 1)
+	for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
 	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x404, 0x0 << 5, 0x5, 0x5));
+		if (((stream->txChList >> chNo) & 1) == 0)
+			continue;
+		/* The trigger bits are written read-modify-write, so each channel is triggered on its own page. */
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0019, (1 << (chNo + 4)), 0, 7));
+		timeUs = (uint32_t)getTimeUs();
+		AFE_FUNC_EXEC(txPowerMeterTrigger(afeId));
+		AFE_FUNC_EXEC(txPowerMeterRead(afeId, powerRaw));
+
+		head = stream->head;
+		/* Acquire, so the reader is done copying a freed entry before it is overwritten. */
+		if ((head - AFE_RING_LOAD_ACQUIRE(&stream->tail)) >= AFE_TX_POWER_STREAM_DEPTH)
+		{
+			AFE_RING_STORE_RELEASE(&stream->dropped, stream->dropped + 1);
+			continue;
+		}
+		entry = &stream->entry[head & (AFE_TX_POWER_STREAM_DEPTH - 1)];
+		entry->timeUs = timeUs;
+		entry->powerRaw[0] = powerRaw[0];
+		entry->powerRaw[1] = powerRaw[1];
+		entry->chNo = chNo;
+		/* Release, so the entry is complete before the reader sees head move on to it. */
+		AFE_RING_STORE_RELEASE(&stream->head, head + 1);
 	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 0x0, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0019, 0, 0, 7));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -602,29 +775,120 @@ uint8_t getRxRmsPower(uint8_t afeId, uint8_t chNo, double *avg_pwrdb)
 }
 
 /**
-    @brief Read the FB power.
-    @details This function reads the FB Power.<br>
-			Note that this detector is near the ADC-DDC interface and needs the RX TDD to be ON.<br>
-			For reading FB power needed in ADC shared case, it should be operated in RX Mode and correponding RX channel should be read.
+    @brief Reads the TX power stream samples.
+    @details Moves the oldest samples out of the ring of the AFE, converting them to dBFS. No SPI access is done, so this can be called from a thread other than the one calling afeTxPowerStreamSample.<br>
+			The samples stay readable after afeTxPowerStreamStop until the next afeTxPowerStreamStart, which must not run during this call.
     @param afeId AFE ID
-    @param chNo Select the FB Channel<br>
-			0 for FB1<br>
-			1 for FB2<br>
-    @param avg_pwrdb Pointer Return of FB Power Read
+    @param samples Array returning the samples, oldest first.
+    @param maxSamples Number of entries in samples.
+    @param numSamples Pointer return of the number of samples written.
 	@return Returns if the function execution passed or failed.
 */
-uint8_t getFbRmsPower(uint8_t afeId, uint8_t chNo, double *avg_pwrdb)
+uint8_t afeTxPowerStreamRead(uint8_t afeId, AfeTxPowerSample_t *samples, uint16_t maxSamples, uint16_t *numSamples)
 {
-	uint8_t errorStatus = 0;
 	AFE_ID_VALIDITY();
-	AFE_PARAMS_VALID(chNo < AFE_NUM_FB_CHANNELS);
-	AFE_PARAMS_VALID(avg_pwrdb != NULL);
-	uint16_t avg_pwr;
-	uint8_t readValue, avg_pwr_lsb, avg_pwr_msb;
+	AFE_PARAMS_VALID((samples != NULL) && (numSamples != NULL));
+	AfeTxPowerStream_t *stream = &afeTxPowerStream[afeId];
+	const AfeTxPowerStreamEntry_t *entry;
+	uint32_t tail = stream->tail;
+	/* Acquire, so the entries up to head are read as the producer completed them. */
+	uint32_t available = AFE_RING_LOAD_ACQUIRE(&stream->head) - tail;
+	uint16_t count = (available < maxSamples) ? (uint16_t)available : maxSamples;
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		entry = &stream->entry[(tail + i) & (AFE_TX_POWER_STREAM_DEPTH - 1)];
+		memset(&samples[i], 0, sizeof(AfeTxPowerSample_t));
+		samples[i].timeUs = entry->timeUs;
+		samples[i].chNo = entry->chNo;
+		for (uint8_t bandNo = 0; bandNo < AFE_NUM_BANDS_PER_TX; bandNo++)
+		{
+			samples[i].powerRaw[bandNo] = entry->powerRaw[bandNo];
+			samples[i].powerDb[bandNo] = txPowerToDbfs(entry->powerRaw[bandNo]);
+		}
+	}
+	/* Release, so the entries are copied before tail frees them for the producer. */
+	AFE_RING_STORE_RELEASE(&stream->tail, tail + count);
+	*numSamples = count;
+	return RET_OK;
+}
 
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 0x10 << chNo, 0x0, 0x7)); /*fbdig*/
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0773, 0x0, 0x0, &readValue));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, 0x0, 0x0, 0x7));	
+/**
+    @brief TX power stream counters.
+    @details Returns the number of samples added to the ring and dropped because it was full since the last afeTxPowerStreamStart, and the channels being streamed.
+    @param afeId AFE ID
+    @param captured Pointer return of the number of samples added to the ring.
+    @param dropped Pointer return of the number of samples dropped.
+    @param txChList Pointer return of the streamed channels, 0 when the stream is stopped.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeTxPowerStreamGetStats(uint8_t afeId, uint32_t *captured, uint32_t *dropped, uint8_t *txChList)
+{
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID((captured != NULL) && (dropped != NULL) && (txChList != NULL));
+	*captured = AFE_RING_LOAD_ACQUIRE(&afeTxPowerStream[afeId].head);
+	*dropped = AFE_RING_LOAD_ACQUIRE(&afeTxPowerStream[afeId].dropped);
+	*txChList = afeTxPowerStream[afeId].txChList;
+	return RET_OK;
+}
+
+/**
+    @brief Stops the TX power stream.
+    @details Restores the PAP block state, alarm masks and single/combined status saved by afeTxPowerStreamStart on every streamed channel. All the channels are restored even if one of them fails.
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeTxPowerStreamStop(uint8_t afeId)
+{
+	AFE_ID_VALIDITY();
+	uint8_t errorStatus = 0;
+	AfeTxPowerStream_t *stream = &afeTxPowerStream[afeId];
+
+	for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+	{
+		if (((stream->txChList >> chNo) & 1) == 0)
+			continue;
+		if ((afeSpiWriteWrapper(afeId, 0x0019, (1 << (chNo + 4)), 0, 7) != RET_OK) || (txPowerMeterRestore(afeId, &stream->saved[chNo]) != RET_OK))
+		{
+			afeLogErr("Restoring the power meter of TX channel %d failed.", chNo);
+			errorStatus = 1;
+		}
+	}
+	stream->txChList = 0;
+	if (afeSpiWriteWrapper(afeId, 0x0019, 0, 0, 7) != RET_OK)
+	{
+		errorStatus = 1;
+	}
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/* Converts the average power read from the RMS detector to dBFS. A reading of 0 is returned as the 1 LSB floor instead of -inf. */
+static double rmsPowerToDbfs(uint16_t avgPwr)
+{
+	return 10 * log10(((avgPwr == 0) ? 1 : avgPwr) / 65536.0);
+}
+
+/* Reads the RMS detector of the single RX or FB channel selected in page 0x12, after the 0x5c4 capture. */
+static uint8_t rmsPowerRead(uint8_t afeId, double *avgPwrDb)
+{
+	uint8_t errorStatus = 0;
+	uint8_t avg_pwr_lsb, avg_pwr_msb;
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x5d1, 0x0, 0x7, &avg_pwr_msb));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x5d0, 0x0, 0x7, &avg_pwr_lsb));
+	*avgPwrDb = rmsPowerToDbfs((avg_pwr_msb << 8) + avg_pwr_lsb);
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/* Configures the power detectors of the FB channel selected in page 0x12 for the RMS power read. It has partial writes, which read the register back, so only one channel may be selected. */
+static uint8_t fbRmsPowerDetConfig(uint8_t afeId)
+{
+	uint8_t errorStatus = 0;
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x1015, 0x04, 0x2, 0x2));
 	
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0400, 0x00, 0x0, 0x0));
@@ -693,16 +957,127 @@ uint8_t getFbRmsPower(uint8_t afeId, uint8_t chNo, double *avg_pwrdb)
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0498, 0x00, 0x1, 0x1));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x1015, 0x00, 0x0, 0x0));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0b04, 0x01, 0x0, 0x0));
-	
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/* FB channels whose power detectors fbRmsPowerDetConfig has set up, valid for the device state epoch they were set up in. */
+static uint8_t afeFbRmsDetConfigured[NUM_OF_AFE];
+static uint32_t afeFbRmsDetEpoch[NUM_OF_AFE];
+
+static uint8_t fbRmsPowerDetIsConfigured(uint8_t afeId, uint8_t chNo)
+{
+	if (afeFbRmsDetEpoch[afeId] != afeGetDeviceStateEpoch(afeId))
+	{
+		afeFbRmsDetConfigured[afeId] = 0;
+		afeFbRmsDetEpoch[afeId] = afeGetDeviceStateEpoch(afeId);
+	}
+	return (afeFbRmsDetConfigured[afeId] >> chNo) & 1;
+}
+
+static void fbRmsPowerDetSetConfigured(uint8_t afeId, uint8_t chNo)
+{
+	fbRmsPowerDetIsConfigured(afeId, chNo);
+	afeFbRmsDetConfigured[afeId] |= 1 << chNo;
+}
+
+/* Sets up the power detectors of the FB channel chNo, selected in page 0x12, unless they still are from an earlier read. The detector enable of 0x1015 cleared after each read is always set. */
+static uint8_t fbRmsPowerDetSetup(uint8_t afeId, uint8_t chNo)
+{
+	uint8_t errorStatus = 0;
+	if (fbRmsPowerDetIsConfigured(afeId, chNo))
+	{
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x1015, 0x04, 0x2, 0x2));
+		return RET_OK;
+	}
+	AFE_FUNC_EXEC(fbRmsPowerDetConfig(afeId));
+	fbRmsPowerDetSetConfigured(afeId, chNo);
+	return RET_OK;
+}
+
+/**
+    @brief Read the RX power.
+    @details This function reads the RX Power.<br>
+			Note that this detector is near the ADC-DDC interface and needs the RX TDD to be ON.<br>
+			For reading FB power needed in ADC shared case, it should be operated in RX Mode and correponding RX channel should be read.
+    @param afeId AFE ID
+    @param chNo Select the RX Channel<br>
+			0 for RXA<br>
+			1 for RXB<br>
+			2 for RXC<br>
+			3 for RXD
+    @param avg_pwrdb Pointer Return of RX Power Read
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getRxRmsPower(uint8_t afeId, uint8_t chNo, double *avg_pwrdb)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(chNo < AFE_NUM_RX_CHANNELS);
+	AFE_PARAMS_VALID(avg_pwrdb != NULL);
+	uint8_t pwr_det_on_state = 0;
+	uint8_t readValue;
+
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 1 << chNo, 0x0, 0x7)); /*rxdig*/
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, 0x0, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x404, 0x5, 0x5, &readValue));
+	if (readValue == 0x0)
+	{
+		pwr_det_on_state = 1;
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x404, 0x1 << 5, 0x5, 0x5));
+	}
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0xb04, 1, 0x0, 0x0)); /*pwr_det_read_sel_agc*/
+
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x0, 0x0, 0x0));
+
 	AFE_FUNC_EXEC(waitMs(1));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x1, 0x0, 0x0));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x5d1, 0x0, 0x7, &avg_pwr_msb));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x5d0, 0x0, 0x7, &avg_pwr_lsb));
-	avg_pwr = (avg_pwr_msb << 8) + avg_pwr_lsb;
+	AFE_FUNC_EXEC(rmsPowerRead(afeId, avg_pwrdb));
+	afeLogInfo("RX channel %d, Average Power read in dbfs %lf", chNo, *avg_pwrdb);
+	if (pwr_det_on_state == 1)
+	{
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x404, 0x0 << 5, 0x5, 0x5));
+	}
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 0x0, 0x0, 0x7));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
 
-	*avg_pwrdb = 10 * log10(avg_pwr / 65536.0);
-	afeLogInfo("FB channel %d, Average Power read in dbfs %lf", chNo, avg_pwrdb);
+/**
+    @brief Read the FB power.
+    @details This function reads the FB Power.<br>
+			Note that this detector is near the ADC-DDC interface and needs the RX TDD to be ON.<br>
+			For reading FB power needed in ADC shared case, it should be operated in RX Mode and correponding RX channel should be read.
+    @param afeId AFE ID
+    @param chNo Select the FB Channel<br>
+			0 for FB1<br>
+			1 for FB2<br>
+    @param avg_pwrdb Pointer Return of FB Power Read
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getFbRmsPower(uint8_t afeId, uint8_t chNo, double *avg_pwrdb)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(chNo < AFE_NUM_FB_CHANNELS);
+	AFE_PARAMS_VALID(avg_pwrdb != NULL);
+	uint8_t readValue;
+
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 0x10 << chNo, 0x0, 0x7)); /*fbdig*/
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0773, 0x0, 0x0, &readValue));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, 0x0, 0x0, 0x7));	
+	AFE_FUNC_EXEC(fbRmsPowerDetConfig(afeId));
+	fbRmsPowerDetSetConfigured(afeId, chNo);
+	
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x0, 0x0, 0x0));
+	AFE_FUNC_EXEC(waitMs(1));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x1, 0x0, 0x0));
+	AFE_FUNC_EXEC(rmsPowerRead(afeId, avg_pwrdb));
+	afeLogInfo("FB channel %d, Average Power read in dbfs %lf", chNo, *avg_pwrdb);
 	
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, readValue, 0x2, 0x2));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x1015, 0x00, 0x2, 0x2));
@@ -715,6 +1090,114 @@ uint8_t getFbRmsPower(uint8_t afeId, uint8_t chNo, double *avg_pwrdb)
 }
 
 
+/**
+    @brief Read the RX and FB power of several channels.
+    @details Reads the RMS power of all the selected RX and FB channels in one pass. The captures of all the channels are started, share a single 1ms wait and are then read channel by channel.
+			The register fields are written with one channel selected at a time, only the full register writes are broadcast.<br>
+			This gives the same readings as calling getRxRmsPower and getFbRmsPower for each channel, with one wait instead of one per channel. The same notes on the RX TDD apply.<br>
+			The FB power detector setup is done once and kept for the next sweeps, which saves about 90 SPI transactions per FB channel. It is done again after closeAllPages, a macro, a failed SPI transfer or afeShadowCacheInvalidate, see afeGetDeviceStateEpoch.
+			afeShadowCacheInvalidate has to be called when the device is reset or the detector registers are written outside this function and getFbRmsPower.<br>
+			Each channel has a single wideband detector near the ADC-DDC interface, so the reading covers both the bands of the channel.
+    @param afeId AFE ID
+    @param rxChList Bit wise RX Channel Select.<br>
+			Bit0 for RXA<br>
+			Bit1 for RXB<br>
+			Bit2 for RXC<br>
+			Bit3 for RXD
+    @param fbChList Bit wise FB Channel Select.<br>
+			Bit0 for FB1<br>
+			Bit1 for FB2
+    @param rxPwrDb Array of AFE_NUM_RX_CHANNELS entries returning the power in dBFS, indexed by the channel number. Only the selected channels are written. Can be NULL when rxChList is 0.
+    @param fbPwrDb Array of AFE_NUM_FB_CHANNELS entries returning the power in dBFS, indexed by the channel number. Only the selected channels are written. Can be NULL when fbChList is 0.
+    @param sweepUs Pointer return of the time taken by the sweep in micro seconds, from getTimeUs. Can be NULL.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getRmsPowerSweep(uint8_t afeId, uint8_t rxChList, uint8_t fbChList, double *rxPwrDb, double *fbPwrDb, uint32_t *sweepUs)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(rxChList <= AFE_NUM_RX_CHANNELS_BITWISE);
+	AFE_PARAMS_VALID(fbChList <= AFE_NUM_FB_CHANNELS_BITWISE);
+	AFE_PARAMS_VALID((rxChList | fbChList) != 0);
+	AFE_PARAMS_VALID((rxChList == 0) || (rxPwrDb != NULL));
+	AFE_PARAMS_VALID((fbChList == 0) || (fbPwrDb != NULL));
+	uint64_t startUs = getTimeUs();
+	uint8_t pwrDetTurnedOn = 0;
+	uint8_t readValue;
+	uint8_t fbDigState[AFE_NUM_FB_CHANNELS] = {0};
+
+	/* The partial writes read the register back, which needs a single channel selected in page 0x12, so they are done channel by channel. */
+	/* RX: enable the detectors that are off, select them for the read and start the capture. */
+	if (rxChList != 0)
+	{
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, rxChList, 0x0, 0x7)); /*rxdig*/
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, 0x0, 0x0, 0x7));
+	}
+	for (uint8_t chNo = 0; chNo < AFE_NUM_RX_CHANNELS; chNo++)
+	{
+		if (((rxChList >> chNo) & 1) == 0)
+			continue;
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 1 << chNo, 0x0, 0x7));
+		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x404, 0x5, 0x5, &readValue));
+		if (readValue == 0x0)
+		{
+			pwrDetTurnedOn |= 1 << chNo;
+			AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x404, 0x1 << 5, 0x5, 0x5));
+		}
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0xb04, 1, 0x0, 0x0)); /*pwr_det_read_sel_agc*/
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x0, 0x0, 0x0));
+	}
+
+	/* FB: save the state restored after the read, set up the detectors if needed and start the capture. */
+	for (uint8_t chNo = 0; chNo < AFE_NUM_FB_CHANNELS; chNo++)
+	{
+		if (((fbChList >> chNo) & 1) == 0)
+			continue;
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 0x10 << chNo, 0x0, 0x7)); /*fbdig*/
+		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x0773, 0x0, 0x0, &fbDigState[chNo]));
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, 0x0, 0x0, 0x7));
+		AFE_FUNC_EXEC(fbRmsPowerDetSetup(afeId, chNo));
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x0, 0x0, 0x0));
+	}
+
+	/* One wait for all the captures. */
+	AFE_FUNC_EXEC(waitMs(1));
+
+	for (uint8_t chNo = 0; chNo < AFE_NUM_RX_CHANNELS; chNo++)
+	{
+		if (((rxChList >> chNo) & 1) == 0)
+			continue;
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 1 << chNo, 0x0, 0x7));
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x1, 0x0, 0x0));
+		AFE_FUNC_EXEC(rmsPowerRead(afeId, &rxPwrDb[chNo]));
+		afeLogDbg("RX channel %d, Average Power read in dbfs %lf", chNo, rxPwrDb[chNo]);
+		if ((pwrDetTurnedOn >> chNo) & 1)
+		{
+			AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x404, 0x0 << 5, 0x5, 0x5));
+		}
+	}
+	for (uint8_t chNo = 0; chNo < AFE_NUM_FB_CHANNELS; chNo++)
+	{
+		if (((fbChList >> chNo) & 1) == 0)
+			continue;
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 0x10 << chNo, 0x0, 0x7));
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x5c4, 0x1, 0x0, 0x0));
+		AFE_FUNC_EXEC(rmsPowerRead(afeId, &fbPwrDb[chNo]));
+		afeLogDbg("FB channel %d, Average Power read in dbfs %lf", chNo, fbPwrDb[chNo]);
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0773, fbDigState[chNo], 0x2, 0x2));
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x1015, 0x00, 0x2, 0x2));
+	}
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x12, 0x0, 0x0, 0x7));
+	if (sweepUs != NULL)
+	{
+		*sweepUs = (uint32_t)(getTimeUs() - startUs);
+	}
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
 /**
     @brief Clear all the alarms
     @details Clears all the AFE alarms
@@ -816,13 +1299,77 @@ uint8_t overrideDigPkDetPin(uint8_t afeId, uint8_t chNo, uint8_t pinNo, uint8_t
 		return RET_OK;
 }
 
+/**
+    @brief Reads the Device Health
+    @details Reads the PLL lock, DAC JESD link and alarms, ADC JESD FIFO errors, SPI alarms, MCU health and the PAP alarms of all the TX channels into one structure, without logging the status.<br>
+		The structure has a fixed layout, a monitor can compare two reads directly and look at the fields only when they differ.
+    @param afeId AFE ID
+	@param health Pointer return of the device health. health->faults has the AFE_HEALTH_FAULT_* bits, 0 if the device is healthy.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getDeviceHealth(uint8_t afeId, AfeDeviceHealth_t *health)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(health != NULL);
+	memset(health, 0, sizeof(AfeDeviceHealth_t));
+
+	AFE_FUNC_EXEC(getPllLockState(afeId, &health->pllStatus));
+	if ((health->pllStatus & (AFE_PLL_STATUS_LOCKED | AFE_PLL_STATUS_LOCK_LOST_STICKY)) != AFE_PLL_STATUS_LOCKED)
+	{
+		health->faults |= AFE_HEALTH_FAULT_PLL;
+	}
+
+	AFE_FUNC_EXEC(getJesdRxLinkState(afeId, &health->jesdRx));
+	AFE_FUNC_EXEC(getJesdRxAlarms(afeId, &health->jesdRxAlarms));
+	if ((health->jesdRx.linkStatus != 10) || (health->jesdRxAlarms != 0))
+	{
+		health->faults |= AFE_HEALTH_FAULT_DAC_JESD;
+	}
+
+	for (uint8_t jesdNo = 0; jesdNo < AFE_NUM_JESD_INSTANCES; jesdNo++)
+	{
+		AFE_FUNC_EXEC(getJesdTxFifoErrors(afeId, jesdNo, &health->jesdTxFifo[jesdNo]));
+		if (health->jesdTxFifo[jesdNo] != 0)
+		{
+			health->faults |= AFE_HEALTH_FAULT_ADC_JESD;
+		}
+	}
+
+	AFE_FUNC_EXEC(getSpiAlarmBits(afeId, &health->spiAlarms));
+	if (health->spiAlarms != 0)
+	{
+		health->faults |= AFE_HEALTH_FAULT_SPI;
+	}
+
+	AFE_FUNC_EXEC(checkMcuHealth(afeId, &health->mcuOk));
+	if (health->mcuOk == 0)
+	{
+		health->faults |= AFE_HEALTH_FAULT_MCU;
+	}
+
+	for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+	{
+		AFE_FUNC_EXEC(papGetAlarmStatus(afeId, chNo, &health->pap[chNo]));
+		if (health->pap[chNo].triggered)
+		{
+			health->faults |= AFE_HEALTH_FAULT_PAP;
+		}
+	}
+
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
 /**
     @brief Checks the Device Health
-    @details This function Reads the complete device health and returns as a pointer.
+    @details This function Reads the complete device health with getDeviceHealth, logs it and returns the status as a pointer.
     @param afeId AFE ID
 	@param allOk Pointer return of the device health status.<br>
-		If there is no error, allOk will be 0.<br>
-			If it is non-zero, below is the interpretation<br>
+		1 if there is no error, 0 otherwise.<br>
+		getDeviceHealth returns the bits below for the failing parts.<br>
 			Bit 0: PLL Not Okay<br>
 			Bit 1: DAC JESD Not Okay<br>
 			Bit 2: ADC JESD Not Okay<br>
@@ -834,44 +1381,34 @@ uint8_t overrideDigPkDetPin(uint8_t afeId, uint8_t chNo, uint8_t pinNo, uint8_t
 uint8_t checkDeviceHealth(uint8_t afeId, uint16_t *allOk)
 {
 	uint8_t errorStatus = 0;
-	uint8_t linkError = 0;
-	uint8_t pllStatus = 0;
-	uint8_t spiAlarm = 0;
-	uint8_t mcuHealth = 0;
-	uint8_t papStatus = 0;
-	uint16_t linkStatus = 0;
+	AfeDeviceHealth_t health;
 
-	*allOk = 1;
+	AFE_PARAMS_VALID(allOk != NULL);
+	*allOk = 0;
+	AFE_FUNC_EXEC(getDeviceHealth(afeId, &health));
 
 	/*	#### PLL Status	#### */
-	AFE_FUNC_EXEC(checkPllLockStatus(afeId, &pllStatus));
-	if (pllStatus != 3)
+	if ((health.faults & AFE_HEALTH_FAULT_PLL) != 0)
 	{
-		*allOk = 0;
 		afeLogErr("%s", "PLL lost lock currently or in the past.");
 	}
 	else
 	{
-		afeLogInfo("%s", "AFE DAC-JESD-RX relink Successful.");
+		afeLogInfo("%s", "PLL locked.");
 	}
 
 	/*	#### JESD Status	#### */
-	AFE_FUNC_EXEC(getJesdRxLinkStatus(afeId, &linkStatus));
-	if (linkStatus != 10)
+	if (health.jesdRx.linkStatus != 10)
 	{
 		afeLogErr("%s", "AFE DAC-JESD-RX Link Down.");
-		*allOk = 0;
 	}
 	else
 	{
 		afeLogInfo("%s", "AFE DAC-JESD-RX Link is good.");
 	}
-
-	AFE_FUNC_EXEC(getJesdRxAlarms(afeId, &linkError));
-	if (linkError != 0)
+	if (health.jesdRxAlarms != 0)
 	{
 		afeLogErr("%s", "AFE DAC-JESD-RX has some errors triggered.");
-		*allOk = 0;
 	}
 	else
 	{
@@ -879,33 +1416,22 @@ uint8_t checkDeviceHealth(uint8_t afeId, uint16_t *allOk)
 	}
 
 	/* ADC JESD */
-	AFE_FUNC_EXEC(getJesdTxFifoErrors(afeId, 0, &linkError));
-	if (linkError != 0)
+	for (uint8_t jesdNo = 0; jesdNo < AFE_NUM_JESD_INSTANCES; jesdNo++)
 	{
-		afeLogErr("%s", "AFE ADC-JESD-TX AB has some errors triggered.");
-		*allOk = 0;
-	}
-	else
-	{
-		afeLogInfo("%s", "AFE ADC-JESD-TX AB has no Errors triggered.");
-	}
-	AFE_FUNC_EXEC(getJesdTxFifoErrors(afeId, 1, &linkError));
-	if (linkError != 0)
-	{
-		afeLogErr("%s", "AFE ADC-JESD-TX CD has some errors triggered.");
-		*allOk = 0;
-	}
-	else
-	{
-		afeLogInfo("%s", "AFE ADC-JESD-TX CD has no Errors triggered.");
+		if (health.jesdTxFifo[jesdNo] != 0)
+		{
+			afeLogErr("AFE ADC-JESD-TX %s has some errors triggered.", (jesdNo == 0) ? "AB" : "CD");
+		}
+		else
+		{
+			afeLogInfo("AFE ADC-JESD-TX %s has no Errors triggered.", (jesdNo == 0) ? "AB" : "CD");
+		}
 	}
 
 	/* SPI Alarms */
-	AFE_FUNC_EXEC(readSpiAlarms(afeId, &spiAlarm));
-	if (spiAlarm != 0)
+	if (health.spiAlarms != 0)
 	{
-		*allOk = 0;
-		afeLogErr("%s", "SPI Alarm triggered.");
+		afeLogErr("SPI Alarm triggered: 0x%X.", health.spiAlarms);
 	}
 	else
 	{
@@ -913,10 +1439,8 @@ uint8_t checkDeviceHealth(uint8_t afeId, uint16_t *allOk)
 	}
 
 	/* MCU Health */
-	AFE_FUNC_EXEC(checkMcuHealth(afeId, &mcuHealth));
-	if (mcuHealth != 0)
+	if (health.mcuOk == 0)
 	{
-		*allOk = 0;
 		afeLogErr("%s", "MCU Not Running.");
 	}
 	else
@@ -925,16 +1449,15 @@ uint8_t checkDeviceHealth(uint8_t afeId, uint16_t *allOk)
 	}
 
 	/* PAP Status */
-	for (uint8_t chNo = 0; chNo < 4; chNo++)
+	for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
 	{
-		AFE_FUNC_EXEC(papAlarmStatus(afeId, chNo, &papStatus));
-		if (papStatus == 1)
+		if (health.pap[chNo].triggered)
 		{
 			afeLogErr("PAP triggered for TX Channel Number: %d", chNo);
-			*allOk = 0;
 		}
 	}
 
+	*allOk = (health.faults == 0);
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -457,6 +457,148 @@ uint8_t updateTxGain(uint8_t afeId, uint8_t txChainSel, uint8_t gainValidity, ui
 		return RET_OK;
 }
 
+/*  Paths of the NCO hop table entries.   */
+#define AFE_NCO_HOP_TX 0
+#define AFE_NCO_HOP_RX 1
+#define AFE_NCO_HOP_FB 2
+/*  Writes of a TX hop: the NCO update pulses with their page select and close, then the band registers with theirs.   */
+#define AFE_NCO_HOP_TX_PULSE_WRITES 11
+#define AFE_NCO_HOP_TX_WRITES (AFE_NCO_HOP_TX_PULSE_WRITES + 9)
+
+/*  One precomputed frequency: the macro operands and, for TX, the full register image of the writes updateTxNco does read-modify-write.   */
+typedef struct AFE_NCO_HOP_ENTRY
+{
+	uint8_t path;
+	uint8_t chNo;
+	uint8_t nco;
+	uint8_t band;
+	uint8_t bandRange;
+	uint32_t mixer;
+	uint8_t numOperands;
+	uint8_t operands[7];
+	uint8_t tuneOperands[4];
+	uint16_t addrList[AFE_NCO_HOP_TX_WRITES];
+	uint8_t dataList[AFE_NCO_HOP_TX_WRITES];
+} AfeNcoHopEntry_t;
+
+typedef struct AFE_NCO_HOP_TABLE
+{
+	uint8_t numEntries;
+	/*  TX channels whose band registers are known to hold txBandRange, set by the hops.   */
+	uint8_t txBandKnown;
+	uint8_t txBandRange[AFE_NUM_TX_CHANNELS];
+	uint32_t numHops;
+	uint32_t latencyUs[AFE_NCO_HOP_LATENCY_SAMPLES];
+	AfeNcoHopEntry_t entry[AFE_NCO_HOP_MAX_ENTRIES];
+} AfeNcoHopTable_t;
+
+static AfeNcoHopTable_t afeNcoHopTable[NUM_OF_AFE];
+
+/*  TX band register values of the mixer frequency ranges: up to 900000, below 2300000 and above.   */
+static const uint8_t txNcoBandReg107[3] = {0x10, 0xf0, 0x00};
+static const uint8_t txNcoBandReg108[3] = {0x1F, 0x00, 0x00};
+
+static uint8_t txNcoBandRange(uint32_t mixer)
+{
+	if (mixer <= 900000)
+		return 0;
+	else if (mixer < 2300000)
+		return 1;
+	return 2;
+}
+
+/*  Writes the TX band registers 0x104-0x10a of the channels in chBits for the mixer frequency range.   */
+static uint8_t writeTxNcoBandRegs(uint8_t afeId, uint8_t chBits, uint8_t range)
+{
+	uint8_t errorStatus = 0;
+	/*  The hop table can't skip the band registers of these channels any more.   */
+	afeNcoHopTable[afeId].txBandKnown &= (uint8_t)~chBits;
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, chBits, 0x0, 0x7)); /*txdh*/
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x107, txNcoBandReg107[range], 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x106, 0x0, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x105, 0x0, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x104, 0x40, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x10a, 0x0, 0x0, 0x3));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x109, 0x0, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x108, txNcoBandReg108[range], 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, 0x0, 0x0, 0x7));
+	return RET_OK;
+}
+
+static uint8_t txNcoImageAdd(uint16_t *addrList, uint8_t *dataList, uint8_t numWrites, uint16_t addr, uint8_t data)
+{
+	addrList[numWrites] = addr;
+	dataList[numWrites] = data;
+	return numWrites + 1;
+}
+
+/*  Adds the write sequence 0, 1, 0 of bit 0 of a pulse register to the image.   */
+static uint8_t txNcoImageAddPulse(uint16_t *addrList, uint8_t *dataList, uint8_t numWrites, uint16_t addr, uint8_t regValue)
+{
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, addr, regValue & 0xfe);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, addr, regValue | 0x01);
+	return txNcoImageAdd(addrList, dataList, numWrites, addr, regValue & 0xfe);
+}
+
+/*  Reads the registers next to the NCO update pulses and band bits that updateTxNco changes with read-modify-write, for the image of txNcoImage.   */
+static uint8_t txNcoReadImageRegs(uint8_t afeId, uint8_t chNo, uint8_t nco, uint8_t *imageRegs)
+{
+	uint8_t errorStatus = 0;
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x19, 1 << (chNo + 4), 0x0, 7)); /*txdig*/
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x130 + nco, 0, 7, &imageRegs[0]));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x230 + nco, 0, 7, &imageRegs[1]));
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x773, 0, 7, &imageRegs[2]));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x19, 0x0, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, 1 << chNo, 0x0, 0x7)); /*txdh*/
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x10a, 0, 7, &imageRegs[3]));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, 0x0, 0x0, 0x7));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/*  Full byte writes of the NCO update pulses and band registers of updateTxNco for the channels in chBits, from the registers read by txNcoReadImageRegs.
+	The first AFE_NCO_HOP_TX_PULSE_WRITES writes are the pulses, the rest the band registers. Returns the number of writes.   */
+static uint8_t txNcoImage(uint16_t *addrList, uint8_t *dataList, uint8_t chBits, uint8_t nco, const uint8_t *imageRegs, uint8_t range)
+{
+	uint8_t numWrites = 0;
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x19, chBits << 4);
+	numWrites = txNcoImageAddPulse(addrList, dataList, numWrites, 0x130 + nco, imageRegs[0]);
+	numWrites = txNcoImageAddPulse(addrList, dataList, numWrites, 0x230 + nco, imageRegs[1]);
+	numWrites = txNcoImageAddPulse(addrList, dataList, numWrites, 0x773, imageRegs[2]); /*config_fmixer_update_pulse*/
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x19, 0x0);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x13, chBits);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x107, txNcoBandReg107[range]);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x106, 0x0);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x105, 0x0);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x104, 0x40);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x10a, imageRegs[3] & 0xf0);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x109, 0x0);
+	numWrites = txNcoImageAdd(addrList, dataList, numWrites, 0x108, txNcoBandReg108[range]);
+	return txNcoImageAdd(addrList, dataList, numWrites, 0x13, 0x0);
+}
+
+/*  Operands of the RX and FB channel frequency configuration macros. ncoSel is the NCO number, for RX plus 2 for band 1. Returns the number of operands.   */
+static uint8_t rxNcoOperands(uint8_t afeId, uint8_t chNo, uint8_t ncoSel, uint32_t mixerVal, uint8_t *byteList)
+{
+	uint8_t numOfOperands = 0;
+	if (systemParams[afeId].chipVersion <= 0x12)
+	{
+		byteList[numOfOperands++] = (1 << chNo);
+		byteList[numOfOperands++] = (1 << ncoSel);
+	}
+	else
+	{
+		byteList[numOfOperands++] = chNo;
+		byteList[numOfOperands++] = ncoSel;
+	}
+	splitToByte(mixerVal, 4, &byteList[numOfOperands]);
+	numOfOperands += 4;
+	byteList[numOfOperands++] = 3;
+	return numOfOperands;
+}
+
 /**
     @brief Set the TX NCO for single band.
     @details This function updates the TX NCO and should be used only single band of operation.
@@ -520,38 +662,71 @@ uint8_t updateTxNco(uint8_t afeId, uint8_t chNo, uint32_t mixer, uint8_t nco)
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x773, 0x0, 0x0, 0x0)); /*config_fmixer_update_pulse*/
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x19, 0x0, 0x0, 0x7));
 
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, chNo, 0x0, 0x7)); /*txdh*/
-	if (mixer <= 900000)
-	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x107, 0x10, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x106, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x105, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x104, 0x40, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x10a, 0x0, 0x0, 0x3));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x109, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x108, 0x1F, 0x0, 0x7));
-	}
-	else if (mixer < 2300000)
+	AFE_FUNC_EXEC(writeTxNcoBandRegs(afeId, chNo, txNcoBandRange(mixer)));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/**
+    @brief Set the TX NCO of several channels for single band.
+    @details Same as calling updateTxNco for each channel in txChList, but the MCU tunes all the channels with one system tune macro, and the NCO update pulses are given once for all the channels.<br>
+				Each channel still needs its own frequency configuration macro. The bits next to the pulses and band registers are read once from the first channel of txChList and written as full bytes with all the channels selected, as afeNcoHopTo does, so they must be configured alike on all the channels.
+				The band registers are written once per frequency range.
+    @param afeId AFE ID
+    @param txChList Bit Wise TX Channel Select.<br>
+				Bit0 for TXA<br>
+				Bit1 for TXB<br>
+				Bit2 for TXC<br>
+				Bit3 for TXD
+	@param mixer Array of AFE_NUM_TX_CHANNELS mixer frequencies indexed by the channel number, as in updateTxNco. Only the entries of the selected channels are used.
+	@param nco NCO number. 0-NCO0, 1-NCO1.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t updateTxNcoMulti(uint8_t afeId, uint8_t txChList, const uint32_t *mixer, uint8_t nco)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID((txChList != 0) && (txChList <= AFE_NUM_TX_CHANNELS_BITWISE));
+	AFE_PARAMS_VALID(mixer != NULL);
+	AFE_PARAMS_VALID(nco < 2);
+	uint32_t Fdac = (uint32_t)(systemParams[afeId].Fdac * 1000);
+	uint32_t mixerVal;
+	uint8_t firstCh = AFE_NUM_TX_CHANNELS;
+	uint8_t rangeChBits[3] = {0, 0, 0};
+	uint8_t imageRegs[4] = {0, 0, 0, 0};
+	uint16_t addrList[AFE_NCO_HOP_TX_WRITES];
+	uint8_t dataList[AFE_NCO_HOP_TX_WRITES];
+	uint8_t numWrites = AFE_NCO_HOP_TX_PULSE_WRITES;
+
+	for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
 	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x107, 0xf0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x106, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x105, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x104, 0x40, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x10a, 0x0, 0x0, 0x3));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x109, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x108, 0x00, 0x0, 0x7));
+		if (((txChList >> chNo) & 1) == 0)
+			continue;
+		if (firstCh == AFE_NUM_TX_CHANNELS)
+			firstCh = chNo;
+		systemParams[afeId].txNco[nco][chNo][0] = mixer[chNo] / (float)1000.0;
+		mixerVal = mixer[chNo] % Fdac;
+		AFE_FUNC_EXEC(updateSystemTxChannelFreqConfig(afeId, chNo, nco, mixerVal, 1, 1));
+		rangeChBits[txNcoBandRange(mixerVal)] |= 1 << chNo;
 	}
-	else
+	AFE_FUNC_EXEC(doSystemTuneSelective(afeId, 0, 0, txChList, 0x20));
+
+	/*  Nothing is read while several channels are selected, the read back of a broadcast page is not defined.   */
+	AFE_FUNC_EXEC(txNcoReadImageRegs(afeId, firstCh, nco, imageRegs));
+	afeNcoHopTable[afeId].txBandKnown &= (uint8_t)~txChList;
+	for (uint8_t range = 0; range < ARRAY_SIZE(rangeChBits); range++)
 	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x107, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x106, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x105, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x104, 0x40, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x10a, 0x0, 0x0, 0x3));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x109, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x108, 0x00, 0x0, 0x7));
+		if (rangeChBits[range] == 0)
+			continue;
+		/*  The pulses go with the band registers of the first range, the other ranges only need their band registers.   */
+		txNcoImage(addrList, dataList, txChList, nco, imageRegs, range);
+		addrList[AFE_NCO_HOP_TX_PULSE_WRITES] = 0x13;
+		dataList[AFE_NCO_HOP_TX_PULSE_WRITES] = rangeChBits[range]; /*txdh*/
+		AFE_FUNC_EXEC(afeSpiWriteBatchWrapper(afeId, &addrList[AFE_NCO_HOP_TX_PULSE_WRITES - numWrites], &dataList[AFE_NCO_HOP_TX_PULSE_WRITES - numWrites], AFE_NCO_HOP_TX_WRITES - AFE_NCO_HOP_TX_PULSE_WRITES + numWrites));
+		numWrites = 0;
 	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, 0x0, 0x0, 0x7));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -661,38 +836,7 @@ uint8_t updateTxNcoDb(uint8_t afeId, uint8_t chNo, uint8_t nco, uint32_t band0Nc
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x773, 0x1, 0x0, 0x0)); /*config_fmixer_update_pulse*/
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x773, 0x0, 0x0, 0x0)); /*config_fmixer_update_pulse*/
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x19, 0x0, 0x0, 0x7));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, chNo, 0x0, 0x7)); /*txdh*/
-	if (averageMixerFreq <= 900000)
-	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x107, 0x10, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x106, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x105, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x104, 0x40, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x10a, 0x0, 0x0, 0x3));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x109, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x108, 0x1F, 0x0, 0x7));
-	}
-	else if (averageMixerFreq < 2300000)
-	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x107, 0xf0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x106, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x105, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x104, 0x40, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x10a, 0x0, 0x0, 0x3));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x109, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x108, 0x00, 0x0, 0x7));
-	}
-	else
-	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x107, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x106, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x105, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x104, 0x40, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x10a, 0x0, 0x0, 0x3));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x109, 0x0, 0x0, 0x7));
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x108, 0x00, 0x0, 0x7));
-	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x13, 0x0, 0x0, 0x7));
+	AFE_FUNC_EXEC(writeTxNcoBandRegs(afeId, chNo, txNcoBandRange(averageMixerFreq)));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -789,7 +933,6 @@ uint8_t updateRxNco(uint8_t afeId, uint8_t chNo, uint32_t mixer, uint8_t band, u
 	uint32_t Fadc = (uint32_t)(systemParams[afeId].FadcRx * 1000);
 	uint8_t byteList[7];
 	uint8_t numOfOperands = 0;
-	uint8_t byteListRxNCO[4];
 
 	if (nco == 0)
 	{
@@ -802,29 +945,64 @@ uint8_t updateRxNco(uint8_t afeId, uint8_t chNo, uint32_t mixer, uint8_t band, u
 	mixer = mixer % Fadc;
 
 	mixerVal = (mixer & 0xffffffff);
-	if (systemParams[afeId].chipVersion <= 0x12)
-	{
-		byteList[numOfOperands] = (1 << chNo);
-		numOfOperands++;
-		byteList[numOfOperands] = (1 << (nco + (band << 1)));
-		numOfOperands++;
-	}
+	numOfOperands = rxNcoOperands(afeId, chNo, (nco + (band << 1)), mixerVal, byteList);
+	AFE_FUNC_EXEC(executeMacro(afeId, byteList, numOfOperands, AFE_MACRO_OPCODE_UPDATE_SYSTEM_RX_CHANNEL_FREQUENCY_CONFIGURATION)); //MacroConsts.MACRO_OPCODE_UPDATE_SYSTEM_RX_CHANNEL_FREQUENCY_CONFIGURATION);
+	if (errorStatus)
+		return RET_EXEC_FAIL;
 	else
+		return RET_OK;
+}
+
+/**
+    @brief Set the RX NCO of several channels.
+    @details Same as calling updateRxNco for each channel in rxChList. The frequency configuration macros of all the channels are submitted with macroSubmit before waiting for the first one, so the MCU starts each macro as soon as the previous one is done.
+    @param afeId AFE ID
+    @param rxChList Bit Wise RX Channel Select.<br>
+				Bit0 for RXA<br>
+				Bit1 for RXB<br>
+				Bit2 for RXC<br>
+				Bit3 for RXD
+	@param mixer Array of AFE_NUM_RX_CHANNELS mixer frequencies indexed by the channel number, as in updateRxNco. Only the entries of the selected channels are used.
+	@param band Band number. 0-band0, 1-band1.
+	@param nco NCO number. 0-NCO0, 1-NCO1.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t updateRxNcoMulti(uint8_t afeId, uint8_t rxChList, const uint32_t *mixer, uint8_t band, uint8_t nco)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID((rxChList != 0) && (rxChList <= AFE_NUM_RX_CHANNELS_BITWISE));
+	AFE_PARAMS_VALID(mixer != NULL);
+	AFE_PARAMS_VALID(band < AFE_NUM_BANDS_PER_RX);
+	AFE_PARAMS_VALID(nco < 2);
+	uint32_t Fadc = (uint32_t)(systemParams[afeId].FadcRx * 1000);
+	uint8_t byteList[7];
+	uint8_t numOfOperands = 0;
+	uint32_t handle[AFE_NUM_RX_CHANNELS];
+	uint8_t numSubmitted = 0;
+
+	for (uint8_t chNo = 0; chNo < AFE_NUM_RX_CHANNELS; chNo++)
 	{
-		byteList[numOfOperands] = (chNo);
-		numOfOperands++;
-		byteList[numOfOperands] = (nco + (band << 1));
-		numOfOperands++;
+		if (((rxChList >> chNo) & 1) == 0)
+			continue;
+		systemParams[afeId].rxNco[nco][chNo][band] = mixer[chNo] / (float)1000.0;
+		numOfOperands = rxNcoOperands(afeId, chNo, (nco + (band << 1)), mixer[chNo] % Fadc, byteList);
+		if (macroSubmit(afeId, byteList, numOfOperands, AFE_MACRO_OPCODE_UPDATE_SYSTEM_RX_CHANNEL_FREQUENCY_CONFIGURATION, &handle[numSubmitted]) != RET_OK)
+		{
+			errorStatus = 1;
+			break;
+		}
+		numSubmitted++;
 	}
-	AFE_FUNC_EXEC(splitToByte(mixerVal, 4, byteListRxNCO));
-	for (uint8_t i = 0; i < 4; i++)
+	/*  Every submitted handle is collected, also after a failure.   */
+	for (uint8_t i = 0; i < numSubmitted; i++)
 	{
-		byteList[numOfOperands] = byteListRxNCO[i];
-		numOfOperands++;
+		if (macroWait(afeId, handle[i], NULL) != RET_OK)
+		{
+			afeLogErr("AFE%d: RX NCO update macro %d failed.", afeId, i);
+			errorStatus = 1;
+		}
 	}
-	byteList[numOfOperands] = (3);
-	numOfOperands++;
-	AFE_FUNC_EXEC(executeMacro(afeId, byteList, numOfOperands, AFE_MACRO_OPCODE_UPDATE_SYSTEM_RX_CHANNEL_FREQUENCY_CONFIGURATION)); //MacroConsts.MACRO_OPCODE_UPDATE_SYSTEM_RX_CHANNEL_FREQUENCY_CONFIGURATION);
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -852,7 +1030,6 @@ uint8_t updateFbNco(uint8_t afeId, uint8_t chNo, uint32_t mixer, uint8_t nco)
 	uint32_t mixerVal = 3000;
 	uint32_t Fadc = (uint32_t)(systemParams[afeId].FadcFb * 1000);
 	uint8_t byteList[7];
-	uint8_t byteListFbNCO[4];
 	uint8_t numOfOperands = 0;
 
 	if (nco == 0)
@@ -875,29 +1052,7 @@ uint8_t updateFbNco(uint8_t afeId, uint8_t chNo, uint32_t mixer, uint8_t nco)
 	mixer = mixer % Fadc;
 
 	mixerVal = (mixer & 0xffffffff);
-	if (systemParams[afeId].chipVersion <= 0x12)
-	{
-		byteList[numOfOperands] = (1 << chNo);
-		numOfOperands++;
-		byteList[numOfOperands] = (1 << nco);
-		numOfOperands++;
-	}
-	else
-	{
-		byteList[numOfOperands] = (chNo);
-		numOfOperands++;
-		byteList[numOfOperands] = (nco);
-		numOfOperands++;
-	}
-
-	AFE_FUNC_EXEC(splitToByte(mixerVal, 4, byteListFbNCO));
-	for (uint8_t i = 0; i < 4; i++)
-	{
-		byteList[numOfOperands] = byteListFbNCO[i];
-		numOfOperands++;
-	}
-	byteList[numOfOperands] = (3);
-	numOfOperands++;
+	numOfOperands = rxNcoOperands(afeId, chNo, nco, mixerVal, byteList);
 	AFE_FUNC_EXEC(executeMacro(afeId, byteList, numOfOperands, AFE_MACRO_OPCODE_UPDATE_SYSTEM_FB_CHANNEL_FREQUENCY_CONFIGURATION)); //MacroConsts.MACRO_OPCODE_UPDATE_SYSTEM_FB_CHANNEL_FREQUENCY_CONFIGURATION);
 	if (errorStatus)
 		return RET_EXEC_FAIL;
@@ -1303,3 +1458,269 @@ uint8_t fbDsaPerTxEn(uint8_t afeId, uint8_t en)
 	else
 		return RET_OK;
 }
+
+/**
+    @brief Clears the NCO Hop Table
+    @details Removes all the frequencies from the NCO hop table of the AFE, forgets the TX band state set by the earlier hops and clears the hop latencies.
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeNcoHopTableClear(uint8_t afeId)
+{
+	AFE_ID_VALIDITY();
+	afeNcoHopTable[afeId].numEntries = 0;
+	afeNcoHopTable[afeId].txBandKnown = 0;
+	afeNcoHopTable[afeId].numHops = 0;
+	return RET_OK;
+}
+
+/**
+    @brief Adds TX Frequencies to the NCO Hop Table
+    @details Precomputes the hops of a TX channel NCO to each frequency of mixerList, so that afeNcoHopTo only has to run the macros and write a prepared batch.<br>
+				The bits next to the NCO update pulses and band registers that updateTxNco changes with read-modify-write are read once here, the TX channel must be configured before the table is built. Rebuild the table if these registers are changed by other functions.
+    @param afeId AFE ID
+    @param chNo Select the TX Channel<br>
+			0 for TXA<br>
+			1 for TXB<br>
+			2 for TXC<br>
+			3 for TXD
+	@param nco NCO number. 0-NCO0, 1-NCO1.
+	@param mixerList Mixer frequencies, in the same format as the mixer parameter of updateTxNco.
+	@param numFreqs Number of frequencies in mixerList.
+	@param firstIndex Pointer returning the hop index of mixerList[0]. The others follow in order.
+	@return Returns if the function execution passed or failed. Fails if the table doesn't have room for all the frequencies.
+*/
+uint8_t afeNcoHopTableAddTx(uint8_t afeId, uint8_t chNo, uint8_t nco, const uint32_t *mixerList, uint8_t numFreqs, uint8_t *firstIndex)
+{
+	uint8_t errorStatus = 0;
+	uint8_t chBits = 1 << chNo;
+	uint8_t imageRegs[4] = {0, 0, 0, 0};
+	uint32_t Fdac;
+	AfeNcoHopTable_t *table;
+
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(chNo < AFE_NUM_TX_CHANNELS);
+	AFE_PARAMS_VALID(nco < 2);
+	AFE_PARAMS_VALID((mixerList != NULL) && (firstIndex != NULL));
+	table = &afeNcoHopTable[afeId];
+	AFE_PARAMS_VALID((numFreqs != 0) && (numFreqs <= AFE_NCO_HOP_MAX_ENTRIES - table->numEntries));
+	Fdac = (uint32_t)(systemParams[afeId].Fdac * 1000);
+	AFE_PARAMS_VALID(Fdac != 0);
+
+	AFE_FUNC_EXEC(txNcoReadImageRegs(afeId, chNo, nco, imageRegs));
+
+	*firstIndex = table->numEntries;
+	for (uint8_t i = 0; i < numFreqs; i++)
+	{
+		AfeNcoHopEntry_t *entry = &table->entry[table->numEntries++];
+		uint32_t mixer = mixerList[i] % Fdac;
+
+		entry->path = AFE_NCO_HOP_TX;
+		entry->chNo = chNo;
+		entry->nco = nco;
+		entry->band = 0;
+		entry->mixer = mixerList[i];
+		entry->bandRange = txNcoBandRange(mixer);
+		/*  Operands of updateSystemTxChannelFreqConfig(afeId, chNo, nco, mixer, 1, 1) and doSystemTuneSelective(afeId, 0, 0, 1 << chNo, 0x20), as in updateTxNco.   */
+		entry->numOperands = 0;
+		entry->operands[entry->numOperands++] = chNo;
+		entry->operands[entry->numOperands++] = nco;
+		splitToByte(mixer, 4, &entry->operands[entry->numOperands]);
+		entry->numOperands += 4;
+		entry->operands[entry->numOperands++] = 1 | (1 << 1);
+		entry->tuneOperands[0] = 0;
+		entry->tuneOperands[1] = chBits;
+		entry->tuneOperands[2] = (0x3FFF ^ 0x20) & 0xff;
+		entry->tuneOperands[3] = (0x3FFF ^ 0x20) >> 8;
+
+		txNcoImage(entry->addrList, entry->dataList, chBits, nco, imageRegs, entry->bandRange);
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Adds RX Frequencies to the NCO Hop Table
+    @details Precomputes the macro operands of the hops of an RX channel NCO to each frequency of mixerList, as done by updateRxNco.
+    @param afeId AFE ID
+    @param chNo Select the RX Channel<br>
+			0 for RXA<br>
+			1 for RXB<br>
+			2 for RXC<br>
+			3 for RXD
+	@param band Band number. 0-band0, 1-band1.
+	@param nco NCO number. 0-NCO0, 1-NCO1.
+	@param mixerList Mixer frequencies, in the same format as the mixer parameter of updateRxNco.
+	@param numFreqs Number of frequencies in mixerList.
+	@param firstIndex Pointer returning the hop index of mixerList[0]. The others follow in order.
+	@return Returns if the function execution passed or failed. Fails if the table doesn't have room for all the frequencies.
+*/
+uint8_t afeNcoHopTableAddRx(uint8_t afeId, uint8_t chNo, uint8_t band, uint8_t nco, const uint32_t *mixerList, uint8_t numFreqs, uint8_t *firstIndex)
+{
+	uint32_t Fadc;
+	AfeNcoHopTable_t *table;
+
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(chNo < AFE_NUM_RX_CHANNELS);
+	AFE_PARAMS_VALID(band < AFE_NUM_BANDS_PER_RX);
+	AFE_PARAMS_VALID(nco < 2);
+	AFE_PARAMS_VALID((mixerList != NULL) && (firstIndex != NULL));
+	table = &afeNcoHopTable[afeId];
+	AFE_PARAMS_VALID((numFreqs != 0) && (numFreqs <= AFE_NCO_HOP_MAX_ENTRIES - table->numEntries));
+	Fadc = (uint32_t)(systemParams[afeId].FadcRx * 1000);
+	AFE_PARAMS_VALID(Fadc != 0);
+
+	*firstIndex = table->numEntries;
+	for (uint8_t i = 0; i < numFreqs; i++)
+	{
+		AfeNcoHopEntry_t *entry = &table->entry[table->numEntries++];
+		entry->path = AFE_NCO_HOP_RX;
+		entry->chNo = chNo;
+		entry->nco = nco;
+		entry->band = band;
+		entry->mixer = mixerList[i];
+		entry->numOperands = rxNcoOperands(afeId, chNo, (nco + (band << 1)), mixerList[i] % Fadc, entry->operands);
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Adds FB Frequencies to the NCO Hop Table
+    @details Precomputes the macro operands of the hops of an FB channel NCO to each frequency of mixerList, as done by updateFbNco.
+    @param afeId AFE ID
+    @param chNo Select the FB Channel<br>
+			0 for FBAB<br>
+			1 for FBCD
+	@param nco NCO number. 0-NCO0 to 3-NCO3.
+	@param mixerList Mixer frequencies, in the same format as the mixer parameter of updateFbNco.
+	@param numFreqs Number of frequencies in mixerList.
+	@param firstIndex Pointer returning the hop index of mixerList[0]. The others follow in order.
+	@return Returns if the function execution passed or failed. Fails if the table doesn't have room for all the frequencies.
+*/
+uint8_t afeNcoHopTableAddFb(uint8_t afeId, uint8_t chNo, uint8_t nco, const uint32_t *mixerList, uint8_t numFreqs, uint8_t *firstIndex)
+{
+	uint32_t Fadc;
+	AfeNcoHopTable_t *table;
+
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(chNo < AFE_NUM_FB_CHANNELS);
+	AFE_PARAMS_VALID(nco < 4);
+	AFE_PARAMS_VALID((mixerList != NULL) && (firstIndex != NULL));
+	table = &afeNcoHopTable[afeId];
+	AFE_PARAMS_VALID((numFreqs != 0) && (numFreqs <= AFE_NCO_HOP_MAX_ENTRIES - table->numEntries));
+	Fadc = (uint32_t)(systemParams[afeId].FadcFb * 1000);
+	AFE_PARAMS_VALID(Fadc != 0);
+
+	*firstIndex = table->numEntries;
+	for (uint8_t i = 0; i < numFreqs; i++)
+	{
+		AfeNcoHopEntry_t *entry = &table->entry[table->numEntries++];
+		entry->path = AFE_NCO_HOP_FB;
+		entry->chNo = chNo;
+		entry->nco = nco;
+		entry->band = 0;
+		entry->mixer = mixerList[i];
+		entry->numOperands = rxNcoOperands(afeId, chNo, nco, mixerList[i] % Fadc, entry->operands);
+	}
+	return RET_OK;
+}
+
+static uint8_t ncoHopRun(uint8_t afeId, AfeNcoHopEntry_t *entry)
+{
+	uint8_t errorStatus = 0;
+	AfeNcoHopTable_t *table = &afeNcoHopTable[afeId];
+	uint8_t chBit = 1 << entry->chNo;
+	uint8_t numWrites = AFE_NCO_HOP_TX_WRITES;
+
+	if (entry->path == AFE_NCO_HOP_RX)
+	{
+		AFE_FUNC_EXEC(executeMacro(afeId, entry->operands, entry->numOperands, AFE_MACRO_OPCODE_UPDATE_SYSTEM_RX_CHANNEL_FREQUENCY_CONFIGURATION));
+		systemParams[afeId].rxNco[entry->nco][entry->chNo][entry->band] = entry->mixer / (float)1000.0;
+		return RET_OK;
+	}
+	if (entry->path == AFE_NCO_HOP_FB)
+	{
+		AFE_FUNC_EXEC(executeMacro(afeId, entry->operands, entry->numOperands, AFE_MACRO_OPCODE_UPDATE_SYSTEM_FB_CHANNEL_FREQUENCY_CONFIGURATION));
+		systemParams[afeId].fbNco[entry->nco][entry->chNo] = entry->mixer / (float)1000.0;
+		return RET_OK;
+	}
+	AFE_FUNC_EXEC(executeMacro(afeId, entry->operands, entry->numOperands, AFE_MACRO_OPCODE_UPDATE_SYSTEM_TX_CHANNEL_FREQUENCY_CONFIGURATION));
+	AFE_FUNC_EXEC(executeMacro(afeId, entry->tuneOperands, ARRAY_SIZE(entry->tuneOperands), AFE_MACRO_OPCODE_SYSTEM_TUNE_SELECTIVE));
+	systemParams[afeId].txNco[entry->nco][entry->chNo][0] = entry->mixer / (float)1000.0;
+	/*  The band registers only change between frequency ranges.   */
+	if ((table->txBandKnown & chBit) && (table->txBandRange[entry->chNo] == entry->bandRange))
+		numWrites = AFE_NCO_HOP_TX_PULSE_WRITES;
+	table->txBandKnown &= (uint8_t)~chBit;
+	AFE_FUNC_EXEC(afeSpiWriteBatchWrapper(afeId, entry->addrList, entry->dataList, numWrites));
+	table->txBandRange[entry->chNo] = entry->bandRange;
+	table->txBandKnown |= chBit;
+	return RET_OK;
+}
+
+/**
+    @brief Hops to a Frequency of the NCO Hop Table
+    @details Moves the NCO of the table entry to its frequency. Gives the same result as updateTxNco, updateRxNco or updateFbNco, with the operands and register values prepared when the table was built. For TX, the update pulses are written as one batch without reads, and the band registers are left out when the previous hop of the channel was in the same frequency range.<br>
+				The time of each hop is kept for afeNcoHopGetLatency.
+    @param afeId AFE ID
+    @param index Hop index returned by afeNcoHopTableAddTx, afeNcoHopTableAddRx or afeNcoHopTableAddFb.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeNcoHopTo(uint8_t afeId, uint8_t index)
+{
+	uint8_t errorStatus = 0;
+	AfeNcoHopTable_t *table;
+	uint64_t startUs = getTimeUs();
+
+	AFE_ID_VALIDITY();
+	table = &afeNcoHopTable[afeId];
+	AFE_PARAMS_VALID(index < table->numEntries);
+	AFE_FUNC_EXEC(ncoHopRun(afeId, &table->entry[index]));
+	table->latencyUs[table->numHops % AFE_NCO_HOP_LATENCY_SAMPLES] = (uint32_t)(getTimeUs() - startUs);
+	table->numHops++;
+	return RET_OK;
+}
+
+/**
+    @brief NCO Hop Latency
+    @details Returns percentiles of the time taken by the last AFE_NCO_HOP_LATENCY_SAMPLES successful afeNcoHopTo calls. The times come from getTimeUs.
+    @param afeId AFE ID
+    @param numHops Pointer returning the number of hops since the table was cleared.
+    @param p50Us Pointer returning the median hop time in micro seconds.
+    @param p90Us Pointer returning the 90th percentile hop time in micro seconds.
+    @param p99Us Pointer returning the 99th percentile hop time in micro seconds.
+    @param maxUs Pointer returning the longest hop time in micro seconds.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeNcoHopGetLatency(uint8_t afeId, uint32_t *numHops, uint32_t *p50Us, uint32_t *p90Us, uint32_t *p99Us, uint32_t *maxUs)
+{
+	uint32_t sorted[AFE_NCO_HOP_LATENCY_SAMPLES];
+	uint32_t numSamples;
+	AfeNcoHopTable_t *table;
+
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID((numHops != NULL) && (p50Us != NULL) && (p90Us != NULL) && (p99Us != NULL) && (maxUs != NULL));
+	table = &afeNcoHopTable[afeId];
+	numSamples = (table->numHops < AFE_NCO_HOP_LATENCY_SAMPLES) ? table->numHops : AFE_NCO_HOP_LATENCY_SAMPLES;
+	*numHops = table->numHops;
+	*p50Us = 0;
+	*p90Us = 0;
+	*p99Us = 0;
+	*maxUs = 0;
+	if (numSamples == 0)
+		return RET_OK;
+	for (uint32_t i = 0; i < numSamples; i++)
+	{
+		uint32_t value = table->latencyUs[i];
+		uint32_t j = i;
+		for (; (j > 0) && (sorted[j - 1] > value); j--)
+		{
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = value;
+	}
+	/*  Nearest rank percentiles.   */
+	*p50Us = sorted[(50 * numSamples + 99) / 100 - 1];
+	*p90Us = sorted[(90 * numSamples + 99) / 100 - 1];
+	*p99Us = sorted[(99 * numSamples + 99) / 100 - 1];
+	*maxUs = sorted[numSamples - 1];
+	return RET_OK;
+}
@@ -8,6 +8,8 @@
 */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "afe79xxLog.h"
 #include "afe79xxTypes.h"
@@ -19,9 +21,40 @@
 
 #include "hMacro.h"
 
+/*  Up to 255 operands padded to a multiple of 4.   */
+#define AFE_MACRO_OPERAND_BLOCK_MAX (UINT8_MAX + 1)
+
+/*  Builds the operand block: the operands padded with zeros to a multiple of 4. Returns the size of the block.   */
+static uint16_t stageOperandList(uint8_t *operandList, uint8_t numOfOperands, uint8_t *operandBlock)
+{
+	uint16_t operandNo = 0;
+	for (; operandNo < numOfOperands; operandNo++)
+	{
+		operandBlock[operandNo] = operandList[operandNo] & 0xff;
+	}
+	while (operandNo % 4 != 0)
+	{
+		operandBlock[operandNo++] = 0;
+	}
+	return operandNo;
+}
+
+/*  Writes an operand block to the consecutive operand registers with afeSpiBurstWriteWrapper, between the macro page select and close.   */
+static uint8_t writeOperandBlock(uint8_t afeId, uint8_t *operandBlock, uint16_t blockSize)
+{
+	uint8_t errorStatus = 0;
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
+	if (blockSize != 0)
+	{
+		AFE_FUNC_EXEC(afeSpiBurstWriteWrapper(afeId, AFE_MACRO_OPERAND_START_REG_ADDR, operandBlock, blockSize));
+	}
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
+	return RET_OK;
+}
+
 /**
     @brief Write the Macro Operands.
-    @details Write the Macro Operands.
+    @details Write the Macro Operands. The operands and their padding to a multiple of 4 are written in one SPI burst, or in one batch until the bursts are enabled (afeSpiBurstEnable).
     @param afeId AFE ID
 	@param operandList Byte-wise array of operands to be written.
 	@param numOfOperands Size of operandList.
@@ -31,22 +64,9 @@ uint8_t writeOperandList(uint8_t afeId, uint8_t *operandList, uint8_t numOfOpera
 {
 	AFE_ID_VALIDITY();
 	uint8_t errorStatus = 0;
-	uint8_t operandNo = 0;
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
-	/*macro*/
-	for (; operandNo < numOfOperands; operandNo++)
-	{
-		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_OPERAND_START_REG_ADDR + operandNo, operandList[operandNo] & 0xff, 0x0, 0x7));
-		/*MACRO_OPERAND_REG0*/
-	}
-	if (operandNo % 4 != 0)
-	{
-		for (uint8_t i = 0; i < 4 - (operandNo % 4); i++)
-		{
-			AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_OPERAND_START_REG_ADDR + operandNo + i, 0, 0x0, 0x7));
-		}
-	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
+	uint8_t operandBlock[AFE_MACRO_OPERAND_BLOCK_MAX];
+	uint16_t blockSize = stageOperandList(operandList, numOfOperands, operandBlock);
+	AFE_FUNC_EXEC(writeOperandBlock(afeId, operandBlock, blockSize));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -74,7 +94,7 @@ uint8_t splitToByte(uint64_t val, uint8_t numBytes, uint8_t *splitByteList)
 
 /**
     @brief Read Macro Result Register
-    @details Read Macro Result Register
+    @details Read Macro Result Register. The 4 bytes of the register are read LSB first, in one SPI burst once enabled (afeSpiBurstEnable).
     @param afeId AFE ID
 	@param regNum Result register number.
 	@param result Returns result register as a pointer.
@@ -83,14 +103,15 @@ uint8_t splitToByte(uint64_t val, uint8_t numBytes, uint8_t *splitByteList)
 uint8_t readResultRegSpi(uint8_t afeId, uint8_t regNum, uint32_t *result)
 {
 	uint8_t errorStatus = 0;
-	uint8_t readValue;
+	uint8_t readValue[4];
 	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(result != NULL);
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
-	/*macro*/
+	AFE_FUNC_EXEC(afeSpiBurstReadWrapper(afeId, AFE_MACRO_RESULT_START_REG_ADDR + (regNum * 4), readValue, 4));
+	*result = 0;
 	for (uint8_t i = 0; i < 4; i++)
 	{
-		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, (AFE_MACRO_RESULT_START_REG_ADDR + i + (regNum * 4)) << (i << 3), 0, 7, &readValue));
-		*result = *result + readValue;
+		*result = *result | ((uint32_t)readValue[i] << (i << 3));
 	}
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
 
@@ -100,77 +121,267 @@ uint8_t readResultRegSpi(uint8_t afeId, uint8_t regNum, uint32_t *result)
 		return RET_OK;
 }
 
+/*  Writes pattern to the operand registers with a burst and reads them back with a burst.   */
+static uint8_t operandBurstRoundTrip(uint8_t afeId, uint8_t *pattern, uint8_t *readBack, uint8_t numBytes)
+{
+	uint8_t errorStatus = 0;
+	AFE_FUNC_EXEC(writeOperandBlock(afeId, pattern, numBytes));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
+	AFE_FUNC_EXEC(afeSpiBurstReadWrapper(afeId, AFE_MACRO_OPERAND_START_REG_ADDR, readBack, numBytes));
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
+	return RET_OK;
+}
+
 /**
-    @brief Poll for Macro Ready
-    @details Polls for Macro Ready
+    @brief Checks the Operand Block SPI Bursts
+    @details Writes a test pattern to the first numBytes macro operand registers and reads it back, once register by register and once with the SPI bursts used by writeOperandList, and compares the SPI transaction counts of the two. Use it to check a dev_spi_write_burst and dev_spi_read_burst integration: it fails if either read back differs from what was written.<br>
+			The bursts need the AFE to step the address after every data byte. They are enabled with afeSpiBurstEnable if the burst read back matches and disabled otherwise, so the burst wrappers fall back to one frame per register.<br>
+			No macro may be running on the AFE. The operand registers are left with the pattern.
     @param afeId AFE ID
-	@return Returns if the function execution passed or failed. It returns as failed even if the Macro_Ready doesn't become 1.
+    @param numBytes Number of operand registers to use. Supported values: 0<numBytes<=80
+    @param singleTransactions Pointer returning the SPI transactions of the register by register write and read back.
+    @param burstTransactions Pointer returning the SPI transactions of the burst write and read back.
+	@return Returns if the function execution passed or failed.
 */
-uint8_t waitForMacroReady(uint8_t afeId)
+uint8_t afeMacroOperandBurstCheck(uint8_t afeId, uint8_t numBytes, uint32_t *singleTransactions, uint32_t *burstTransactions)
 {
 	uint8_t errorStatus = 0;
-	uint8_t count = 0;
-	uint8_t readValue;
-	/*  Wait for Macro Ready.   */
+	uint8_t pattern[AFE_MACRO_STATUS_REG_ADDR - AFE_MACRO_OPERAND_START_REG_ADDR];
+	uint8_t readBack[AFE_MACRO_STATUS_REG_ADDR - AFE_MACRO_OPERAND_START_REG_ADDR];
+	uint16_t addrList[AFE_MACRO_STATUS_REG_ADDR - AFE_MACRO_OPERAND_START_REG_ADDR];
+	uint8_t singleMismatches = 0;
+	uint8_t burstMismatches = 0;
+	uint8_t burstResult;
+
 	AFE_ID_VALIDITY();
-	count = 0;
+	AFE_PARAMS_VALID((numBytes != 0) && (numBytes <= ARRAY_SIZE(pattern)));
+	AFE_PARAMS_VALID((singleTransactions != NULL) && (burstTransactions != NULL));
+	for (uint8_t i = 0; i < numBytes; i++)
+	{
+		pattern[i] = (uint8_t)(0x5A ^ (i * 0x25));
+		addrList[i] = AFE_MACRO_OPERAND_START_REG_ADDR + i;
+	}
+
+	AFE_FUNC_EXEC(afeSpiGetTransactionCount(afeId, singleTransactions, 1));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
-	/*macro*/
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
-	while (((readValue & 1) == 0) && (count <= 200))
+	AFE_FUNC_EXEC(afeSpiWriteBatchWrapper(afeId, addrList, pattern, numBytes));
+	for (uint8_t i = 0; i < numBytes; i++)
 	{
-		count++;
-		AFE_FUNC_EXEC(waitMs(1));
-		if (count > 200)
-		{
-			AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
-			/*macro*/
-			return RET_EXEC_FAIL;
-		}
-		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
+		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, addrList[i], 0, 7, &readBack[i]));
+		singleMismatches += (readBack[i] != pattern[i]);
 	}
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
-	/*macro*/
-	if (errorStatus)
+	AFE_FUNC_EXEC(afeSpiGetTransactionCount(afeId, singleTransactions, 1));
+
+	for (uint8_t i = 0; i < numBytes; i++)
+	{
+		pattern[i] = (uint8_t)~pattern[i];
+	}
+	AFE_FUNC_EXEC(afeSpiBurstEnable(afeId, 1));
+	burstResult = operandBurstRoundTrip(afeId, pattern, readBack, numBytes);
+	for (uint8_t i = 0; (burstResult == RET_OK) && (i < numBytes); i++)
+	{
+		burstMismatches += (readBack[i] != pattern[i]);
+	}
+	AFE_FUNC_EXEC(afeSpiBurstEnable(afeId, (burstResult == RET_OK) && (singleMismatches == 0) && (burstMismatches == 0)));
+	AFE_FUNC_EXEC(burstResult);
+	AFE_FUNC_EXEC(afeSpiGetTransactionCount(afeId, burstTransactions, 1));
+
+	afeLogInfo("AFE%d: %d operand bytes written and read back in %d SPI transactions register by register, %d with bursts.", afeId, numBytes, *singleTransactions, *burstTransactions);
+	if ((singleMismatches != 0) || (burstMismatches != 0))
+	{
+		afeLogErr("AFE%d: %d operand bytes read back register by register and %d read back with bursts differ from the ones written. The SPI bursts stay disabled.", afeId, singleMismatches, burstMismatches);
 		return RET_EXEC_FAIL;
-	else
-		return RET_OK;
+	}
+	return RET_OK;
 }
 
-/**
-    @brief Poll for Macro Done
-    @details Polls for Macro Done
-    @param afeId AFE ID
-	@return Returns if the function execution passed or failed. It returns as failed even if the Macro_Done doesn't become 1.
-*/
-uint8_t waitForMacroDone(uint8_t afeId)
+/*  Macro status register bits.   */
+#define AFE_MACRO_STATUS_READY 0x1
+#define AFE_MACRO_STATUS_ACK 0x2
+#define AFE_MACRO_STATUS_DONE 0x4
+/*  Time a macro phase may take before it is reported as failed.   */
+#define AFE_MACRO_WAIT_TIMEOUT_MS 200
+/*  Polls of macroPoll that may find a macro running before it is reported as failed, used while getTimeUs doesn't advance.   */
+#define AFE_MACRO_POLL_TIMEOUT_POLLS 200
+/*  Back-to-back status reads before AFE_MACRO_WAIT_BACKOFF starts to wait, and the longest wait between reads.   */
+#define AFE_MACRO_BACKOFF_SPIN_READS 8
+#define AFE_MACRO_BACKOFF_MAX_MS 8
+
+/*  Latency of one opcode, from the trigger to Macro_Done.   */
+typedef struct AFE_MACRO_LATENCY
+{
+	uint8_t opcode;
+	uint32_t count;
+	uint32_t maxUs;
+	uint64_t totalUs;
+	uint32_t bins[AFE_MACRO_LATENCY_BINS];
+} AfeMacroLatency_t;
+
+typedef struct AFE_MACRO_ENGINE
+{
+	uint8_t waitMode;
+	uint8_t opcode;
+	uint64_t triggerTimeUs;
+	uint32_t polls;
+	uint8_t numOpcodes;
+	AfeMacroLatency_t latency[AFE_MACRO_LATENCY_MAX_OPCODES];
+} AfeMacroEngine_t;
+
+static AfeMacroEngine_t afeMacroEngine[NUM_OF_AFE];
+/*  Expected run time of each opcode in milli seconds, for AFE_MACRO_WAIT_HINT.   */
+static uint16_t afeMacroDurationHintMs[256];
+
+static void macroLatencyRecord(uint8_t afeId, uint8_t opcode, uint64_t latencyUs)
+{
+	AfeMacroEngine_t *engine = &afeMacroEngine[afeId];
+	AfeMacroLatency_t *entry = NULL;
+	uint8_t bin = 0;
+
+	for (uint8_t i = 0; i < engine->numOpcodes; i++)
+	{
+		if (engine->latency[i].opcode == opcode)
+			entry = &engine->latency[i];
+	}
+	if (entry == NULL)
+	{
+		if (engine->numOpcodes >= AFE_MACRO_LATENCY_MAX_OPCODES)
+			return;
+		entry = &engine->latency[engine->numOpcodes++];
+		entry->opcode = opcode;
+	}
+	while ((bin < AFE_MACRO_LATENCY_BINS - 1) && ((latencyUs >> (bin + 1)) != 0))
+		bin++;
+	entry->bins[bin]++;
+	entry->count++;
+	entry->totalUs += latencyUs;
+	if (latencyUs > entry->maxUs)
+		entry->maxUs = (uint32_t)latencyUs;
+}
+
+/*  Book-keeping once Macro_Done is seen.   */
+static uint8_t macroDoneUpdate(uint8_t afeId)
+{
+	macroLatencyRecord(afeId, afeMacroEngine[afeId].opcode, getTimeUs() - afeMacroEngine[afeId].triggerTimeUs);
+	/*  Drop what was cached while the macro was still running.   */
+	return afeShadowCacheInvalidate(afeId);
+}
+
+/*  Time a macro phase has been waited for: the sum of the sleeps, or the time since startUs if that is longer, so the back-to-back reads count too.   */
+static uint32_t macroWaitedMs(uint64_t startUs, uint32_t sleptMs)
+{
+	uint64_t elapsedMs = (getTimeUs() - startUs) / 1000;
+	return (elapsedMs > sleptMs) ? (uint32_t)elapsedMs : sleptMs;
+}
+
+/*  Waits until one of the statusMask bits of the macro status register is set. The page is opened once for the whole wait.
+	How the time between the status reads is spent depends on the wait mode of the AFE, see afeMacroSetWaitMode. The timeout is kept on the
+	milli seconds slept and waited for the alarm pin, so it holds when getTimeUs doesn't advance.   */
+static uint8_t waitForMacroStatus(uint8_t afeId, uint8_t statusMask)
 {
 	uint8_t errorStatus = 0;
-	uint8_t count = 0;
-	uint8_t readValue;
-	AFE_ID_VALIDITY();
+	uint8_t readValue = 0;
+	uint8_t waitMode = afeMacroEngine[afeId].waitMode;
+	uint8_t eventTried = 0;
+	uint8_t pinTimedOut = 0;
+	uint8_t pinResult;
+	uint64_t startUs = getTimeUs();
+	uint64_t pinStartUs;
+	uint32_t timeoutMs = AFE_MACRO_WAIT_TIMEOUT_MS;
+	uint32_t waitedMs = 0;
+	uint32_t stepMs = 0;
+	uint32_t spinReads = 0;
+	uint32_t backoffWaits = 0;
+
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
 	/*macro*/
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
-	while (((readValue & 4) == 0) && (count <= 200))
+	if (((readValue & statusMask) == 0) && (waitMode == AFE_MACRO_WAIT_HINT) && (statusMask == AFE_MACRO_STATUS_DONE))
+	{
+		/*  Sleep for what is left of the expected run time, then poll as AFE_MACRO_WAIT_BACKOFF. The timeout starts after the sleep.   */
+		uint32_t hintMs = afeMacroDurationHintMs[afeMacroEngine[afeId].opcode];
+		uint32_t sinceTriggerMs = macroWaitedMs(afeMacroEngine[afeId].triggerTimeUs, 0);
+		if (hintMs > sinceTriggerMs)
+		{
+			AFE_FUNC_EXEC(waitMs(hintMs - sinceTriggerMs));
+			waitedMs += hintMs - sinceTriggerMs;
+			timeoutMs += hintMs - sinceTriggerMs;
+			AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
+		}
+	}
+	while ((readValue & statusMask) == 0)
 	{
-		count++;
-		AFE_FUNC_EXEC(waitMs(1));
-		if (count > 200)
+		if (pinTimedOut || (macroWaitedMs(startUs, waitedMs) > timeoutMs))
 		{
 			AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
 			/*macro*/
 			return RET_EXEC_FAIL;
 		}
+		if ((waitMode == AFE_MACRO_WAIT_EVENT) && !eventTried)
+		{
+			/*  The pin wait gets what is left of the timeout. After a pin timeout the status is read once more. Hosts that can't watch the alarm pin
+				return AFE_ALARM_PIN_UNSUPPORTED at once and the status is polled instead.   */
+			eventTried = 1;
+			pinStartUs = getTimeUs();
+			pinResult = waitForAfeAlarmPin(afeId, timeoutMs - macroWaitedMs(startUs, waitedMs));
+			if (pinResult == AFE_ALARM_PIN_UNSUPPORTED)
+				afeLogDbg("AFE%d: no alarm pin event, polling the macro status", afeId);
+			else if (pinResult != RET_OK)
+				pinTimedOut = 1;
+			else
+				waitedMs += macroWaitedMs(pinStartUs, 0);
+		}
+		else if (waitMode == AFE_MACRO_WAIT_FIXED_POLL)
+			stepMs = 1;
+		else if (spinReads < AFE_MACRO_BACKOFF_SPIN_READS)
+			spinReads++;
+		else
+		{
+			/*  1, 1, 2, 2, 4, 4 ms and so on, so a wait never overshoots the run time by much.   */
+			stepMs = 1UL << (backoffWaits / 2);
+			if (stepMs > AFE_MACRO_BACKOFF_MAX_MS)
+				stepMs = AFE_MACRO_BACKOFF_MAX_MS;
+			backoffWaits++;
+		}
+		if (stepMs != 0)
+		{
+			AFE_FUNC_EXEC(waitMs(stepMs));
+			waitedMs += stepMs;
+		}
 		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
 	}
+	if (statusMask == AFE_MACRO_STATUS_DONE)
+	{
+		AFE_FUNC_EXEC(macroDoneUpdate(afeId));
+	}
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
 	/*macro*/
+	return RET_OK;
+}
 
-	if (errorStatus)
-		return RET_EXEC_FAIL;
-	else
-		return RET_OK;
+/**
+    @brief Poll for Macro Ready
+    @details Polls for Macro Ready
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed. It returns as failed even if the Macro_Ready doesn't become 1.
+*/
+uint8_t waitForMacroReady(uint8_t afeId)
+{
+	AFE_ID_VALIDITY();
+	/*  Wait for Macro Ready.   */
+	return waitForMacroStatus(afeId, AFE_MACRO_STATUS_READY);
+}
+
+/**
+    @brief Poll for Macro Done
+    @details Polls for Macro Done. The time from triggerMacro to Macro_Done is added to the latency statistics of the opcode.
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed. It returns as failed even if the Macro_Done doesn't become 1.
+*/
+uint8_t waitForMacroDone(uint8_t afeId)
+{
+	AFE_ID_VALIDITY();
+	return waitForMacroStatus(afeId, AFE_MACRO_STATUS_DONE);
 }
 
 /**
@@ -181,47 +392,136 @@ uint8_t waitForMacroDone(uint8_t afeId)
 */
 uint8_t waitForMacroAck(uint8_t afeId)
 {
-	uint8_t errorStatus = 0;
-	uint8_t count = 0;
-	uint8_t readValue = 0;
 	AFE_ID_VALIDITY();
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
-	/*macro*/
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
-	while (((readValue & 2) == 0) && (count <= 200))
+	return waitForMacroStatus(afeId, AFE_MACRO_STATUS_ACK);
+}
+
+/**
+    @brief Sets how the Macro Completion is waited for
+    @details Selects what waitForMacroReady, waitForMacroDone and waitForMacroAck do between the reads of the macro status register. All modes time out after about 200 ms of waiting.<br>
+			AFE_MACRO_WAIT_FIXED_POLL	0	:	Waits 1 ms between the reads. This is the default.<br>
+			AFE_MACRO_WAIT_BACKOFF		1	:	Reads back to back first, then waits 1, 1, 2, 2, 4, 4 ms and so on, up to 8 ms. Fast macros finish in well under 1 ms.<br>
+			AFE_MACRO_WAIT_EVENT		2	:	Waits for the AFE alarm pin through waitForAfeAlarmPin in baseFunc.c, then reads the status. The pin wait counts towards the 200 ms. Falls back to AFE_MACRO_WAIT_BACKOFF if the host can't watch the pin.<br>
+			AFE_MACRO_WAIT_HINT			3	:	Sleeps for the expected run time of the opcode set with afeMacroSetDurationHint before polling for Macro_Done, otherwise as AFE_MACRO_WAIT_BACKOFF. The 200 ms start after the sleep.
+    @param afeId AFE ID
+    @param waitMode Wait mode, one of the values above.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeMacroSetWaitMode(uint8_t afeId, uint8_t waitMode)
+{
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(waitMode <= AFE_MACRO_WAIT_HINT);
+	afeMacroEngine[afeId].waitMode = waitMode;
+	return RET_OK;
+}
+
+/**
+    @brief Sets the Expected Run Time of a Macro
+    @details Sets how long the macro of an opcode is expected to run, measured from triggerMacro. Used in the AFE_MACRO_WAIT_HINT mode. The hints are the same for all AFEs. Take them from the latency statistics, see afeMacroLogLatencyStats.
+    @param opcode Opcode of the Macro.
+    @param durationMs Expected run time in milli seconds. 0 removes the hint.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeMacroSetDurationHint(uint8_t opcode, uint16_t durationMs)
+{
+	afeMacroDurationHintMs[opcode] = durationMs;
+	return RET_OK;
+}
+
+/**
+    @brief Macro Latency Statistics
+    @details Returns the latency statistics of one opcode. The latency is the time from triggerMacro to Macro_Done, measured with getTimeUs.
+    @param afeId AFE ID
+    @param opcode Opcode of the Macro.
+    @param count Pointer returning the number of completed macros.
+    @param totalUs Pointer returning the sum of their latencies in micro seconds.
+    @param maxUs Pointer returning the longest latency in micro seconds.
+    @param bins Array of AFE_MACRO_LATENCY_BINS returning the histogram. Bin n counts the latencies from 2^n to 2^(n+1) micro seconds. Can be NULL.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeMacroGetLatencyStats(uint8_t afeId, uint8_t opcode, uint32_t *count, uint64_t *totalUs, uint32_t *maxUs, uint32_t *bins)
+{
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID((count != NULL) && (totalUs != NULL) && (maxUs != NULL));
+	*count = 0;
+	*totalUs = 0;
+	*maxUs = 0;
+	if (bins != NULL)
+		memset(bins, 0, AFE_MACRO_LATENCY_BINS * sizeof(uint32_t));
+	for (uint8_t i = 0; i < afeMacroEngine[afeId].numOpcodes; i++)
+	{
+		AfeMacroLatency_t *entry = &afeMacroEngine[afeId].latency[i];
+		if (entry->opcode != opcode)
+			continue;
+		*count = entry->count;
+		*totalUs = entry->totalUs;
+		*maxUs = entry->maxUs;
+		if (bins != NULL)
+			memcpy(bins, entry->bins, sizeof(entry->bins));
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Logs the Macro Latency Statistics
+    @details Logs the latency of every opcode run on the AFE at info level, the opcode with the largest total time first.
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeMacroLogLatencyStats(uint8_t afeId)
+{
+	AfeMacroEngine_t *engine;
+	uint8_t logged[AFE_MACRO_LATENCY_MAX_OPCODES] = {0};
+	/*  Longest bin is " 524288us:4294967295", 1 + 6 + 3 + 10 characters.   */
+	char binStr[AFE_MACRO_LATENCY_BINS * (1 + 6 + 3 + 10) + 1];
+
+	AFE_ID_VALIDITY();
+	engine = &afeMacroEngine[afeId];
+	for (uint8_t n = 0; n < engine->numOpcodes; n++)
 	{
-		count++;
-		AFE_FUNC_EXEC(waitMs(1));
-		if (count > 200)
+		AfeMacroLatency_t *entry = NULL;
+		uint8_t index = 0;
+		uint16_t len = 0;
+		for (uint8_t i = 0; i < engine->numOpcodes; i++)
 		{
-			AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
-			/*macro*/
-			return RET_EXEC_FAIL;
+			if (!logged[i] && ((entry == NULL) || (engine->latency[i].totalUs > entry->totalUs)))
+			{
+				entry = &engine->latency[i];
+				index = i;
+			}
 		}
-		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
+		logged[index] = 1;
+		binStr[0] = '\0';
+		for (uint8_t bin = 0; (bin < AFE_MACRO_LATENCY_BINS) && (len < sizeof(binStr)); bin++)
+		{
+			if (entry->bins[bin] != 0)
+				len += (uint16_t)snprintf(binStr + len, sizeof(binStr) - len, " %luus:%lu", 1UL << bin, (unsigned long)entry->bins[bin]);
+		}
+		afeLogInfo("AFE%d macro 0x%02X: %lu runs, total %lu us, average %lu us, max %lu us, histogram%s", afeId, entry->opcode, (unsigned long)entry->count, (unsigned long)entry->totalUs, (unsigned long)(entry->totalUs / entry->count), (unsigned long)entry->maxUs, binStr);
 	}
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
-	/*macro*/
-
-	if (errorStatus)
-		return RET_EXEC_FAIL;
-	else
-		return RET_OK;
+	return RET_OK;
 }
 
 /**
-    @brief Checks if there is a Macro Error
-    @details Checks if there is a Macro Error and returns the error status as pointer.
+    @brief Clears the Macro Latency Statistics
+    @details Clears the latency statistics of all opcodes of the AFE.
     @param afeId AFE ID
-    @param macroErrorStatus Macro Error Status return as pointer.
 	@return Returns if the function execution passed or failed.
 */
-uint8_t checkForMacroError(uint8_t afeId, uint8_t *macroErrorStatus)
+uint8_t afeMacroClearLatencyStats(uint8_t afeId)
+{
+	AFE_ID_VALIDITY();
+	memset(afeMacroEngine[afeId].latency, 0, sizeof(afeMacroEngine[afeId].latency));
+	afeMacroEngine[afeId].numOpcodes = 0;
+	return RET_OK;
+}
+
+/*  Reads and logs the macro error status. macroErrorFlags returns the AFE_MACRO_ERROR_* bits, macroErrorStatus only if there was an error.   */
+static uint8_t readMacroError(uint8_t afeId, uint8_t *macroErrorStatus, uint8_t *macroErrorFlags)
 {
 	uint8_t errorStatus = 0;
 	uint8_t errorReadReg = 0;
 	uint8_t errorExtendedCodeReg = 0;
-	AFE_ID_VALIDITY();
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
 	/*macro*/
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &errorReadReg));
@@ -252,6 +552,7 @@ uint8_t checkForMacroError(uint8_t afeId, uint8_t *macroErrorStatus)
 			*macroErrorStatus |= AFE_MACRO_ERROR_IN_EXECUTION;
 		}
 	}
+	*macroErrorFlags = *macroErrorStatus;
 	/*Returning only the macro Error*/
 	*macroErrorStatus = ((errorReadReg >> 3) & 1);
 	if (errorStatus)
@@ -260,6 +561,20 @@ uint8_t checkForMacroError(uint8_t afeId, uint8_t *macroErrorStatus)
 		return RET_OK;
 }
 
+/**
+    @brief Checks if there is a Macro Error
+    @details Checks if there is a Macro Error and returns the error status as pointer.
+    @param afeId AFE ID
+    @param macroErrorStatus Macro Error Status return as pointer.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t checkForMacroError(uint8_t afeId, uint8_t *macroErrorStatus)
+{
+	uint8_t macroErrorFlags = 0;
+	AFE_ID_VALIDITY();
+	return readMacroError(afeId, macroErrorStatus, &macroErrorFlags);
+}
+
 /**
     @brief Writes Opcode and triggers the Macro.
     @details Writes Opcode and triggers the Macro.
@@ -276,13 +591,241 @@ uint8_t triggerMacro(uint8_t afeId, uint8_t opcode)
 	/*macro*/
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_OPCODE_REG_ADDR, (opcode)&0xff, 0x0, 0x7));
 	/*MACRO_OPCODE*/
+	afeMacroEngine[afeId].opcode = opcode;
+	afeMacroEngine[afeId].triggerTimeUs = getTimeUs();
+	afeMacroEngine[afeId].polls = 0;
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
+	/*  The MCU can change any register while the macro runs.   */
+	AFE_FUNC_EXEC(afeShadowCacheInvalidate(afeId));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
 		return RET_OK;
 }
 
+/*  States of a macroSubmit slot.   */
+#define AFE_MACRO_SLOT_FREE 0
+#define AFE_MACRO_SLOT_QUEUED 1
+#define AFE_MACRO_SLOT_RUNNING 2
+#define AFE_MACRO_SLOT_DONE 3
+
+/*  A submitted macro. The operand block is built at submit time, so starting it after the previous macro is a single block write.   */
+typedef struct AFE_MACRO_SLOT
+{
+	uint8_t state;
+	uint8_t opcode;
+	uint8_t result;
+	uint8_t macroErrorFlags;
+	uint32_t handle;
+	uint16_t blockSize;
+	uint8_t operandBlock[AFE_MACRO_OPERAND_BLOCK_MAX];
+} AfeMacroSlot_t;
+
+/*  Macros run in handle order. Handles below runHandle have completed, handles from runHandle to nextHandle are running or queued.   */
+typedef struct AFE_MACRO_QUEUE
+{
+	uint32_t nextHandle;
+	uint32_t runHandle;
+	AfeMacroSlot_t slot[AFE_MACRO_QUEUE_DEPTH];
+} AfeMacroQueue_t;
+
+static AfeMacroQueue_t afeMacroQueue[NUM_OF_AFE];
+
+/*  Starts the oldest queued macro: ready poll, operand writes and trigger.   */
+static uint8_t macroQueueStart(uint8_t afeId, AfeMacroSlot_t *slot)
+{
+	uint8_t errorStatus = 0;
+	slot->state = AFE_MACRO_SLOT_RUNNING;
+	AFE_MACRO_READY_POLL_FAIL(waitForMacroReady(afeId));
+	AFE_FUNC_EXEC(writeOperandBlock(afeId, slot->operandBlock, slot->blockSize));
+	AFE_FUNC_EXEC(triggerMacro(afeId, slot->opcode));
+	return RET_OK;
+}
+
+/*  Ends the running macro with the given result and starts the next queued one.   */
+static void macroQueueComplete(uint8_t afeId, uint8_t result, uint8_t macroErrorFlags)
+{
+	AfeMacroQueue_t *queue = &afeMacroQueue[afeId];
+	AfeMacroSlot_t *slot = &queue->slot[queue->runHandle % AFE_MACRO_QUEUE_DEPTH];
+	slot->result = result;
+	slot->macroErrorFlags = macroErrorFlags;
+	slot->state = AFE_MACRO_SLOT_DONE;
+	queue->runHandle++;
+	while (queue->runHandle != queue->nextHandle)
+	{
+		slot = &queue->slot[queue->runHandle % AFE_MACRO_QUEUE_DEPTH];
+		if (macroQueueStart(afeId, slot) == RET_OK)
+			break;
+		/*  A macro that couldn't be started completes as failed, the next one is tried.   */
+		slot->result = RET_EXEC_FAIL;
+		slot->macroErrorFlags = AFE_MACRO_NO_ERROR;
+		slot->state = AFE_MACRO_SLOT_DONE;
+		queue->runHandle++;
+	}
+}
+
+/*  Counts a poll that found the running macro not done and returns 1 once it has timed out: AFE_MACRO_WAIT_TIMEOUT_MS after the trigger,
+	or after AFE_MACRO_POLL_TIMEOUT_POLLS polls if getTimeUs hasn't moved since the trigger, as with the user template.   */
+static uint8_t macroPollTimedOut(uint8_t afeId)
+{
+	AfeMacroEngine_t *engine = &afeMacroEngine[afeId];
+	uint64_t elapsedUs = getTimeUs() - engine->triggerTimeUs;
+
+	engine->polls++;
+	if (elapsedUs == 0)
+		return engine->polls > AFE_MACRO_POLL_TIMEOUT_POLLS;
+	return elapsedUs > (uint64_t)AFE_MACRO_WAIT_TIMEOUT_MS * 1000;
+}
+
+/*  Moves the running macro on. With blocking set it waits for Macro_Done as waitForMacroDone does, otherwise it reads the status once.   */
+static uint8_t macroQueueAdvance(uint8_t afeId, uint8_t blocking)
+{
+	uint8_t errorStatus = 0;
+	uint8_t readValue = 0;
+	uint8_t macroErrorStatus = 0;
+	uint8_t macroErrorFlags = 0;
+	AfeMacroQueue_t *queue = &afeMacroQueue[afeId];
+
+	if (queue->runHandle == queue->nextHandle)
+		return RET_OK;
+	if (blocking)
+	{
+		if (waitForMacroDone(afeId) != RET_OK)
+		{
+			afeLogErr("AFE%d: macro 0x%X didn't finish.", afeId, afeMacroEngine[afeId].opcode);
+			macroQueueComplete(afeId, RET_EXEC_FAIL, AFE_MACRO_NO_ERROR);
+			return RET_OK;
+		}
+	}
+	else
+	{
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, AFE_MACRO_PAGE_SEL_VAL, 0x0, 0x7));
+		/*macro*/
+		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, AFE_MACRO_STATUS_REG_ADDR, 0, 7, &readValue));
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, AFE_MACRO_PAGE_REG_ADDR, 0x00, 0x0, 0x7));
+		if ((readValue & AFE_MACRO_STATUS_DONE) == 0)
+		{
+			if (!macroPollTimedOut(afeId))
+				return RET_OK;
+			afeLogErr("AFE%d: macro 0x%X didn't finish.", afeId, afeMacroEngine[afeId].opcode);
+			macroQueueComplete(afeId, RET_EXEC_FAIL, AFE_MACRO_NO_ERROR);
+			return RET_OK;
+		}
+		AFE_FUNC_EXEC(macroDoneUpdate(afeId));
+	}
+	AFE_FUNC_EXEC(readMacroError(afeId, &macroErrorStatus, &macroErrorFlags));
+	macroQueueComplete(afeId, (macroErrorStatus != 0) ? RET_EXEC_FAIL : RET_OK, macroErrorFlags);
+	return RET_OK;
+}
+
+/*  Hands the result of a completed macro to the caller and frees its slot.   */
+static uint8_t macroQueueCollect(uint8_t afeId, uint32_t handle, uint8_t *macroErrorFlags)
+{
+	AfeMacroSlot_t *slot = &afeMacroQueue[afeId].slot[handle % AFE_MACRO_QUEUE_DEPTH];
+	uint8_t result = slot->result;
+	if (macroErrorFlags != NULL)
+		*macroErrorFlags = slot->macroErrorFlags;
+	slot->state = AFE_MACRO_SLOT_FREE;
+	return result;
+}
+
+static uint8_t macroQueueHandleValid(uint8_t afeId, uint32_t handle)
+{
+	AfeMacroSlot_t *slot = &afeMacroQueue[afeId].slot[handle % AFE_MACRO_QUEUE_DEPTH];
+	if ((slot->state == AFE_MACRO_SLOT_FREE) || (slot->handle != handle))
+	{
+		afeLogErr("AFE%d: macro handle %d is not pending.", afeId, handle);
+		return RET_EXEC_FAIL;
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Submits a Macro
+    @details Queues a macro and returns without waiting for it. If no macro is running on the AFE, it is started at once, otherwise its operand writes are prepared and it is started when the macros before it are done, during macroPoll or macroWait.
+			Macros of one AFE run and complete in the order they were submitted. Submitting to several AFEs before waiting lets their MCUs work at the same time.<br>
+			Every handle has to be collected with macroWait or macroPoll, at most AFE_MACRO_QUEUE_DEPTH macros can be uncollected per AFE.
+    @param afeId AFE ID
+	@param byteList Byte-wise array of operands to be written.
+	@param numOfOperands Size of operandList.
+    @param opcode Opcode of the Macro.
+    @param handle Pointer returning the handle of the macro.
+	@return Returns if the function execution passed or failed. Fails if the queue is full.
+*/
+uint8_t macroSubmit(uint8_t afeId, uint8_t *byteList, uint8_t numOfOperands, uint8_t opcode, uint32_t *handle)
+{
+	AfeMacroQueue_t *queue;
+	AfeMacroSlot_t *slot;
+
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID((handle != NULL) && ((byteList != NULL) || (numOfOperands == 0)));
+	queue = &afeMacroQueue[afeId];
+	slot = &queue->slot[queue->nextHandle % AFE_MACRO_QUEUE_DEPTH];
+	if (slot->state != AFE_MACRO_SLOT_FREE)
+	{
+		afeLogErr("AFE%d: macro queue full, collect the earlier macros first.", afeId);
+		return RET_EXEC_FAIL;
+	}
+	slot->opcode = opcode;
+	slot->handle = queue->nextHandle;
+	slot->blockSize = stageOperandList(byteList, numOfOperands, slot->operandBlock);
+	slot->state = AFE_MACRO_SLOT_QUEUED;
+	*handle = queue->nextHandle++;
+	if (queue->runHandle == slot->handle)
+	{
+		if (macroQueueStart(afeId, slot) != RET_OK)
+			macroQueueComplete(afeId, RET_EXEC_FAIL, AFE_MACRO_NO_ERROR);
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Checks for the Completion of a Submitted Macro
+    @details Reads the macro status once without waiting. If the running macro is done, its error status is read as in checkForMacroError and the next queued macro is started.<br>
+			A macro that hasn't finished 200 ms after it was started completes as failed. If getTimeUs doesn't advance, as in the user template, it fails after 200 polls that find it running instead, so poll about once per milli second then.
+    @param afeId AFE ID
+    @param handle Handle returned by macroSubmit.
+    @param done Pointer returning 1 if the macro has completed. The handle is then collected and can't be used again.
+    @param macroErrorFlags Pointer returning the AFE_MACRO_ERROR_* bits of the completed macro. Can be NULL.
+	@return Returns if the function execution passed or failed. Once done is 1, it also returns failed if the macro failed.
+*/
+uint8_t macroPoll(uint8_t afeId, uint32_t handle, uint8_t *done, uint8_t *macroErrorFlags)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(done != NULL);
+	AFE_FUNC_EXEC(macroQueueHandleValid(afeId, handle));
+	*done = 0;
+	if (afeMacroQueue[afeId].slot[handle % AFE_MACRO_QUEUE_DEPTH].state != AFE_MACRO_SLOT_DONE)
+	{
+		AFE_FUNC_EXEC(macroQueueAdvance(afeId, 0));
+		if (afeMacroQueue[afeId].slot[handle % AFE_MACRO_QUEUE_DEPTH].state != AFE_MACRO_SLOT_DONE)
+			return RET_OK;
+	}
+	*done = 1;
+	return macroQueueCollect(afeId, handle, macroErrorFlags);
+}
+
+/**
+    @brief Waits for a Submitted Macro
+    @details Waits until the macro and all the macros submitted to the AFE before it are done, using the wait mode of afeMacroSetWaitMode. The handle is collected and can't be used again.
+    @param afeId AFE ID
+    @param handle Handle returned by macroSubmit.
+    @param macroErrorFlags Pointer returning the AFE_MACRO_ERROR_* bits of the macro. Can be NULL.
+	@return Returns if the function execution passed or failed. It returns as failed if the macro didn't finish or finished with an error.
+*/
+uint8_t macroWait(uint8_t afeId, uint32_t handle, uint8_t *macroErrorFlags)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_FUNC_EXEC(macroQueueHandleValid(afeId, handle));
+	while (afeMacroQueue[afeId].slot[handle % AFE_MACRO_QUEUE_DEPTH].state != AFE_MACRO_SLOT_DONE)
+	{
+		AFE_FUNC_EXEC(macroQueueAdvance(afeId, 1));
+	}
+	return macroQueueCollect(afeId, handle, macroErrorFlags);
+}
+
 /**
     @brief Execute a Macro
     @details Executes the Macro by calling other sub functions.
@@ -298,6 +841,11 @@ uint8_t executeMacro(uint8_t afeId, uint8_t *byteList, uint8_t numOfOperands, ui
 	uint8_t macroErrorStatus = 0;
 	uint8_t errorStatus = 0;
 	AFE_ID_VALIDITY();
+	/*  Macros submitted with macroSubmit run first. Their results stay for macroWait.   */
+	while (afeMacroQueue[afeId].runHandle != afeMacroQueue[afeId].nextHandle)
+	{
+		AFE_FUNC_EXEC(macroQueueAdvance(afeId, 1));
+	}
 	AFE_MACRO_READY_POLL_FAIL(waitForMacroReady(afeId));
 	AFE_FUNC_EXEC(writeOperandList(afeId, byteList, numOfOperands));
 	AFE_FUNC_EXEC(triggerMacro(afeId, opcode));
@@ -0,0 +1,289 @@
+/** @file healthMonitor.c
+ * 	@brief	Periodic device health monitor.<br>
+ * 		Runs the checks of checkDeviceHealth a few at a time, round robin, from afeHealthMonitorTick, so that a periodic call
+ * 		costs only a slice of the SPI transactions of a full check. The last state of every check is cached in a snapshot
+ * 		and an event is logged only when the fault state of a check changes.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "afe79xxLog.h"
+#include "afe79xxTypes.h"
+
+#include "afeCommonMacros.h"
+
+#include "baseFunc.h"
+#include "basicFunctions.h"
+#include "controls.h"
+#include "hMacro.h"
+#include "jesd.h"
+#include "pap.h"
+#include "healthMonitor.h"
+
+typedef struct AFE_HEALTH_MONITOR
+{
+    uint8_t configured;
+    uint8_t checksPerTick;
+    uint8_t nextCheck;
+    uint16_t enableMask;
+    AfeHealthSnapshot_t snapshot;
+} AfeHealthMonitor_t;
+
+static AfeHealthMonitor_t afeHealthMonitor[NUM_OF_AFE];
+
+static const char *const afeHealthCheckName[AFE_HEALTH_NUM_CHECKS] = {
+    "PLL lock",
+    "DAC-JESD-RX link",
+    "DAC-JESD-RX alarms",
+    "ADC-JESD-TX AB FIFO",
+    "ADC-JESD-TX CD FIFO",
+    "SPI alarms",
+    "MCU",
+    "PAP TXA",
+    "PAP TXB",
+    "PAP TXC",
+    "PAP TXD"};
+
+/* AFE_HEALTH_FAULT_* bit of each check. */
+static const uint8_t afeHealthCheckFaultBit[AFE_HEALTH_NUM_CHECKS] = {
+    AFE_HEALTH_FAULT_PLL, AFE_HEALTH_FAULT_DAC_JESD, AFE_HEALTH_FAULT_DAC_JESD, AFE_HEALTH_FAULT_ADC_JESD,
+    AFE_HEALTH_FAULT_ADC_JESD, AFE_HEALTH_FAULT_SPI, AFE_HEALTH_FAULT_MCU, AFE_HEALTH_FAULT_PAP,
+    AFE_HEALTH_FAULT_PAP, AFE_HEALTH_FAULT_PAP, AFE_HEALTH_FAULT_PAP};
+
+static void healthMonitorDefaults(AfeHealthMonitor_t *mon)
+{
+    if (!mon->configured)
+    {
+        mon->configured = 1;
+        mon->enableMask = AFE_HEALTH_CHECK_ALL;
+        mon->checksPerTick = AFE_HEALTH_CHECKS_PER_TICK;
+    }
+}
+
+/* Runs one check, updating its part of state. fault is 1 when the value read is not the good one. */
+static uint8_t healthRunCheck(uint8_t afeId, uint8_t check, AfeDeviceHealth_t *state, uint8_t *fault)
+{
+    uint8_t errorStatus = 0;
+
+    switch (check)
+    {
+    case AFE_HEALTH_CHECK_PLL:
+        AFE_FUNC_EXEC(getPllLockState(afeId, &state->pllStatus));
+        *fault = ((state->pllStatus & (AFE_PLL_STATUS_LOCKED | AFE_PLL_STATUS_LOCK_LOST_STICKY)) != AFE_PLL_STATUS_LOCKED);
+        break;
+    case AFE_HEALTH_CHECK_JESD_RX_LINK:
+        AFE_FUNC_EXEC(getJesdRxLinkState(afeId, &state->jesdRx));
+        *fault = (state->jesdRx.linkStatus != 10);
+        break;
+    case AFE_HEALTH_CHECK_JESD_RX_ALARMS:
+        AFE_FUNC_EXEC(getJesdRxAlarms(afeId, &state->jesdRxAlarms));
+        *fault = (state->jesdRxAlarms != 0);
+        break;
+    case AFE_HEALTH_CHECK_JESD_TX_FIFO_AB:
+    case AFE_HEALTH_CHECK_JESD_TX_FIFO_CD:
+        AFE_FUNC_EXEC(getJesdTxFifoErrors(afeId, check - AFE_HEALTH_CHECK_JESD_TX_FIFO_AB, &state->jesdTxFifo[check - AFE_HEALTH_CHECK_JESD_TX_FIFO_AB]));
+        *fault = (state->jesdTxFifo[check - AFE_HEALTH_CHECK_JESD_TX_FIFO_AB] != 0);
+        break;
+    case AFE_HEALTH_CHECK_SPI_ALARMS:
+        AFE_FUNC_EXEC(getSpiAlarmBits(afeId, &state->spiAlarms));
+        *fault = (state->spiAlarms != 0);
+        break;
+    case AFE_HEALTH_CHECK_MCU:
+        AFE_FUNC_EXEC(checkMcuHealth(afeId, &state->mcuOk));
+        *fault = (state->mcuOk == 0);
+        break;
+    default:
+        AFE_FUNC_EXEC(papGetAlarmStatus(afeId, check - AFE_HEALTH_CHECK_PAP_TXA, &state->pap[check - AFE_HEALTH_CHECK_PAP_TXA]));
+        *fault = state->pap[check - AFE_HEALTH_CHECK_PAP_TXA].triggered;
+        break;
+    }
+
+    if (errorStatus)
+        return RET_EXEC_FAIL;
+    else
+        return RET_OK;
+}
+
+/* Runs the check, records its cost and state in the snapshot and logs when the fault state changes.
+   A check which has not run before is taken as healthy, so a fault found in its first run is reported. */
+static uint8_t healthMonitorRun(uint8_t afeId, uint8_t check, uint16_t *changedMask)
+{
+    AfeHealthSnapshot_t *snap = &afeHealthMonitor[afeId].snapshot;
+    uint16_t bit = (uint16_t)(1 << check);
+    AfeDeviceHealth_t state = snap->state;
+    uint8_t fault = 0;
+    uint8_t result;
+    uint32_t spiBefore = 0;
+    uint32_t spiAfter = 0;
+
+    afeSpiGetTransactionCount(afeId, &spiBefore, 0);
+    result = healthRunCheck(afeId, check, &state, &fault);
+    afeSpiGetTransactionCount(afeId, &spiAfter, 0);
+
+    snap->lastSpiCost[check] = spiAfter - spiBefore;
+    snap->totalSpiCost[check] += spiAfter - spiBefore;
+    snap->runs[check]++;
+    snap->lastTick[check] = snap->tick;
+    if (result != RET_OK)
+    {
+        snap->errorMask |= bit;
+        afeLogErr("AFE%d health: %s check failed.", afeId, afeHealthCheckName[check]);
+        return RET_EXEC_FAIL;
+    }
+    snap->errorMask &= (uint16_t)~bit;
+    snap->validMask |= bit;
+    snap->state = state;
+
+    if (fault != ((snap->faultMask & bit) != 0))
+    {
+        *changedMask |= bit;
+        if (fault)
+        {
+            snap->faultMask |= bit;
+            afeLogErr("AFE%d health: %s fault.", afeId, afeHealthCheckName[check]);
+        }
+        else
+        {
+            snap->faultMask &= (uint16_t)~bit;
+            afeLogInfo("AFE%d health: %s recovered.", afeId, afeHealthCheckName[check]);
+        }
+    }
+    return RET_OK;
+}
+
+static void healthMonitorSummary(AfeHealthSnapshot_t *snap)
+{
+    snap->state.faults = 0;
+    for (uint8_t check = 0; check < AFE_HEALTH_NUM_CHECKS; check++)
+    {
+        if (snap->faultMask & (1 << check))
+            snap->state.faults |= afeHealthCheckFaultBit[check];
+    }
+}
+
+/**
+    @brief Configures the Health Monitor
+    @details Selects the checks run by afeHealthMonitorTick and how many of them each call runs. Until this is called all the checks are enabled and AFE_HEALTH_CHECKS_PER_TICK run per call.<br>
+        A check disabled here keeps its last state in the snapshot.
+    @param afeId AFE ID
+    @param enableMask Bit wise check select, bit n for the check AFE_HEALTH_CHECK_* n. AFE_HEALTH_CHECK_ALL for all.
+    @param checksPerTick Number of enabled checks run per afeHealthMonitorTick, 1 to AFE_HEALTH_NUM_CHECKS.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeHealthMonitorConfig(uint8_t afeId, uint16_t enableMask, uint8_t checksPerTick)
+{
+    AfeHealthMonitor_t *mon;
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID((enableMask & ~AFE_HEALTH_CHECK_ALL) == 0);
+    AFE_PARAMS_VALID((checksPerTick >= 1) && (checksPerTick <= AFE_HEALTH_NUM_CHECKS));
+    mon = &afeHealthMonitor[afeId];
+    mon->configured = 1;
+    mon->enableMask = enableMask;
+    mon->checksPerTick = checksPerTick;
+    return RET_OK;
+}
+
+/**
+    @brief Health Monitor Tick
+    @details Runs the next checksPerTick enabled checks, continuing from where the previous call stopped. Call it periodically, every enabled check is run once every ceil(enabled checks / checksPerTick) calls.<br>
+        Only the checks whose fault state changed are logged, an error when a fault appears and an info when it clears. The full state is read with afeHealthMonitorGetSnapshot.<br>
+        A check that fails on the SPI keeps its previous state and is marked in the errorMask of the snapshot, the other checks of the slice are still run.
+    @param afeId AFE ID
+    @param changedMask Pointer returning the checks whose fault state changed in this call, bit n for check n. Can be NULL.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeHealthMonitorTick(uint8_t afeId, uint16_t *changedMask)
+{
+    uint8_t errorStatus = 0;
+    AfeHealthMonitor_t *mon;
+    uint16_t changed = 0;
+    uint8_t ran = 0;
+
+    AFE_ID_VALIDITY();
+    mon = &afeHealthMonitor[afeId];
+    healthMonitorDefaults(mon);
+    mon->snapshot.tick++;
+
+    for (uint8_t i = 0; (i < AFE_HEALTH_NUM_CHECKS) && (ran < mon->checksPerTick); i++)
+    {
+        uint8_t check = mon->nextCheck;
+        mon->nextCheck = (uint8_t)((check + 1) % AFE_HEALTH_NUM_CHECKS);
+        if ((mon->enableMask & (1 << check)) == 0)
+            continue;
+        if (healthMonitorRun(afeId, check, &changed) != RET_OK)
+            errorStatus = 1;
+        ran++;
+    }
+    healthMonitorSummary(&mon->snapshot);
+    if (changedMask != NULL)
+        *changedMask = changed;
+
+    if (errorStatus)
+        return RET_EXEC_FAIL;
+    else
+        return RET_OK;
+}
+
+/**
+    @brief Health Monitor Full Pass
+    @details Runs all the enabled checks at once, for example right after bringup to fill the snapshot. The round robin position of afeHealthMonitorTick is not changed. Events are logged as in afeHealthMonitorTick.
+    @param afeId AFE ID
+    @param changedMask Pointer returning the checks whose fault state changed, bit n for check n. Can be NULL.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeHealthMonitorRunAll(uint8_t afeId, uint16_t *changedMask)
+{
+    uint8_t errorStatus = 0;
+    AfeHealthMonitor_t *mon;
+    uint16_t changed = 0;
+
+    AFE_ID_VALIDITY();
+    mon = &afeHealthMonitor[afeId];
+    healthMonitorDefaults(mon);
+    mon->snapshot.tick++;
+
+    for (uint8_t check = 0; check < AFE_HEALTH_NUM_CHECKS; check++)
+    {
+        if ((mon->enableMask & (1 << check)) == 0)
+            continue;
+        if (healthMonitorRun(afeId, check, &changed) != RET_OK)
+            errorStatus = 1;
+    }
+    healthMonitorSummary(&mon->snapshot);
+    if (changedMask != NULL)
+        *changedMask = changed;
+
+    if (errorStatus)
+        return RET_EXEC_FAIL;
+    else
+        return RET_OK;
+}
+
+/**
+    @brief Health Monitor Snapshot
+    @details Copies the cached state of all the checks, no SPI access is done. Only the checks set in validMask have run successfully at least once.
+    @param afeId AFE ID
+    @param snapshot Pointer returning the snapshot.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeHealthMonitorGetSnapshot(uint8_t afeId, AfeHealthSnapshot_t *snapshot)
+{
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID(snapshot != NULL);
+    *snapshot = afeHealthMonitor[afeId].snapshot;
+    return RET_OK;
+}
+
+/**
+    @brief Resets the Health Monitor
+    @details Clears the snapshot, including the SPI cost counters, and restarts the round robin from the first check. The configuration is kept. Call it after a bringup, as all the checks are then taken as healthy again.
+    @param afeId AFE ID
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeHealthMonitorReset(uint8_t afeId)
+{
+    AFE_ID_VALIDITY();
+    memset(&afeHealthMonitor[afeId].snapshot, 0, sizeof(AfeHealthSnapshot_t));
+    afeHealthMonitor[afeId].nextCheck = 0;
+    return RET_OK;
+}
@@ -67,6 +67,9 @@ int8_t configAfeFromFileFormat0(uint8_t afeId, char *file, uint8_t breakAtPollFa
         }
         else if (4 == ret && 0 == strcasecmp(op, "spiread"))
         {
+            /* spiread has no data field, the lsb is in the second field. */
+            lsb = (uint8_t)utemp2;
+            msb = (uint8_t)temp3;
             AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, spiaddr, lsb, msb, &spidata));
             afeLogDbg("AFE FROM FILE READ: 0x%04x[%d:%d] = 0x%04x\n", spiaddr, lsb, msb, spidata);
             continue;
@@ -263,3 +266,768 @@ int8_t configAfeFromFile(uint8_t afeId, uint8_t logFormat, char *file, uint8_t b
     else
         return RET_OK;
 }
+
+/* Compiled script format. All fields are little endian.
+   Header (AFE_SCRIPT_HEADER_LEN bytes):
+     0  magic "AFES"          8  record count          16 payload checksum
+     4  version (2 bytes)     12 payload length        20 header checksum, over bytes 0 to 19
+     6  header length (2 bytes)
+   Records follow back to back, each starting with its opcode:
+     WRITE  addr(2) data lsb msb     READ addr(2) lsb msb
+     CHECK  addr(2) lsb msb data     POLL addr(2) lsb msb data     WAIT ms(4)
+     WRITE_MASK addr(2) data mask, only made by optimizeAfeScript for fields that are not contiguous.
+   Version 2 added WRITE_MASK, so loaders of version 1 reject the scripts that may hold it. Version 1 scripts still load. */
+#define AFE_SCRIPT_MAGIC "AFES"
+#define AFE_SCRIPT_VERSION 2
+#define AFE_SCRIPT_MIN_VERSION 1
+#define AFE_SCRIPT_HEADER_LEN 24
+#define AFE_SCRIPT_OP_WRITE 1
+#define AFE_SCRIPT_OP_READ 2
+#define AFE_SCRIPT_OP_CHECK 3
+#define AFE_SCRIPT_OP_POLL 4
+#define AFE_SCRIPT_OP_WAIT 5
+#define AFE_SCRIPT_OP_WRITE_MASK 6
+#define AFE_SCRIPT_OP_LAST AFE_SCRIPT_OP_WRITE_MASK
+#define AFE_SCRIPT_MAX_RECORD_LEN 6
+/* Size of the chunks configAfeFromBinary and optimizeAfeScript read from the file. */
+#define AFE_SCRIPT_CHUNK_LEN 4096
+
+static const uint8_t afeScriptRecordLen[] = {0, 6, 5, 6, 6, 5, 5};
+
+/* State carried across the chunks of one compiled script run. */
+typedef struct
+{
+    uint8_t afeId;
+    uint8_t breakAtPollFail;
+    uint8_t breakAtReadCheckFail;
+    uint8_t errorStatus;
+    uint8_t stop;
+    uint16_t batchLen;
+    uint16_t batchAddr[AFE_SPI_BATCH_MAX_LEN];
+    uint8_t batchData[AFE_SPI_BATCH_MAX_LEN];
+    uint32_t records;
+    uint64_t execTimeUs;
+} AfeScriptRun_t;
+
+/* Output side of compileAfeScript and optimizeAfeScript. */
+typedef struct
+{
+    FILE *fp;
+    uint8_t errorStatus;
+    uint32_t recordCount;
+    uint32_t payloadLen;
+    uint32_t checksum;
+} AfeScriptWriter_t;
+
+/* A write held back by optimizeAfeScript, as data and bit mask. */
+typedef struct
+{
+    uint16_t addr;
+    uint8_t data;
+    uint8_t mask;
+    uint8_t alive;
+} AfeScriptPendingWrite_t;
+
+/* optimizeAfeScript state. Writes are held in a window that is flushed at every read, check, poll or wait, so those
+   see exactly the register state the original script gives them. */
+typedef struct
+{
+    uint32_t flags;
+    AfeScriptWriter_t *writer;
+    uint16_t numPending;
+    AfeScriptPendingWrite_t pending[AFE_SPI_BATCH_MAX_LEN];
+    uint8_t pageKnown[AFE_NUM_PAGE_REGS];
+    uint8_t pageValue[AFE_NUM_PAGE_REGS];
+    uint32_t mergedWrites;
+    uint32_t pageWrites;
+    uint32_t deadWrites;
+    uint32_t transactionsIn;
+    uint32_t transactionsOut;
+} AfeScriptOptimizer_t;
+
+static uint32_t afeScriptChecksum(uint32_t checksum, const uint8_t *buf, uint32_t len)
+{
+    /* FNV-1a */
+    for (uint32_t i = 0; i < len; i++)
+        checksum = (checksum ^ buf[i]) * 16777619u;
+    return checksum;
+}
+
+static void afeScriptPut16(uint8_t *buf, uint16_t val)
+{
+    buf[0] = (uint8_t)val;
+    buf[1] = (uint8_t)(val >> 8);
+}
+
+static void afeScriptPut32(uint8_t *buf, uint32_t val)
+{
+    afeScriptPut16(buf, (uint16_t)val);
+    afeScriptPut16(buf + 2, (uint16_t)(val >> 16));
+}
+
+static uint16_t afeScriptGet16(const uint8_t *buf)
+{
+    return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+static uint32_t afeScriptGet32(const uint8_t *buf)
+{
+    return afeScriptGet16(buf) | ((uint32_t)afeScriptGet16(buf + 2) << 16);
+}
+
+/* Turns one script line into a record, with the same matching rules as configAfeFromFileFormat0/5.
+   Returns the record length, 0 for lines that don't execute anything. */
+static uint8_t afeScriptParseLine(uint8_t logFormat, char *strLine, uint8_t *record)
+{
+    char op[16] = {0};
+    int32_t temp3, temp4, temp5;
+    uint32_t utemp1, utemp2, utemp3;
+    float delay;
+    int8_t ret;
+
+    if (logFormat == 5)
+    {
+        ret = sscanf(strLine, "{0x%x,0x%x,0x%x,%d,%d}", &utemp1, &utemp2, &utemp3, &temp4, &temp5);
+        if (5 != ret)
+            return 0;
+        afeScriptPut16(record + 1, (uint16_t)utemp2);
+        if (utemp1 == 0)
+        {
+            record[0] = AFE_SCRIPT_OP_READ;
+            record[3] = (uint8_t)temp4;
+            record[4] = (uint8_t)temp5;
+        }
+        else if (utemp1 == 1)
+        {
+            record[0] = AFE_SCRIPT_OP_WRITE;
+            record[3] = (uint8_t)utemp3;
+            record[4] = (uint8_t)temp4;
+            record[5] = (uint8_t)temp5;
+        }
+        else if (utemp1 == 2 || utemp1 == 3)
+        {
+            record[0] = (utemp1 == 2) ? AFE_SCRIPT_OP_CHECK : AFE_SCRIPT_OP_POLL;
+            record[3] = (uint8_t)temp4;
+            record[4] = (uint8_t)temp5;
+            record[5] = (uint8_t)utemp3;
+        }
+        else if (utemp1 == 5)
+        {
+            record[0] = AFE_SCRIPT_OP_WAIT;
+            afeScriptPut32(record + 1, utemp2);
+        }
+        else
+            return 0;
+        return afeScriptRecordLen[record[0]];
+    }
+
+    ret = sscanf(strLine, "%15[^ ] %x,%x,%d,%d", op, &utemp1, &utemp2, &temp3, &temp4);
+    if (5 == ret && 0 == strcasecmp(op, "spiwrite"))
+    {
+        record[0] = AFE_SCRIPT_OP_WRITE;
+        afeScriptPut16(record + 1, (uint16_t)utemp1);
+        record[3] = (uint8_t)utemp2;
+        record[4] = (uint8_t)temp3;
+        record[5] = (uint8_t)temp4;
+        return afeScriptRecordLen[AFE_SCRIPT_OP_WRITE];
+    }
+    else if (4 == ret && 0 == strcasecmp(op, "spiread"))
+    {
+        record[0] = AFE_SCRIPT_OP_READ;
+        afeScriptPut16(record + 1, (uint16_t)utemp1);
+        record[3] = (uint8_t)utemp2;
+        record[4] = (uint8_t)temp3;
+        return afeScriptRecordLen[AFE_SCRIPT_OP_READ];
+    }
+    ret = sscanf(strLine, "%15[^ ] %x,%d,%d,%x", op, &utemp1, &temp3, &temp4, &utemp3);
+    if (5 == ret && (0 == strcasecmp(op, "spipoll") || 0 == strcasecmp(op, "SPIReadCheck")))
+    {
+        record[0] = (0 == strcasecmp(op, "spipoll")) ? AFE_SCRIPT_OP_POLL : AFE_SCRIPT_OP_CHECK;
+        afeScriptPut16(record + 1, (uint16_t)utemp1);
+        record[3] = (uint8_t)temp3;
+        record[4] = (uint8_t)temp4;
+        record[5] = (uint8_t)utemp3;
+        return afeScriptRecordLen[record[0]];
+    }
+    ret = sscanf(strLine, "%15[^ ] %f", op, &delay);
+    if (2 == ret)
+    {
+        record[0] = AFE_SCRIPT_OP_WAIT;
+        afeScriptPut32(record + 1, (uint32_t)(delay * 1000));
+        return afeScriptRecordLen[AFE_SCRIPT_OP_WAIT];
+    }
+    return 0;
+}
+
+static FILE *afeScriptWriterOpen(AfeScriptWriter_t *writer, char *binFile)
+{
+    uint8_t header[AFE_SCRIPT_HEADER_LEN] = {0};
+    memset(writer, 0, sizeof(AfeScriptWriter_t));
+    writer->checksum = 2166136261u;
+    writer->fp = fopen(binFile, "wb");
+    /* The header is rewritten once the payload is known. */
+    if (writer->fp != NULL && fwrite(header, 1, AFE_SCRIPT_HEADER_LEN, writer->fp) != AFE_SCRIPT_HEADER_LEN)
+        writer->errorStatus |= 1;
+    return writer->fp;
+}
+
+static void afeScriptWriterPut(AfeScriptWriter_t *writer, const uint8_t *record)
+{
+    uint8_t recordLen = afeScriptRecordLen[record[0]];
+    if (fwrite(record, 1, recordLen, writer->fp) != recordLen)
+        writer->errorStatus |= 1;
+    writer->checksum = afeScriptChecksum(writer->checksum, record, recordLen);
+    writer->payloadLen += recordLen;
+    writer->recordCount++;
+}
+
+static uint8_t afeScriptWriterClose(AfeScriptWriter_t *writer)
+{
+    uint8_t header[AFE_SCRIPT_HEADER_LEN];
+    memcpy(header, AFE_SCRIPT_MAGIC, 4);
+    afeScriptPut16(header + 4, AFE_SCRIPT_VERSION);
+    afeScriptPut16(header + 6, AFE_SCRIPT_HEADER_LEN);
+    afeScriptPut32(header + 8, writer->recordCount);
+    afeScriptPut32(header + 12, writer->payloadLen);
+    afeScriptPut32(header + 16, writer->checksum);
+    afeScriptPut32(header + 20, afeScriptChecksum(2166136261u, header, 20));
+    if (!writer->errorStatus && (fseek(writer->fp, 0, SEEK_SET) != 0 || fwrite(header, 1, AFE_SCRIPT_HEADER_LEN, writer->fp) != AFE_SCRIPT_HEADER_LEN))
+        writer->errorStatus |= 1;
+    if (fclose(writer->fp) != 0)
+        writer->errorStatus |= 1;
+    return writer->errorStatus ? RET_EXEC_FAIL : RET_OK;
+}
+
+/**
+    @brief Compiles a Latte log file to the binary script format.
+    @details Parses a format 0 or format 5 Latte log once and writes it as a compact binary opcode stream, which configAfeFromBinary executes without any string parsing. Comment lines are dropped.
+    @param logFormat Format of the input log, 0 or 5.
+    @param file Log File Path as generated by Latte.
+    @param binFile Path of the compiled script to be written.
+    @return Returns if the function execution passed or failed.
+*/
+int8_t compileAfeScript(uint8_t logFormat, char *file, char *binFile)
+{
+    AFE_PARAMS_VALID((file != NULL) && (binFile != NULL) && ((logFormat == 0) || (logFormat == 5)));
+
+    FILE *fp = fopen(file, "r");
+    if (NULL == fp)
+    {
+        printf("File open error.\n");
+        return RET_EXEC_FAIL;
+    }
+    AfeScriptWriter_t writer;
+    if (NULL == afeScriptWriterOpen(&writer, binFile))
+    {
+        printf("File open error.\n");
+        fclose(fp);
+        return RET_EXEC_FAIL;
+    }
+    char strLine[256] = {0};
+    uint8_t record[AFE_SCRIPT_MAX_RECORD_LEN];
+
+    while (!writer.errorStatus && fgets(strLine, sizeof(strLine), fp) != NULL)
+    {
+        if (afeScriptParseLine(logFormat, strLine, record) != 0)
+            afeScriptWriterPut(&writer, record);
+    }
+    fclose(fp);
+    if (afeScriptWriterClose(&writer) != RET_OK)
+    {
+        afeLogErr("Writing compiled script %s failed", binFile);
+        return RET_EXEC_FAIL;
+    }
+    afeLogInfo("Compiled %d records, %d bytes to %s", writer.recordCount, writer.payloadLen + AFE_SCRIPT_HEADER_LEN, binFile);
+    return RET_OK;
+}
+
+static uint8_t afeScriptCheckHeader(const uint8_t *header, uint32_t *recordCount, uint32_t *payloadLen, uint32_t *checksum)
+{
+    uint16_t version = afeScriptGet16(header + 4);
+
+    if (memcmp(header, AFE_SCRIPT_MAGIC, 4) != 0 || version < AFE_SCRIPT_MIN_VERSION || version > AFE_SCRIPT_VERSION || afeScriptGet16(header + 6) != AFE_SCRIPT_HEADER_LEN)
+    {
+        afeLogErr("%s", "Not a compiled AFE script or unsupported version.");
+        return RET_EXEC_FAIL;
+    }
+    if (afeScriptGet32(header + 20) != afeScriptChecksum(2166136261u, header, 20))
+    {
+        afeLogErr("%s", "Compiled script header checksum mismatch.");
+        return RET_EXEC_FAIL;
+    }
+    *recordCount = afeScriptGet32(header + 8);
+    *payloadLen = afeScriptGet32(header + 12);
+    *checksum = afeScriptGet32(header + 16);
+    return RET_OK;
+}
+
+/* Opens a compiled script, checks the header and payload checksums and leaves the file at the first record. */
+static FILE *afeScriptOpenVerified(char *file, uint32_t *recordCount)
+{
+    uint8_t buf[AFE_SCRIPT_CHUNK_LEN];
+    uint32_t payloadLen, checksum;
+    uint32_t sum = 2166136261u;
+    uint32_t total = 0;
+    size_t readLen;
+
+    FILE *fp = fopen(file, "rb");
+    if (NULL == fp)
+    {
+        printf("File open error.\n");
+        return NULL;
+    }
+    if (fread(buf, 1, AFE_SCRIPT_HEADER_LEN, fp) != AFE_SCRIPT_HEADER_LEN || afeScriptCheckHeader(buf, recordCount, &payloadLen, &checksum) != RET_OK)
+    {
+        afeLogErr("Compiled script %s has no valid header.", file);
+        fclose(fp);
+        return NULL;
+    }
+    while ((readLen = fread(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        sum = afeScriptChecksum(sum, buf, (uint32_t)readLen);
+        total += (uint32_t)readLen;
+    }
+    if (total != payloadLen || sum != checksum || fseek(fp, AFE_SCRIPT_HEADER_LEN, SEEK_SET) != 0)
+    {
+        afeLogErr("Compiled script %s is truncated or corrupted.", file);
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+static void afeScriptFlushBatch(AfeScriptRun_t *run)
+{
+    if (run->batchLen == 0)
+        return;
+    if (afeSpiWriteBatchWrapper(run->afeId, run->batchAddr, run->batchData, run->batchLen) != RET_OK)
+    {
+        run->errorStatus |= 1;
+        run->stop = 1;
+    }
+    run->batchLen = 0;
+}
+
+/* Executes the complete records in buf and returns how many bytes were used. A record cut at the end of buf is left
+   for the next call. Full byte writes are gathered into batches, anything else flushes the batch first. */
+static uint32_t afeScriptExecute(AfeScriptRun_t *run, const uint8_t *buf, uint32_t len)
+{
+    uint32_t pos = 0;
+    uint64_t start = getTimeUs();
+
+    while (pos < len && !run->stop)
+    {
+        const uint8_t *rec = buf + pos;
+        uint16_t spiaddr;
+        uint8_t spidata = 0;
+        uint8_t spiCheckSuccess = 0;
+        uint8_t returnVal = RET_OK;
+
+        if (rec[0] == 0 || rec[0] > AFE_SCRIPT_OP_LAST)
+        {
+            afeLogErr("Invalid opcode 0x%x in compiled script.", rec[0]);
+            run->errorStatus |= 1;
+            run->stop = 1;
+            break;
+        }
+        if (pos + afeScriptRecordLen[rec[0]] > len)
+            break;
+        pos += afeScriptRecordLen[rec[0]];
+        run->records++;
+        spiaddr = afeScriptGet16(rec + 1);
+        if ((rec[0] == AFE_SCRIPT_OP_WRITE && rec[4] == 0 && rec[5] == 7) || (rec[0] == AFE_SCRIPT_OP_WRITE_MASK && rec[4] == 0xFF))
+        {
+            run->batchAddr[run->batchLen] = spiaddr;
+            run->batchData[run->batchLen] = rec[3];
+            run->batchLen++;
+            if (run->batchLen == AFE_SPI_BATCH_MAX_LEN)
+                afeScriptFlushBatch(run);
+            continue;
+        }
+        afeScriptFlushBatch(run);
+        if (run->stop)
+            break;
+        switch (rec[0])
+        {
+        case AFE_SCRIPT_OP_WRITE:
+            returnVal = afeSpiWriteWrapper(run->afeId, spiaddr, rec[3], rec[4], rec[5]);
+            afeLogDbg("AFE FROM FILE WRITE: 0x%04x[%d:%d] = 0x%02x \n", spiaddr, rec[4], rec[5], rec[3]);
+            break;
+        case AFE_SCRIPT_OP_WRITE_MASK:
+            returnVal = afeSpiReadWrapper(run->afeId, spiaddr, 0, 7, &spidata);
+            if (returnVal == RET_OK)
+                returnVal = afeSpiWriteWrapper(run->afeId, spiaddr, (spidata & (0xFF ^ rec[4])) | (rec[3] & rec[4]), 0, 7);
+            afeLogDbg("AFE FROM FILE WRITE: 0x%04x mask 0x%02x = 0x%02x \n", spiaddr, rec[4], rec[3]);
+            break;
+        case AFE_SCRIPT_OP_READ:
+            returnVal = afeSpiReadWrapper(run->afeId, spiaddr, rec[3], rec[4], &spidata);
+            afeLogDbg("AFE FROM FILE READ: 0x%04x[%d:%d] = 0x%04x\n", spiaddr, rec[3], rec[4], spidata);
+            break;
+        case AFE_SCRIPT_OP_CHECK:
+            returnVal = afeSpiCheckWrapper(run->afeId, spiaddr, rec[3], rec[4], rec[5], &spiCheckSuccess);
+            if (returnVal == RET_OK && spiCheckSuccess != 0)
+            {
+                afeLogErr("AFE FROM FILE Read Check Fail: 0x%04x[%d:%d] = 0x%04x\n", spiaddr, rec[3], rec[4], rec[5]);
+                run->errorStatus |= 1;
+                if (run->breakAtReadCheckFail)
+                    run->stop = 1;
+            }
+            break;
+        case AFE_SCRIPT_OP_POLL:
+            if (afeSpiPollLogWrapper(run->afeId, spiaddr, rec[3], rec[4], rec[5]) != RET_OK)
+            {
+                afeLogErr("AFE FROM FILE POLL Failed: 0x%04x[%d:%d] = 0x%04x\n", spiaddr, rec[3], rec[4], rec[5]);
+                run->errorStatus |= 1;
+                if (run->breakAtPollFail)
+                    run->stop = 1;
+            }
+            break;
+        default:
+            returnVal = waitMs(afeScriptGet32(rec + 1));
+            afeLogDbg("AFE FROM FILE WAIT: %d ms\n", afeScriptGet32(rec + 1));
+            break;
+        }
+        /* Like the text loaders, an SPI error stops the script. */
+        if (returnVal != RET_OK)
+        {
+            run->errorStatus |= 1;
+            run->stop = 1;
+        }
+    }
+    run->execTimeUs += getTimeUs() - start;
+    return pos;
+}
+
+static void afeScriptRunInit(AfeScriptRun_t *run, uint8_t afeId, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail)
+{
+    memset(run, 0, sizeof(AfeScriptRun_t));
+    run->afeId = afeId;
+    run->breakAtPollFail = breakAtPollFail;
+    run->breakAtReadCheckFail = breakAtReadCheckFail;
+}
+
+static int8_t afeScriptRunDone(AfeScriptRun_t *run, uint32_t recordCount, uint64_t start, uint32_t *parseTimeUs, uint32_t *spiTimeUs)
+{
+    uint64_t total;
+    if (!run->stop)
+        afeScriptFlushBatch(run);
+    total = getTimeUs() - start;
+    if (!run->stop && run->records != recordCount)
+    {
+        afeLogErr("Compiled script has %d records, header says %d.", run->records, recordCount);
+        run->errorStatus |= 1;
+    }
+    if (parseTimeUs != NULL)
+        *parseTimeUs = (uint32_t)(total - run->execTimeUs);
+    if (spiTimeUs != NULL)
+        *spiTimeUs = (uint32_t)run->execTimeUs;
+    afeLogInfo("Compiled script: %d records, parse %d us, SPI %d us", run->records, (uint32_t)(total - run->execTimeUs), (uint32_t)run->execTimeUs);
+    if (run->errorStatus)
+        return RET_EXEC_FAIL;
+    else
+        return RET_OK;
+}
+
+/**
+    @brief Bringup function configuration function from a compiled script in memory.
+    @details Executes a script made by compileAfeScript from a memory image, for example a mapped file or a table in flash. The header and payload checksums are checked before anything is executed.
+    @param afeId AFE ID
+    @param image Start of the compiled script.
+    @param imageLen Length of image in bytes.
+    @param breakAtPollFail If this is 0, then configuration will continue when some poll fails. If it is 1, configuration will stop when some poll fails. 
+    @param breakAtReadCheckFail If this is 0, then configuration will continue when some SPI Read Check fails. If it is 1, configuration will stop when some SPI Read Checks fails. 
+    @param parseTimeUs Pointer returning the time spent on everything except the SPI accesses and waits, in micro seconds. Can be NULL.
+    @param spiTimeUs Pointer returning the time spent executing the records, SPI accesses and waits, in micro seconds. Can be NULL.
+    @return Returns if AFE initialization passed or failed.
+*/
+int8_t configAfeFromBinaryBuffer(uint8_t afeId, const uint8_t *image, uint32_t imageLen, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint32_t *parseTimeUs, uint32_t *spiTimeUs)
+{
+    uint8_t errorStatus = 0;
+    AfeScriptRun_t run;
+    uint32_t recordCount, payloadLen, checksum;
+    uint64_t start = getTimeUs();
+
+    AFE_PARAMS_VALID((image != NULL) && (imageLen >= AFE_SCRIPT_HEADER_LEN));
+    AFE_FUNC_EXEC(afeScriptCheckHeader(image, &recordCount, &payloadLen, &checksum));
+    if (payloadLen != imageLen - AFE_SCRIPT_HEADER_LEN || checksum != afeScriptChecksum(2166136261u, image + AFE_SCRIPT_HEADER_LEN, payloadLen))
+    {
+        afeLogErr("%s", "Compiled script payload is truncated or corrupted.");
+        return RET_EXEC_FAIL;
+    }
+    afeScriptRunInit(&run, afeId, breakAtPollFail, breakAtReadCheckFail);
+    afeScriptExecute(&run, image + AFE_SCRIPT_HEADER_LEN, payloadLen);
+    return afeScriptRunDone(&run, recordCount, start, parseTimeUs, spiTimeUs);
+}
+
+/**
+    @brief Bringup function configuration function from a compiled script file.
+    @details Executes a script made by compileAfeScript. The file is streamed in fixed size chunks, so no buffer of the script size is needed. The checksums are verified in a first pass before anything is executed.
+    @param afeId AFE ID
+    @param file Path of the compiled script.
+    @param breakAtPollFail If this is 0, then configuration will continue when some poll fails. If it is 1, configuration will stop when some poll fails. 
+    @param breakAtReadCheckFail If this is 0, then configuration will continue when some SPI Read Check fails. If it is 1, configuration will stop when some SPI Read Checks fails. 
+    @param parseTimeUs Pointer returning the time spent reading and checking the file, in micro seconds. Can be NULL.
+    @param spiTimeUs Pointer returning the time spent executing the records, SPI accesses and waits, in micro seconds. Can be NULL.
+    @return Returns if AFE initialization passed or failed.
+*/
+int8_t configAfeFromBinary(uint8_t afeId, char *file, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint32_t *parseTimeUs, uint32_t *spiTimeUs)
+{
+    AFE_PARAMS_VALID(file != NULL);
+
+    AfeScriptRun_t run;
+    uint8_t buf[AFE_SCRIPT_CHUNK_LEN];
+    uint32_t recordCount;
+    uint32_t bufLen = 0;
+    uint32_t used;
+    size_t readLen;
+    uint64_t start = getTimeUs();
+    FILE *fp = afeScriptOpenVerified(file, &recordCount);
+    if (NULL == fp)
+        return RET_EXEC_FAIL;
+
+    afeScriptRunInit(&run, afeId, breakAtPollFail, breakAtReadCheckFail);
+    while (!run.stop && (readLen = fread(buf + bufLen, 1, sizeof(buf) - bufLen, fp)) > 0)
+    {
+        bufLen += (uint32_t)readLen;
+        used = afeScriptExecute(&run, buf, bufLen);
+        /* Keep the cut record for the next chunk. */
+        memmove(buf, buf + used, bufLen - used);
+        bufLen -= used;
+    }
+    fclose(fp);
+    if (!run.stop && bufLen != 0)
+    {
+        afeLogErr("Compiled script %s ends in the middle of a record.", file);
+        run.errorStatus |= 1;
+    }
+    return afeScriptRunDone(&run, recordCount, start, parseTimeUs, spiTimeUs);
+}
+
+/* SPI transactions a record costs, without page selects. A field write is a read and a write. */
+static uint8_t afeScriptRecordCost(const uint8_t *rec)
+{
+    if (rec[0] == AFE_SCRIPT_OP_WRITE)
+        return (rec[4] == 0 && rec[5] == 7) ? 1 : 2;
+    if (rec[0] == AFE_SCRIPT_OP_WRITE_MASK)
+        return (rec[4] == 0xFF) ? 1 : 2;
+    if (rec[0] == AFE_SCRIPT_OP_WAIT)
+        return 0;
+    return 1;
+}
+
+static uint8_t afeScriptIsPageReg(uint16_t addr)
+{
+    return (addr >= AFE_PAGE_START_ADDR) && (addr <= AFE_PAGE_END_ADDR);
+}
+
+static void afeScriptOptEmit(AfeScriptOptimizer_t *opt, const uint8_t *rec)
+{
+    afeScriptWriterPut(opt->writer, rec);
+    opt->transactionsOut += afeScriptRecordCost(rec);
+}
+
+static void afeScriptOptFlush(AfeScriptOptimizer_t *opt)
+{
+    uint8_t rec[AFE_SCRIPT_MAX_RECORD_LEN];
+    uint8_t lsb, fieldBits;
+
+    for (uint16_t i = 0; i < opt->numPending; i++)
+    {
+        AfeScriptPendingWrite_t *w = &opt->pending[i];
+        if (!w->alive)
+            continue;
+        if (afeScriptIsPageReg(w->addr) && (opt->flags & AFE_SCRIPT_OPT_PAGE_SELECTS))
+        {
+            uint8_t page = (uint8_t)(w->addr - AFE_PAGE_START_ADDR);
+            uint8_t value = (opt->pageValue[page] & (0xFF ^ w->mask)) | (w->data & w->mask);
+            /* The page is already selected by the script, the write changes nothing. */
+            if (opt->pageKnown[page] && value == opt->pageValue[page])
+            {
+                opt->pageWrites++;
+                continue;
+            }
+            opt->pageKnown[page] = opt->pageKnown[page] || (w->mask == 0xFF);
+            opt->pageValue[page] = value;
+        }
+        afeScriptPut16(rec + 1, w->addr);
+        rec[3] = w->data;
+        for (lsb = 0; !(w->mask & (1 << lsb)); lsb++)
+        {
+        }
+        fieldBits = w->mask >> lsb;
+        if ((fieldBits & (fieldBits + 1)) == 0)
+        {
+            rec[0] = AFE_SCRIPT_OP_WRITE;
+            rec[4] = lsb;
+            for (rec[5] = lsb; fieldBits > 1; fieldBits >>= 1)
+                rec[5]++;
+        }
+        else
+        {
+            rec[0] = AFE_SCRIPT_OP_WRITE_MASK;
+            rec[4] = w->mask;
+        }
+        afeScriptOptEmit(opt, rec);
+    }
+    opt->numPending = 0;
+}
+
+static void afeScriptOptAddWrite(AfeScriptOptimizer_t *opt, uint16_t addr, uint8_t data, uint8_t mask)
+{
+    AfeScriptPendingWrite_t *w;
+    int32_t i;
+
+    if (afeScriptIsPageReg(addr))
+    {
+        /* A page select followed only by other page selects was never used, the last one wins. */
+        for (i = opt->numPending - 1; (mask == 0xFF) && (opt->flags & AFE_SCRIPT_OPT_PAGE_SELECTS) && i >= 0; i--)
+        {
+            w = &opt->pending[i];
+            if (!w->alive)
+                continue;
+            if (!afeScriptIsPageReg(w->addr))
+                break;
+            if (w->addr == addr)
+            {
+                w->alive = 0;
+                opt->pageWrites++;
+            }
+        }
+    }
+    else if (opt->flags & AFE_SCRIPT_OPT_DEAD_WRITES)
+    {
+        /* Earlier writes whose bits are all written again. A page select changes what addr means, so stop there. */
+        for (i = opt->numPending - 1; i >= 0; i--)
+        {
+            w = &opt->pending[i];
+            if (!w->alive)
+                continue;
+            if (afeScriptIsPageReg(w->addr))
+                break;
+            if (w->addr == addr && (w->mask & (0xFF ^ mask)) == 0)
+            {
+                w->alive = 0;
+                opt->deadWrites++;
+            }
+        }
+    }
+
+    if (opt->flags & AFE_SCRIPT_OPT_MERGE_FIELDS)
+    {
+        /* Fields of the same byte written back to back become one access. Overlapping fields are kept apart, a
+           bit written twice may be a pulse. */
+        for (i = opt->numPending - 1; i >= 0 && !opt->pending[i].alive; i--)
+        {
+        }
+        if (i >= 0 && opt->pending[i].addr == addr && (opt->pending[i].mask & mask) == 0)
+        {
+            w = &opt->pending[i];
+            w->data = (w->data & (0xFF ^ mask)) | (data & mask);
+            w->mask |= mask;
+            opt->mergedWrites++;
+            return;
+        }
+    }
+
+    if (opt->numPending == AFE_SPI_BATCH_MAX_LEN)
+        afeScriptOptFlush(opt);
+    w = &opt->pending[opt->numPending++];
+    w->addr = addr;
+    w->data = data & mask;
+    w->mask = mask;
+    w->alive = 1;
+}
+
+/* Runs the complete records in buf through the optimizer and returns how many bytes were used. */
+static uint32_t afeScriptOptimizeChunk(AfeScriptOptimizer_t *opt, const uint8_t *buf, uint32_t len, uint8_t *invalid)
+{
+    uint32_t pos = 0;
+
+    while (pos < len)
+    {
+        const uint8_t *rec = buf + pos;
+        if (rec[0] == 0 || rec[0] > AFE_SCRIPT_OP_LAST)
+        {
+            afeLogErr("Invalid opcode 0x%x in compiled script.", rec[0]);
+            *invalid = 1;
+            break;
+        }
+        if (pos + afeScriptRecordLen[rec[0]] > len)
+            break;
+        pos += afeScriptRecordLen[rec[0]];
+        opt->transactionsIn += afeScriptRecordCost(rec);
+        if (rec[0] == AFE_SCRIPT_OP_WRITE && rec[5] < 8 && rec[4] <= rec[5])
+        {
+            uint8_t mask = (uint8_t)(((1 << (rec[5] + 1)) - 1) & (0xFF << rec[4]));
+            afeScriptOptAddWrite(opt, afeScriptGet16(rec + 1), rec[3], mask);
+        }
+        else if (rec[0] == AFE_SCRIPT_OP_WRITE_MASK && rec[4] != 0)
+            afeScriptOptAddWrite(opt, afeScriptGet16(rec + 1), rec[3], rec[4]);
+        else
+        {
+            /* Reads, checks, polls, waits and anything the optimizer doesn't understand keep their place. */
+            afeScriptOptFlush(opt);
+            afeScriptOptEmit(opt, rec);
+        }
+    }
+    return pos;
+}
+
+/**
+    @brief Optimizes a compiled bring-up script.
+    @details Rewrites a script made by compileAfeScript with fewer SPI transactions. Reads, checks, polls and waits see the same register state as in the original script. The passes are selected by flags:<br>
+            AFE_SCRIPT_OPT_MERGE_FIELDS : Field writes to the same address that follow each other and don't overlap become one write. If they cover the whole byte the read of the read-modify-write is gone too.<br>
+            AFE_SCRIPT_OPT_PAGE_SELECTS : Page selects that are replaced before any other access are dropped, and so are page selects that write the page already selected.<br>
+            AFE_SCRIPT_OPT_DEAD_WRITES : Writes whose bits are all written again before the next read, check, poll, wait or page select are dropped. This is not safe for self clearing or trigger bits, so it is not part of AFE_SCRIPT_OPT_SAFE.<br>
+            A report of the removed transactions is logged at info level.
+    @param binFile Path of the compiled script.
+    @param optFile Path of the optimized script to be written. Must not be binFile.
+    @param flags Passes to run, see above.
+    @param removedTransactions Pointer returning the number of SPI transactions removed. Can be NULL.
+    @return Returns if the function execution passed or failed.
+*/
+int8_t optimizeAfeScript(char *binFile, char *optFile, uint32_t flags, uint32_t *removedTransactions)
+{
+    AFE_PARAMS_VALID((binFile != NULL) && (optFile != NULL) && (strcmp(binFile, optFile) != 0));
+
+    AfeScriptOptimizer_t opt;
+    AfeScriptWriter_t writer;
+    uint8_t buf[AFE_SCRIPT_CHUNK_LEN];
+    uint32_t recordCount;
+    uint32_t bufLen = 0;
+    uint32_t used;
+    uint8_t invalid = 0;
+    size_t readLen;
+
+    FILE *fp = afeScriptOpenVerified(binFile, &recordCount);
+    if (NULL == fp)
+        return RET_EXEC_FAIL;
+    if (NULL == afeScriptWriterOpen(&writer, optFile))
+    {
+        printf("File open error.\n");
+        fclose(fp);
+        return RET_EXEC_FAIL;
+    }
+    memset(&opt, 0, sizeof(opt));
+    opt.flags = flags;
+    opt.writer = &writer;
+    while (!invalid && (readLen = fread(buf + bufLen, 1, sizeof(buf) - bufLen, fp)) > 0)
+    {
+        bufLen += (uint32_t)readLen;
+        used = afeScriptOptimizeChunk(&opt, buf, bufLen, &invalid);
+        memmove(buf, buf + used, bufLen - used);
+        bufLen -= used;
+    }
+    afeScriptOptFlush(&opt);
+    fclose(fp);
+    if (afeScriptWriterClose(&writer) != RET_OK || invalid || bufLen != 0)
+    {
+        afeLogErr("Optimizing compiled script %s failed", binFile);
+        return RET_EXEC_FAIL;
+    }
+    if (removedTransactions != NULL)
+        *removedTransactions = opt.transactionsIn - opt.transactionsOut;
+    afeLogInfo("Script optimizer: %d records to %d, SPI transactions %d to %d (%d removed)", recordCount, writer.recordCount, opt.transactionsIn, opt.transactionsOut, opt.transactionsIn - opt.transactionsOut);
+    afeLogInfo("Script optimizer: merged field writes %d, page selects removed %d, dead writes removed %d", opt.mergedWrites, opt.pageWrites, opt.deadWrites);
+    return RET_OK;
+}
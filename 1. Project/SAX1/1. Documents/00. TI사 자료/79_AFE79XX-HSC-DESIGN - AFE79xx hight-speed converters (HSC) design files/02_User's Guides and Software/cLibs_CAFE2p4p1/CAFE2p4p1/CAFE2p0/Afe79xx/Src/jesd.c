@@ -12,6 +12,7 @@
 */
 ////DACJESD
 #include <stdint.h>
+#include <string.h>
 #include <afe79xxLog.h>
 #include <afe79xxTypes.h>
 
@@ -371,107 +372,117 @@ uint8_t getJesdRxLinkStatus(uint8_t afeId, uint16_t *linkStatus)
 		return RET_OK;
 }
 
-/**
-    @brief Read Link Status for for DAC JESD204B.
-    @details Reads link status for all the enabled lanes and returns it.
-    @param afeId AFE ID
-	@param linkStatus Pointer return of the status.<br>
-				Return Value is 4 bits. 2 bits for top 4 lanes and 2 bits for bottom 4 lanes.<br>
-						=0 Idle state. No change in state.<br>
-						=1 In JESD204B: CGS Passed. Still in K characters mode. In JESD204C:Header Aligned but EoEMB lock yet to happen. <br>
-						=2 Link is up.
-	@return Returns if the function execution passed or failed.
-*/
-uint8_t getJesdRxLinkStatus204B(uint8_t afeId, uint16_t *linkStatus)
+/* Reads the lane enables and the lane states of both the DAC JESD instances.
+   An enabled lane first passes CS (2 per lane), then reaches FS (1 per lane) in JESD204B or aligns the EMB (buffer state 3 per lane) in JESD204C. */
+static uint8_t jesdRxReadLinkState(uint8_t afeId, uint8_t is204C, AfeJesdRxLinkState_t *state)
 {
-	/* 
-		Reads the lane enables and accordingly returns the status of the link 
-		Return Value is 4 bits. 2 bits for top 4 lanes and 2 bits for bottom 4 lanes.
-						=0 Idle state. No change in state.
-						=1 CGS Passed. Still in K characters mode.
-						=2 Link is up.
-	*/
 	uint8_t errorStatus = 0;
-	AFE_ID_VALIDITY();
-	AFE_PARAMS_VALID(linkStatus != NULL);
-	uint8_t laneEna0, laneEna1;
-	uint8_t csState0, csState1;
-	uint8_t expectedCsState0, expectedCsState1;
-	uint8_t expectedFsState0, expectedFsState1;
-	uint8_t fsState0, fsState1;
-	uint8_t linkStatus0, linkStatus1;
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x04, 0x0, 0x7));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x64, 0x0, 0x7, &laneEna0));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa2, 0x0, 0x7, &csState0));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa4, 0x0, 0x7, &fsState0));
-
-	expectedCsState0 = 0;
-	expectedFsState0 = 0;
-	for (uint8_t i = 0; i < 4; i++)
+	uint8_t laneFsState = is204C ? 3 : 1;
+	uint8_t expectedCsState, expectedFsState;
+	uint8_t linkStatus;
+
+	memset(state, 0, sizeof(AfeJesdRxLinkState_t));
+	for (uint8_t jesdNo = 0; jesdNo < AFE_NUM_JESD_INSTANCES; jesdNo++)
 	{
-		if (((laneEna0 >> i) & 1) != 0)
+		AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x04 << jesdNo, 0x0, 0x7));
+		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x64, 0x0, 0x7, &state->laneEna[jesdNo]));
+		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa2, 0x0, 0x7, &state->csState[jesdNo]));
+		AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, is204C ? 0xa6 : 0xa4, 0x0, 0x7, &state->fsState[jesdNo]));
+
+		expectedCsState = 0;
+		expectedFsState = 0;
+		for (uint8_t i = 0; i < 4; i++)
 		{
-			expectedCsState0 = expectedCsState0 + (2 << (i << 1));
-			expectedFsState0 = expectedFsState0 + (1 << (i << 1));
+			if (((state->laneEna[jesdNo] >> i) & 1) != 0)
+			{
+				expectedCsState = expectedCsState + (2 << (i << 1));
+				expectedFsState = expectedFsState + (laneFsState << (i << 1));
+				if ((((state->csState[jesdNo] >> (i << 1)) & 3) == 2) && (((state->fsState[jesdNo] >> (i << 1)) & 3) == laneFsState))
+				{
+					state->laneUp |= 1 << (i + (jesdNo << 2));
+				}
+			}
 		}
-	}
-
-	if (expectedCsState0 == csState0)
-	{
-		if (expectedFsState0 == fsState0)
+		if (expectedCsState != state->csState[jesdNo])
+		{
+			linkStatus = 0;
+		}
+		else if (expectedFsState != state->fsState[jesdNo])
 		{
-			linkStatus0 = 2;
-			afeLogInfo("%s", "DAC JESD RX AB. Link is Up.");
+			linkStatus = 1;
 		}
 		else
 		{
-			linkStatus0 = 1;
-			afeLogErr("%s", "DAC JESD RX AB. Link Not Up. Passed CS State but failed FS State. Probably still receiving K Characters");
+			linkStatus = 2;
 		}
+		state->linkStatus |= linkStatus << (jesdNo << 1);
 	}
-	else
-	{
-		linkStatus0 = 0;
-		afeLogErr("%s", "DAC JESD RX AB. Link Not Up. Didn't pass CS State.");
-	}
-
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x08, 0x0, 0x7));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x64, 0x0, 0x7, &laneEna1));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa2, 0x0, 0x7, &csState1));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa4, 0x0, 0x7, &fsState1));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x00, 0x0, 0x7));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
 
-	expectedCsState1 = 0;
-	expectedFsState1 = 0;
-	for (uint8_t i = 0; i < 4; i++)
+static void jesdRxLogLinkStatus(uint8_t linkStatus, const char *notAlignedMsg)
+{
+	for (uint8_t jesdNo = 0; jesdNo < AFE_NUM_JESD_INSTANCES; jesdNo++)
 	{
-		if (((laneEna1 >> i) & 1) != 0)
+		const char *jesdName = (jesdNo == 0) ? "AB" : "CD";
+		switch ((linkStatus >> (jesdNo << 1)) & 3)
 		{
-			expectedCsState1 = expectedCsState1 + (2 << (i << 1));
-			expectedFsState1 = expectedFsState1 + (1 << (i << 1));
+		case 2:
+			afeLogInfo("DAC JESD RX %s. Link is Up.", jesdName);
+			break;
+		case 1:
+			afeLogErr("DAC JESD RX %s. Link Not Up. Passed CS State but %s", jesdName, notAlignedMsg);
+			break;
+		default:
+			afeLogErr("DAC JESD RX %s. Link Not Up. Didn't pass CS State.", jesdName);
+			break;
 		}
 	}
+}
 
-	if (expectedCsState1 == csState1)
-	{
-		if (expectedFsState1 == fsState1)
-		{
-			linkStatus1 = 2;
-			afeLogInfo("%s", "DAC JESD RX CD. Link is Up.");
-		}
-		else
-		{
-			linkStatus1 = 1;
-			afeLogErr("%s", "DAC JESD RX CD. Link Not Up. Passed CS State but failed FS State. Probably still receiving K Characters");
-		}
-	}
+/**
+    @brief Read Lane States for DAC JESD.
+    @details Reads the lane enables and the per lane CS and FS states of both the DAC JESD instances, without logging them. The register read depends on systemParams[afeId].jesdProtocol.
+    @param afeId AFE ID
+	@param state Pointer return of the lane states. state->linkStatus is the value returned by getJesdRxLinkStatus and state->laneUp has a bit per lane which is enabled and up.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getJesdRxLinkState(uint8_t afeId, AfeJesdRxLinkState_t *state)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(state != NULL);
+	AFE_FUNC_EXEC(jesdRxReadLinkState(afeId, systemParams[afeId].jesdProtocol != 0, state));
+	if (errorStatus)
+		return RET_EXEC_FAIL;
 	else
-	{
-		linkStatus1 = 0;
-		afeLogErr("%s", "DAC JESD RX CD. Link Not Up. Didn't pass CS State.");
-	}
+		return RET_OK;
+}
 
-	*linkStatus = ((linkStatus1 << 2) + linkStatus0);
+/**
+    @brief Read Link Status for for DAC JESD204B.
+    @details Reads link status for all the enabled lanes and returns it.
+    @param afeId AFE ID
+	@param linkStatus Pointer return of the status.<br>
+				Return Value is 4 bits. 2 bits for top 4 lanes and 2 bits for bottom 4 lanes.<br>
+						=0 Idle state. No change in state.<br>
+						=1 In JESD204B: CGS Passed. Still in K characters mode. In JESD204C:Header Aligned but EoEMB lock yet to happen. <br>
+						=2 Link is up.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t getJesdRxLinkStatus204B(uint8_t afeId, uint16_t *linkStatus)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(linkStatus != NULL);
+	AfeJesdRxLinkState_t state;
+	AFE_FUNC_EXEC(jesdRxReadLinkState(afeId, 0, &state));
+	jesdRxLogLinkStatus(state.linkStatus, "failed FS State. Probably still receiving K Characters");
+	*linkStatus = state.linkStatus;
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -491,96 +502,13 @@ uint8_t getJesdRxLinkStatus204B(uint8_t afeId, uint16_t *linkStatus)
 */
 uint8_t getJesdRxLinkStatus204C(uint8_t afeId, uint16_t *linkStatus)
 {
-	/*
-		Reads the lane enables and accordingly returns the status of the link 
-		Return Value is 4 bits. 2 bits for top 4 lanes and 2 bits for bottom 4 lanes.
-						=0 Idle state. No change in state.
-						=1 Header Aligned but EoEMB lock yet to happen.
-						=2 Link is up.
-	*/
 	uint8_t errorStatus = 0;
 	AFE_ID_VALIDITY();
 	AFE_PARAMS_VALID(linkStatus != NULL);
-	uint8_t laneEna0, laneEna1;
-	uint8_t csState0, csState1;
-	uint8_t expectedCsState0, expectedCsState1;
-	uint8_t expectedBufState0, expectedBufState1;
-	uint8_t bufState0, bufState1;
-	uint8_t linkStatus0, linkStatus1;
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x04, 0x0, 0x7));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x64, 0x0, 0x7, &laneEna0));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa2, 0x0, 0x7, &csState0));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa6, 0x0, 0x7, &bufState0));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x00, 0x0, 0x7));
-
-	expectedCsState0 = 0;
-	expectedBufState0 = 0;
-
-	for (uint8_t i = 0; i < 4; i++)
-	{
-		if (((laneEna0 >> i) & 1) != 0)
-		{
-			expectedCsState0 = expectedCsState0 + (2 << (i << 1));
-			expectedBufState0 = expectedBufState0 + (3 << (i << 1));
-		}
-	}
-
-	if (expectedCsState0 == csState0)
-	{
-		if (expectedBufState0 == bufState0)
-		{
-			linkStatus0 = 2;
-			afeLogInfo("%s", "DAC JESD RX AB. Link is Up.");
-		}
-		else
-		{
-			linkStatus0 = 1;
-			afeLogErr("%s", "DAC JESD RX AB. Link Not Up. Passed CS State but failed EMB alignment.");
-		}
-	}
-	else
-	{
-		linkStatus0 = 0;
-		afeLogErr("%s", "DAC JESD RX AB. Link Not Up. Didn't pass CS State.");
-	}
-
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x08, 0x0, 0x7));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x64, 0x0, 0x7, &laneEna1));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa2, 0x0, 0x7, &csState1));
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0xa6, 0x0, 0x7, &bufState1));
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x0016, 0x00, 0x0, 0x7));
-
-	expectedCsState1 = 0;
-	expectedBufState1 = 0;
-	for (uint8_t i = 0; i < 4; i++)
-	{
-		if (((laneEna1 >> i) & 1) != 0)
-		{
-			expectedCsState1 = expectedCsState1 + (2 << (i << 1));
-			expectedBufState1 = expectedBufState1 + (3 << (i << 1));
-		}
-	}
-
-	if (expectedCsState1 == csState1)
-	{
-		if (expectedBufState1 == bufState1)
-		{
-			linkStatus1 = 2;
-			afeLogInfo("%s", "DAC JESD RX CD. Link is Up.");
-		}
-		else
-		{
-			linkStatus1 = 1;
-			afeLogErr("%s", "DAC JESD RX CD. Link Not Up. Passed CS State but failed EMB alignment.");
-		}
-	}
-	else
-	{
-		linkStatus1 = 0;
-		afeLogErr("%s", "DAC JESD RX CD. Link Not Up. Didn't pass CS State.");
-	}
-
-	*linkStatus = ((linkStatus1 << 2) + linkStatus0);
+	AfeJesdRxLinkState_t state;
+	AFE_FUNC_EXEC(jesdRxReadLinkState(afeId, 1, &state));
+	jesdRxLogLinkStatus(state.linkStatus, "failed EMB alignment.");
+	*linkStatus = state.linkStatus;
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 
 #include "afe79xxLog.h"
 #include "afe79xxTypes.h"
@@ -376,87 +377,96 @@ uint8_t rampStickyClear(uint8_t afeId, uint8_t chno)
 }
 
 /**
-    @brief Reads the PAP alarm Status
-    @details Reads the PAP alarm Status and returns it as a pointer. This is sticky status and clearPapAlarms needs to be called to clear the status.
+    @brief Reads the PAP alarm Status as bits
+    @details Reads the cause bits of the PAP alarm Status without logging them. This is sticky status and clearPapAlarms needs to be called to clear the status.
     @param afeId AFE ID
 	@param chno Select the TX Channel<br>
 			0 for TXA<br>
 			1 for TXB<br>
 			2 for TXC<br>
 			3 for TXD
-	@param alarmTriggered Pointer return of the status. If this value is 1, then there was a PAP trigger.
+	@param status Pointer return of the status. txAlarm has the AFE_PAP_TX_ALARM_* bits, papAlarm the PAP triggered per TX and detector the AFE_PAP_DET_* bits.
 	@return Returns if the function execution passed or failed.
 */
-uint8_t papAlarmStatus(uint8_t afeId, uint8_t chno, uint8_t *alarmTriggered)
+uint8_t papGetAlarmStatus(uint8_t afeId, uint8_t chno, AfePapAlarmStatus_t *status)
 {
 	uint8_t errorStatus = 0;
 	AFE_ID_VALIDITY();
 	AFE_PARAMS_VALID(chno < AFE_NUM_TX_CHANNELS);
-	AFE_PARAMS_VALID(alarmTriggered != NULL);
-	uint16_t errorRead = 0;
+	AFE_PARAMS_VALID(status != NULL);
 	uint8_t errorRead_lsb, errorRead_msb;
-	*alarmTriggered = 0;
+	memset(status, 0, sizeof(AfePapAlarmStatus_t));
 	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x19, (1 << (chno + 4)) & 0xff, 0x0, 0x7)); /*txdig*/
 
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x55c, 0x0, 0x7, &errorRead_lsb));
 	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x55d, 0x0, 0x2, &errorRead_msb));
-	errorRead = (errorRead_msb << 8) + errorRead_lsb; /*txa_pap_alarm_sts;*/
-	if ((errorRead & 1) != 0)
+	status->txAlarm = (errorRead_msb << 8) + errorRead_lsb; /*txa_pap_alarm_sts;*/
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x558, 0x0, 0x7, &status->papAlarm)); /*pap_alarm_sts;	# refer dml for description*/
+	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x584, 0x0, 0x7, &status->detector)); /*pap_alarm_sts;	# refer dml for description*/
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x19, 0x0, 0x0, 0x7));
+
+	status->triggered = ((status->txAlarm & AFE_PAP_TX_ALARM_ALL) != 0) || ((status->papAlarm & AFE_NUM_TX_CHANNELS_BITWISE) != 0) ||
+						((status->detector & (AFE_PAP_DET_MOVING_AVERAGE | AFE_PAP_DET_HPF)) != 0);
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/**
+    @brief Reads the PAP alarm Status
+    @details Reads the PAP alarm Status, logs the causes and returns it as a pointer. This is sticky status and clearPapAlarms needs to be called to clear the status.<br>
+		papGetAlarmStatus returns the causes without logging them.
+    @param afeId AFE ID
+	@param chno Select the TX Channel<br>
+			0 for TXA<br>
+			1 for TXB<br>
+			2 for TXC<br>
+			3 for TXD
+	@param alarmTriggered Pointer return of the status. If this value is 1, then there was a PAP trigger.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t papAlarmStatus(uint8_t afeId, uint8_t chno, uint8_t *alarmTriggered)
+{
+	uint8_t errorStatus = 0;
+	AFE_PARAMS_VALID(alarmTriggered != NULL);
+	AfePapAlarmStatus_t status;
+	*alarmTriggered = 0;
+	AFE_FUNC_EXEC(papGetAlarmStatus(afeId, chno, &status));
+
+	if ((status.txAlarm & AFE_PAP_TX_ALARM_PLL) != 0)
 	{
 		afeLogErr("%s", "PLL Alarm Triggered");
-		*alarmTriggered = 1;
 	}
-	if ((errorRead & 0x20) != 0)
+	if ((status.txAlarm & AFE_PAP_TX_ALARM_JESD_SERDES) != 0)
 	{
 		afeLogErr("%s", "JESD-SerDes Alarm Triggered");
-		*alarmTriggered = 1;
 	}
-	if ((errorRead & 0x40) != 0)
+	if ((status.txAlarm & AFE_PAP_TX_ALARM_ASYNC_FIFO) != 0)
 	{
 		afeLogErr("%s", "Async FIFO Overflow Alarm Triggered");
-		*alarmTriggered = 1;
 	}
-	if ((errorRead & 0x80) != 0)
+	if ((status.txAlarm & AFE_PAP_TX_ALARM_SATURATION) != 0)
 	{
 		afeLogErr("%s", "Saturation Overflow Alarm Triggered");
-		*alarmTriggered = 1;
-	}
-
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x558, 0x0, 0x7, &errorRead_lsb)); /*pap_alarm_sts;	# refer dml for description*/
-	if ((errorRead_lsb & 1) != 0)
-	{
-		afeLogErr("%s", "TXA PAP Triggered");
-		*alarmTriggered = 1;
-	}
-	if ((errorRead_lsb & 0x2) != 0)
-	{
-		afeLogErr("%s", "TXB PAP Triggered");
-		*alarmTriggered = 1;
-	}
-	if ((errorRead_lsb & 0x4) != 0)
-	{
-		afeLogErr("%s", "TXC PAP Triggered");
-		*alarmTriggered = 1;
 	}
-	if ((errorRead_lsb & 0x8) != 0)
+	for (uint8_t txNo = 0; txNo < AFE_NUM_TX_CHANNELS; txNo++)
 	{
-		afeLogErr("%s", "TXD PAP Triggered");
-		*alarmTriggered = 1;
+		if (((status.papAlarm >> txNo) & 1) != 0)
+		{
+			afeLogErr("TX%c PAP Triggered", 'A' + txNo);
+		}
 	}
-
-	AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, 0x584, 0x0, 0x7, &errorRead_lsb)); /*pap_alarm_sts;	# refer dml for description*/
-	if ((errorRead_lsb & 1) != 0)
+	if ((status.detector & AFE_PAP_DET_MOVING_AVERAGE) != 0)
 	{
 		afeLogErr("%s", "Moving Average Mode Detector Triggered");
-		*alarmTriggered = 1;
 	}
-	if ((errorRead_lsb & 0x2) != 0)
+	if ((status.detector & AFE_PAP_DET_HPF) != 0)
 	{
 		afeLogErr("%s", "HPF Mode Detector Triggered");
-		*alarmTriggered = 1;
 	}
+	*alarmTriggered = status.triggered;
 
-	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x19, 0x0, 0x0, 0x7));
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
@@ -10,6 +10,8 @@
  */
 
 #include <stdint.h>
+#include <string.h>
+#include <stdio.h>
 #include "afe79xxLog.h"
 #include "afe79xxTypes.h"
 #include "afeCommonMacros.h"
@@ -375,24 +377,10 @@ uint8_t reAdaptSerDesAllLanes(uint8_t afeId)
 		return RET_OK;
 }
 
-/**
-    @brief Checks the status of the SerDes Eye Read.
-    @details Checks the status of the SerDes Eye Read. This function is called getSerdesEye and shouldn't be called independently.
-    @param afeId AFE ID
-	@return Returns if the function execution passed or failed.
-*/
-uint8_t parse_response(uint8_t afeId, uint16_t *responseRet)
+/*  Decodes the error and information codes of an eye monitor response.   */
+static uint8_t emResponseCheck(uint16_t response)
 {
-	uint16_t response = 0;
 	uint8_t errorStatus = 0;
-	while (1)
-	{
-		AFE_FUNC_EXEC(serdesRawRead(afeId, 0x9815, &response));
-		if (response >> 12 == 0)
-		{
-			break;
-		}
-	}
 	uint8_t status = (response >> 8) & 0xf;
 	uint8_t data = response & 0xff;
 	if (status == 0x3)
@@ -425,13 +413,217 @@ uint8_t parse_response(uint8_t afeId, uint16_t *responseRet)
 			afeLogInfo("%d", data);
 		}
 	}
-	*responseRet = response;
 	if (errorStatus)
 		return RET_EXEC_FAIL;
 	else
 		return RET_OK;
 }
 
+/*  SerDes eye monitor mailbox. The command is written to 0x9815 with its argument in 0x9816, bits 15:12 of 0x9815 read back non-zero until the response is there.   */
+#define AFE_SERDES_MAILBOX_CMD_ADDR 0x9815
+#define AFE_SERDES_MAILBOX_ARG_ADDR 0x9816
+/*  Time a command may take before it is reported as failed.   */
+#define AFE_SERDES_MAILBOX_TIMEOUT_MS 500
+/*  Back-to-back response reads before waiting, the most back-to-back reads of a command, and the longest wait between reads.
+	The limit on the reads keeps the spin bounded when getTimeUs doesn't advance.   */
+#define AFE_SERDES_MAILBOX_SPIN_READS 4
+#define AFE_SERDES_MAILBOX_MAX_SPIN_READS 32
+#define AFE_SERDES_MAILBOX_BACKOFF_MAX_MS 8
+
+typedef struct AFE_SERDES_MAILBOX_STATS
+{
+	uint32_t count;
+	uint32_t timeouts;
+	uint32_t reads;
+	uint32_t maxUs;
+	uint64_t totalUs;
+} AfeSerdesMailboxStats_t;
+
+static AfeSerdesMailboxStats_t afeSerdesMailboxStats[NUM_OF_AFE][AFE_SERDES_MAILBOX_NUM_CMDS];
+
+static uint8_t serdesMailboxCmdType(uint16_t command)
+{
+	uint8_t cmdType = command >> 12;
+	return (cmdType < AFE_SERDES_MAILBOX_NUM_CMDS) ? cmdType : 0;
+}
+
+static void serdesMailboxRecord(uint8_t afeId, uint16_t command, uint64_t latencyUs, uint32_t reads, uint8_t timedOut)
+{
+	AfeSerdesMailboxStats_t *stats = &afeSerdesMailboxStats[afeId][serdesMailboxCmdType(command)];
+	stats->reads += reads;
+	if (timedOut)
+	{
+		stats->timeouts++;
+		return;
+	}
+	stats->count++;
+	stats->totalUs += latencyUs;
+	if (latencyUs > stats->maxUs)
+		stats->maxUs = (uint32_t)latencyUs;
+}
+
+/*  Writes a command to the mailbox of the selected SerDes instance. The argument is written only with useArg set.   */
+static uint8_t serdesMailboxIssue(uint8_t afeId, uint16_t command, uint16_t arg, uint8_t useArg)
+{
+	uint8_t errorStatus = 0;
+	if (useArg)
+	{
+		AFE_FUNC_EXEC(serdesRawWrite(afeId, AFE_SERDES_MAILBOX_ARG_ADDR, arg));
+	}
+	AFE_FUNC_EXEC(serdesRawWrite(afeId, AFE_SERDES_MAILBOX_CMD_ADDR, command));
+	return RET_OK;
+}
+
+/*  Returns 1 while the next response read should follow at once: for the first reads, then up to twice the average latency of the command type if that is below 1 ms.
+	Before the first response of a type is timed, up to 1 ms. Never more than AFE_SERDES_MAILBOX_MAX_SPIN_READS reads.   */
+static uint8_t serdesMailboxSpin(uint8_t afeId, uint16_t command, uint64_t issueTimeUs, uint32_t reads)
+{
+	AfeSerdesMailboxStats_t *stats = &afeSerdesMailboxStats[afeId][serdesMailboxCmdType(command)];
+	uint64_t spinUs = 1000;
+	if (reads < AFE_SERDES_MAILBOX_SPIN_READS)
+		return 1;
+	if (reads >= AFE_SERDES_MAILBOX_MAX_SPIN_READS)
+		return 0;
+	if (stats->count != 0)
+	{
+		spinUs = 2 * (stats->totalUs / stats->count);
+		if (spinUs >= 2000)
+			return 0;
+	}
+	return (getTimeUs() - issueTimeUs) < spinUs;
+}
+
+/*  Next wait between response reads: 1, 1, 2, 2, 4, 4 ms and so on, up to AFE_SERDES_MAILBOX_BACKOFF_MAX_MS. backoffWaits stops counting at the longest wait, so the shift stays small.   */
+static uint32_t serdesMailboxBackoffMs(uint32_t *backoffWaits)
+{
+	uint32_t stepMs = 1UL << (*backoffWaits / 2);
+	if (stepMs >= AFE_SERDES_MAILBOX_BACKOFF_MAX_MS)
+		return AFE_SERDES_MAILBOX_BACKOFF_MAX_MS;
+	(*backoffWaits)++;
+	return stepMs;
+}
+
+/*  Time a command has been waited for: the sum of the sleeps, or the time since it was issued if that is longer, so the back-to-back reads count too.   */
+static uint32_t serdesMailboxWaitedMs(uint64_t issueTimeUs, uint32_t sleptMs)
+{
+	uint64_t elapsedMs = (getTimeUs() - issueTimeUs) / 1000;
+	return (elapsedMs > sleptMs) ? (uint32_t)elapsedMs : sleptMs;
+}
+
+/*  Waits for the response of the running command. Reads back to back while serdesMailboxSpin says so. Commands that usually take 1 ms or more then sleep for their average latency,
+	after that the reads are 1, 1, 2, 2, 4, 4 ms and so on apart. command is 0 if unknown, the type is then taken from the busy response.   */
+static uint8_t serdesMailboxWait(uint8_t afeId, uint16_t command, uint64_t issueTimeUs, uint16_t *response)
+{
+	uint8_t errorStatus = 0;
+	AfeSerdesMailboxStats_t *stats;
+	uint32_t reads = 1;
+	uint32_t waitedMs = 0;
+	uint32_t stepMs = 0;
+	uint32_t backoffWaits = 0;
+	uint8_t averageSlept = 0;
+
+	AFE_FUNC_EXEC(serdesRawRead(afeId, AFE_SERDES_MAILBOX_CMD_ADDR, response));
+	if (command == 0)
+		command = *response;
+	stats = &afeSerdesMailboxStats[afeId][serdesMailboxCmdType(command)];
+	while (*response >> 12 != 0)
+	{
+		if (serdesMailboxWaitedMs(issueTimeUs, waitedMs) > AFE_SERDES_MAILBOX_TIMEOUT_MS)
+		{
+			afeLogErr("AFE%d: SerDes mailbox command 0x%X got no response in %d ms.", afeId, command, serdesMailboxWaitedMs(issueTimeUs, waitedMs));
+			serdesMailboxRecord(afeId, command, 0, reads, 1);
+			return RET_EXEC_FAIL;
+		}
+		if (!serdesMailboxSpin(afeId, command, issueTimeUs, reads))
+		{
+			if (!averageSlept && (stats->count != 0) && (stats->totalUs / stats->count >= 1000))
+			{
+				stepMs = (uint32_t)(stats->totalUs / stats->count / 1000);
+				averageSlept = 1;
+			}
+			else
+			{
+				stepMs = serdesMailboxBackoffMs(&backoffWaits);
+			}
+			AFE_FUNC_EXEC(waitMs(stepMs));
+			waitedMs += stepMs;
+		}
+		AFE_FUNC_EXEC(serdesRawRead(afeId, AFE_SERDES_MAILBOX_CMD_ADDR, response));
+		reads++;
+	}
+	serdesMailboxRecord(afeId, command, getTimeUs() - issueTimeUs, reads, 0);
+	return RET_OK;
+}
+
+/*  Runs one mailbox command on the selected SerDes instance and checks its response.   */
+static uint8_t serdesMailboxCommand(uint8_t afeId, uint16_t command, uint16_t arg, uint8_t useArg, uint16_t *response)
+{
+	uint8_t errorStatus = 0;
+	uint64_t issueTimeUs = getTimeUs();
+	AFE_FUNC_EXEC(serdesMailboxIssue(afeId, command, arg, useArg));
+	AFE_FUNC_EXEC(serdesMailboxWait(afeId, command, issueTimeUs, response));
+	return emResponseCheck(*response);
+}
+
+/**
+    @brief SerDes Mailbox Statistics
+    @details Returns the statistics of one type of eye monitor mailbox command. The latency is the time from writing the command to its response, measured with getTimeUs.
+    @param afeId AFE ID
+    @param cmdType Command type, bits 15:12 of the command.<br>
+			1 start (em_start)<br>
+			2 progress (em_report_progress)<br>
+			3 read (em_read)<br>
+			4 cancel (em_cancel)<br>
+			0 commands of unknown type
+    @param count Pointer returning the number of commands answered.
+    @param timeouts Pointer returning the number of commands that timed out.
+    @param reads Pointer returning the number of response reads, for all the commands.
+    @param totalUs Pointer returning the sum of the latencies of the answered commands in micro seconds.
+    @param maxUs Pointer returning the longest latency in micro seconds.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSerdesMailboxGetStats(uint8_t afeId, uint8_t cmdType, uint32_t *count, uint32_t *timeouts, uint32_t *reads, uint64_t *totalUs, uint32_t *maxUs)
+{
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(cmdType < AFE_SERDES_MAILBOX_NUM_CMDS);
+	AFE_PARAMS_VALID((count != NULL) && (timeouts != NULL) && (reads != NULL) && (totalUs != NULL) && (maxUs != NULL));
+	*count = afeSerdesMailboxStats[afeId][cmdType].count;
+	*timeouts = afeSerdesMailboxStats[afeId][cmdType].timeouts;
+	*reads = afeSerdesMailboxStats[afeId][cmdType].reads;
+	*totalUs = afeSerdesMailboxStats[afeId][cmdType].totalUs;
+	*maxUs = afeSerdesMailboxStats[afeId][cmdType].maxUs;
+	return RET_OK;
+}
+
+/**
+    @brief Clears the SerDes Mailbox Statistics
+    @details Clears the statistics of all the mailbox command types of the AFE. The average latencies the waits adapt to are cleared with them.
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSerdesMailboxClearStats(uint8_t afeId)
+{
+	AFE_ID_VALIDITY();
+	memset(afeSerdesMailboxStats[afeId], 0, sizeof(afeSerdesMailboxStats[afeId]));
+	return RET_OK;
+}
+
+/**
+    @brief Checks the status of the SerDes Eye Read.
+    @details Checks the status of the SerDes Eye Read. This function is called getSerdesEye and shouldn't be called independently.<br>
+			Waits for the response of the command written to the mailbox with back-off between the reads, and fails if there is no response within 500 ms.
+    @param afeId AFE ID
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t parse_response(uint8_t afeId, uint16_t *responseRet)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(responseRet != NULL);
+	AFE_FUNC_EXEC(serdesMailboxWait(afeId, 0, getTimeUs(), responseRet));
+	return emResponseCheck(*responseRet);
+}
+
 /**
     @brief Initiates the SerDes Eye Read.
     @details Initiates the SerDes Eye Read. This function is called getSerdesEye and shouldn't be called independently.
@@ -446,9 +638,7 @@ uint8_t em_start(uint8_t afeId, uint8_t lane_num, uint8_t ber_exp, uint8_t mode)
 	// uint8_t jesdToSerdesLaneMappingLocal[8] = jesdToSerdesLaneMapping;
 	// lane_num = jesdToSerdesLaneMappingLocal[lane_num];
 	uint16_t command = 0x1000 | (lane_num & 0x3) | ((ber_exp & 0xF) << 4);
-	AFE_FUNC_EXEC(serdesRawWrite(afeId, 0x9816, mode));
-	AFE_FUNC_EXEC(serdesRawWrite(afeId, 0x9815, command));
-	AFE_FUNC_EXEC(parse_response(afeId, &response));
+	AFE_FUNC_EXEC(serdesMailboxCommand(afeId, command, mode, 1, &response));
 	uint8_t status = (response >> 8) & 0xf;
 
 	if (status == 0x0)
@@ -473,8 +663,7 @@ uint8_t em_report_progress(uint8_t afeId, uint8_t *progress)
 	uint8_t errorStatus = 0;
 	uint16_t command = 0x2000;
 	uint16_t response = 0;
-	AFE_FUNC_EXEC(serdesRawWrite(afeId, 0x9815, command));
-	AFE_FUNC_EXEC(parse_response(afeId, &response));
+	AFE_FUNC_EXEC(serdesMailboxCommand(afeId, command, 0, 0, &response));
 	uint8_t status = (response >> 8) & 0xf;
 	uint8_t data = response & 0xff;
 	if (status == 0x1)
@@ -501,7 +690,7 @@ uint8_t em_read(uint8_t afeId, uint16_t *ber)
 {
 	uint8_t errorStatus = 0;
 	uint16_t response = 0;
-	uint8_t m = 0;
+	int16_t m = 0;
 	uint8_t status = 0;
 	for (int8_t phase = -16; phase < 17; phase++)
 	{
@@ -527,9 +716,7 @@ uint8_t em_read(uint8_t afeId, uint16_t *ber)
 			{
 				phaseValue = phase;
 			}
-			AFE_FUNC_EXEC(serdesRawWrite(afeId, 0x9816, marginValue & 0xffff));
-			AFE_FUNC_EXEC(serdesRawWrite(afeId, 0x9815, (phaseValue & 0xFF) | 0x3000));
-			AFE_FUNC_EXEC(parse_response(afeId, &response));
+			AFE_FUNC_EXEC(serdesMailboxCommand(afeId, (phaseValue & 0xFF) | 0x3000, marginValue & 0xffff, 1, &response));
 			status = (response >> 8) & 0xf;
 
 			if (status == 0x2)
@@ -573,9 +760,8 @@ uint8_t em_read(uint8_t afeId, uint16_t *ber)
 uint8_t em_cancel(uint8_t afeId)
 {
 	uint8_t errorStatus = 0;
-	AFE_FUNC_EXEC(serdesRawWrite(afeId, 0x9815, 0x4000));
 	uint16_t response = 0;
-	AFE_FUNC_EXEC(parse_response(afeId, &response));
+	AFE_FUNC_EXEC(serdesMailboxCommand(afeId, 0x4000, 0, 0, &response));
 
 	afeLogInfo("%d", response);
 	if (errorStatus)
@@ -636,3 +822,591 @@ uint8_t getSerdesEye(uint8_t afeId, uint8_t laneNo, uint16_t *ber, uint16_t *ext
 	else
 		return RET_OK;
 }
+
+/*  States of the eye scan of a SerDes instance.   */
+#define AFE_SERDES_EYE_STATE_IDLE 0
+#define AFE_SERDES_EYE_STATE_START 1
+#define AFE_SERDES_EYE_STATE_PROGRESS 2
+#define AFE_SERDES_EYE_STATE_READ 3
+#define AFE_SERDES_EYE_STATE_CANCEL 4
+/*  em_read reads the margins in blocks of 16 from -47, 6 blocks cover the 95 margins.   */
+#define AFE_SERDES_EYE_MARGIN_BLOCK 16
+#define AFE_SERDES_EYE_NUM_MARGIN_BLOCKS 6
+
+/*  Eye scan of one SerDes instance. The lanes of an instance share its eye monitor and are scanned one after the other.   */
+typedef struct AFE_SERDES_EYE_SCAN
+{
+	uint8_t state;
+	uint8_t laneList;
+	uint8_t laneNo;
+	uint8_t quick;
+	uint8_t phaseIdx;
+	uint8_t blockIdx;
+	uint8_t progress;
+	uint16_t command;
+	uint32_t reads;
+	uint32_t waitedMs;
+	uint64_t issueTimeUs;
+	uint64_t startTimeUs;
+	AfeSerdesEye_t *eye;
+	AfeSerdesEye_t *eyeList[AFE_NUM_SERDES_LANES];
+} AfeSerdesEyeScan_t;
+
+/*  Writes the eye monitor command of the current state. The response is read by eyeScanStep.   */
+static uint8_t eyeScanCommand(uint8_t afeId, AfeSerdesEyeScan_t *scan)
+{
+	uint8_t errorStatus = 0;
+	uint8_t jesdToSerdesLaneMappingLocal[8] = jesdToSerdesLaneMapping;
+	int16_t phase = scan->eye->firstPhase + scan->phaseIdx * scan->eye->phaseStep;
+	int16_t margin = scan->eye->firstMargin + scan->blockIdx * AFE_SERDES_EYE_MARGIN_BLOCK;
+	uint16_t arg = 0;
+
+	if (scan->state == AFE_SERDES_EYE_STATE_START)
+	{
+		scan->command = 0x1000 | (jesdToSerdesLaneMappingLocal[scan->laneNo] & 0x3) | (AFE_SERDES_EYE_BER_EXP << 4); /*em_start, mode 1*/
+		arg = 1;
+	}
+	else if (scan->state == AFE_SERDES_EYE_STATE_PROGRESS)
+	{
+		scan->command = 0x2000; /*em_report_progress*/
+	}
+	else if (scan->state == AFE_SERDES_EYE_STATE_CANCEL)
+	{
+		scan->command = 0x4000; /*em_cancel*/
+	}
+	else
+	{
+		scan->command = ((uint16_t)phase & 0xFF) | 0x3000; /*em_read*/
+		arg = (uint16_t)margin;
+	}
+	scan->issueTimeUs = getTimeUs();
+	scan->reads = 0;
+	scan->waitedMs = 0;
+	AFE_FUNC_EXEC(serdesMailboxIssue(afeId, scan->command, arg, (scan->state != AFE_SERDES_EYE_STATE_PROGRESS) && (scan->state != AFE_SERDES_EYE_STATE_CANCEL)));
+	return RET_OK;
+}
+
+/*  Starts the next lane of the instance, or leaves it idle when all the lanes are done.   */
+static uint8_t eyeScanNextLane(uint8_t afeId, AfeSerdesEyeScan_t *scan)
+{
+	uint8_t errorStatus = 0;
+	AfeSerdesEye_t *eye;
+	scan->state = AFE_SERDES_EYE_STATE_IDLE;
+	if (scan->laneList == 0)
+		return RET_OK;
+	scan->laneNo = 0;
+	while (((scan->laneList >> scan->laneNo) & 1) == 0)
+		scan->laneNo++;
+	scan->laneList &= (uint8_t)~(1 << scan->laneNo);
+
+	eye = scan->eyeList[scan->laneNo];
+	eye->laneNo = scan->laneNo;
+	eye->result = RET_EXEC_FAIL;
+	eye->phaseStep = scan->quick ? AFE_SERDES_EYE_QUICK_STEP : 1;
+	eye->marginStep = scan->quick ? AFE_SERDES_EYE_QUICK_STEP : 1;
+	eye->firstPhase = -(AFE_SERDES_EYE_NUM_PHASES / 2);
+	eye->firstMargin = -(AFE_SERDES_EYE_NUM_MARGINS / 2);
+	eye->numPhases = (AFE_SERDES_EYE_NUM_PHASES - 1) / eye->phaseStep + 1;
+	eye->numMargins = (AFE_SERDES_EYE_NUM_MARGINS - 1) / eye->marginStep + 1;
+	eye->extent = 0;
+	eye->scanTimeUs = 0;
+	eye->threshold = 0;
+	eye->eyeHeight = 0;
+	eye->eyeWidth = 0;
+	eye->openArea = 0;
+	scan->eye = eye;
+	scan->phaseIdx = 0;
+	scan->blockIdx = 0;
+	scan->progress = 0;
+	scan->startTimeUs = getTimeUs();
+	scan->state = AFE_SERDES_EYE_STATE_START;
+	AFE_FUNC_EXEC(eyeScanCommand(afeId, scan));
+	return RET_OK;
+}
+
+/*  Stores the 16 margins of a em_read response that are on the grid of the eye. valid is 0 when the response had no data.   */
+static uint8_t eyeScanReadBlock(uint8_t afeId, AfeSerdesEyeScan_t *scan, uint8_t valid)
+{
+	uint8_t errorStatus = 0;
+	AfeSerdesEye_t *eye = scan->eye;
+	uint16_t serdesReadVal = 0;
+	for (uint8_t i = 0; i < AFE_SERDES_EYE_MARGIN_BLOCK; i++)
+	{
+		uint16_t offset = scan->blockIdx * AFE_SERDES_EYE_MARGIN_BLOCK + i;
+		if ((offset >= AFE_SERDES_EYE_NUM_MARGINS) || ((offset % eye->marginStep) != 0))
+			continue;
+		if (valid)
+		{
+			AFE_FUNC_EXEC(serdesRawRead(afeId, (0x9f00 + i), &serdesReadVal));
+		}
+		eye->ber[scan->phaseIdx * eye->numMargins + offset / eye->marginStep] = valid ? serdesReadVal : 0;
+	}
+	return RET_OK;
+}
+
+/*  Reads the eye monitor response of the instance once. If the command is done, handles the response, writes the next command and sets ready.
+	A command without response is cancelled with em_cancel before the next lane is started. If the cancel gets no response either, the other lanes of the instance are given up.   */
+static uint8_t eyeScanStep(uint8_t afeId, AfeSerdesEyeScan_t *scan, uint8_t *ready)
+{
+	uint8_t errorStatus = 0;
+	uint16_t response = 0;
+	uint8_t status;
+
+	*ready = 0;
+	AFE_FUNC_EXEC(serdesRawRead(afeId, AFE_SERDES_MAILBOX_CMD_ADDR, &response));
+	scan->reads++;
+	if (response >> 12 != 0)
+	{
+		if (serdesMailboxWaitedMs(scan->issueTimeUs, scan->waitedMs) <= AFE_SERDES_MAILBOX_TIMEOUT_MS)
+			return RET_OK;
+		afeLogErr("AFE%d: SerDes lane %d eye monitor command 0x%X got no response in %d ms.", afeId, scan->laneNo, scan->command, serdesMailboxWaitedMs(scan->issueTimeUs, scan->waitedMs));
+		serdesMailboxRecord(afeId, scan->command, 0, scan->reads, 1);
+		if (scan->state == AFE_SERDES_EYE_STATE_CANCEL)
+		{
+			scan->laneList = 0;
+			return eyeScanNextLane(afeId, scan);
+		}
+		scan->state = AFE_SERDES_EYE_STATE_CANCEL;
+		AFE_FUNC_EXEC(eyeScanCommand(afeId, scan));
+		return RET_OK;
+	}
+	*ready = 1;
+	serdesMailboxRecord(afeId, scan->command, getTimeUs() - scan->issueTimeUs, scan->reads, 0);
+	if (scan->state == AFE_SERDES_EYE_STATE_CANCEL)
+		return eyeScanNextLane(afeId, scan);
+	status = (response >> 8) & 0xf;
+	if (emResponseCheck(response) != RET_OK)
+	{
+		afeLogErr("AFE%d: eye scan of SerDes lane %d failed.", afeId, scan->laneNo);
+		return eyeScanNextLane(afeId, scan);
+	}
+
+	if (scan->state == AFE_SERDES_EYE_STATE_START)
+	{
+		scan->state = AFE_SERDES_EYE_STATE_PROGRESS;
+	}
+	else if (scan->state == AFE_SERDES_EYE_STATE_PROGRESS)
+	{
+		uint8_t progress = (status == 0x1) ? (response & 0xff) : 0xff;
+		if ((progress == 0xff) || (progress == 100))
+		{
+			scan->state = AFE_SERDES_EYE_STATE_READ;
+		}
+		else if (progress != scan->progress)
+		{
+			afeLogDbg("AFE%d: SerDes lane %d eye monitor %d%%", afeId, scan->laneNo, progress);
+			scan->progress = progress;
+		}
+	}
+	else
+	{
+		AFE_FUNC_EXEC(eyeScanReadBlock(afeId, scan, status == 0x2));
+		scan->blockIdx++;
+		if (scan->blockIdx == AFE_SERDES_EYE_NUM_MARGIN_BLOCKS)
+		{
+			scan->blockIdx = 0;
+			scan->phaseIdx++;
+		}
+		if (scan->phaseIdx == scan->eye->numPhases)
+		{
+			AFE_FUNC_EXEC(serdesRawRead(afeId, AFE_SERDES_MAILBOX_ARG_ADDR, &scan->eye->extent));
+			scan->eye->scanTimeUs = (uint32_t)(getTimeUs() - scan->startTimeUs);
+			scan->eye->result = RET_OK;
+			AFE_FUNC_EXEC(afeSerdesEyeMetrics(scan->eye, 0));
+			afeLogInfo("AFE%d: SerDes lane %d eye scan done in %d us, extent %d, height %d, width %d", afeId, scan->laneNo, scan->eye->scanTimeUs, scan->eye->extent, scan->eye->eyeHeight, scan->eye->eyeWidth);
+			return eyeScanNextLane(afeId, scan);
+		}
+	}
+	AFE_FUNC_EXEC(eyeScanCommand(afeId, scan));
+	return RET_OK;
+}
+
+/*  Returns 1 if the response of any running instance should be read again at once, see serdesMailboxSpin.   */
+static uint8_t eyeScanSpin(uint8_t afeId, AfeSerdesEyeScan_t *scan)
+{
+	for (uint8_t instanceNo = 0; instanceNo < AFE_NUM_JESD_INSTANCES; instanceNo++)
+	{
+		if ((scan[instanceNo].state != AFE_SERDES_EYE_STATE_IDLE) && serdesMailboxSpin(afeId, scan[instanceNo].command, scan[instanceNo].issueTimeUs, scan[instanceNo].reads))
+			return 1;
+	}
+	return 0;
+}
+
+/**
+    @brief Reads the SerDes Eye of several lanes.
+    @details Scans the eye of the lanes in laneList as getSerdesEye does. The two SerDes instances have an eye monitor each, so a lane of SRX1-SRX4 and a lane of SRX5-SRX8 are scanned at the same time: the function polls the instances in turn and writes the next command of an instance as soon as its response is ready, instead of waiting for each response in turn.<br>
+			The lanes of one instance are scanned one after the other. A lane whose eye monitor command gets no response in 500 ms is cancelled with em_cancel and fails.<br>
+			In quick mode only every AFE_SERDES_EYE_QUICK_STEP-th phase and margin is read out, 9 x 24 points instead of 33 x 95. The eye monitor measurement itself is the same.
+    @param afeId AFE ID
+    @param laneList Bit Wise Lane Select. Bit0-Bit7 refer to SRX1-SRX8, the physical SerDes lanes.
+    @param quick 1 for the coarse quick eye, 0 for the full eye.
+    @param eye Array with one entry per lane in laneList, in ascending lane order. Each entry returns the BER matrix, the extent and the scan time of the lane.<br>
+			ber[phaseIdx * numMargins + marginIdx] is the value at phase firstPhase + phaseIdx * phaseStep and margin firstMargin + marginIdx * marginStep. For the full eye it has the layout of the ber array of getSerdesEye.
+	@return Returns if the function execution passed or failed. Fails if the scan of any lane failed, the result of each lane is in eye[].result.
+*/
+uint8_t getSerdesEyeMulti(uint8_t afeId, uint8_t laneList, uint8_t quick, AfeSerdesEye_t *eye)
+{
+	uint8_t errorStatus = 0;
+	AFE_ID_VALIDITY();
+	AFE_PARAMS_VALID(laneList != 0);
+	AFE_PARAMS_VALID(eye != NULL);
+	AfeSerdesEyeScan_t scan[AFE_NUM_JESD_INSTANCES];
+	uint8_t numLanes = 0;
+	uint8_t active = 0;
+	uint8_t ready = 0;
+	uint8_t anyReady = 0;
+	uint8_t pageInstance = 0xff;
+	uint32_t backoffWaits = 0;
+	uint32_t stepMs = 0;
+
+	for (uint8_t instanceNo = 0; instanceNo < AFE_NUM_JESD_INSTANCES; instanceNo++)
+	{
+		scan[instanceNo].state = AFE_SERDES_EYE_STATE_IDLE;
+		scan[instanceNo].quick = quick;
+		scan[instanceNo].laneList = laneList & (0xf << (instanceNo * 4));
+	}
+	for (uint8_t laneNo = 0; laneNo < AFE_NUM_SERDES_LANES; laneNo++)
+	{
+		if ((laneList >> laneNo) & 1)
+		{
+			scan[laneNo >> 2].eyeList[laneNo] = &eye[numLanes];
+			eye[numLanes].result = RET_EXEC_FAIL;
+			numLanes++;
+		}
+	}
+
+	do
+	{
+		active = 0;
+		anyReady = 0;
+		for (uint8_t instanceNo = 0; instanceNo < AFE_NUM_JESD_INSTANCES; instanceNo++)
+		{
+			if ((scan[instanceNo].state == AFE_SERDES_EYE_STATE_IDLE) && (scan[instanceNo].laneList == 0))
+				continue;
+			if (pageInstance != instanceNo)
+			{
+				AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x16, 0x20 << instanceNo, 0x0, 0x7));
+				pageInstance = instanceNo;
+			}
+			if (scan[instanceNo].state == AFE_SERDES_EYE_STATE_IDLE)
+			{
+				AFE_FUNC_EXEC(eyeScanNextLane(afeId, &scan[instanceNo]));
+				ready = 1;
+			}
+			else
+			{
+				AFE_FUNC_EXEC(eyeScanStep(afeId, &scan[instanceNo], &ready));
+			}
+			anyReady |= ready;
+			if (scan[instanceNo].state != AFE_SERDES_EYE_STATE_IDLE)
+				active = 1;
+		}
+		/*  Back-off as in serdesMailboxWait when no instance had a response in a pass.   */
+		if (anyReady)
+		{
+			backoffWaits = 0;
+		}
+		else if (active && !eyeScanSpin(afeId, scan))
+		{
+			stepMs = serdesMailboxBackoffMs(&backoffWaits);
+			AFE_FUNC_EXEC(waitMs(stepMs));
+			for (uint8_t instanceNo = 0; instanceNo < AFE_NUM_JESD_INSTANCES; instanceNo++)
+				scan[instanceNo].waitedMs += stepMs;
+		}
+	} while (active);
+	AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, 0x16, 0x00, 0x0, 0x7));
+
+	for (uint8_t i = 0; i < numLanes; i++)
+	{
+		if (eye[i].result != RET_OK)
+			errorStatus |= 1;
+	}
+	if (errorStatus)
+		return RET_EXEC_FAIL;
+	else
+		return RET_OK;
+}
+
+/*  Eye file format. All fields are little endian.
+	Header (AFE_SERDES_EYE_FILE_HEADER_LEN bytes):
+	  0  magic "AFEE"     4  version (2 bytes)     6  number of eyes (2 bytes)     8  board ID (4 bytes)     12-15 reserved
+	Each eye is a record header (AFE_SERDES_EYE_RECORD_LEN bytes) followed by its numPhases x numMargins BER values of 2 bytes, phase by phase:
+	  0  laneNo   1  result   2  numPhases   3  numMargins   4  firstPhase   5  phaseStep   6  firstMargin   7  marginStep
+	  8  extent   10 threshold   12 eyeHeight   14 eyeWidth   16 openArea (2 bytes each)   18 scanTimeUs (4 bytes)   22-23 reserved   */
+#define AFE_SERDES_EYE_FILE_MAGIC "AFEE"
+#define AFE_SERDES_EYE_FILE_VERSION 1
+#define AFE_SERDES_EYE_FILE_HEADER_LEN 16
+#define AFE_SERDES_EYE_RECORD_LEN 24
+
+static void eyePut16(uint8_t *buf, uint16_t val)
+{
+	buf[0] = (uint8_t)val;
+	buf[1] = (uint8_t)(val >> 8);
+}
+
+static void eyePut32(uint8_t *buf, uint32_t val)
+{
+	eyePut16(buf, (uint16_t)val);
+	eyePut16(buf + 2, (uint16_t)(val >> 16));
+}
+
+static uint16_t eyeGet16(const uint8_t *buf)
+{
+	return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+static uint32_t eyeGet32(const uint8_t *buf)
+{
+	return eyeGet16(buf) | ((uint32_t)eyeGet16(buf + 2) << 16);
+}
+
+/**
+    @brief Makes a SerDes Eye Result from the getSerdesEye Output
+    @details Copies the ber array and extent returned by getSerdesEye into an eye result, so it can be measured with afeSerdesEyeMetrics and saved with afeSerdesEyeSave. The metrics are computed with threshold 0.
+    @param eye Eye result to be filled.
+    @param laneNo Lane passed to getSerdesEye.
+    @param ber Array with 3135 elements filled by getSerdesEye.
+    @param extent Extent returned by getSerdesEye.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSerdesEyeFromBer(AfeSerdesEye_t *eye, uint8_t laneNo, const uint16_t *ber, uint16_t extent)
+{
+	AFE_PARAMS_VALID((eye != NULL) && (ber != NULL));
+	AFE_PARAMS_VALID(laneNo < AFE_NUM_SERDES_LANES);
+	eye->laneNo = laneNo;
+	eye->result = RET_OK;
+	eye->numPhases = AFE_SERDES_EYE_NUM_PHASES;
+	eye->numMargins = AFE_SERDES_EYE_NUM_MARGINS;
+	eye->firstPhase = -(AFE_SERDES_EYE_NUM_PHASES / 2);
+	eye->phaseStep = 1;
+	eye->firstMargin = -(AFE_SERDES_EYE_NUM_MARGINS / 2);
+	eye->marginStep = 1;
+	eye->extent = extent;
+	eye->scanTimeUs = 0;
+	memcpy(eye->ber, ber, sizeof(eye->ber));
+	return afeSerdesEyeMetrics(eye, 0);
+}
+
+/**
+    @brief Computes the Eye Opening of a SerDes Eye Result
+    @details A point of the eye is open if its value is at most threshold. The results are in full resolution steps, so quick and full eyes compare directly.<br>
+			eyeHeight: number of margin steps of the open run through margin 0 at phase 0.<br>
+			eyeWidth: number of phase steps of the open run through phase 0 at margin 0.<br>
+			openArea: number of open points, each counted as phaseStep x marginStep points.<br>
+			The height and area are counted along the rows of the matrix, which are contiguous in memory. In quick eyes the margin nearest to 0 on the grid is used.
+    @param eye Eye result. The threshold and the three metrics are written into it.
+    @param threshold Highest value counted as open.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSerdesEyeMetrics(AfeSerdesEye_t *eye, uint16_t threshold)
+{
+	AFE_PARAMS_VALID(eye != NULL);
+	AFE_PARAMS_VALID((eye->phaseStep != 0) && (eye->marginStep != 0));
+	AFE_PARAMS_VALID((uint16_t)eye->numPhases * eye->numMargins <= AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS);
+	uint16_t numPoints = (uint16_t)eye->numPhases * eye->numMargins;
+	uint16_t centerPhase = (uint16_t)((-eye->firstPhase + eye->phaseStep / 2) / eye->phaseStep);
+	uint16_t centerMargin = (uint16_t)((-eye->firstMargin + eye->marginStep / 2) / eye->marginStep);
+	const uint16_t *row;
+	uint16_t openPoints = 0;
+	int16_t i;
+
+	eye->threshold = threshold;
+	eye->eyeHeight = 0;
+	eye->eyeWidth = 0;
+	for (uint16_t n = 0; n < numPoints; n++)
+	{
+		openPoints += (eye->ber[n] <= threshold);
+	}
+	eye->openArea = openPoints * eye->phaseStep * eye->marginStep;
+	if ((centerPhase >= eye->numPhases) || (centerMargin >= eye->numMargins))
+		return RET_OK;
+
+	row = &eye->ber[centerPhase * eye->numMargins];
+	for (i = centerMargin; (i >= 0) && (row[i] <= threshold); i--)
+		eye->eyeHeight += eye->marginStep;
+	for (i = centerMargin + 1; (i < eye->numMargins) && (row[i] <= threshold); i++)
+		eye->eyeHeight += eye->marginStep;
+	for (i = centerPhase; (i >= 0) && (eye->ber[i * eye->numMargins + centerMargin] <= threshold); i--)
+		eye->eyeWidth += eye->phaseStep;
+	for (i = centerPhase + 1; (i < eye->numPhases) && (eye->ber[i * eye->numMargins + centerMargin] <= threshold); i++)
+		eye->eyeWidth += eye->phaseStep;
+	return RET_OK;
+}
+
+/**
+    @brief Saves SerDes Eye Results
+    @details Writes eye results, for example the ones of getSerdesEyeMulti, to a compact binary file: a 16 byte header, then per eye a 24 byte record with the grid, extent, metrics and scan time, followed by only the measured points, 2 bytes each.
+			A full eye takes 6294 bytes, a quick eye 456 bytes. The format is described in serDes.c, afeSerdesEyeLoad reads it back.<br>
+			Optionally also writes a CSV file with, per eye, a comment line with the record fields, a line with the margins and one line per phase.
+    @param file Path of the binary file to be written.
+    @param csvFile Path of the CSV file to be written. NULL for no CSV.
+    @param boardId Number stored in the file to tell the boards apart, for example the serial number.
+    @param eye Array of eye results.
+    @param numEyes Number of entries in eye.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t afeSerdesEyeSave(char *file, char *csvFile, uint32_t boardId, const AfeSerdesEye_t *eye, uint8_t numEyes)
+{
+	uint8_t errorStatus = 0;
+	uint8_t buf[AFE_SERDES_EYE_NUM_MARGINS * 2];
+	FILE *fp;
+
+	AFE_PARAMS_VALID((file != NULL) && (eye != NULL));
+	for (uint8_t e = 0; e < numEyes; e++)
+	{
+		AFE_PARAMS_VALID((eye[e].numPhases <= AFE_SERDES_EYE_NUM_PHASES) && (eye[e].numMargins <= AFE_SERDES_EYE_NUM_MARGINS));
+	}
+	fp = fopen(file, "wb");
+	if (NULL == fp)
+	{
+		printf("File open error.\n");
+		return RET_EXEC_FAIL;
+	}
+	memset(buf, 0, AFE_SERDES_EYE_FILE_HEADER_LEN);
+	memcpy(buf, AFE_SERDES_EYE_FILE_MAGIC, 4);
+	eyePut16(buf + 4, AFE_SERDES_EYE_FILE_VERSION);
+	eyePut16(buf + 6, numEyes);
+	eyePut32(buf + 8, boardId);
+	if (fwrite(buf, 1, AFE_SERDES_EYE_FILE_HEADER_LEN, fp) != AFE_SERDES_EYE_FILE_HEADER_LEN)
+		errorStatus |= 1;
+	for (uint8_t e = 0; (e < numEyes) && !errorStatus; e++)
+	{
+		memset(buf, 0, AFE_SERDES_EYE_RECORD_LEN);
+		buf[0] = eye[e].laneNo;
+		buf[1] = eye[e].result;
+		buf[2] = eye[e].numPhases;
+		buf[3] = eye[e].numMargins;
+		buf[4] = (uint8_t)eye[e].firstPhase;
+		buf[5] = eye[e].phaseStep;
+		buf[6] = (uint8_t)eye[e].firstMargin;
+		buf[7] = eye[e].marginStep;
+		eyePut16(buf + 8, eye[e].extent);
+		eyePut16(buf + 10, eye[e].threshold);
+		eyePut16(buf + 12, eye[e].eyeHeight);
+		eyePut16(buf + 14, eye[e].eyeWidth);
+		eyePut16(buf + 16, eye[e].openArea);
+		eyePut32(buf + 18, eye[e].scanTimeUs);
+		if (fwrite(buf, 1, AFE_SERDES_EYE_RECORD_LEN, fp) != AFE_SERDES_EYE_RECORD_LEN)
+			errorStatus |= 1;
+		for (uint8_t p = 0; (p < eye[e].numPhases) && !errorStatus; p++)
+		{
+			for (uint8_t m = 0; m < eye[e].numMargins; m++)
+				eyePut16(buf + 2 * m, eye[e].ber[p * eye[e].numMargins + m]);
+			if (fwrite(buf, 2, eye[e].numMargins, fp) != eye[e].numMargins)
+				errorStatus |= 1;
+		}
+	}
+	if (fclose(fp) != 0)
+		errorStatus |= 1;
+	if (errorStatus)
+	{
+		afeLogErr("Writing SerDes eye file %s failed", file);
+		return RET_EXEC_FAIL;
+	}
+	if (csvFile == NULL)
+		return RET_OK;
+
+	fp = fopen(csvFile, "w");
+	if (NULL == fp)
+	{
+		printf("File open error.\n");
+		return RET_EXEC_FAIL;
+	}
+	for (uint8_t e = 0; e < numEyes; e++)
+	{
+		fprintf(fp, "# board %u, lane %d, result %d, extent %d, threshold %d, height %d, width %d, area %d, scan %u us\n", (unsigned int)boardId, eye[e].laneNo, eye[e].result, eye[e].extent, eye[e].threshold, eye[e].eyeHeight, eye[e].eyeWidth, eye[e].openArea, (unsigned int)eye[e].scanTimeUs);
+		fprintf(fp, "phase\\margin");
+		for (uint8_t m = 0; m < eye[e].numMargins; m++)
+			fprintf(fp, ",%d", eye[e].firstMargin + m * eye[e].marginStep);
+		fprintf(fp, "\n");
+		for (uint8_t p = 0; p < eye[e].numPhases; p++)
+		{
+			fprintf(fp, "%d", eye[e].firstPhase + p * eye[e].phaseStep);
+			for (uint8_t m = 0; m < eye[e].numMargins; m++)
+				fprintf(fp, ",%d", eye[e].ber[p * eye[e].numMargins + m]);
+			fprintf(fp, "\n");
+		}
+	}
+	errorStatus = (ferror(fp) != 0);
+	if (fclose(fp) != 0)
+		errorStatus |= 1;
+	if (errorStatus)
+	{
+		afeLogErr("Writing SerDes eye CSV %s failed", csvFile);
+		return RET_EXEC_FAIL;
+	}
+	return RET_OK;
+}
+
+/**
+    @brief Loads SerDes Eye Results
+    @details Reads a file written by afeSerdesEyeSave, for example to compare the eyes of several boards offline.
+    @param file Path of the binary file.
+    @param boardId Pointer returning the board ID stored in the file.
+    @param eye Array returning the eye results.
+    @param maxEyes Number of entries in eye.
+    @param numEyes Pointer returning the number of eye results read.
+	@return Returns if the function execution passed or failed. Fails if the file has more than maxEyes eyes.
+*/
+uint8_t afeSerdesEyeLoad(char *file, uint32_t *boardId, AfeSerdesEye_t *eye, uint8_t maxEyes, uint8_t *numEyes)
+{
+	uint8_t errorStatus = 0;
+	uint8_t buf[AFE_SERDES_EYE_NUM_MARGINS * 2];
+	uint16_t count;
+	FILE *fp;
+
+	AFE_PARAMS_VALID((file != NULL) && (boardId != NULL) && (eye != NULL) && (numEyes != NULL));
+	*numEyes = 0;
+	fp = fopen(file, "rb");
+	if (NULL == fp)
+	{
+		printf("File open error.\n");
+		return RET_EXEC_FAIL;
+	}
+	if ((fread(buf, 1, AFE_SERDES_EYE_FILE_HEADER_LEN, fp) != AFE_SERDES_EYE_FILE_HEADER_LEN) || (memcmp(buf, AFE_SERDES_EYE_FILE_MAGIC, 4) != 0) || (eyeGet16(buf + 4) != AFE_SERDES_EYE_FILE_VERSION) || (eyeGet16(buf + 6) > maxEyes))
+	{
+		afeLogErr("%s is not a SerDes eye file or has more than %d eyes", file, maxEyes);
+		fclose(fp);
+		return RET_EXEC_FAIL;
+	}
+	count = eyeGet16(buf + 6);
+	*boardId = eyeGet32(buf + 8);
+	for (uint8_t e = 0; (e < count) && !errorStatus; e++)
+	{
+		if (fread(buf, 1, AFE_SERDES_EYE_RECORD_LEN, fp) != AFE_SERDES_EYE_RECORD_LEN || (buf[2] > AFE_SERDES_EYE_NUM_PHASES) || (buf[3] > AFE_SERDES_EYE_NUM_MARGINS))
+		{
+			errorStatus |= 1;
+			break;
+		}
+		eye[e].laneNo = buf[0];
+		eye[e].result = buf[1];
+		eye[e].numPhases = buf[2];
+		eye[e].numMargins = buf[3];
+		eye[e].firstPhase = (int8_t)buf[4];
+		eye[e].phaseStep = buf[5];
+		eye[e].firstMargin = (int8_t)buf[6];
+		eye[e].marginStep = buf[7];
+		eye[e].extent = eyeGet16(buf + 8);
+		eye[e].threshold = eyeGet16(buf + 10);
+		eye[e].eyeHeight = eyeGet16(buf + 12);
+		eye[e].eyeWidth = eyeGet16(buf + 14);
+		eye[e].openArea = eyeGet16(buf + 16);
+		eye[e].scanTimeUs = eyeGet32(buf + 18);
+		for (uint8_t p = 0; (p < eye[e].numPhases) && !errorStatus; p++)
+		{
+			if (fread(buf, 2, eye[e].numMargins, fp) != eye[e].numMargins)
+				errorStatus |= 1;
+			for (uint8_t m = 0; m < eye[e].numMargins; m++)
+				eye[e].ber[p * eye[e].numMargins + m] = eyeGet16(buf + 2 * m);
+		}
+		if (!errorStatus)
+			(*numEyes)++;
+	}
+	fclose(fp);
+	if (errorStatus)
+	{
+		afeLogErr("SerDes eye file %s is truncated", file);
+		return RET_EXEC_FAIL;
+	}
+	return RET_OK;
+}
@@ -0,0 +1,388 @@
+/** @file spiTrace.c
+ * 	@brief	Binary trace of the SPI operations.<br>
+ * 		The SPI wrappers in basicFunctions.c record every operation in a fixed size ring per AFE, without formatting any text.
+ * 		A capture saved with afeSpiTraceSave is turned back into a format 0 script by afeSpiTraceDecode, which can be run
+ * 		with configAfeFromFile or compiled with compileAfeScript.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include "afe79xxLog.h"
+#include "afe79xxTypes.h"
+
+#include "afeCommonMacros.h"
+
+#include "baseFunc.h"
+#include "spiTrace.h"
+
+/* Trace file format. All fields are little endian.
+   Header (AFE_SPI_TRACE_HEADER_LEN bytes):
+     0  magic "AFET"     4  version (2 bytes)     6  entry length (2 bytes)
+     8  entry count      12 entries dropped before the first one
+   Entries follow oldest first:
+     0  time in us (4 bytes)     4  addr (2 bytes)     6  data (2 bytes)
+     8  afeId   9  op   10 lsb   11 msb   12 result   13-15 reserved
+   For CHECK and POLL entries the low byte of data is the expected value and the high byte the value read last. */
+#define AFE_SPI_TRACE_MAGIC "AFET"
+#define AFE_SPI_TRACE_VERSION 1
+#define AFE_SPI_TRACE_HEADER_LEN 16
+#define AFE_SPI_TRACE_ENTRY_LEN 16
+
+#if (AFE_SPI_TRACE_DEPTH & (AFE_SPI_TRACE_DEPTH - 1)) != 0
+#error AFE_SPI_TRACE_DEPTH should be a power of 2.
+#endif
+
+typedef struct AFE_SPI_TRACE_ENTRY
+{
+    uint32_t timeUs;
+    uint16_t addr;
+    uint16_t data;
+    uint8_t afeId;
+    uint8_t op;
+    uint8_t lsb;
+    uint8_t msb;
+    uint8_t result;
+} AfeSpiTraceEntry_t;
+
+/* Each AFE is driven by one thread at a time, so every ring has a single producer and needs no lock.
+   head counts all the entries recorded since the last clear, the slot is head modulo the depth. The producer publishes an entry with a
+   release store of head, afeSpiTraceSave and afeSpiTraceGetStats load head with acquire, so the entries below it are complete. */
+typedef struct AFE_SPI_TRACE_RING
+{
+    volatile uint8_t enabled;
+    uint32_t head;
+    AfeSpiTraceEntry_t entry[AFE_SPI_TRACE_DEPTH];
+} AfeSpiTraceRing_t;
+
+static AfeSpiTraceRing_t afeSpiTraceRing[NUM_OF_AFE];
+
+static void spiTracePut16(uint8_t *buf, uint16_t val)
+{
+    buf[0] = (uint8_t)val;
+    buf[1] = (uint8_t)(val >> 8);
+}
+
+static void spiTracePut32(uint8_t *buf, uint32_t val)
+{
+    spiTracePut16(buf, (uint16_t)val);
+    spiTracePut16(buf + 2, (uint16_t)(val >> 16));
+}
+
+static uint16_t spiTraceGet16(const uint8_t *buf)
+{
+    return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+static uint32_t spiTraceGet32(const uint8_t *buf)
+{
+    return spiTraceGet16(buf) | ((uint32_t)spiTraceGet16(buf + 2) << 16);
+}
+
+/**
+    @brief Records one SPI operation
+    @details Called by the SPI wrappers after each operation. Returns at once when the trace of the AFE is disabled.
+    @param afeId AFE ID
+    @param op Operation, one of AFE_SPI_TRACE_OP_*.
+    @param addr SPI address, or SerDes address for the SerDes operations.
+    @param data Value written or read. For CHECK and POLL, the expected value in the low byte and the read value in the high byte.
+    @param lsb lsb of the field.
+    @param msb msb of the field.
+    @param result Return value of the operation. CHECK entries add AFE_SPI_TRACE_RESULT_MISMATCH when the value didn't match.
+*/
+void afeSpiTraceRecord(uint8_t afeId, uint8_t op, uint16_t addr, uint16_t data, uint8_t lsb, uint8_t msb, uint8_t result)
+{
+    AfeSpiTraceRing_t *ring;
+    AfeSpiTraceEntry_t *entry;
+    uint32_t head;
+
+    if ((afeId >= NUM_OF_AFE) || !afeSpiTraceRing[afeId].enabled)
+        return;
+    ring = &afeSpiTraceRing[afeId];
+    head = ring->head;
+    entry = &ring->entry[head & (AFE_SPI_TRACE_DEPTH - 1)];
+    entry->timeUs = (uint32_t)getTimeUs();
+    entry->addr = addr;
+    entry->data = data;
+    entry->afeId = afeId;
+    entry->op = op;
+    entry->lsb = lsb;
+    entry->msb = msb;
+    entry->result = result;
+    AFE_RING_STORE_RELEASE(&ring->head, head + 1);
+}
+
+/**
+    @brief Enables the SPI Trace
+    @details Starts or stops recording the SPI operations of the AFE. The entries already recorded are kept.
+    @param afeId AFE ID
+    @param enable 1 to record, 0 to stop.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiTraceEnable(uint8_t afeId, uint8_t enable)
+{
+    AFE_ID_VALIDITY();
+    afeSpiTraceRing[afeId].enabled = (enable != 0);
+    return RET_OK;
+}
+
+/**
+    @brief Clears the SPI Trace
+    @details Drops all the recorded entries of the AFE. Call it while the AFE is idle.
+    @param afeId AFE ID
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiTraceClear(uint8_t afeId)
+{
+    AFE_ID_VALIDITY();
+    AFE_RING_STORE_RELEASE(&afeSpiTraceRing[afeId].head, 0);
+    return RET_OK;
+}
+
+/**
+    @brief SPI Trace Counters
+    @details Returns how many operations were recorded since the last clear and how many of them were overwritten because the ring was full.
+    @param afeId AFE ID
+    @param recorded Pointer returning the number of operations recorded.
+    @param dropped Pointer returning the number of operations no longer in the ring.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiTraceGetStats(uint8_t afeId, uint32_t *recorded, uint32_t *dropped)
+{
+    uint32_t head;
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID((recorded != NULL) && (dropped != NULL));
+    head = AFE_RING_LOAD_ACQUIRE(&afeSpiTraceRing[afeId].head);
+    *recorded = head;
+    *dropped = (head > AFE_SPI_TRACE_DEPTH) ? (head - AFE_SPI_TRACE_DEPTH) : 0;
+    return RET_OK;
+}
+
+/**
+    @brief Saves the SPI Trace
+    @details Writes the entries in the ring of the AFE to a binary capture file, oldest first. The ring is not cleared.
+        It can be called while the AFE is running, but the entries overwritten during the save are reported as an error, so it is best called when the AFE is idle.
+    @param afeId AFE ID
+    @param file Path of the capture file to be written.
+    @return Returns if the function execution passed or failed.
+*/
+uint8_t afeSpiTraceSave(uint8_t afeId, char *file)
+{
+    uint8_t errorStatus = 0;
+    AfeSpiTraceRing_t *ring;
+    uint8_t buf[AFE_SPI_TRACE_HEADER_LEN];
+    uint32_t head, count, overwritten;
+    FILE *fp;
+
+    AFE_ID_VALIDITY();
+    AFE_PARAMS_VALID(file != NULL);
+    ring = &afeSpiTraceRing[afeId];
+    head = AFE_RING_LOAD_ACQUIRE(&ring->head);
+    count = (head > AFE_SPI_TRACE_DEPTH) ? AFE_SPI_TRACE_DEPTH : head;
+
+    fp = fopen(file, "wb");
+    if (NULL == fp)
+    {
+        printf("File open error.\n");
+        return RET_EXEC_FAIL;
+    }
+    memcpy(buf, AFE_SPI_TRACE_MAGIC, 4);
+    spiTracePut16(buf + 4, AFE_SPI_TRACE_VERSION);
+    spiTracePut16(buf + 6, AFE_SPI_TRACE_ENTRY_LEN);
+    spiTracePut32(buf + 8, count);
+    spiTracePut32(buf + 12, head - count);
+    if (fwrite(buf, 1, AFE_SPI_TRACE_HEADER_LEN, fp) != AFE_SPI_TRACE_HEADER_LEN)
+        errorStatus |= 1;
+    for (uint32_t i = head - count; (i != head) && !errorStatus; i++)
+    {
+        const AfeSpiTraceEntry_t *entry = &ring->entry[i & (AFE_SPI_TRACE_DEPTH - 1)];
+        memset(buf, 0, AFE_SPI_TRACE_ENTRY_LEN);
+        spiTracePut32(buf, entry->timeUs);
+        spiTracePut16(buf + 4, entry->addr);
+        spiTracePut16(buf + 6, entry->data);
+        buf[8] = entry->afeId;
+        buf[9] = entry->op;
+        buf[10] = entry->lsb;
+        buf[11] = entry->msb;
+        buf[12] = entry->result;
+        if (fwrite(buf, 1, AFE_SPI_TRACE_ENTRY_LEN, fp) != AFE_SPI_TRACE_ENTRY_LEN)
+            errorStatus |= 1;
+    }
+    if (fclose(fp) != 0)
+        errorStatus |= 1;
+    if (errorStatus)
+    {
+        afeLogErr("Writing SPI trace %s failed", file);
+        return RET_EXEC_FAIL;
+    }
+    /* Entries the producer reached while they were written out may be mixed up. */
+    overwritten = AFE_RING_LOAD_ACQUIRE(&ring->head) - head;
+    if (overwritten > AFE_SPI_TRACE_DEPTH - count)
+    {
+        afeLogErr("SPI trace of AFE %d changed during the save, the oldest %d entries of %s may be invalid", afeId, overwritten - (AFE_SPI_TRACE_DEPTH - count), file);
+        return RET_EXEC_FAIL;
+    }
+    afeLogInfo("Saved %d SPI trace entries of AFE %d to %s, %d dropped", count, afeId, file, head - count);
+    return RET_OK;
+}
+
+/* Writes the page select registers known from the trace, so the operations that follow can be read in context. */
+static void spiTraceWritePages(FILE *fp, const uint8_t *pageValue, uint16_t pageKnown)
+{
+    uint8_t anyOpen = 0;
+    fprintf(fp, "// pages:");
+    for (uint8_t i = 0; i < AFE_NUM_PAGE_REGS; i++)
+    {
+        if ((pageKnown & (1 << i)) && (pageValue[i] != 0))
+        {
+            fprintf(fp, " 0x%04x=0x%02x", AFE_PAGE_START_ADDR + i, pageValue[i]);
+            anyOpen = 1;
+        }
+    }
+    if (!anyOpen)
+        fprintf(fp, " none open");
+    if (pageKnown != (1 << AFE_NUM_PAGE_REGS) - 1)
+        fprintf(fp, " (not all written in the trace)");
+    fprintf(fp, "\n");
+}
+
+/**
+    @brief Decodes an SPI Trace to a Script
+    @details Turns a capture of afeSpiTraceSave into a format 0 Latte script, which replays the traced writes, reads, checks and polls in order.
+        A comment with the open pages is added whenever the page select registers change. SerDes operations are written as the SPI accesses they are made of.
+        Operations that failed are written as comments. Read values are added as comments at the end of the lines.
+    @param traceFile Capture file written by afeSpiTraceSave.
+    @param scriptFile Path of the format 0 script to be written.
+    @param minWaitUs Gaps between two operations of at least this many micro seconds are written as waits, rounded up to milli seconds. 0 writes no waits.
+    @return Returns if the function execution passed or failed.
+*/
+int8_t afeSpiTraceDecode(char *traceFile, char *scriptFile, uint32_t minWaitUs)
+{
+    uint8_t errorStatus = 0;
+    uint8_t buf[AFE_SPI_TRACE_HEADER_LEN];
+    uint8_t pageValue[AFE_NUM_PAGE_REGS] = {0};
+    uint16_t pageKnown = 0;
+    uint8_t pagesChanged = 0;
+    uint32_t count, dropped, prevTimeUs = 0;
+    FILE *fp, *out;
+
+    AFE_PARAMS_VALID((traceFile != NULL) && (scriptFile != NULL));
+    fp = fopen(traceFile, "rb");
+    if (NULL == fp)
+    {
+        printf("File open error.\n");
+        return RET_EXEC_FAIL;
+    }
+    if (fread(buf, 1, AFE_SPI_TRACE_HEADER_LEN, fp) != AFE_SPI_TRACE_HEADER_LEN || memcmp(buf, AFE_SPI_TRACE_MAGIC, 4) != 0 || spiTraceGet16(buf + 4) != AFE_SPI_TRACE_VERSION || spiTraceGet16(buf + 6) != AFE_SPI_TRACE_ENTRY_LEN)
+    {
+        afeLogErr("%s is not an SPI trace or has an unsupported version.", traceFile);
+        fclose(fp);
+        return RET_EXEC_FAIL;
+    }
+    count = spiTraceGet32(buf + 8);
+    dropped = spiTraceGet32(buf + 12);
+    out = fopen(scriptFile, "w");
+    if (NULL == out)
+    {
+        printf("File open error.\n");
+        fclose(fp);
+        return RET_EXEC_FAIL;
+    }
+    fprintf(out, "// SPI trace %s: %d operations, %d older operations dropped\n", traceFile, count, dropped);
+
+    for (uint32_t i = 0; (i < count) && !errorStatus; i++)
+    {
+        uint32_t timeUs;
+        uint16_t addr, data, serdesAddr;
+        uint8_t afeId, op, lsb, msb, result;
+        const char *failed;
+
+        if (fread(buf, 1, AFE_SPI_TRACE_ENTRY_LEN, fp) != AFE_SPI_TRACE_ENTRY_LEN)
+        {
+            afeLogErr("SPI trace %s ends after %d of %d entries", traceFile, i, count);
+            errorStatus |= 1;
+            break;
+        }
+        timeUs = spiTraceGet32(buf);
+        addr = spiTraceGet16(buf + 4);
+        data = spiTraceGet16(buf + 6);
+        afeId = buf[8];
+        op = buf[9];
+        lsb = buf[10];
+        msb = buf[11];
+        result = buf[12];
+        failed = ((result & ~AFE_SPI_TRACE_RESULT_MISMATCH) != RET_OK) ? "// failed: " : "";
+
+        if (i == 0)
+            fprintf(out, "// AFE %d\n", afeId);
+        else if ((minWaitUs != 0) && (timeUs - prevTimeUs >= minWaitUs))
+            fprintf(out, "wait %.3f\n", (double)((timeUs - prevTimeUs + 999) / 1000) / 1000);
+        prevTimeUs = timeUs;
+
+        if ((op == AFE_SPI_TRACE_OP_WRITE) && (addr >= AFE_PAGE_START_ADDR) && (addr <= AFE_PAGE_END_ADDR))
+        {
+            uint8_t index = (uint8_t)(addr - AFE_PAGE_START_ADDR);
+            uint8_t mask = (uint8_t)(((1 << (msb - lsb + 1)) - 1) << lsb);
+            uint8_t oldValue = pageValue[index];
+            uint16_t oldKnown = pageKnown;
+            fprintf(out, "%sspiwrite 0x%04x,0x%02x,%d,%d\n", failed, addr, data & 0xff, lsb, msb);
+            if (result != RET_OK)
+                pageKnown &= ~(1 << index);
+            else if (mask == 0xff)
+            {
+                pageValue[index] = (uint8_t)data;
+                pageKnown |= (1 << index);
+            }
+            else
+                pageValue[index] = (pageValue[index] & ~mask) | (data & mask);
+            if ((pageValue[index] != oldValue) || (pageKnown != oldKnown))
+                pagesChanged = 1;
+            continue;
+        }
+        if (pagesChanged)
+        {
+            spiTraceWritePages(out, pageValue, pageKnown);
+            pagesChanged = 0;
+        }
+
+        switch (op)
+        {
+        case AFE_SPI_TRACE_OP_WRITE:
+            fprintf(out, "%sspiwrite 0x%04x,0x%02x,%d,%d\n", failed, addr, data & 0xff, lsb, msb);
+            break;
+        case AFE_SPI_TRACE_OP_READ:
+            fprintf(out, "%sspiread 0x%04x,%d,%d // 0x%02x\n", failed, addr, lsb, msb, data & 0xff);
+            break;
+        case AFE_SPI_TRACE_OP_CHECK:
+            fprintf(out, "%sSPIReadCheck 0x%04x,%d,%d,0x%02x // read 0x%02x%s\n", failed, addr, lsb, msb, data & 0xff, data >> 8, (result & AFE_SPI_TRACE_RESULT_MISMATCH) ? ", mismatch" : "");
+            break;
+        case AFE_SPI_TRACE_OP_POLL:
+            /* A poll that timed out is part of the sequence, so it is replayed as well. */
+            fprintf(out, "spipoll 0x%04x,%d,%d,0x%02x // read 0x%02x%s\n", addr, lsb, msb, data & 0xff, data >> 8, (result != RET_OK) ? ", failed" : "");
+            break;
+        case AFE_SPI_TRACE_OP_SERDES_WRITE:
+            serdesAddr = (uint16_t)((addr + 0x2000) << 1);
+            fprintf(out, "// serdes write 0x%04x = 0x%04x%s\n", addr, data, (result != RET_OK) ? ", failed" : "");
+            fprintf(out, "%sspiwrite 0x%04x,0x%02x,0,7\n", failed, (serdesAddr + 1) & 0x7fff, data >> 8);
+            fprintf(out, "%sspiwrite 0x%04x,0x%02x,0,7\n", failed, serdesAddr & 0x7fff, data & 0xff);
+            break;
+        case AFE_SPI_TRACE_OP_SERDES_READ:
+            /* serdesRawRead reads every byte twice. */
+            serdesAddr = (uint16_t)(((addr + 0x2000) & 0x3fff) << 1);
+            fprintf(out, "// serdes read 0x%04x = 0x%04x%s\n", addr, data, (result != RET_OK) ? ", failed" : "");
+            fprintf(out, "%sspiread 0x%04x,0,7\n%sspiread 0x%04x,0,7\n", failed, serdesAddr + 1, failed, serdesAddr + 1);
+            fprintf(out, "%sspiread 0x%04x,0,7\n%sspiread 0x%04x,0,7\n", failed, serdesAddr, failed, serdesAddr);
+            break;
+        default:
+            fprintf(out, "// unknown trace entry: op %d, addr 0x%04x, data 0x%04x\n", op, addr, data);
+            break;
+        }
+    }
+    fclose(fp);
+    if (fclose(out) != 0)
+        errorStatus |= 1;
+    if (errorStatus)
+        return RET_EXEC_FAIL;
+    afeLogInfo("Decoded %d SPI trace entries from %s to %s", count, traceFile, scriptFile);
+    return RET_OK;
+}
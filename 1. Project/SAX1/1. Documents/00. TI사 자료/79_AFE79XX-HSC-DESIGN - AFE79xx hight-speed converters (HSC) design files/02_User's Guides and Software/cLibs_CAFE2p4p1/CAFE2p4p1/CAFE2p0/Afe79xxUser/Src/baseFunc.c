@@ -34,6 +34,27 @@ uint8_t dev_spi_write(uint8_t afeId, uint16_t addr, uint8_t data)
     return RET_OK;
 }
 
+/**
+    @brief AFE SPI batch write driver function.
+    @details Writes a list of registers in order. The contents of this function should be replaced by host SPI driver function.<br>
+        Drivers which can queue several transactions into one transfer should do so here. The default calls dev_spi_write for each entry.
+    @param afeId AFE ID
+	@param addr Array of addresses to be written to.
+	@param data Array of values to be written.
+	@param count Number of entries in addr and data.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t dev_spi_write_batch(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count)
+{
+    /* TBD: User domain */
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (dev_spi_write(afeId, addr[i], data[i]) != RET_OK)
+            return RET_EXEC_FAIL;
+    }
+    return RET_OK;
+}
+
 /**
     @brief AFE SPI read driver function.
     @details AFE SPI read driver function and returns the read value as pointer. The contents of this function should be replaced by host SPI driver function.
@@ -50,6 +71,48 @@ uint8_t dev_spi_read(uint8_t afeId, uint16_t addr, uint8_t *readVal)
     return RET_OK;
 }
 
+/**
+    @brief AFE SPI burst write driver function.
+    @details Writes count bytes to the consecutive addresses starting at addr. The contents of this function should be replaced by host SPI driver function.<br>
+        Drivers should send the address once followed by all the data bytes in one chip select window, the AFE increments the address after every byte. The default calls dev_spi_write for each byte.
+    @param afeId AFE ID
+	@param addr Address of the first byte.
+	@param data Array of values to be written.
+	@param count Number of bytes in data.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t dev_spi_write_burst(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count)
+{
+    /* TBD: User domain */
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (dev_spi_write(afeId, addr + i, data[i]) != RET_OK)
+            return RET_EXEC_FAIL;
+    }
+    return RET_OK;
+}
+
+/**
+    @brief AFE SPI burst read driver function.
+    @details Reads count bytes from the consecutive addresses starting at addr. The contents of this function should be replaced by host SPI driver function.<br>
+        Drivers should send the address once and clock in all the data bytes in one chip select window. The default calls dev_spi_read for each byte.
+    @param afeId AFE ID
+	@param addr Address of the first byte.
+	@param data Array returning the values read.
+	@param count Number of bytes to read.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t dev_spi_read_burst(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count)
+{
+    /* TBD: User domain */
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (dev_spi_read(afeId, addr + i, &data[i]) != RET_OK)
+            return RET_EXEC_FAIL;
+    }
+    return RET_OK;
+}
+
 /**
     @brief AFE single shot Pin Sysref.
     @details AFE single shot pin sysref driver function. The contents of this function should be replaced by host driver function.
@@ -142,6 +205,32 @@ uint8_t waitMs(uint32_t wait_ms)
     return RET_OK;
 }
 
+/**
+    @brief Monotonic Time in micro Seconds
+    @details Returns a monotonic time stamp in micro seconds, used only to report execution times. The contents of this function should be replaced by host driver function.
+	@return Time in micro seconds from an arbitrary start point. 0 if no timer is available.
+*/
+uint64_t getTimeUs(void)
+{
+    /* TBD: User domain */
+    return 0;
+}
+
+/**
+    @brief Wait for the AFE Alarm Pin
+    @details Blocks until the AFE alarm GPIO assigned to the macro status is asserted, or until the timeout. Used by the AFE_MACRO_WAIT_EVENT mode of the macro completion (afeMacroSetWaitMode) in place of polling the status register. The contents of this function should be replaced by host driver function, for example a wait on a GPIO interrupt.
+    @param afeId AFE ID
+    @param timeout_ms Maximum wait in milli seconds.
+	@return RET_OK if the pin was asserted, RET_EXEC_FAIL on timeout. AFE_ALARM_PIN_UNSUPPORTED if the host can't watch the pin, the macro status is then polled.
+*/
+uint8_t waitForAfeAlarmPin(uint8_t afeId, uint32_t timeout_ms)
+{
+    (void)afeId;
+    (void)timeout_ms;
+    /* TBD: User domain */
+    return AFE_ALARM_PIN_UNSUPPORTED;
+}
+
 static uint32_t AFE_CURRENT_LOG_LEVEL = AFE_LOG_LEVEL_INFO;
 
 /**
@@ -0,0 +1,233 @@
+/** @file mockDevice.c
+ * 	@brief	Mock AFE for the host tests. The driver functions read and write mockDevice.regs, count the SPI transactions and advance a simulated clock.
+ * 		Tests that never finish are stopped after MOCK_DEVICE_ACCESS_LIMIT SPI accesses.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afe79xxLog.h"
+#include "baseFunc.h"
+#include "mockDevice.h"
+
+MockDevice_t mockDevice;
+int testFailures = 0;
+static uint32_t mockLogLevel = AFE_LOG_LEVEL_ERROR;
+
+void mockDeviceReset(void)
+{
+    memset(&mockDevice, 0, sizeof(mockDevice));
+}
+
+/*  Counts a driver call. Returns 1 when it is the call set to fail by mockDevice.failTransaction.   */
+static uint8_t mockDeviceTransaction(void)
+{
+    mockDevice.transactions++;
+    return mockDevice.transactions == mockDevice.failTransaction;
+}
+
+static void mockDeviceAccess(void)
+{
+    mockDevice.timeUs += mockDevice.usPerAccess;
+    if (mockDevice.reads + mockDevice.writes >= MOCK_DEVICE_ACCESS_LIMIT)
+    {
+        printf("mock device: more than %d SPI accesses, the test hangs\n", MOCK_DEVICE_ACCESS_LIMIT);
+        exit(1);
+    }
+}
+
+static uint8_t mockMcuPage(uint16_t addr, uint16_t regAddr)
+{
+    return mockDevice.mcuModel && (addr == regAddr) && (mockDevice.regs[AFE_MACRO_PAGE_REG_ADDR] == AFE_MACRO_PAGE_SEL_VAL);
+}
+
+static void mockMcuTrigger(uint8_t opcode)
+{
+    if (mockDevice.mcuTriggers < MOCK_MCU_MAX_TRIGGERS)
+    {
+        mockDevice.mcuOpcodes[mockDevice.mcuTriggers] = opcode;
+        mockDevice.mcuOperands[mockDevice.mcuTriggers] = mockDevice.regs[AFE_MACRO_OPERAND_START_REG_ADDR];
+    }
+    mockDevice.mcuTriggers++;
+    mockDevice.mcuStatusReads = 0;
+}
+
+static uint8_t mockMcuStatus(void)
+{
+    uint8_t opcode;
+    if (mockDevice.mcuTriggers == 0)
+        return 0x1;
+    if (mockDevice.mcuStatusReads < mockDevice.mcuRunReads)
+    {
+        mockDevice.mcuStatusReads++;
+        return 0x1;
+    }
+    opcode = mockDevice.regs[AFE_MACRO_OPCODE_REG_ADDR];
+    return 0x7 | ((opcode == mockDevice.mcuErrorOpcode) ? mockDevice.mcuErrorBits : 0);
+}
+
+static void mockDeviceWrite(uint16_t addr, uint8_t data)
+{
+    mockDevice.writes++;
+    mockDeviceAccess();
+    if ((mockDevice.writeHook != NULL) && mockDevice.writeHook(addr, data))
+        return;
+    mockDevice.regs[addr & 0x7fff] = data;
+    if (mockMcuPage(addr, AFE_MACRO_OPCODE_REG_ADDR))
+        mockMcuTrigger(data);
+}
+
+static void mockDeviceRead(uint16_t addr, uint8_t *readVal)
+{
+    mockDevice.reads++;
+    mockDeviceAccess();
+    if ((mockDevice.readHook != NULL) && mockDevice.readHook(addr, readVal))
+        return;
+    if (mockMcuPage(addr, AFE_MACRO_STATUS_REG_ADDR))
+    {
+        *readVal = mockMcuStatus();
+        return;
+    }
+    *readVal = mockDevice.regs[addr & 0x7fff];
+}
+
+uint8_t dev_spi_write(uint8_t afeId, uint16_t addr, uint8_t data)
+{
+    (void)afeId;
+    if (mockDeviceTransaction())
+        return RET_EXEC_FAIL;
+    mockDeviceWrite(addr, data);
+    return RET_OK;
+}
+
+uint8_t dev_spi_read(uint8_t afeId, uint16_t addr, uint8_t *readVal)
+{
+    (void)afeId;
+    if (mockDeviceTransaction())
+        return RET_EXEC_FAIL;
+    mockDeviceRead(addr, readVal);
+    return RET_OK;
+}
+
+uint8_t dev_spi_write_batch(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count)
+{
+    (void)afeId;
+    if (mockDeviceTransaction())
+        return RET_EXEC_FAIL;
+    for (uint16_t i = 0; i < count; i++)
+        mockDeviceWrite(addr[i], data[i]);
+    return RET_OK;
+}
+
+uint8_t dev_spi_write_burst(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count)
+{
+    (void)afeId;
+    if (mockDeviceTransaction())
+        return RET_EXEC_FAIL;
+    mockDevice.bursts++;
+    for (uint16_t i = 0; i < count; i++)
+        mockDeviceWrite(addr + (mockDevice.burstFixedAddr ? 0 : i), data[i]);
+    return RET_OK;
+}
+
+uint8_t dev_spi_read_burst(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count)
+{
+    (void)afeId;
+    if (mockDeviceTransaction())
+        return RET_EXEC_FAIL;
+    mockDevice.bursts++;
+    for (uint16_t i = 0; i < count; i++)
+        mockDeviceRead(addr + (mockDevice.burstFixedAddr ? 0 : i), &data[i]);
+    return RET_OK;
+}
+
+uint8_t wait(uint32_t wait_s)
+{
+    return waitMs(wait_s * 1000);
+}
+
+uint8_t waitMs(uint32_t wait_ms)
+{
+    mockDevice.waits++;
+    mockDevice.waitedMs += wait_ms;
+    if (mockDevice.waitAdvancesClock)
+        mockDevice.timeUs += (uint64_t)wait_ms * 1000;
+    return RET_OK;
+}
+
+uint64_t getTimeUs(void)
+{
+    return mockDevice.timeUs;
+}
+
+uint8_t waitForAfeAlarmPin(uint8_t afeId, uint32_t timeout_ms)
+{
+    (void)afeId;
+    if (mockDevice.alarmPin == MOCK_ALARM_PIN_NONE)
+        return AFE_ALARM_PIN_UNSUPPORTED;
+    mockDevice.pinWaits++;
+    if (mockDevice.alarmPin == MOCK_ALARM_PIN_DONE)
+    {
+        /*  The macro finishes while the host sleeps on the pin.   */
+        mockDevice.mcuStatusReads = mockDevice.mcuRunReads;
+        return RET_OK;
+    }
+    mockDevice.pinWaitedMs += timeout_ms;
+    if (mockDevice.waitAdvancesClock)
+        mockDevice.timeUs += (uint64_t)timeout_ms * 1000;
+    return RET_EXEC_FAIL;
+}
+
+void afeLogmsg(uint32_t level, const char *pcLogFmt, ...)
+{
+    va_list args;
+    char buf[1024];
+    mockDevice.logCalls++;
+    if (level == AFE_LOG_LEVEL_ERROR)
+        mockDevice.logErrors++;
+    if (level > mockLogLevel)
+        return;
+    va_start(args, pcLogFmt);
+    if (mockDevice.quiet)
+        vsnprintf(buf, sizeof(buf), pcLogFmt, args);
+    else
+        vprintf(pcLogFmt, args);
+    va_end(args);
+}
+
+void setAfeLogLvl(uint32_t level)
+{
+    mockLogLevel = level;
+}
+
+uint32_t getAfeLogLvl()
+{
+    return mockLogLevel;
+}
+
+uint8_t giveSingleSysrefPulse(uint8_t afeId)
+{
+    (void)afeId;
+    return RET_OK;
+}
+
+uint8_t giveAfeAdcInput(uint8_t afeId, uint8_t rxChNo, uint8_t bandNo)
+{
+    (void)afeId;
+    (void)rxChNo;
+    (void)bandNo;
+    return RET_OK;
+}
+
+uint8_t connectAfeTxToFb(uint8_t afeId, uint8_t txChNo, uint8_t fbChNo, uint8_t bandNo)
+{
+    (void)afeId;
+    (void)txChNo;
+    (void)fbChNo;
+    (void)bandNo;
+    return RET_OK;
+}
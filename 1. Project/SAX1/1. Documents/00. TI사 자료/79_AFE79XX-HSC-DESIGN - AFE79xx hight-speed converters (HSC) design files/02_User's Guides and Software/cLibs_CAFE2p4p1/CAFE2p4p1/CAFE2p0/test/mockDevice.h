@@ -0,0 +1,83 @@
+/** @file mockDevice.h
+ * 	@brief	Mock AFE for the host tests. Replaces the driver functions of baseFunc.c with a register array and a simulated clock.
+*/
+
+#ifndef MOCK_DEVICE_H
+#define MOCK_DEVICE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/// SPI accesses after which a test is stopped as hung.
+#define MOCK_DEVICE_ACCESS_LIMIT 1000000
+/// What waitForAfeAlarmPin does: not supported, asserted once the running macro is done, or never asserted (waits for the timeout).
+#define MOCK_ALARM_PIN_NONE 0
+#define MOCK_ALARM_PIN_DONE 1
+#define MOCK_ALARM_PIN_STUCK 2
+/// Triggered macros mockDevice.mcuOpcodes records.
+#define MOCK_MCU_MAX_TRIGGERS 64
+
+typedef struct MOCK_DEVICE
+{
+    /// Register values, by SPI address.
+    uint8_t regs[0x8000];
+    /// Simulated time returned by getTimeUs.
+    uint64_t timeUs;
+    /// Time an SPI access takes. 0 freezes the clock, as the getTimeUs of the user template does.
+    uint32_t usPerAccess;
+    /// When 0, waitMs returns at once without advancing the clock, as the waitMs of the user template does.
+    uint8_t waitAdvancesClock;
+    /// Called for every read before the register array. Returns 1 if it set the value.
+    uint8_t (*readHook)(uint16_t addr, uint8_t *value);
+    /// Called for every write before the register array. Returns 1 if it took the value.
+    uint8_t (*writeHook)(uint16_t addr, uint8_t value);
+    /// When 1, the macro status register answers as the MCU: Macro_Ready is always set, and Macro_ACK and Macro_Done are set once the macro triggered
+    /// by the last write of the opcode register has been seen running by mcuRunReads status reads.
+    uint8_t mcuModel;
+    uint32_t mcuRunReads;
+    /// Macros of this opcode finish with the error bits mcuErrorBits (status bits 7:3) set.
+    uint8_t mcuErrorOpcode;
+    uint8_t mcuErrorBits;
+    /// Opcodes and first operands of the triggered macros, in order, and their count.
+    uint8_t mcuOpcodes[MOCK_MCU_MAX_TRIGGERS];
+    uint8_t mcuOperands[MOCK_MCU_MAX_TRIGGERS];
+    uint32_t mcuTriggers;
+    uint32_t mcuStatusReads;
+    /// MOCK_ALARM_PIN_* behaviour of waitForAfeAlarmPin, its calls, and the time it waited for the pin. Advances the clock as waitMs does.
+    uint8_t alarmPin;
+    uint32_t pinWaits;
+    uint64_t pinWaitedMs;
+    /// When 1, every byte of a burst accesses its first address, as an AFE that does not step the address does.
+    uint8_t burstFixedAddr;
+    /// Set by the tests that expect errors, afeLogmsg then prints nothing.
+    uint8_t quiet;
+    /// Error messages logged, counted even when quiet.
+    uint32_t logErrors;
+    /// Calls of afeLogmsg at any level. When quiet, the messages at the log level are still formatted, into a buffer, as a logger would.
+    uint32_t logCalls;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t transactions;
+    /// Number of the driver call, counted as transactions, that fails without accessing the registers. 0 for none.
+    uint32_t failTransaction;
+    uint32_t bursts;
+    uint32_t waits;
+    uint64_t waitedMs;
+} MockDevice_t;
+
+extern MockDevice_t mockDevice;
+extern int testFailures;
+
+void mockDeviceReset(void);
+
+#define TEST_CHECK(cond)                                                          \
+    do                                                                            \
+    {                                                                             \
+        if (!(cond))                                                              \
+        {                                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);       \
+            testFailures++;                                                       \
+        }                                                                         \
+    } while (0)
+
+#endif
@@ -0,0 +1,402 @@
+/** @file testAfeScript.c
+ * 	@brief	Compiled bring-up scripts on the mock AFE. A random Latte log in format 0 and format 5 compiles to the same binary, and
+ * 		configAfeFromBinary and configAfeFromBinaryBuffer issue exactly the SPI sequence of configAfeFromFile, also when a read check stops the script.
+ * 		optimizeAfeScript is checked with every pass: the optimized script passes the read checks of the original, which compare every
+ * 		register the script touches at random points, leaves the same registers, and saves the SPI accesses it reports.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "basicFunctions.h"
+#include "init.h"
+#include "mockDevice.h"
+
+#define LOG_FILE0 "testAfeScript0.txt"
+#define LOG_FILE5 "testAfeScript5.txt"
+#define BIN_FILE0 "testAfeScript0.bin"
+#define BIN_FILE5 "testAfeScript5.bin"
+#define OPT_FILE "testAfeScriptOpt.bin"
+
+#define MAX_OPS 4000
+#define MAX_TRACE 40000
+#define MAX_IMAGE 65536
+
+#define OP_WRITE 1
+#define OP_READ 2
+#define OP_CHECK 3
+#define OP_POLL 4
+#define OP_WAIT 5
+
+typedef struct
+{
+    uint8_t op;
+    uint16_t addr;
+    uint8_t data;
+    uint8_t lsb;
+    uint8_t msb;
+    uint32_t waitMs;
+} ScriptOp_t;
+
+typedef struct
+{
+    uint8_t write;
+    uint16_t addr;
+    uint8_t value;
+} TraceEntry_t;
+
+/*  Page selects first, then the registers of the script. Those are banked by the value of the first page select, so a write that
+    looks dead across a page select is not.   */
+static const uint16_t scriptAddrs[] = {0x10, 0x11, 0x12, 0x20, 0x21, 0x22, 0x23, 0x24, 0x4100, 0x4101};
+#define NUM_PAGE_ADDRS 3
+#define NUM_ADDRS (sizeof(scriptAddrs) / sizeof(scriptAddrs[0]))
+#define NUM_BANKS 3
+#define BANK(pageValue) ((pageValue) % NUM_BANKS)
+#define INITIAL_VALUE(bank, i) (uint8_t)(0x5A ^ ((i) * 29) ^ ((bank) * 0x11))
+
+static ScriptOp_t ops[MAX_OPS];
+static uint32_t numOps;
+static uint8_t model[NUM_BANKS][NUM_ADDRS];
+
+static uint8_t bankedRegs[NUM_BANKS][NUM_ADDRS];
+static TraceEntry_t trace[MAX_TRACE];
+static uint32_t traceLen;
+static uint8_t refBankedRegs[NUM_BANKS][NUM_ADDRS];
+static TraceEntry_t refTrace[MAX_TRACE];
+static uint32_t refTraceLen;
+static uint8_t refRegs[0x8000];
+static uint8_t image[MAX_IMAGE];
+
+static uint8_t *bankedReg(uint16_t addr)
+{
+    for (uint8_t i = NUM_PAGE_ADDRS; i < NUM_ADDRS; i++)
+    {
+        if (scriptAddrs[i] == addr)
+            return &bankedRegs[BANK(mockDevice.regs[scriptAddrs[0]])][i];
+    }
+    return NULL;
+}
+
+static void traceAccess(uint8_t write, uint16_t addr, uint8_t value)
+{
+    if (traceLen < MAX_TRACE)
+    {
+        trace[traceLen].write = write;
+        trace[traceLen].addr = addr;
+        trace[traceLen].value = value;
+    }
+    traceLen++;
+}
+
+static uint8_t traceRead(uint16_t addr, uint8_t *value)
+{
+    uint8_t *reg = bankedReg(addr);
+    if (reg == NULL)
+    {
+        traceAccess(0, addr, mockDevice.regs[addr & 0x7fff]);
+        return 0;
+    }
+    *value = *reg;
+    traceAccess(0, addr, *value);
+    return 1;
+}
+
+static uint8_t traceWrite(uint16_t addr, uint8_t value)
+{
+    uint8_t *reg = bankedReg(addr);
+    traceAccess(1, addr, value);
+    if (reg == NULL)
+        return 0;
+    *reg = value;
+    return 1;
+}
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.quiet = 1;
+    mockDevice.readHook = traceRead;
+    mockDevice.writeHook = traceWrite;
+    traceLen = 0;
+    for (uint8_t i = 0; i < NUM_ADDRS; i++)
+    {
+        mockDevice.regs[scriptAddrs[i]] = INITIAL_VALUE(0, i);
+        for (uint8_t bank = 0; bank < NUM_BANKS; bank++)
+            bankedRegs[bank][i] = INITIAL_VALUE(bank, i);
+    }
+}
+
+static void saveReference(void)
+{
+    memcpy(refTrace, trace, sizeof(trace));
+    refTraceLen = traceLen;
+    memcpy(refRegs, mockDevice.regs, sizeof(refRegs));
+    memcpy(refBankedRegs, bankedRegs, sizeof(refBankedRegs));
+}
+
+static uint8_t sameRegsAsReference(void)
+{
+    return (memcmp(mockDevice.regs, refRegs, sizeof(refRegs)) == 0) && (memcmp(bankedRegs, refBankedRegs, sizeof(refBankedRegs)) == 0);
+}
+
+static uint8_t sameAsReference(void)
+{
+    return (traceLen == refTraceLen) && (traceLen <= MAX_TRACE) && (memcmp(trace, refTrace, traceLen * sizeof(TraceEntry_t)) == 0) && sameRegsAsReference();
+}
+
+/*  Value the script sees at index, in the bank selected at this point of the script.   */
+static uint8_t *modelReg(uint8_t index)
+{
+    return &model[(index < NUM_PAGE_ADDRS) ? 0 : BANK(model[0][0])][index];
+}
+
+static void addOp(uint8_t op, uint8_t index, uint8_t data, uint8_t lsb, uint8_t msb)
+{
+    uint8_t mask = (uint8_t)(((1 << (msb + 1)) - 1) & (0xFF << lsb));
+    if (numOps >= MAX_OPS)
+        return;
+    ops[numOps].op = op;
+    ops[numOps].addr = scriptAddrs[index];
+    ops[numOps].data = data;
+    ops[numOps].lsb = lsb;
+    ops[numOps].msb = msb;
+    ops[numOps].waitMs = 0;
+    numOps++;
+    if (op == OP_WRITE)
+        *modelReg(index) = (uint8_t)((*modelReg(index) & (0xFF ^ mask)) | (data & mask));
+}
+
+/*  Writes the fields of one register from bit 0 up, as consecutive field writes, some of them left out.   */
+static void addFieldWrites(uint8_t index)
+{
+    uint8_t lsb = 0;
+    while (lsb < 8)
+    {
+        uint8_t msb = (uint8_t)(lsb + rand() % (8 - lsb));
+        if (rand() % 4)
+            addOp(OP_WRITE, index, (uint8_t)rand(), lsb, msb);
+        lsb = (uint8_t)(msb + 1);
+    }
+}
+
+/*  Checks every register, mostly the full byte, against the model.   */
+static void addSync(void)
+{
+    for (uint8_t i = 0; i < NUM_ADDRS; i++)
+    {
+        uint8_t lsb = (rand() % 4) ? 0 : (uint8_t)(rand() % 8);
+        uint8_t msb = (rand() % 4) ? 7 : (uint8_t)(lsb + rand() % (8 - lsb));
+        addOp(OP_CHECK, i, *modelReg(i), lsb, msb);
+    }
+}
+
+static void generateScript(unsigned int seed, uint32_t steps)
+{
+    srand(seed);
+    numOps = 0;
+    for (uint8_t i = 0; i < NUM_ADDRS; i++)
+    {
+        for (uint8_t bank = 0; bank < NUM_BANKS; bank++)
+            model[bank][i] = INITIAL_VALUE(bank, i);
+    }
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        int r = rand() % 100;
+        uint8_t index = (uint8_t)(NUM_PAGE_ADDRS + rand() % (NUM_ADDRS - NUM_PAGE_ADDRS));
+        uint8_t page = (uint8_t)(rand() % NUM_PAGE_ADDRS);
+        if (r < 30)
+            addOp(OP_WRITE, index, (uint8_t)rand(), 0, 7);
+        else if (r < 50)
+            addFieldWrites(index);
+        else if (r < 60)
+        {
+            /*  Page selects, often replaced or repeated before they are used.   */
+            addOp(OP_WRITE, page, (uint8_t)(rand() % 3), 0, 7);
+            if (rand() % 2)
+                addOp(OP_WRITE, page, (uint8_t)(rand() % 3), 0, 7);
+        }
+        else if (r < 67)
+        {
+            addOp(OP_WRITE, index, (uint8_t)rand(), 0, 7);
+            addOp(OP_WRITE, index, (uint8_t)rand(), (uint8_t)(rand() % 2), 7);
+        }
+        else if (r < 75)
+            addOp(OP_READ, index, 0, 0, 7);
+        else if (r < 83)
+            addSync();
+        else if (r < 90)
+            addOp(OP_POLL, index, *modelReg(index), 2, 5);
+        else if (numOps < MAX_OPS)
+        {
+            ops[numOps].op = OP_WAIT;
+            ops[numOps].waitMs = (rand() % 2) ? 125 : 250;
+            numOps++;
+        }
+    }
+    addSync();
+}
+
+/*  Writes the ops as a Latte log, with comments and blank lines the compiler drops.   */
+static void writeLog(const char *file, uint8_t logFormat)
+{
+    FILE *fp = fopen(file, "w");
+    TEST_CHECK(fp != NULL);
+    if (fp == NULL)
+        return;
+    for (uint32_t i = 0; i < numOps; i++)
+    {
+        ScriptOp_t *op = &ops[i];
+        if (i % 50 == 0)
+            fprintf(fp, (logFormat == 0) ? "//START: block %u\n\n" : "//START: block %u\n", i / 50);
+        if (logFormat == 0)
+        {
+            if (op->op == OP_WRITE)
+                fprintf(fp, "SPIWrite 0x%04x,0x%02x,%d,%d\n", op->addr, op->data, op->lsb, op->msb);
+            else if (op->op == OP_READ)
+                fprintf(fp, "SPIRead 0x%04x,%d,%d\n", op->addr, op->lsb, op->msb);
+            else if (op->op == OP_CHECK)
+                fprintf(fp, "SPIReadCheck 0x%04x,%d,%d,0x%02x\n", op->addr, op->lsb, op->msb, op->data);
+            else if (op->op == OP_POLL)
+                fprintf(fp, "SPIPoll 0x%04x,%d,%d,0x%02x\n", op->addr, op->lsb, op->msb, op->data);
+            else
+                fprintf(fp, "Wait %g\n", op->waitMs / 1000.0);
+        }
+        else
+        {
+            static const uint8_t format5Op[] = {1, 0, 2, 3};
+            if (op->op == OP_WAIT)
+                fprintf(fp, "{0x5,0x%x,0x0,0,0}\n", op->waitMs);
+            else
+                fprintf(fp, "{0x%x,0x%04x,0x%02x,%d,%d}\n", format5Op[op->op - 1], op->addr, op->data, op->lsb, op->msb);
+        }
+    }
+    fclose(fp);
+}
+
+static uint32_t readFile(const char *file, uint8_t *buf, uint32_t size)
+{
+    FILE *fp = fopen(file, "rb");
+    uint32_t len = 0;
+    if (fp == NULL)
+        return 0;
+    len = (uint32_t)fread(buf, 1, size, fp);
+    fclose(fp);
+    return len;
+}
+
+/*  The text loader, the compiled file and the compiled image issue the same SPI accesses and leave the same registers.   */
+static void testBinaryMatchesText(uint8_t logFormat, const char *logFile, const char *binFile)
+{
+    uint32_t parseTimeUs = 0, spiTimeUs = 0;
+    uint32_t imageLen;
+
+    setup();
+    TEST_CHECK(configAfeFromFile(0, logFormat, (char *)logFile, 1, 1) == RET_OK);
+    TEST_CHECK(traceLen <= MAX_TRACE);
+    saveReference();
+    uint64_t waitedMs = mockDevice.waitedMs;
+    uint32_t waits = mockDevice.waits;
+
+    TEST_CHECK(compileAfeScript(logFormat, (char *)logFile, (char *)binFile) == RET_OK);
+    setup();
+    TEST_CHECK(configAfeFromBinary(0, (char *)binFile, 1, 1, &parseTimeUs, &spiTimeUs) == RET_OK);
+    TEST_CHECK(sameAsReference());
+    TEST_CHECK(mockDevice.waits == waits);
+    TEST_CHECK(mockDevice.waitedMs == waitedMs);
+
+    imageLen = readFile(binFile, image, sizeof(image));
+    TEST_CHECK((imageLen > 0) && (imageLen < sizeof(image)));
+    setup();
+    TEST_CHECK(configAfeFromBinaryBuffer(0, image, imageLen, 1, 1, NULL, NULL) == RET_OK);
+    TEST_CHECK(sameAsReference());
+
+    /*  A corrupted image is rejected before any access.   */
+    image[imageLen / 2] ^= 0x1;
+    setup();
+    TEST_CHECK(configAfeFromBinaryBuffer(0, image, imageLen, 1, 1, NULL, NULL) == RET_EXEC_FAIL);
+    TEST_CHECK(traceLen == 0);
+}
+
+/*  A failing read check stops all the loaders at the same access, and with breakAtReadCheckFail 0 they all run on to the end and fail.   */
+static void testCheckFailure(void)
+{
+    uint32_t failAt = numOps / 2;
+    while (ops[failAt].op != OP_CHECK)
+        failAt++;
+    ops[failAt].data ^= (uint8_t)(1 << ops[failAt].msb);
+    writeLog(LOG_FILE0, 0);
+    TEST_CHECK(compileAfeScript(0, LOG_FILE0, BIN_FILE0) == RET_OK);
+
+    for (uint8_t breakAtFail = 0; breakAtFail <= 1; breakAtFail++)
+    {
+        setup();
+        TEST_CHECK(configAfeFromFile(0, 0, LOG_FILE0, 1, breakAtFail) == RET_EXEC_FAIL);
+        saveReference();
+        setup();
+        TEST_CHECK(configAfeFromBinary(0, BIN_FILE0, 1, breakAtFail, NULL, NULL) == RET_EXEC_FAIL);
+        TEST_CHECK(sameAsReference());
+    }
+    ops[failAt].data ^= (uint8_t)(1 << ops[failAt].msb);
+    writeLog(LOG_FILE0, 0);
+}
+
+/*  The optimized script passes every check of the original and leaves the same registers. The accesses it saves on the mock
+    are the ones optimizeAfeScript reports.   */
+static void testOptimizer(uint32_t flags, uint32_t *removed)
+{
+    uint32_t removedTransactions = 0;
+    uint32_t originalAccesses;
+
+    setup();
+    TEST_CHECK(configAfeFromBinary(0, BIN_FILE0, 1, 1, NULL, NULL) == RET_OK);
+    saveReference();
+    originalAccesses = mockDevice.reads + mockDevice.writes;
+
+    TEST_CHECK(optimizeAfeScript(BIN_FILE0, OPT_FILE, flags, &removedTransactions) == RET_OK);
+    setup();
+    TEST_CHECK(configAfeFromBinary(0, OPT_FILE, 1, 1, NULL, NULL) == RET_OK);
+    TEST_CHECK(sameRegsAsReference());
+    TEST_CHECK(mockDevice.reads + mockDevice.writes + removedTransactions == originalAccesses);
+    TEST_CHECK(removedTransactions > 0);
+    printf("optimizeAfeScript flags 0x%x: %u SPI accesses, %u removed\n", flags, originalAccesses, removedTransactions);
+    *removed = removedTransactions;
+}
+
+int main(void)
+{
+    uint8_t bin0[MAX_IMAGE];
+    uint32_t len0, len5;
+    uint32_t removedMerge, removedPages, removedDead, removedSafe, removedAll;
+
+    generateScript(11, 600);
+    writeLog(LOG_FILE0, 0);
+    writeLog(LOG_FILE5, 5);
+    testBinaryMatchesText(0, LOG_FILE0, BIN_FILE0);
+    testBinaryMatchesText(5, LOG_FILE5, BIN_FILE5);
+    len0 = readFile(BIN_FILE0, bin0, sizeof(bin0));
+    len5 = readFile(BIN_FILE5, image, sizeof(image));
+    TEST_CHECK((len0 == len5) && (memcmp(bin0, image, len0) == 0));
+
+    testCheckFailure();
+
+    TEST_CHECK(compileAfeScript(0, LOG_FILE0, BIN_FILE0) == RET_OK);
+    testOptimizer(AFE_SCRIPT_OPT_MERGE_FIELDS, &removedMerge);
+    testOptimizer(AFE_SCRIPT_OPT_PAGE_SELECTS, &removedPages);
+    testOptimizer(AFE_SCRIPT_OPT_DEAD_WRITES, &removedDead);
+    testOptimizer(AFE_SCRIPT_OPT_SAFE, &removedSafe);
+    testOptimizer(AFE_SCRIPT_OPT_ALL, &removedAll);
+    TEST_CHECK(removedSafe >= removedMerge + removedPages);
+    TEST_CHECK(removedAll > removedSafe);
+
+    /*  The optimized script is a valid input of the optimizer, which finds nothing more to remove with the same passes.   */
+    TEST_CHECK(optimizeAfeScript(OPT_FILE, BIN_FILE5, AFE_SCRIPT_OPT_SAFE, &removedSafe) == RET_OK);
+    TEST_CHECK(optimizeAfeScript(BIN_FILE5, OPT_FILE, AFE_SCRIPT_OPT_SAFE, &removedSafe) == RET_OK);
+    TEST_CHECK(removedSafe == 0);
+
+    printf("testAfeScript: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,79 @@
+/** @file testBroadcastPages.c
+ * 	@brief	Checks that no register is read while a page register selects several channels. The read back of a broadcast page is not defined, so partial writes there would corrupt the other channels.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "controls.h"
+#include "dsaAndNco.h"
+#include "mockDevice.h"
+
+static uint32_t broadcastReads = 0;
+
+static uint8_t countBits(uint8_t value)
+{
+    uint8_t bits = 0;
+    for (; value != 0; value >>= 1)
+        bits += value & 1;
+    return bits;
+}
+
+/*  The MCU answers every macro at once: Macro_Ready, Macro_ACK and Macro_Done are set.   */
+static uint8_t broadcastReadCheck(uint16_t addr, uint8_t *value)
+{
+    if ((addr == AFE_MACRO_STATUS_REG_ADDR) && (mockDevice.regs[AFE_MACRO_PAGE_REG_ADDR] == AFE_MACRO_PAGE_SEL_VAL))
+    {
+        *value = 0x7;
+        return 1;
+    }
+    if ((addr >= 0x10) && (addr < 0x20))
+        return 0;
+    if ((countBits(mockDevice.regs[0x12]) > 1) || (countBits(mockDevice.regs[0x19] & 0xf0) > 1) || (countBits(mockDevice.regs[0x13] & 0xf) > 1))
+    {
+        printf("read of 0x%X with page 0x12 = 0x%X, page 0x13 = 0x%X, page 0x19 = 0x%X\n", addr, mockDevice.regs[0x12], mockDevice.regs[0x13], mockDevice.regs[0x19]);
+        broadcastReads++;
+    }
+    return 0;
+}
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.readHook = broadcastReadCheck;
+    broadcastReads = 0;
+}
+
+static void testRmsPowerSweep(void)
+{
+    double rxPwrDb[AFE_NUM_RX_CHANNELS];
+    double fbPwrDb[AFE_NUM_FB_CHANNELS];
+
+    setup();
+    TEST_CHECK(getRmsPowerSweep(0, 0xf, 0x3, rxPwrDb, fbPwrDb, NULL) == RET_OK);
+    TEST_CHECK(broadcastReads == 0);
+    TEST_CHECK(mockDevice.waits == 1);
+    TEST_CHECK((mockDevice.regs[0x12] == 0) && (mockDevice.regs[0x19] == 0));
+    printf("getRmsPowerSweep, 4 RX and 2 FB channels: %u SPI transactions, %u wait\n", mockDevice.transactions, mockDevice.waits);
+}
+
+static void testTxNcoMulti(void)
+{
+    const uint32_t mixer[AFE_NUM_TX_CHANNELS] = {800000, 1800000, 1800000, 2400000};
+
+    setup();
+    TEST_CHECK(updateTxNcoMulti(0, 0xf, mixer, 0) == RET_OK);
+    TEST_CHECK(broadcastReads == 0);
+    TEST_CHECK((mockDevice.regs[0x13] == 0) && (mockDevice.regs[0x19] == 0));
+    printf("updateTxNcoMulti, 4 TX channels: %u SPI transactions\n", mockDevice.transactions);
+}
+
+int main(void)
+{
+    testRmsPowerSweep();
+    testTxNcoMulti();
+    printf("testBroadcastPages: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,208 @@
+/** @file testCalibStore.c
+ * 	@brief	Boot to calibrated on the mock AFE: the DSA calibrations against the reload of their packets from a calibration store file.
+ * 		Also checks that a corrupted store or a changed frequency plan is rejected before any packet is loaded.
+ * 		The times are of the simulated clock, 1 us per SPI access and the waits of waitMs, with macros that finish at once.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "afeParameters.h"
+#include "basicFunctions.h"
+#include "calibrations.h"
+#include "hMacro.h"
+#include "mockDevice.h"
+
+/*  Page of the MCU memory that holds the DSA packet, from address 0x20 on.   */
+#define PACKET_PAGE_SEL_VAL 0x01
+#define PACKET_START_ADDR 0x20
+#define PACKET_SIZE 600
+#define STORE_FILE "testCalibStore.bin"
+
+static uint8_t packetMem[PACKET_SIZE];
+static uint32_t packetWrites = 0;
+
+static uint8_t inPacketPage(uint16_t addr)
+{
+    return (mockDevice.regs[AFE_MACRO_PAGE_REG_ADDR] == PACKET_PAGE_SEL_VAL) && (addr >= PACKET_START_ADDR) && (addr < PACKET_START_ADDR + PACKET_SIZE);
+}
+
+/*  The MCU answers every macro at once and reports a packet of PACKET_SIZE bytes.   */
+static uint8_t mcuRead(uint16_t addr, uint8_t *value)
+{
+    if (mockDevice.regs[AFE_MACRO_PAGE_REG_ADDR] == AFE_MACRO_PAGE_SEL_VAL)
+    {
+        if (addr == AFE_MACRO_STATUS_REG_ADDR)
+        {
+            *value = 0x7;
+            return 1;
+        }
+        if ((addr == 0xFC) || (addr == 0xFD))
+        {
+            *value = (uint8_t)(PACKET_SIZE >> ((addr - 0xFC) * 8));
+            return 1;
+        }
+    }
+    if (inPacketPage(addr))
+    {
+        *value = packetMem[addr - PACKET_START_ADDR];
+        return 1;
+    }
+    return 0;
+}
+
+static uint8_t mcuWrite(uint16_t addr, uint8_t value)
+{
+    if (!inPacketPage(addr))
+        return 0;
+    packetMem[addr - PACKET_START_ADDR] = value;
+    packetWrites++;
+    return 1;
+}
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.usPerAccess = 1;
+    mockDevice.waitAdvancesClock = 1;
+    mockDevice.readHook = mcuRead;
+    mockDevice.writeHook = mcuWrite;
+    packetWrites = 0;
+    afeSpiBurstEnable(0, 0);
+}
+
+static void fillPacket(uint8_t seed)
+{
+    for (uint16_t i = 0; i < PACKET_SIZE; i++)
+        packetMem[i] = (uint8_t)(seed ^ (i * 7));
+}
+
+typedef struct BOOT_RESULT
+{
+    uint32_t transactions;
+    uint64_t us;
+} BootResult_t;
+
+/*  Calibrates RX and TX and stores both packets in image.   */
+static void calibrate(uint8_t *image, uint32_t imageSize, uint32_t *imageLen, BootResult_t *result)
+{
+    uint8_t rxPacket[PACKET_SIZE];
+    uint8_t txPacket[PACKET_SIZE];
+    uint16_t rxSize = 0, txSize = 0;
+    AfeCalibKey_t key;
+    uint64_t startUs = mockDevice.timeUs;
+    uint32_t startTransactions = 0;
+
+    TEST_CHECK(afeSpiGetTransactionCount(0, &startTransactions, 0) == RET_OK);
+    fillPacket(0x3C);
+    TEST_CHECK(doRxDsaCalib(0, 0xf, 0x3, 0, 0, rxPacket, &rxSize) == RET_OK);
+    fillPacket(0xC3);
+    TEST_CHECK(doTxDsaCalib(0, 0xf, 2, 0, txPacket, &txSize) == RET_OK);
+    TEST_CHECK(afeSpiGetTransactionCount(0, &result->transactions, 0) == RET_OK);
+    result->transactions -= startTransactions;
+    result->us = mockDevice.timeUs - startUs;
+    TEST_CHECK((rxSize == PACKET_SIZE) && (txSize == PACKET_SIZE));
+    TEST_CHECK(rxPacket[1] == (uint8_t)(0x3C ^ 7));
+    TEST_CHECK(txPacket[1] == (uint8_t)(0xC3 ^ 7));
+
+    *imageLen = 0;
+    TEST_CHECK(afeCalibStoreGetKey(0, &key) == RET_OK);
+    TEST_CHECK(afeCalibStoreAdd(image, imageSize, imageLen, &key, AFE_CALIB_PACKET_RX_DSA, rxPacket, rxSize) == RET_OK);
+    TEST_CHECK(afeCalibStoreAdd(image, imageSize, imageLen, &key, AFE_CALIB_PACKET_TX_DSA, txPacket, txSize) == RET_OK);
+}
+
+static void testBootToCalibrated(uint8_t useBursts)
+{
+    static uint8_t image[2 * PACKET_SIZE + 128];
+    static uint8_t loaded[2 * PACKET_SIZE + 128];
+    uint32_t imageLen = 0, loadedLen = 0;
+    uint32_t applyUs = 0, applyTransactions = 0, endTransactions = 0;
+    uint32_t singleTransactions, burstTransactions;
+    BootResult_t calibrated;
+    BootResult_t reloaded;
+
+    setup();
+    if (useBursts)
+        TEST_CHECK(afeMacroOperandBurstCheck(0, 32, &singleTransactions, &burstTransactions) == RET_OK);
+    calibrate(image, sizeof(image), &imageLen, &calibrated);
+    TEST_CHECK(afeCalibStoreSave(STORE_FILE, image, imageLen) == RET_OK);
+
+    /*  Next boot: the store is read back from the file and applied. The TX packet is the last one in the MCU memory.   */
+    memset(packetMem, 0, sizeof(packetMem));
+    TEST_CHECK(afeSpiGetTransactionCount(0, &reloaded.transactions, 0) == RET_OK);
+    reloaded.us = mockDevice.timeUs;
+    TEST_CHECK(afeCalibStoreLoad(STORE_FILE, loaded, sizeof(loaded), &loadedLen) == RET_OK);
+    TEST_CHECK((loadedLen == imageLen) && (memcmp(loaded, image, imageLen) == 0));
+    TEST_CHECK(afeCalibStoreApply(0, loaded, loadedLen, 0x3, &applyUs, &applyTransactions) == RET_OK);
+    TEST_CHECK(afeSpiGetTransactionCount(0, &endTransactions, 0) == RET_OK);
+    reloaded.transactions = endTransactions - reloaded.transactions;
+    reloaded.us = mockDevice.timeUs - reloaded.us;
+    remove(STORE_FILE);
+
+    TEST_CHECK(packetMem[1] == (uint8_t)(0xC3 ^ 7));
+    TEST_CHECK(packetWrites == 2 * PACKET_SIZE);
+    TEST_CHECK(applyTransactions == reloaded.transactions);
+    TEST_CHECK((applyUs != 0) && (applyUs == reloaded.us));
+    TEST_CHECK((reloaded.transactions < calibrated.transactions) && (reloaded.us < calibrated.us));
+    printf("boot to calibrated, %s: calibration %u SPI transactions %u us, reload from file %u SPI transactions %u us\n", useBursts ? "bursts" : "no bursts",
+           calibrated.transactions, (unsigned int)calibrated.us, reloaded.transactions, (unsigned int)reloaded.us);
+}
+
+/*  The getTimeUs of the user template always returns 0: the time reads 0, the transaction count still measures the reload.   */
+static void testFrozenClock(void)
+{
+    static uint8_t image[2 * PACKET_SIZE + 128];
+    uint32_t imageLen = 0;
+    uint32_t applyUs = 1, applyTransactions = 0;
+    BootResult_t calibrated;
+
+    setup();
+    mockDevice.usPerAccess = 0;
+    mockDevice.waitAdvancesClock = 0;
+    calibrate(image, sizeof(image), &imageLen, &calibrated);
+    TEST_CHECK(afeCalibStoreApply(0, image, imageLen, 0x3, &applyUs, &applyTransactions) == RET_OK);
+    TEST_CHECK(applyUs == 0);
+    TEST_CHECK(applyTransactions > 2 * PACKET_SIZE);
+}
+
+/*  Nothing is written to the MCU memory when a packet, the header or the frequency plan does not match.   */
+static void testRejected(void)
+{
+    static uint8_t image[2 * PACKET_SIZE + 128];
+    uint32_t imageLen = 0;
+    float fRef;
+    BootResult_t calibrated;
+
+    setup();
+    calibrate(image, sizeof(image), &imageLen, &calibrated);
+    mockDevice.quiet = 1;
+
+    packetWrites = 0;
+    image[imageLen - 1] ^= 0x01;
+    TEST_CHECK(afeCalibStoreApply(0, image, imageLen, 0x3, NULL, NULL) == RET_EXEC_FAIL);
+    image[imageLen - 1] ^= 0x01;
+    image[5] ^= 0x01;
+    TEST_CHECK(afeCalibStoreApply(0, image, imageLen, 0x3, NULL, NULL) == RET_EXEC_FAIL);
+    image[5] ^= 0x01;
+    TEST_CHECK(packetWrites == 0);
+
+    fRef = systemParams[0].FRef;
+    systemParams[0].FRef = fRef * 2;
+    TEST_CHECK(afeCalibStoreApply(0, image, imageLen, 0x3, NULL, NULL) == RET_EXEC_FAIL);
+    systemParams[0].FRef = fRef;
+    TEST_CHECK(packetWrites == 0);
+    TEST_CHECK(afeCalibStoreApply(0, image, imageLen, 0x3, NULL, NULL) == RET_OK);
+}
+
+int main(void)
+{
+    testBootToCalibrated(0);
+    testBootToCalibrated(1);
+    testFrozenClock();
+    testRejected();
+    printf("testCalibStore: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,395 @@
+/** @file testHealthMonitor.c
+ * 	@brief	Checks the health readers and the health monitor on a mock with per instance DAC JESD and per channel PAP registers.
+ * 		The decoded PAP and JESD fields and the flags of the logging wrappers are compared with decoders written from the register
+ * 		descriptions, over random register values. The monitor is checked for its round robin slices, events only on a fault change,
+ * 		and the SPI cost it records per check.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "afeParameters.h"
+#include "basicFunctions.h"
+#include "controls.h"
+#include "healthMonitor.h"
+#include "jesd.h"
+#include "pap.h"
+#include "mockDevice.h"
+
+#define RANDOM_ROUNDS 500
+
+/*  DAC JESD lane registers, paged by 0x16 (0x04 for AB, 0x08 for CD), and PAP alarm registers, paged by the TX of 0x19.   */
+static const uint16_t jesdRegs[] = {0x64, 0xa2, 0xa4, 0xa6};
+static const uint16_t papRegs[] = {0x558, 0x55c, 0x55d, 0x584};
+static uint8_t jesdRx[AFE_NUM_JESD_INSTANCES][0x100];
+static uint8_t pap[AFE_NUM_TX_CHANNELS][0x600];
+static uint32_t badPageReads;
+
+static uint8_t isReg(const uint16_t *list, uint8_t count, uint16_t addr)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (list[i] == addr)
+            return 1;
+    }
+    return 0;
+}
+
+static uint8_t pagedRead(uint16_t addr, uint8_t *value)
+{
+    if (isReg(jesdRegs, ARRAY_SIZE(jesdRegs), addr) && (mockDevice.regs[0x16] != 0))
+    {
+        if ((mockDevice.regs[0x16] != 0x04) && (mockDevice.regs[0x16] != 0x08))
+            badPageReads++;
+        *value = jesdRx[mockDevice.regs[0x16] >> 3][addr];
+        return 1;
+    }
+    if (isReg(papRegs, ARRAY_SIZE(papRegs), addr))
+    {
+        uint8_t chBits = mockDevice.regs[0x19] >> 4;
+        uint8_t chNo = 0;
+        if ((chBits == 0) || ((chBits & (chBits - 1)) != 0))
+            badPageReads++;
+        while ((chNo < AFE_NUM_TX_CHANNELS - 1) && !((chBits >> chNo) & 1))
+            chNo++;
+        *value = pap[chNo][addr];
+        return 1;
+    }
+    return 0;
+}
+
+static void setHealthy(void)
+{
+    memset(jesdRx, 0, sizeof(jesdRx));
+    memset(pap, 0, sizeof(pap));
+    for (uint8_t jesdNo = 0; jesdNo < AFE_NUM_JESD_INSTANCES; jesdNo++)
+    {
+        jesdRx[jesdNo][0x64] = 0xf;
+        jesdRx[jesdNo][0xa2] = 0xaa;
+        jesdRx[jesdNo][0xa4] = 0x55;
+        jesdRx[jesdNo][0xa6] = 0xff;
+    }
+    mockDevice.regs[0x66] = AFE_PLL_STATUS_LOCKED;
+    mockDevice.regs[0x1e] = 0;
+    mockDevice.regs[0x1f] = 0;
+    mockDevice.mcuModel = 1;
+}
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.readHook = pagedRead;
+    mockDevice.quiet = 1;
+    /*  The PLL pages are granted at once.   */
+    mockDevice.regs[0x171] = 1;
+    badPageReads = 0;
+    setHealthy();
+    afeHealthMonitorConfig(0, AFE_HEALTH_CHECK_ALL, AFE_HEALTH_CHECKS_PER_TICK);
+    afeHealthMonitorReset(0);
+}
+
+/*  Reference decoders.   */
+static uint8_t refLinkStatus(uint8_t jesdNo, uint8_t is204C, uint8_t *laneUp)
+{
+    uint8_t laneEna = jesdRx[jesdNo][0x64];
+    uint8_t csState = jesdRx[jesdNo][0xa2];
+    uint8_t fsState = jesdRx[jesdNo][is204C ? 0xa6 : 0xa4];
+    uint8_t laneFs = is204C ? 3 : 1;
+    uint8_t csOk = 1;
+    uint8_t fsOk = 1;
+    for (uint8_t lane = 0; lane < 4; lane++)
+    {
+        uint8_t enabled = (laneEna >> lane) & 1;
+        uint8_t cs = (csState >> (2 * lane)) & 3;
+        uint8_t fs = (fsState >> (2 * lane)) & 3;
+        if (cs != (enabled ? 2 : 0))
+            csOk = 0;
+        if (fs != (enabled ? laneFs : 0))
+            fsOk = 0;
+        if (enabled && (cs == 2) && (fs == laneFs))
+            *laneUp |= 1 << (lane + 4 * jesdNo);
+    }
+    return csOk ? (fsOk ? 2 : 1) : 0;
+}
+
+static uint16_t refPapTxAlarm(uint8_t chNo)
+{
+    return (uint16_t)(pap[chNo][0x55c] | ((pap[chNo][0x55d] & 0x7) << 8));
+}
+
+static uint8_t refPapTriggered(uint8_t chNo)
+{
+    return ((refPapTxAlarm(chNo) & 0xe1) != 0) || ((pap[chNo][0x558] & 0xf) != 0) || ((pap[chNo][0x584] & 0x3) != 0);
+}
+
+/*  Random register byte, half the time 0 or the healthy value.   */
+static uint8_t randomReg(uint8_t healthy)
+{
+    int r = rand() % 4;
+    if (r == 0)
+        return 0;
+    if (r == 1)
+        return healthy;
+    return (uint8_t)rand();
+}
+
+static void randomize(void)
+{
+    for (uint8_t jesdNo = 0; jesdNo < AFE_NUM_JESD_INSTANCES; jesdNo++)
+    {
+        uint8_t laneEna = (rand() % 2) ? 0xf : (uint8_t)(rand() & 0xf);
+        uint8_t csGood = 0, fsGood = 0, bufGood = 0;
+        for (uint8_t lane = 0; lane < 4; lane++)
+        {
+            if ((laneEna >> lane) & 1)
+            {
+                csGood |= 2 << (2 * lane);
+                fsGood |= 1 << (2 * lane);
+                bufGood |= 3 << (2 * lane);
+            }
+        }
+        jesdRx[jesdNo][0x64] = laneEna;
+        jesdRx[jesdNo][0xa2] = randomReg(csGood);
+        jesdRx[jesdNo][0xa4] = randomReg(fsGood);
+        jesdRx[jesdNo][0xa6] = randomReg(bufGood);
+    }
+    for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+    {
+        pap[chNo][0x55c] = (rand() % 2) ? 0 : (uint8_t)rand();
+        pap[chNo][0x55d] = (rand() % 2) ? 0 : (uint8_t)rand();
+        pap[chNo][0x558] = (rand() % 2) ? 0 : (uint8_t)rand();
+        pap[chNo][0x584] = (rand() % 2) ? 0 : (uint8_t)rand();
+    }
+    mockDevice.regs[0x66] = randomReg(AFE_PLL_STATUS_LOCKED);
+    mockDevice.regs[0x1e] = (rand() % 2) ? 0 : (uint8_t)rand();
+    mockDevice.regs[0x1f] = (rand() % 2) ? 0 : (uint8_t)rand();
+}
+
+static void testDecoders(void)
+{
+    setup();
+    srand(1);
+    for (uint32_t round = 0; round < RANDOM_ROUNDS; round++)
+    {
+        uint8_t is204C = round & 1;
+        uint8_t refLaneUp = 0;
+        uint8_t refLink;
+        uint16_t refSpi;
+        uint8_t refPll;
+        uint8_t refFaults = 0;
+        uint8_t jesdRxAlarms = 0;
+        uint8_t txFifo[AFE_NUM_JESD_INSTANCES] = {0, 0};
+        uint8_t flag;
+        uint16_t linkStatus;
+        uint16_t allOk;
+        AfeJesdRxLinkState_t linkState;
+        AfePapAlarmStatus_t papStatus;
+        AfeDeviceHealth_t health;
+
+        randomize();
+        systemParams[0].jesdProtocol = is204C ? 2 : 0;
+        refLink = refLinkStatus(0, is204C, &refLaneUp) | (refLinkStatus(1, is204C, &refLaneUp) << 2);
+        refSpi = (uint16_t)(mockDevice.regs[0x1e] | ((mockDevice.regs[0x1f] & 1) << 8));
+        refPll = ((mockDevice.regs[0x66] >> 4) & 1) | ((((mockDevice.regs[0x66] >> 6) & 1) == 0) << 1);
+
+        /*  The quiet readers decode the fields.   */
+        TEST_CHECK(getJesdRxLinkState(0, &linkState) == RET_OK);
+        TEST_CHECK((linkState.linkStatus == refLink) && (linkState.laneUp == refLaneUp));
+        TEST_CHECK((linkState.laneEna[0] == jesdRx[0][0x64]) && (linkState.laneEna[1] == jesdRx[1][0x64]));
+        TEST_CHECK((linkState.csState[1] == jesdRx[1][0xa2]) && (linkState.fsState[1] == jesdRx[1][is204C ? 0xa6 : 0xa4]));
+        for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+        {
+            TEST_CHECK(papGetAlarmStatus(0, chNo, &papStatus) == RET_OK);
+            TEST_CHECK((papStatus.txAlarm == refPapTxAlarm(chNo)) && (papStatus.papAlarm == pap[chNo][0x558]) && (papStatus.detector == pap[chNo][0x584]));
+            TEST_CHECK(papStatus.triggered == refPapTriggered(chNo));
+            /*  The logging wrapper returns the same flag.   */
+            TEST_CHECK((papAlarmStatus(0, chNo, &flag) == RET_OK) && (flag == refPapTriggered(chNo)));
+            if (refPapTriggered(chNo))
+                refFaults |= AFE_HEALTH_FAULT_PAP;
+        }
+
+        /*  The logging wrappers return the flags they did before the quiet readers.   */
+        refLaneUp = 0;
+        TEST_CHECK((getJesdRxLinkStatus204B(0, &linkStatus) == RET_OK) && (linkStatus == (refLinkStatus(0, 0, &refLaneUp) | (refLinkStatus(1, 0, &refLaneUp) << 2))));
+        TEST_CHECK((getJesdRxLinkStatus204C(0, &linkStatus) == RET_OK) && (linkStatus == (refLinkStatus(0, 1, &refLaneUp) | (refLinkStatus(1, 1, &refLaneUp) << 2))));
+        TEST_CHECK((getJesdRxLinkStatus(0, &linkStatus) == RET_OK) && (linkStatus == refLink));
+        TEST_CHECK((checkPllLockStatus(0, &flag) == RET_OK) && (flag == refPll));
+        TEST_CHECK((readSpiAlarms(0, &flag) == RET_OK) && (flag == (refSpi != 0)));
+
+        TEST_CHECK(getJesdRxAlarms(0, &jesdRxAlarms) == RET_OK);
+        TEST_CHECK(getJesdTxFifoErrors(0, 0, &txFifo[0]) == RET_OK);
+        TEST_CHECK(getJesdTxFifoErrors(0, 1, &txFifo[1]) == RET_OK);
+        if (refPll != 3)
+            refFaults |= AFE_HEALTH_FAULT_PLL;
+        if ((refLink != 10) || (jesdRxAlarms != 0))
+            refFaults |= AFE_HEALTH_FAULT_DAC_JESD;
+        if ((txFifo[0] | txFifo[1]) != 0)
+            refFaults |= AFE_HEALTH_FAULT_ADC_JESD;
+        if (refSpi != 0)
+            refFaults |= AFE_HEALTH_FAULT_SPI;
+        TEST_CHECK(getDeviceHealth(0, &health) == RET_OK);
+        TEST_CHECK((health.faults == refFaults) && (health.spiAlarms == refSpi) && (health.pllStatus == mockDevice.regs[0x66]) && (health.mcuOk == 1));
+        TEST_CHECK(memcmp(&health.jesdRx, &linkState, sizeof(linkState)) == 0);
+        TEST_CHECK((checkDeviceHealth(0, &allOk) == RET_OK) && (allOk == (refFaults == 0)));
+    }
+    TEST_CHECK(badPageReads == 0);
+
+    /*  An MCU that doesn't answer is a fault of its own.   */
+    setup();
+    mockDevice.mcuModel = 0;
+    {
+        AfeDeviceHealth_t health;
+        uint16_t allOk;
+        TEST_CHECK((getDeviceHealth(0, &health) == RET_OK) && (health.faults == AFE_HEALTH_FAULT_MCU) && (health.mcuOk == 0));
+        TEST_CHECK((checkDeviceHealth(0, &allOk) == RET_OK) && (allOk == 0));
+    }
+    TEST_CHECK(sizeof(AfePapAlarmStatus_t) == 8);
+    TEST_CHECK(sizeof(AfeJesdRxLinkState_t) == 8);
+    TEST_CHECK(sizeof(AfeDeviceHealth_t) == 48);
+}
+
+static void testRoundRobin(void)
+{
+    AfeHealthSnapshot_t snap;
+
+    setup();
+    TEST_CHECK(afeHealthMonitorConfig(0, AFE_HEALTH_CHECK_ALL, 3) == RET_OK);
+    TEST_CHECK(afeHealthMonitorTick(0, NULL) == RET_OK);
+    afeHealthMonitorGetSnapshot(0, &snap);
+    TEST_CHECK((snap.validMask == 0x7) && (snap.tick == 1));
+    for (uint8_t tick = 2; tick <= 4; tick++)
+        TEST_CHECK(afeHealthMonitorTick(0, NULL) == RET_OK);
+    /*  11 checks, 3 per tick: the 4th tick runs checks 9, 10 and 0.   */
+    afeHealthMonitorGetSnapshot(0, &snap);
+    TEST_CHECK(snap.validMask == AFE_HEALTH_CHECK_ALL);
+    TEST_CHECK((snap.runs[AFE_HEALTH_CHECK_PLL] == 2) && (snap.lastTick[AFE_HEALTH_CHECK_PLL] == 4));
+    TEST_CHECK((snap.runs[AFE_HEALTH_CHECK_JESD_RX_LINK] == 1) && (snap.lastTick[AFE_HEALTH_CHECK_PAP_TXD] == 4));
+    TEST_CHECK((snap.lastTick[AFE_HEALTH_CHECK_MCU] == 3) && (snap.lastTick[AFE_HEALTH_CHECK_JESD_TX_FIFO_AB] == 2));
+
+    /*  Disabled checks are skipped and keep their state.   */
+    setup();
+    TEST_CHECK(afeHealthMonitorConfig(0, (1 << AFE_HEALTH_CHECK_PLL) | (1 << AFE_HEALTH_CHECK_PAP_TXD), 1) == RET_OK);
+    for (uint8_t tick = 0; tick < 4; tick++)
+        TEST_CHECK(afeHealthMonitorTick(0, NULL) == RET_OK);
+    afeHealthMonitorGetSnapshot(0, &snap);
+    TEST_CHECK(snap.validMask == ((1 << AFE_HEALTH_CHECK_PLL) | (1 << AFE_HEALTH_CHECK_PAP_TXD)));
+    TEST_CHECK((snap.runs[AFE_HEALTH_CHECK_PLL] == 2) && (snap.runs[AFE_HEALTH_CHECK_PAP_TXD] == 2));
+    TEST_CHECK((snap.lastTick[AFE_HEALTH_CHECK_PLL] == 3) && (snap.lastTick[AFE_HEALTH_CHECK_PAP_TXD] == 4));
+
+    mockDevice.quiet = 1;
+    TEST_CHECK(afeHealthMonitorConfig(0, 0, AFE_HEALTH_NUM_CHECKS + 1) == RET_EXEC_FAIL);
+}
+
+static void testEvents(void)
+{
+    uint16_t changed = 0xffff;
+    uint32_t logErrors;
+    AfeHealthSnapshot_t snap;
+
+    /*  A healthy device gives no event.   */
+    setup();
+    TEST_CHECK(afeHealthMonitorRunAll(0, &changed) == RET_OK);
+    TEST_CHECK((changed == 0) && (mockDevice.logErrors == 0));
+
+    /*  A PAP alarm on TXC and a PLL lock loss are reported once, by the tick that runs their checks.   */
+    pap[2][0x584] = AFE_PAP_DET_HPF;
+    mockDevice.regs[0x66] = AFE_PLL_STATUS_LOCKED | AFE_PLL_STATUS_LOCK_LOST_STICKY;
+    TEST_CHECK(afeHealthMonitorConfig(0, AFE_HEALTH_CHECK_ALL, 4) == RET_OK);
+    TEST_CHECK((afeHealthMonitorTick(0, &changed) == RET_OK) && (changed == (1 << AFE_HEALTH_CHECK_PLL)));
+    TEST_CHECK((afeHealthMonitorTick(0, &changed) == RET_OK) && (changed == 0));
+    logErrors = mockDevice.logErrors;
+    TEST_CHECK((afeHealthMonitorTick(0, &changed) == RET_OK) && (changed == (1 << AFE_HEALTH_CHECK_PAP_TXC)));
+    TEST_CHECK(mockDevice.logErrors == logErrors + 1);
+    afeHealthMonitorGetSnapshot(0, &snap);
+    TEST_CHECK(snap.faultMask == ((1 << AFE_HEALTH_CHECK_PLL) | (1 << AFE_HEALTH_CHECK_PAP_TXC)));
+    TEST_CHECK(snap.state.faults == (AFE_HEALTH_FAULT_PLL | AFE_HEALTH_FAULT_PAP));
+    TEST_CHECK(snap.state.pap[2].detector == AFE_PAP_DET_HPF);
+
+    /*  Faults that stay are not reported again.   */
+    logErrors = mockDevice.logErrors;
+    for (uint8_t tick = 0; tick < 6; tick++)
+    {
+        TEST_CHECK((afeHealthMonitorTick(0, &changed) == RET_OK) && (changed == 0));
+    }
+    TEST_CHECK(afeHealthMonitorRunAll(0, &changed) == RET_OK);
+    TEST_CHECK((changed == 0) && (mockDevice.logErrors == logErrors));
+
+    /*  Recovery is an event too.   */
+    mockDevice.regs[0x66] = AFE_PLL_STATUS_LOCKED;
+    TEST_CHECK((afeHealthMonitorRunAll(0, &changed) == RET_OK) && (changed == (1 << AFE_HEALTH_CHECK_PLL)));
+    TEST_CHECK(mockDevice.logErrors == logErrors);
+    afeHealthMonitorGetSnapshot(0, &snap);
+    TEST_CHECK((snap.faultMask == (1 << AFE_HEALTH_CHECK_PAP_TXC)) && (snap.state.faults == AFE_HEALTH_FAULT_PAP));
+}
+
+static uint32_t spiCost(uint32_t *before)
+{
+    uint32_t after = 0;
+    afeSpiGetTransactionCount(0, &after, 0);
+    return after - *before;
+}
+
+static void testSpiCost(void)
+{
+    AfeHealthSnapshot_t snap;
+    AfeDeviceHealth_t health;
+    AfeJesdRxLinkState_t linkState;
+    AfePapAlarmStatus_t papStatus;
+    uint8_t pllStatus;
+    uint16_t spiAlarms;
+    uint32_t before = 0;
+    uint32_t sliceCost = 0;
+    uint32_t totalCost = 0;
+
+    setup();
+    TEST_CHECK(afeHealthMonitorRunAll(0, NULL) == RET_OK);
+    afeHealthMonitorGetSnapshot(0, &snap);
+
+    /*  Each check costs what its reader costs on its own.   */
+    afeSpiGetTransactionCount(0, &before, 0);
+    getPllLockState(0, &pllStatus);
+    TEST_CHECK(snap.lastSpiCost[AFE_HEALTH_CHECK_PLL] == spiCost(&before));
+    afeSpiGetTransactionCount(0, &before, 0);
+    getJesdRxLinkState(0, &linkState);
+    TEST_CHECK(snap.lastSpiCost[AFE_HEALTH_CHECK_JESD_RX_LINK] == spiCost(&before));
+    afeSpiGetTransactionCount(0, &before, 0);
+    getSpiAlarmBits(0, &spiAlarms);
+    TEST_CHECK(snap.lastSpiCost[AFE_HEALTH_CHECK_SPI_ALARMS] == spiCost(&before));
+    afeSpiGetTransactionCount(0, &before, 0);
+    papGetAlarmStatus(0, 1, &papStatus);
+    TEST_CHECK(snap.lastSpiCost[AFE_HEALTH_CHECK_PAP_TXB] == spiCost(&before));
+
+    /*  A full pass costs as much as getDeviceHealth, a tick only its slice.   */
+    for (uint8_t check = 0; check < AFE_HEALTH_NUM_CHECKS; check++)
+    {
+        TEST_CHECK(snap.totalSpiCost[check] == snap.lastSpiCost[check]);
+        totalCost += snap.lastSpiCost[check];
+    }
+    afeSpiGetTransactionCount(0, &before, 0);
+    getDeviceHealth(0, &health);
+    TEST_CHECK(totalCost == spiCost(&before));
+
+    TEST_CHECK(afeHealthMonitorConfig(0, AFE_HEALTH_CHECK_ALL, 2) == RET_OK);
+    afeSpiGetTransactionCount(0, &before, 0);
+    TEST_CHECK(afeHealthMonitorTick(0, NULL) == RET_OK);
+    sliceCost = spiCost(&before);
+    afeHealthMonitorGetSnapshot(0, &snap);
+    TEST_CHECK(sliceCost == snap.lastSpiCost[AFE_HEALTH_CHECK_PLL] + snap.lastSpiCost[AFE_HEALTH_CHECK_JESD_RX_LINK]);
+    TEST_CHECK(snap.totalSpiCost[AFE_HEALTH_CHECK_PLL] == 2 * snap.lastSpiCost[AFE_HEALTH_CHECK_PLL]);
+    TEST_CHECK(sliceCost < totalCost);
+    printf("health: full pass %u SPI transactions, slice of 2 checks %u\n", totalCost, sliceCost);
+}
+
+int main(void)
+{
+    testDecoders();
+    testRoundRobin();
+    testEvents();
+    testSpiCost();
+    printf("testHealthMonitor: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,59 @@
+/** @file testLogOverhead.c
+ * 	@brief	Benchmark of the library overhead of closeAllPages at the runtime log levels, on the mock device whose SPI calls return at once.
+ * 		Checks that the log calls above the runtime level never reach afeLogmsg, so their messages are never formatted.
+ * 		Build the library with -DAFE_LOG_MAX_LEVEL=AFE_LOG_LEVEL_INFO to compare with the SPI logs compiled out.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "afe79xxTypes.h"
+#include "afe79xxLog.h"
+#include "afeCommonMacros.h"
+#include "baseFunc.h"
+#include "basicFunctions.h"
+#include "mockDevice.h"
+
+#define BENCH_CALLS 20000
+
+/*  Average time of a closeAllPages call in ns, and the afeLogmsg calls per closeAllPages.   */
+static uint32_t benchCloseAllPages(uint32_t logLevel, uint32_t *logCallsPerCall)
+{
+    clock_t start;
+    clock_t ticks;
+
+    mockDeviceReset();
+    mockDevice.quiet = 1;
+    setAfeLogLvl(logLevel);
+    start = clock();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+        TEST_CHECK(closeAllPages(0) == RET_OK);
+    ticks = clock() - start;
+    setAfeLogLvl(AFE_LOG_LEVEL_ERROR);
+    *logCallsPerCall = mockDevice.logCalls / BENCH_CALLS;
+    return (uint32_t)((double)ticks / CLOCKS_PER_SEC * 1e9 / BENCH_CALLS);
+}
+
+int main(void)
+{
+    const char *levelNames[] = {"ERROR", "WARNING", "INFO", "SPILOG", "DEBUG"};
+    uint32_t nsPerCall[AFE_LOG_LEVEL_DEBUG + 1];
+    uint32_t logCalls[AFE_LOG_LEVEL_DEBUG + 1];
+
+    for (uint32_t level = AFE_LOG_LEVEL_ERROR; level <= AFE_LOG_LEVEL_DEBUG; level++)
+    {
+        nsPerCall[level] = benchCloseAllPages(level, &logCalls[level]);
+        printf("closeAllPages x %u, log level %s, AFE_LOG_MAX_LEVEL %d: %u ns per call, %u log messages per call\n", BENCH_CALLS, levelNames[level], AFE_LOG_MAX_LEVEL, nsPerCall[level], logCalls[level]);
+    }
+    /*  closeAllPages only logs its SPI writes, one per page register.   */
+    TEST_CHECK((logCalls[AFE_LOG_LEVEL_ERROR] == 0) && (logCalls[AFE_LOG_LEVEL_INFO] == 0));
+#if AFE_LOG_MAX_LEVEL >= AFE_LOG_LEVEL_SPILOG
+    TEST_CHECK(logCalls[AFE_LOG_LEVEL_SPILOG] >= AFE_NUM_PAGE_REGS);
+    TEST_CHECK(nsPerCall[AFE_LOG_LEVEL_INFO] < nsPerCall[AFE_LOG_LEVEL_SPILOG]);
+#else
+    TEST_CHECK(logCalls[AFE_LOG_LEVEL_SPILOG] == 0);
+#endif
+    printf("testLogOverhead: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,164 @@
+/** @file testMacroQueue.c
+ * 	@brief	Checks macroSubmit, macroPoll and macroWait on the MCU model of the mock: completion in submit order, the timeouts with a running and a frozen clock,
+ * 		and the decoding of the macro error flags.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "hMacro.h"
+#include "mockDevice.h"
+
+static void setup(uint32_t usPerAccess, uint32_t mcuRunReads)
+{
+    mockDeviceReset();
+    mockDevice.usPerAccess = usPerAccess;
+    mockDevice.mcuModel = 1;
+    mockDevice.mcuRunReads = mcuRunReads;
+    mockDevice.quiet = 1;
+}
+
+/*  Polls a macro until it is done and returns the result of the last poll.   */
+static uint8_t pollUntilDone(uint32_t handle, uint32_t *polls, uint8_t *macroErrorFlags)
+{
+    uint8_t done = 0;
+    uint8_t result = RET_OK;
+    *polls = 0;
+    while (!done && (*polls < 10000))
+    {
+        result = macroPoll(0, handle, &done, macroErrorFlags);
+        (*polls)++;
+    }
+    return result;
+}
+
+static void testInOrder(void)
+{
+    uint8_t operand[3] = {0x11, 0x22, 0x33};
+    uint32_t handle[3];
+    uint32_t polls = 0;
+    uint8_t done = 0;
+    uint8_t flags = 0xff;
+
+    setup(1, 3);
+    for (uint8_t i = 0; i < 3; i++)
+        TEST_CHECK(macroSubmit(0, &operand[i], 1, AFE_MACRO_OPCODE_SYSTEM_TUNE + i, &handle[i]) == RET_OK);
+    /*  Only the first macro runs, the others wait for it.   */
+    TEST_CHECK(mockDevice.mcuTriggers == 1);
+    TEST_CHECK(macroPoll(0, handle[2], &done, NULL) == RET_OK);
+    TEST_CHECK((done == 0) && (mockDevice.mcuTriggers == 1));
+
+    TEST_CHECK(pollUntilDone(handle[0], &polls, &flags) == RET_OK);
+    TEST_CHECK((flags == AFE_MACRO_NO_ERROR) && (polls > 1));
+    TEST_CHECK(mockDevice.mcuTriggers == 2);
+    /*  Waiting for the last one completes the one before it, which is then collected at once.   */
+    TEST_CHECK(macroWait(0, handle[2], &flags) == RET_OK);
+    TEST_CHECK(macroPoll(0, handle[1], &done, &flags) == RET_OK);
+    TEST_CHECK(done == 1);
+    TEST_CHECK(mockDevice.mcuTriggers == 3);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        TEST_CHECK(mockDevice.mcuOpcodes[i] == AFE_MACRO_OPCODE_SYSTEM_TUNE + i);
+        TEST_CHECK(mockDevice.mcuOperands[i] == operand[i]);
+    }
+    /*  A collected handle is gone.   */
+    TEST_CHECK(macroWait(0, handle[1], NULL) == RET_EXEC_FAIL);
+}
+
+static void testQueueFull(void)
+{
+    uint8_t operand = 0;
+    uint32_t handle[AFE_MACRO_QUEUE_DEPTH + 1];
+
+    setup(1, 0);
+    for (uint8_t i = 0; i < AFE_MACRO_QUEUE_DEPTH; i++)
+        TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle[i]) == RET_OK);
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle[AFE_MACRO_QUEUE_DEPTH]) == RET_EXEC_FAIL);
+    for (uint8_t i = 0; i < AFE_MACRO_QUEUE_DEPTH; i++)
+        TEST_CHECK(macroWait(0, handle[i], NULL) == RET_OK);
+}
+
+/*  A stuck MCU with the frozen clock of the user template: macroPoll has to give up after its poll limit.   */
+static void testTimeoutFrozenClock(void)
+{
+    uint8_t operand = 0;
+    uint32_t handle[2];
+    uint32_t polls = 0;
+
+    setup(0, 0xffffffff);
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle[0]) == RET_OK);
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle[1]) == RET_OK);
+    TEST_CHECK(pollUntilDone(handle[0], &polls, NULL) == RET_EXEC_FAIL);
+    TEST_CHECK((polls > 200) && (polls < 205));
+    /*  The next macro was started after the failed one.   */
+    TEST_CHECK(mockDevice.mcuTriggers == 2);
+    mockDevice.mcuRunReads = 0;
+    TEST_CHECK(macroWait(0, handle[1], NULL) == RET_OK);
+    printf("stuck macro, frozen clock: failed after %u polls\n", polls);
+}
+
+/*  With a running clock the 200 ms count, however fast the polls are.   */
+static void testTimeoutRunningClock(void)
+{
+    uint8_t operand = 0;
+    uint32_t handle;
+    uint32_t polls = 0;
+
+    setup(1000, 0xffffffff);
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle) == RET_OK);
+    TEST_CHECK(pollUntilDone(handle, &polls, NULL) == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.timeUs > 200000) && (mockDevice.timeUs < 220000));
+    TEST_CHECK(polls < 200);
+
+    /*  macroWait gives up on its own too.   */
+    setup(0, 0xffffffff);
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle) == RET_OK);
+    TEST_CHECK(macroWait(0, handle, NULL) == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.waitedMs > 200) && (mockDevice.waitedMs < 210));
+}
+
+static void testErrorFlags(void)
+{
+    uint8_t operand = 0;
+    uint32_t handle[3];
+    uint32_t polls = 0;
+    uint8_t flags = 0;
+
+    setup(1, 2);
+    mockDevice.mcuErrorOpcode = AFE_MACRO_OPCODE_UPDATE_TX_GAIN;
+    mockDevice.mcuErrorBits = 0x08 | 0x40;
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle[0]) == RET_OK);
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_UPDATE_TX_GAIN, &handle[1]) == RET_OK);
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE, &handle[2]) == RET_OK);
+    TEST_CHECK(macroWait(0, handle[0], &flags) == RET_OK);
+    TEST_CHECK(flags == AFE_MACRO_NO_ERROR);
+    TEST_CHECK(macroWait(0, handle[1], &flags) == RET_EXEC_FAIL);
+    TEST_CHECK(flags == AFE_MACRO_ERROR_IN_OPERAND);
+    TEST_CHECK(macroWait(0, handle[2], &flags) == RET_OK);
+    TEST_CHECK(flags == AFE_MACRO_NO_ERROR);
+
+    /*  All four flags, read through macroPoll.   */
+    mockDevice.mcuErrorBits = 0x08 | 0x10 | 0x20 | 0x40 | 0x80;
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_UPDATE_TX_GAIN, &handle[0]) == RET_OK);
+    TEST_CHECK(pollUntilDone(handle[0], &polls, &flags) == RET_EXEC_FAIL);
+    TEST_CHECK(flags == (AFE_MACRO_ERROR_IN_OPCODE | AFE_MACRO_ERROR_OPCODE_NOT_ALLOWED | AFE_MACRO_ERROR_IN_OPERAND | AFE_MACRO_ERROR_IN_EXECUTION));
+
+    /*  Error bits without the error bit 3 are not an error.   */
+    mockDevice.mcuErrorBits = 0x40;
+    TEST_CHECK(macroSubmit(0, &operand, 1, AFE_MACRO_OPCODE_UPDATE_TX_GAIN, &handle[0]) == RET_OK);
+    TEST_CHECK(macroWait(0, handle[0], &flags) == RET_OK);
+    TEST_CHECK(flags == AFE_MACRO_NO_ERROR);
+}
+
+int main(void)
+{
+    testInOrder();
+    testQueueFull();
+    testTimeoutFrozenClock();
+    testTimeoutRunningClock();
+    testErrorFlags();
+    printf("testMacroQueue: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,113 @@
+/** @file testMacroWait.c
+ * 	@brief	Checks the four macro completion wait modes of afeMacroSetWaitMode on the MCU model of the mock, for a macro that finishes and one that never does.
+ * 		The timeouts have to hold with the frozen clock of the user template too.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "hMacro.h"
+#include "mockDevice.h"
+
+#define STUCK_RUN_READS 0xffffffff
+
+static void setup(uint8_t waitMode, uint32_t usPerAccess, uint8_t waitAdvancesClock, uint32_t mcuRunReads)
+{
+    mockDeviceReset();
+    mockDevice.usPerAccess = usPerAccess;
+    mockDevice.waitAdvancesClock = waitAdvancesClock;
+    mockDevice.mcuModel = 1;
+    mockDevice.mcuRunReads = mcuRunReads;
+    mockDevice.quiet = 1;
+    afeMacroSetWaitMode(0, waitMode);
+}
+
+static uint8_t runMacro(void)
+{
+    uint8_t operand = 0;
+    return executeMacro(0, &operand, 1, AFE_MACRO_OPCODE_SYSTEM_TUNE);
+}
+
+static void testFixedPoll(void)
+{
+    setup(AFE_MACRO_WAIT_FIXED_POLL, 0, 0, 5);
+    TEST_CHECK(runMacro() == RET_OK);
+    TEST_CHECK((mockDevice.waits == 5) && (mockDevice.waitedMs == 5));
+
+    setup(AFE_MACRO_WAIT_FIXED_POLL, 0, 0, STUCK_RUN_READS);
+    TEST_CHECK(runMacro() == RET_EXEC_FAIL);
+    TEST_CHECK(mockDevice.waitedMs == 201);
+}
+
+static void testBackoff(void)
+{
+    /*  A fast macro is seen by the back-to-back reads, without any wait.   */
+    setup(AFE_MACRO_WAIT_BACKOFF, 0, 0, 5);
+    TEST_CHECK(runMacro() == RET_OK);
+    TEST_CHECK(mockDevice.waits == 0);
+
+    setup(AFE_MACRO_WAIT_BACKOFF, 0, 0, STUCK_RUN_READS);
+    TEST_CHECK(runMacro() == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.waitedMs > 200) && (mockDevice.waitedMs <= 200 + 8));
+    TEST_CHECK(mockDevice.waits < 40);
+    printf("backoff, stuck macro: %u waits, %u ms\n", mockDevice.waits, (unsigned int)mockDevice.waitedMs);
+}
+
+static void testEvent(void)
+{
+    /*  No pin on the host: polled as AFE_MACRO_WAIT_BACKOFF.   */
+    setup(AFE_MACRO_WAIT_EVENT, 0, 0, STUCK_RUN_READS);
+    TEST_CHECK(runMacro() == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.waitedMs > 200) && (mockDevice.waitedMs <= 200 + 8));
+
+    /*  The pin tells the macro is done: one pin wait, no sleeps.   */
+    setup(AFE_MACRO_WAIT_EVENT, 0, 0, STUCK_RUN_READS);
+    mockDevice.alarmPin = MOCK_ALARM_PIN_DONE;
+    TEST_CHECK(runMacro() == RET_OK);
+    TEST_CHECK((mockDevice.pinWaits == 1) && (mockDevice.waits == 0));
+
+    /*  A pin that never comes uses up the timeout, there is no second 200 ms of polling after it. Frozen and running clock.   */
+    setup(AFE_MACRO_WAIT_EVENT, 0, 0, STUCK_RUN_READS);
+    mockDevice.alarmPin = MOCK_ALARM_PIN_STUCK;
+    TEST_CHECK(runMacro() == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.pinWaitedMs == 200) && (mockDevice.waitedMs == 0));
+
+    setup(AFE_MACRO_WAIT_EVENT, 10, 1, STUCK_RUN_READS);
+    mockDevice.alarmPin = MOCK_ALARM_PIN_STUCK;
+    TEST_CHECK(runMacro() == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.pinWaitedMs <= 200) && (mockDevice.timeUs < 210000));
+    printf("event, stuck pin, running clock: failed after %u us\n", (unsigned int)mockDevice.timeUs);
+}
+
+static void testHint(void)
+{
+    /*  With the frozen clock the whole hint is slept, the macro is then done at the first read.   */
+    setup(AFE_MACRO_WAIT_HINT, 0, 0, 2);
+    afeMacroSetDurationHint(AFE_MACRO_OPCODE_SYSTEM_TUNE, 50);
+    TEST_CHECK(runMacro() == RET_OK);
+    TEST_CHECK((mockDevice.waits == 1) && (mockDevice.waitedMs == 50));
+
+    /*  The part of the hint that has already passed since the trigger is not slept again.   */
+    setup(AFE_MACRO_WAIT_HINT, 1000, 1, 2);
+    afeMacroSetDurationHint(AFE_MACRO_OPCODE_SYSTEM_TUNE, 50);
+    TEST_CHECK(runMacro() == RET_OK);
+    TEST_CHECK((mockDevice.waits == 1) && (mockDevice.waitedMs < 50));
+
+    /*  A stuck macro fails 200 ms after the hint, by the slept time alone.   */
+    setup(AFE_MACRO_WAIT_HINT, 0, 0, STUCK_RUN_READS);
+    TEST_CHECK(runMacro() == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.waitedMs > 250) && (mockDevice.waitedMs <= 250 + 8));
+    afeMacroSetDurationHint(AFE_MACRO_OPCODE_SYSTEM_TUNE, 0);
+}
+
+int main(void)
+{
+    testFixedPoll();
+    testBackoff();
+    testEvent();
+    testHint();
+    printf("testMacroWait: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,235 @@
+/** @file testNcoHop.c
+ * 	@brief	Checks updateTxNcoMulti and the NCO hop table against updateTxNco, updateRxNco and updateFbNco on a mock with per channel TX registers:
+ * 		the same channel registers and macros, one update pulse per page for all the channels, and the hop latencies.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "basicFunctions.h"
+#include "dsaAndNco.h"
+#include "mockDevice.h"
+
+/*  TX registers kept per channel: the NCO update pulses on the txdig page 0x19 and the band registers on the txdh page 0x13.   */
+static const uint16_t pulseRegs[] = {0x130, 0x131, 0x230, 0x231, 0x773};
+static const uint16_t bandRegs[] = {0x104, 0x105, 0x106, 0x107, 0x108, 0x109, 0x10a};
+
+static uint8_t chRegs[AFE_NUM_TX_CHANNELS][0x800];
+static uint32_t chPulses[AFE_NUM_TX_CHANNELS][0x800];
+static uint32_t pulseWrites;
+
+static int regIndex(const uint16_t *list, uint8_t count, uint16_t addr)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (list[i] == addr)
+            return i;
+    }
+    return -1;
+}
+
+/*  Channels selected for addr, 0 if it isn't a per channel register.   */
+static uint8_t selectedChannels(uint16_t addr)
+{
+    if (regIndex(pulseRegs, ARRAY_SIZE(pulseRegs), addr) >= 0)
+        return mockDevice.regs[0x19] >> 4;
+    if (regIndex(bandRegs, ARRAY_SIZE(bandRegs), addr) >= 0)
+        return mockDevice.regs[0x13] & 0xf;
+    return 0;
+}
+
+static uint8_t channelWrite(uint16_t addr, uint8_t value)
+{
+    uint8_t chBits = selectedChannels(addr);
+    if (chBits == 0)
+        return 0;
+    if (regIndex(pulseRegs, ARRAY_SIZE(pulseRegs), addr) >= 0)
+        pulseWrites++;
+    for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+    {
+        if ((chBits >> chNo) & 1)
+        {
+            if (!(chRegs[chNo][addr] & 1) && (value & 1))
+                chPulses[chNo][addr]++;
+            chRegs[chNo][addr] = value;
+        }
+    }
+    return 1;
+}
+
+static uint8_t channelRead(uint16_t addr, uint8_t *value)
+{
+    uint8_t chBits = selectedChannels(addr);
+    if (chBits == 0)
+        return 0;
+    for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+    {
+        if ((chBits >> chNo) & 1)
+        {
+            *value = chRegs[chNo][addr];
+            break;
+        }
+    }
+    TEST_CHECK((chBits & (chBits - 1)) == 0);
+    return 1;
+}
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.mcuModel = 1;
+    mockDevice.usPerAccess = 1;
+    mockDevice.readHook = channelRead;
+    mockDevice.writeHook = channelWrite;
+    memset(chRegs, 0, sizeof(chRegs));
+    memset(chPulses, 0, sizeof(chPulses));
+    pulseWrites = 0;
+    /*  Other bits of the registers, set by the bringup, must survive the updates.   */
+    for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+    {
+        for (uint8_t i = 0; i < ARRAY_SIZE(pulseRegs); i++)
+            chRegs[chNo][pulseRegs[i]] = 0xa4;
+        chRegs[chNo][0x10a] = 0x5c;
+    }
+    afeNcoHopTableClear(0);
+}
+
+static void testTxNcoMulti(void)
+{
+    const uint32_t mixer[AFE_NUM_TX_CHANNELS] = {800000, 1800000, 1800000, 2400000};
+    static uint8_t singleRegs[AFE_NUM_TX_CHANNELS][0x800];
+    static uint32_t singlePulses[AFE_NUM_TX_CHANNELS][0x800];
+    uint8_t singleOpcodes[MOCK_MCU_MAX_TRIGGERS];
+    uint32_t singleTransactions;
+    uint32_t singleTriggers;
+
+    setup();
+    for (uint8_t chNo = 0; chNo < AFE_NUM_TX_CHANNELS; chNo++)
+        TEST_CHECK(updateTxNco(0, chNo, mixer[chNo], 0) == RET_OK);
+    memcpy(singleRegs, chRegs, sizeof(chRegs));
+    memcpy(singlePulses, chPulses, sizeof(chPulses));
+    memcpy(singleOpcodes, mockDevice.mcuOpcodes, sizeof(singleOpcodes));
+    singleTransactions = mockDevice.transactions;
+    singleTriggers = mockDevice.mcuTriggers;
+
+    setup();
+    TEST_CHECK(updateTxNcoMulti(0, 0xf, mixer, 0) == RET_OK);
+    /*  The same channel registers and pulses, but each pulse register is written 0, 1, 0 once for all the channels.   */
+    TEST_CHECK(memcmp(singleRegs, chRegs, sizeof(chRegs)) == 0);
+    TEST_CHECK(memcmp(singlePulses, chPulses, sizeof(chPulses)) == 0);
+    TEST_CHECK((chPulses[0][0x773] == 1) && (chPulses[3][0x773] == 1));
+    TEST_CHECK(pulseWrites == 3 * 3);
+    /*  One frequency configuration per channel and one system tune.   */
+    TEST_CHECK(mockDevice.mcuTriggers == 5);
+    for (uint8_t i = 0; i < 4; i++)
+        TEST_CHECK(mockDevice.mcuOpcodes[i] == AFE_MACRO_OPCODE_UPDATE_SYSTEM_TX_CHANNEL_FREQUENCY_CONFIGURATION);
+    TEST_CHECK(mockDevice.mcuOpcodes[4] == AFE_MACRO_OPCODE_SYSTEM_TUNE_SELECTIVE);
+    TEST_CHECK(singleTriggers == 8);
+    TEST_CHECK(mockDevice.transactions < singleTransactions);
+    TEST_CHECK((mockDevice.regs[0x13] == 0) && (mockDevice.regs[0x19] == 0));
+    printf("4 TX NCOs: updateTxNco %u, updateTxNcoMulti %u SPI transactions\n", singleTransactions, mockDevice.transactions);
+}
+
+static void testTxHop(void)
+{
+    const uint32_t mixerList[3] = {1800000, 2000000, 2400000};
+    static uint8_t singleRegs[AFE_NUM_TX_CHANNELS][0x800];
+    uint8_t singleOperands[MOCK_MCU_MAX_TRIGGERS];
+    uint8_t index;
+    uint32_t sameRangeWrites;
+    uint32_t otherRangeWrites;
+    uint32_t numHops, p50Us, p90Us, p99Us, maxUs;
+
+    setup();
+    TEST_CHECK(updateTxNco(0, 2, mixerList[2], 1) == RET_OK);
+    memcpy(singleRegs, chRegs, sizeof(chRegs));
+    memcpy(singleOperands, mockDevice.mcuOperands, sizeof(singleOperands));
+
+    setup();
+    TEST_CHECK(afeNcoHopTableAddTx(0, 2, 1, mixerList, 3, &index) == RET_OK);
+    TEST_CHECK(index == 0);
+    TEST_CHECK(afeNcoHopTo(0, index + 2) == RET_OK);
+    TEST_CHECK(memcmp(singleRegs, chRegs, sizeof(chRegs)) == 0);
+    TEST_CHECK((mockDevice.mcuTriggers == 2) && (mockDevice.mcuOperands[0] == singleOperands[0]));
+
+    /*  A hop in the same frequency range leaves the band registers alone, one in another range writes them.   */
+    TEST_CHECK(afeNcoHopTo(0, index + 1) == RET_OK);
+    chRegs[2][0x107] = 0x55;
+    sameRangeWrites = mockDevice.writes;
+    TEST_CHECK(afeNcoHopTo(0, index) == RET_OK);
+    sameRangeWrites = mockDevice.writes - sameRangeWrites;
+    TEST_CHECK(chRegs[2][0x107] == 0x55);
+    otherRangeWrites = mockDevice.writes;
+    TEST_CHECK(afeNcoHopTo(0, index + 2) == RET_OK);
+    otherRangeWrites = mockDevice.writes - otherRangeWrites;
+    TEST_CHECK(chRegs[2][0x107] == 0x00);
+    TEST_CHECK(otherRangeWrites == sameRangeWrites + 9);
+    TEST_CHECK((chPulses[2][0x131] == 4) && (chPulses[0][0x131] == 0));
+
+    TEST_CHECK(afeNcoHopGetLatency(0, &numHops, &p50Us, &p90Us, &p99Us, &maxUs) == RET_OK);
+    TEST_CHECK(numHops == 4);
+    TEST_CHECK((p50Us > 0) && (p50Us <= p90Us) && (p90Us <= p99Us) && (p99Us <= maxUs));
+
+    /*  Hops past the end of the table fail.   */
+    mockDevice.quiet = 1;
+    TEST_CHECK(afeNcoHopTo(0, 3) == RET_EXEC_FAIL);
+    afeNcoHopTableClear(0);
+    TEST_CHECK(afeNcoHopTo(0, 0) == RET_EXEC_FAIL);
+    TEST_CHECK((afeNcoHopGetLatency(0, &numHops, &p50Us, &p90Us, &p99Us, &maxUs) == RET_OK) && (numHops == 0) && (maxUs == 0));
+}
+
+static void testRxFbHop(void)
+{
+    const uint32_t mixerList[2] = {1000000, 1200000};
+    uint8_t rxIndex;
+    uint8_t fbIndex;
+    uint8_t singleOperands[MOCK_MCU_MAX_TRIGGERS];
+    uint8_t singleOpcodes[MOCK_MCU_MAX_TRIGGERS];
+
+    setup();
+    TEST_CHECK(updateRxNco(0, 3, mixerList[1], 1, 0) == RET_OK);
+    TEST_CHECK(updateFbNco(0, 1, mixerList[0], 2) == RET_OK);
+    memcpy(singleOperands, mockDevice.mcuOperands, sizeof(singleOperands));
+    memcpy(singleOpcodes, mockDevice.mcuOpcodes, sizeof(singleOpcodes));
+
+    setup();
+    TEST_CHECK(afeNcoHopTableAddRx(0, 3, 1, 0, mixerList, 2, &rxIndex) == RET_OK);
+    TEST_CHECK(afeNcoHopTableAddFb(0, 1, 2, mixerList, 2, &fbIndex) == RET_OK);
+    TEST_CHECK((rxIndex == 0) && (fbIndex == 2));
+    TEST_CHECK(afeNcoHopTo(0, rxIndex + 1) == RET_OK);
+    TEST_CHECK(afeNcoHopTo(0, fbIndex) == RET_OK);
+    TEST_CHECK(mockDevice.mcuTriggers == 2);
+    TEST_CHECK(memcmp(singleOpcodes, mockDevice.mcuOpcodes, 2) == 0);
+    TEST_CHECK(memcmp(singleOperands, mockDevice.mcuOperands, 2) == 0);
+    TEST_CHECK(mockDevice.mcuOpcodes[0] == AFE_MACRO_OPCODE_UPDATE_SYSTEM_RX_CHANNEL_FREQUENCY_CONFIGURATION);
+    TEST_CHECK(mockDevice.mcuOpcodes[1] == AFE_MACRO_OPCODE_UPDATE_SYSTEM_FB_CHANNEL_FREQUENCY_CONFIGURATION);
+}
+
+static void testTableFull(void)
+{
+    uint32_t mixerList[AFE_NCO_HOP_MAX_ENTRIES];
+    uint8_t index;
+
+    setup();
+    mockDevice.quiet = 1;
+    for (uint8_t i = 0; i < AFE_NCO_HOP_MAX_ENTRIES; i++)
+        mixerList[i] = 1000000 + i * 1000;
+    TEST_CHECK(afeNcoHopTableAddRx(0, 0, 0, 0, mixerList, AFE_NCO_HOP_MAX_ENTRIES - 1, &index) == RET_OK);
+    TEST_CHECK(afeNcoHopTableAddFb(0, 0, 0, mixerList, 2, &index) == RET_EXEC_FAIL);
+    TEST_CHECK(afeNcoHopTableAddFb(0, 0, 0, mixerList, 1, &index) == RET_OK);
+    TEST_CHECK(index == AFE_NCO_HOP_MAX_ENTRIES - 1);
+    afeNcoHopTableClear(0);
+}
+
+int main(void)
+{
+    testTxNcoMulti();
+    testTxHop();
+    testRxFbHop();
+    testTableFull();
+    printf("testNcoHop: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,187 @@
+/** @file testPageTracking.c
+ * 	@brief	Checks the page select tracking modes: the page writes that AFE_PAGE_TRACK_SKIP_REDUNDANT drops, the closes AFE_PAGE_TRACK_LAZY_CLOSE
+ * 		holds back and when they reach the device, and the counters of both.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "basicFunctions.h"
+#include "mockDevice.h"
+
+#define PAGE0 AFE_PAGE_START_ADDR
+#define PAGE1 (AFE_PAGE_START_ADDR + 1)
+#define REG_ADDR 0x0120
+#define MAX_WRITES 64
+
+static uint16_t writeAddr[MAX_WRITES];
+static uint8_t writeData[MAX_WRITES];
+static uint32_t numWrites;
+
+static uint8_t logWrite(uint16_t addr, uint8_t value)
+{
+    if (numWrites < MAX_WRITES)
+    {
+        writeAddr[numWrites] = addr;
+        writeData[numWrites] = value;
+    }
+    numWrites++;
+    return 0;
+}
+
+static void setup(uint8_t mode)
+{
+    mockDeviceReset();
+    mockDevice.quiet = 1;
+    mockDevice.writeHook = logWrite;
+    TEST_CHECK(afePageTrackingSetMode(0, mode) == RET_OK);
+    numWrites = 0;
+}
+
+static void writeReg(uint16_t addr, uint8_t data)
+{
+    TEST_CHECK(afeSpiWriteWrapper(0, addr, data, 0, 7) == RET_OK);
+}
+
+/*  Checks the writes that reached the device since the last call, as address, data pairs.   */
+static void checkWrites(const uint16_t *expected, uint32_t count)
+{
+    TEST_CHECK(numWrites == count);
+    for (uint32_t i = 0; (i < count) && (i < numWrites); i++)
+    {
+        TEST_CHECK(writeAddr[i] == expected[2 * i]);
+        TEST_CHECK(writeData[i] == expected[2 * i + 1]);
+    }
+    numWrites = 0;
+}
+
+static void checkStats(uint32_t expectedSkipped, uint32_t expectedLazySaved, uint8_t reset)
+{
+    uint32_t skipped = 0, lazySaved = 0;
+    TEST_CHECK(afePageTrackingGetStats(0, &skipped, &lazySaved, reset) == RET_OK);
+    TEST_CHECK(skipped == expectedSkipped);
+    TEST_CHECK(lazySaved == expectedLazySaved);
+}
+
+/*  Without tracking every page write is sent.   */
+static void testOff(void)
+{
+    static const uint16_t expected[] = {PAGE0, 1, PAGE0, 1, REG_ADDR, 5, PAGE0, 0, PAGE0, 0};
+
+    setup(AFE_PAGE_TRACK_OFF);
+    writeReg(PAGE0, 1);
+    writeReg(PAGE0, 1);
+    writeReg(REG_ADDR, 5);
+    writeReg(PAGE0, 0);
+    writeReg(PAGE0, 0);
+    checkWrites(expected, 5);
+    checkStats(0, 0, 1);
+}
+
+static void testSkipRedundant(void)
+{
+    static const uint16_t expected[] = {PAGE0, 1, REG_ADDR, 5, PAGE0, 2, PAGE0, 0};
+    static const uint16_t expectedAfterSetMode[] = {PAGE0, 0};
+
+    setup(AFE_PAGE_TRACK_SKIP_REDUNDANT);
+    writeReg(PAGE0, 1);
+    writeReg(PAGE0, 1);
+    writeReg(REG_ADDR, 5);
+    writeReg(PAGE0, 1);
+    writeReg(PAGE0, 2);
+    writeReg(PAGE0, 0);
+    writeReg(PAGE0, 0);
+    checkWrites(expected, 4);
+    checkStats(3, 0, 0);
+
+    /*  closeAllPages writes every page even when they are known to be closed, and the next page write is checked against it.   */
+    TEST_CHECK(closeAllPages(0) == RET_OK);
+    TEST_CHECK(numWrites == AFE_NUM_PAGE_REGS);
+    numWrites = 0;
+    writeReg(PAGE0, 0);
+    checkWrites(NULL, 0);
+    checkStats(4, 0, 1);
+    checkStats(0, 0, 0);
+
+    /*  Changing the mode forgets the tracked values.   */
+    TEST_CHECK(afePageTrackingSetMode(0, AFE_PAGE_TRACK_SKIP_REDUNDANT) == RET_OK);
+    writeReg(PAGE0, 0);
+    checkWrites(expectedAfterSetMode, 1);
+}
+
+static void testLazyClose(void)
+{
+    static const uint16_t expectedOpen[] = {PAGE0, 1, REG_ADDR, 1, REG_ADDR, 2};
+    static const uint16_t expectedRead[] = {PAGE0, 0};
+    static const uint16_t expectedReplace[] = {PAGE0, 1, PAGE0, 2};
+    static const uint16_t expectedOtherPage[] = {PAGE0, 0, PAGE1, 3};
+    static const uint16_t expectedFlush[] = {PAGE1, 0};
+    uint8_t value = 0;
+
+    setup(AFE_PAGE_TRACK_LAZY_CLOSE);
+    /*  Close and re-open of the same page between two functions never reach the device.   */
+    writeReg(PAGE0, 1);
+    writeReg(REG_ADDR, 1);
+    writeReg(PAGE0, 0);
+    writeReg(PAGE0, 1);
+    writeReg(REG_ADDR, 2);
+    writeReg(PAGE0, 0);
+    checkWrites(expectedOpen, 3);
+    TEST_CHECK(mockDevice.regs[PAGE0] == 1);
+    checkStats(0, 2, 0);
+
+    /*  A held back close is written before a read.   */
+    TEST_CHECK(afeSpiReadWrapper(0, REG_ADDR, 0, 7, &value) == RET_OK);
+    checkWrites(expectedRead, 1);
+    TEST_CHECK(mockDevice.regs[PAGE0] == 0);
+
+    /*  Opening another value of the same page replaces the close.   */
+    writeReg(PAGE0, 1);
+    writeReg(PAGE0, 0);
+    writeReg(PAGE0, 2);
+    checkWrites(expectedReplace, 2);
+    checkStats(0, 3, 0);
+
+    /*  Opening another page closes the held back one first.   */
+    writeReg(PAGE0, 0);
+    writeReg(PAGE1, 3);
+    writeReg(PAGE1, 0);
+    checkWrites(expectedOtherPage, 2);
+    TEST_CHECK(mockDevice.regs[PAGE1] == 3);
+
+    TEST_CHECK(afePageFlushPendingCloses(0) == RET_OK);
+    checkWrites(expectedFlush, 1);
+    TEST_CHECK(afePageFlushPendingCloses(0) == RET_OK);
+    checkWrites(NULL, 0);
+
+    /*  Redundant page writes are dropped too, and closeAllPages forgets a held back close before it closes everything.   */
+    writeReg(PAGE1, 0);
+    writeReg(PAGE0, 1);
+    writeReg(PAGE0, 0);
+    numWrites = 0;
+    TEST_CHECK(closeAllPages(0) == RET_OK);
+    TEST_CHECK(numWrites == AFE_NUM_PAGE_REGS);
+    TEST_CHECK(writeAddr[0] == PAGE0);
+    TEST_CHECK(mockDevice.regs[PAGE0] == 0);
+    numWrites = 0;
+    checkStats(1, 3, 1);
+    checkStats(0, 0, 0);
+
+    /*  Leaving the mode writes the held back closes.   */
+    writeReg(PAGE0, 1);
+    writeReg(PAGE0, 0);
+    numWrites = 0;
+    TEST_CHECK(afePageTrackingSetMode(0, AFE_PAGE_TRACK_OFF) == RET_OK);
+    checkWrites(expectedRead, 1);
+}
+
+int main(void)
+{
+    testOff();
+    testSkipRedundant();
+    testLazyClose();
+    printf("testPageTracking: %d failures\n", testFailures);
+    return testFailures != 0;
+}
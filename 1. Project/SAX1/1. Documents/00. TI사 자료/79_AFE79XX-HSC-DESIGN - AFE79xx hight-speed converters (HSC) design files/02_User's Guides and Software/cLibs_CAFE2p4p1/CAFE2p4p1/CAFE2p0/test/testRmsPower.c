@@ -0,0 +1,180 @@
+/** @file testRmsPower.c
+ * 	@brief	Checks getRmsPowerSweep against getRxRmsPower and getFbRmsPower on a mock with per channel detector registers,
+ * 		and that the FB detector setup is done once and redone after the device state is invalidated.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "basicFunctions.h"
+#include "controls.h"
+#include "mockDevice.h"
+
+/*  Page 0x12 bits: RXA-RXD, then FB1 and FB2.   */
+#define NUM_CHANNELS 6
+#define FB_CHANNEL(chNo) (4 + (chNo))
+
+static uint8_t chRegs[NUM_CHANNELS][0x1100];
+static uint16_t chPower[NUM_CHANNELS];
+static uint16_t chCapture[NUM_CHANNELS];
+static uint32_t multiSelectReads;
+
+static uint8_t isChannelReg(uint16_t addr)
+{
+    return ((addr >= 0x400) && (addr < 0x600)) || (addr == 0x773) || (addr == 0xb04) || (addr == 0x1015);
+}
+
+/*  The capture of 0x5c4 latches the power of a channel whose detector is set up: on for RX, configured and enabled in 0x1015 for FB.   */
+static uint16_t detectorReading(uint8_t ch)
+{
+    if ((chRegs[ch][0xb04] & 1) == 0)
+        return 0;
+    if (ch < 4)
+        return ((chRegs[ch][0x404] >> 5) & 1) ? chPower[ch] : 0;
+    if (((chRegs[ch][0x1015] & 0x4) == 0) || (chRegs[ch][0x450] != 0x08) || (chRegs[ch][0x43e] != 0x4e))
+        return 0;
+    return chPower[ch];
+}
+
+static uint8_t channelWrite(uint16_t addr, uint8_t value)
+{
+    uint8_t page = mockDevice.regs[0x12];
+    if ((page == 0) || !isChannelReg(addr))
+        return 0;
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+    {
+        if (((page >> ch) & 1) == 0)
+            continue;
+        if ((addr == 0x5c4) && (value & 1) && ((chRegs[ch][0x5c4] & 1) == 0))
+            chCapture[ch] = detectorReading(ch);
+        chRegs[ch][addr] = value;
+    }
+    return 1;
+}
+
+static uint8_t channelRead(uint16_t addr, uint8_t *value)
+{
+    uint8_t page = mockDevice.regs[0x12];
+    uint8_t ch = 0;
+    if ((page == 0) || ((addr != 0x5d0) && (addr != 0x5d1) && !isChannelReg(addr)))
+        return 0;
+    if ((page & (page - 1)) != 0)
+        multiSelectReads++;
+    while (((page >> ch) & 1) == 0)
+        ch++;
+    if (addr == 0x5d0)
+        *value = (uint8_t)chCapture[ch];
+    else if (addr == 0x5d1)
+        *value = (uint8_t)(chCapture[ch] >> 8);
+    else
+        *value = chRegs[ch][addr];
+    return 1;
+}
+
+static void setup(void)
+{
+    const uint16_t power[NUM_CHANNELS] = {0x1000, 0x2000, 0x4000, 0x100, 0x8000, 0x20};
+    mockDeviceReset();
+    mockDevice.readHook = channelRead;
+    mockDevice.writeHook = channelWrite;
+    memset(chRegs, 0, sizeof(chRegs));
+    memset(chCapture, 0, sizeof(chCapture));
+    memcpy(chPower, power, sizeof(chPower));
+    multiSelectReads = 0;
+    /*  A fresh device, nothing set up from the tests before.   */
+    afeShadowCacheInvalidate(0);
+}
+
+static uint32_t sweepCost(double *rxPwrDb, double *fbPwrDb)
+{
+    uint32_t count = 0;
+    afeSpiGetTransactionCount(0, &count, 1);
+    TEST_CHECK(getRmsPowerSweep(0, 0xf, 0x3, rxPwrDb, fbPwrDb, NULL) == RET_OK);
+    afeSpiGetTransactionCount(0, &count, 1);
+    return count;
+}
+
+static void testSweepMatchesSingle(void)
+{
+    double rxSingle[AFE_NUM_RX_CHANNELS], fbSingle[AFE_NUM_FB_CHANNELS];
+    double rxPwrDb[AFE_NUM_RX_CHANNELS], fbPwrDb[AFE_NUM_FB_CHANNELS];
+
+    setup();
+    for (uint8_t chNo = 0; chNo < AFE_NUM_RX_CHANNELS; chNo++)
+    {
+        TEST_CHECK(getRxRmsPower(0, chNo, &rxSingle[chNo]) == RET_OK);
+        TEST_CHECK(fabs(rxSingle[chNo] - 10 * log10(chPower[chNo] / 65536.0)) < 1e-9);
+    }
+    for (uint8_t chNo = 0; chNo < AFE_NUM_FB_CHANNELS; chNo++)
+    {
+        TEST_CHECK(getFbRmsPower(0, chNo, &fbSingle[chNo]) == RET_OK);
+        TEST_CHECK(fabs(fbSingle[chNo] - 10 * log10(chPower[FB_CHANNEL(chNo)] / 65536.0)) < 1e-9);
+    }
+
+    /*  The first sweep sets up the FB detectors, the second one reuses them, both read what the single channel reads do.   */
+    setup();
+    for (uint8_t sweep = 0; sweep < 2; sweep++)
+    {
+        memset(chCapture, 0, sizeof(chCapture));
+        TEST_CHECK(getRmsPowerSweep(0, 0xf, 0x3, rxPwrDb, fbPwrDb, NULL) == RET_OK);
+        TEST_CHECK(memcmp(rxPwrDb, rxSingle, sizeof(rxSingle)) == 0);
+        TEST_CHECK(memcmp(fbPwrDb, fbSingle, sizeof(fbSingle)) == 0);
+    }
+    /*  The sweep leaves the detectors of RX off as it found them, and the FB enable and digital state restored.   */
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+    {
+        if (ch < 4)
+            TEST_CHECK((chRegs[ch][0x404] & 0x20) == 0);
+        else
+            TEST_CHECK((chRegs[ch][0x1015] & 0x4) == 0);
+    }
+    TEST_CHECK(multiSelectReads == 0);
+    TEST_CHECK(mockDevice.regs[0x12] == 0);
+}
+
+static void testSetupOnce(void)
+{
+    double rxPwrDb[AFE_NUM_RX_CHANNELS], fbPwrDb[AFE_NUM_FB_CHANNELS];
+    double fbPwr = 0;
+    uint32_t firstCost, repeatCost;
+
+    setup();
+    firstCost = sweepCost(rxPwrDb, fbPwrDb);
+    repeatCost = sweepCost(rxPwrDb, fbPwrDb);
+    /*  The setup is 61 writes, of which 29 partial ones with their read, per FB channel. The skipped setup still sets the 0x1015 enable.   */
+    TEST_CHECK(firstCost - repeatCost == 2 * (61 + 29 - 2));
+    TEST_CHECK(sweepCost(rxPwrDb, fbPwrDb) == repeatCost);
+    printf("RMS power sweep of 4 RX and 2 FB channels: %u SPI transactions, %u once the FB detectors are set up\n", firstCost, repeatCost);
+
+    /*  Whatever invalidates the device state makes the next sweep set the detectors up again.   */
+    TEST_CHECK(closeAllPages(0) == RET_OK);
+    TEST_CHECK(sweepCost(rxPwrDb, fbPwrDb) == firstCost);
+    TEST_CHECK(sweepCost(rxPwrDb, fbPwrDb) == repeatCost);
+    TEST_CHECK(afeShadowCacheInvalidate(0) == RET_OK);
+    TEST_CHECK(sweepCost(rxPwrDb, fbPwrDb) == firstCost);
+
+    /*  A device reset behind the library is reported with afeShadowCacheInvalidate, and the sweep reads correctly again.   */
+    memset(chRegs, 0, sizeof(chRegs));
+    afeShadowCacheInvalidate(0);
+    TEST_CHECK(getRmsPowerSweep(0, 0x0, 0x2, NULL, fbPwrDb, NULL) == RET_OK);
+    TEST_CHECK(fabs(fbPwrDb[1] - 10 * log10(chPower[FB_CHANNEL(1)] / 65536.0)) < 1e-9);
+
+    /*  getFbRmsPower sets the detectors up as well, so the sweep after it doesn't.   */
+    setup();
+    TEST_CHECK(getFbRmsPower(0, 0, &fbPwr) == RET_OK);
+    TEST_CHECK(getFbRmsPower(0, 1, &fbPwr) == RET_OK);
+    TEST_CHECK(sweepCost(rxPwrDb, fbPwrDb) == repeatCost);
+    TEST_CHECK(multiSelectReads == 0);
+}
+
+int main(void)
+{
+    testSweepMatchesSingle();
+    testSetupOnce();
+    printf("testRmsPower: %d failures\n", testFailures);
+    return testFailures != 0;
+}
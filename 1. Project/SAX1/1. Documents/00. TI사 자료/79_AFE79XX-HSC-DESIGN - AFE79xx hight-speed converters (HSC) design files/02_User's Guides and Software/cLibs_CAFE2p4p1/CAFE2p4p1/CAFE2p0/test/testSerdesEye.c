@@ -0,0 +1,318 @@
+/** @file testSerdesEye.c
+ * 	@brief	Checks the multi-lane eye scan against getSerdesEye on a model of the eye monitor firmware of the two SerDes instances, the quick eye grid,
+ * 		the cancel of a lane without response, and the binary save/load round trip of the eye results.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "serDes.h"
+#include "mockDevice.h"
+
+/*  SPI addresses of the bytes of the mailbox command 0x9815, its argument 0x9816 and the data 0x9f00-0x9f0f.   */
+#define CMD_LOW_SPI_ADDR 0x702a
+#define CMD_HIGH_SPI_ADDR 0x702b
+#define ARG_LOW_SPI_ADDR 0x702c
+#define ARG_HIGH_SPI_ADDR 0x702d
+#define DATA_SPI_ADDR 0x7e00
+#define NO_RESPONSE UINT64_MAX
+#define MAX_LOGGED_CMDS 4096
+
+/*  Eye monitor of a SerDes instance. Commands are answered after a latency of simulated time, 2 ms for em_start and em_read, as the measurement takes longer than the SPI reads of the results.   */
+typedef struct MOCK_EYE_MONITOR
+{
+    uint16_t cmdReg;
+    uint16_t response;
+    uint64_t doneUs;
+    uint8_t lane;
+    uint8_t progress;
+    int16_t phase;
+    int16_t margin;
+    uint16_t extent;
+    /// em_start of this firmware lane is never answered, 0xff for none.
+    uint8_t stuckLane;
+    uint32_t cancels;
+} MockEyeMonitor_t;
+
+static MockEyeMonitor_t monitor[AFE_NUM_JESD_INSTANCES];
+static uint32_t badPageAccesses;
+static uint16_t loggedCmds[MAX_LOGGED_CMDS];
+static uint32_t numLoggedCmds;
+
+static uint16_t modelBer(uint8_t instanceNo, uint8_t lane, int16_t phase, int16_t margin)
+{
+    if ((abs(phase) < 6) && (abs(margin) < 20))
+        return 0;
+    return (uint16_t)(abs(phase) * 50 + abs(margin) * 3 + lane * 7 + instanceNo * 3 + 1);
+}
+
+static MockEyeMonitor_t *selectedMonitor(void)
+{
+    if (mockDevice.regs[0x16] == 0x20)
+        return &monitor[0];
+    if (mockDevice.regs[0x16] == 0x40)
+        return &monitor[1];
+    badPageAccesses++;
+    return &monitor[0];
+}
+
+static uint8_t eyeMonitorWrite(uint16_t addr, uint8_t value)
+{
+    MockEyeMonitor_t *mon;
+    uint16_t cmd;
+    uint16_t arg;
+    uint64_t latencyUs = 2000;
+
+    if (addr != CMD_LOW_SPI_ADDR)
+        return 0;
+    mon = selectedMonitor();
+    cmd = (uint16_t)((mockDevice.regs[CMD_HIGH_SPI_ADDR] << 8) | value);
+    arg = (uint16_t)((mockDevice.regs[ARG_HIGH_SPI_ADDR] << 8) | mockDevice.regs[ARG_LOW_SPI_ADDR]);
+    if (numLoggedCmds < MAX_LOGGED_CMDS)
+        loggedCmds[numLoggedCmds++] = (uint16_t)((mon - monitor) << 15) | cmd;
+    mon->cmdReg = cmd;
+    switch (cmd >> 12)
+    {
+    case 1:
+        mon->lane = cmd & 0x3;
+        mon->progress = 0;
+        mon->extent = (uint16_t)(100 + (mon - monitor) * 10 + mon->lane);
+        mon->response = 0x0000;
+        if (mon->lane == mon->stuckLane)
+            latencyUs = NO_RESPONSE;
+        break;
+    case 2:
+        mon->progress += 50;
+        mon->response = 0x0100 | mon->progress;
+        latencyUs = 200;
+        break;
+    case 3:
+        mon->phase = (int8_t)(cmd & 0xff);
+        mon->margin = (int16_t)arg;
+        /*  No data for the last phase, the readers fill in zeros.   */
+        mon->response = (mon->phase == 16) ? 0x0000 : 0x0200;
+        break;
+    default:
+        mon->response = 0x0306;
+        mon->cancels++;
+        latencyUs = 100;
+        break;
+    }
+    mon->doneUs = (latencyUs == NO_RESPONSE) ? NO_RESPONSE : mockDevice.timeUs + latencyUs;
+    return 1;
+}
+
+static uint8_t eyeMonitorRead(uint16_t addr, uint8_t *value)
+{
+    MockEyeMonitor_t *mon;
+    if ((addr != CMD_LOW_SPI_ADDR) && (addr != CMD_HIGH_SPI_ADDR) && (addr != ARG_LOW_SPI_ADDR) && (addr != ARG_HIGH_SPI_ADDR) && ((addr < DATA_SPI_ADDR) || (addr >= DATA_SPI_ADDR + 32)))
+        return 0;
+    mon = selectedMonitor();
+    if (mockDevice.timeUs >= mon->doneUs)
+        mon->cmdReg = mon->response;
+    if ((addr == CMD_LOW_SPI_ADDR) || (addr == CMD_HIGH_SPI_ADDR))
+        *value = (addr == CMD_HIGH_SPI_ADDR) ? (uint8_t)(mon->cmdReg >> 8) : (uint8_t)mon->cmdReg;
+    else if ((addr == ARG_LOW_SPI_ADDR) || (addr == ARG_HIGH_SPI_ADDR))
+        *value = (addr == ARG_HIGH_SPI_ADDR) ? (uint8_t)(mon->extent >> 8) : (uint8_t)mon->extent;
+    else
+    {
+        uint16_t ber = modelBer((uint8_t)(mon - monitor), mon->lane, mon->phase, mon->margin + (addr - DATA_SPI_ADDR) / 2);
+        *value = (addr & 1) ? (uint8_t)(ber >> 8) : (uint8_t)ber;
+    }
+    return 1;
+}
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.usPerAccess = 10;
+    mockDevice.waitAdvancesClock = 1;
+    mockDevice.readHook = eyeMonitorRead;
+    mockDevice.writeHook = eyeMonitorWrite;
+    mockDevice.quiet = 1;
+    memset(monitor, 0, sizeof(monitor));
+    monitor[0].stuckLane = 0xff;
+    monitor[1].stuckLane = 0xff;
+    badPageAccesses = 0;
+    numLoggedCmds = 0;
+    afeSerdesMailboxClearStats(0);
+}
+
+static uint32_t countCmds(uint16_t type)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < numLoggedCmds; i++)
+        count += ((loggedCmds[i] & 0x7000) >> 12) == type;
+    return count;
+}
+
+/*  getSerdesEyeMulti returns the BER matrices and extents of getSerdesEye, and takes about half the time with lanes on both instances.   */
+static void testMultiMatchesSingle(void)
+{
+    static uint16_t ber[4][AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS];
+    static AfeSerdesEye_t eye[4];
+    const uint8_t lanes[4] = {0, 1, 4, 5};
+    uint16_t extent[4] = {0, 0, 0, 0};
+    uint64_t singleUs = 0;
+    uint64_t multiUs;
+
+    setup();
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        uint64_t startUs = mockDevice.timeUs;
+        TEST_CHECK(getSerdesEye(0, lanes[i], ber[i], &extent[i]) == RET_OK);
+        singleUs += mockDevice.timeUs - startUs;
+    }
+    setup();
+    TEST_CHECK(getSerdesEyeMulti(0, 0x33, 0, eye) == RET_OK);
+    multiUs = mockDevice.timeUs;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        TEST_CHECK((eye[i].result == RET_OK) && (eye[i].laneNo == lanes[i]));
+        TEST_CHECK((eye[i].numPhases == AFE_SERDES_EYE_NUM_PHASES) && (eye[i].numMargins == AFE_SERDES_EYE_NUM_MARGINS));
+        TEST_CHECK(eye[i].extent == extent[i]);
+        TEST_CHECK(memcmp(eye[i].ber, ber[i], sizeof(ber[i])) == 0);
+    }
+    /*  The lanes map to distinct firmware lanes, so a mix-up of the lanes shows in the matrices.   */
+    TEST_CHECK(memcmp(ber[0], ber[1], sizeof(ber[0])) != 0);
+    TEST_CHECK(memcmp(ber[0], ber[2], sizeof(ber[0])) != 0);
+    TEST_CHECK(ber[3][5 * AFE_SERDES_EYE_NUM_MARGINS] == modelBer(1, 2, -11, -47));
+    TEST_CHECK(ber[3][32 * AFE_SERDES_EYE_NUM_MARGINS] == 0);
+    TEST_CHECK((badPageAccesses == 0) && (mockDevice.regs[0x16] == 0));
+    TEST_CHECK(multiUs < singleUs * 6 / 10);
+    printf("eye of 4 lanes: %u us one by one, %u us with getSerdesEyeMulti\n", (unsigned int)singleUs, (unsigned int)multiUs);
+}
+
+/*  The quick eye is the full eye on every AFE_SERDES_EYE_QUICK_STEP-th phase and margin, and its metrics agree with the full eye to a step.   */
+static void testQuickGrid(void)
+{
+    static AfeSerdesEye_t full[2];
+    static AfeSerdesEye_t quick[2];
+    uint32_t fullReads;
+
+    setup();
+    TEST_CHECK(getSerdesEyeMulti(0, 0x11, 0, full) == RET_OK);
+    fullReads = countCmds(3);
+    setup();
+    TEST_CHECK(getSerdesEyeMulti(0, 0x11, 1, quick) == RET_OK);
+    TEST_CHECK(fullReads == 2 * AFE_SERDES_EYE_NUM_PHASES * 6);
+    TEST_CHECK(countCmds(3) == 2 * 9 * 6);
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        AfeSerdesEye_t *q = &quick[i];
+        TEST_CHECK((q->result == RET_OK) && (q->numPhases == 9) && (q->numMargins == 24));
+        TEST_CHECK((q->phaseStep == AFE_SERDES_EYE_QUICK_STEP) && (q->marginStep == AFE_SERDES_EYE_QUICK_STEP));
+        TEST_CHECK((q->firstPhase == -16) && (q->firstMargin == -47) && (q->extent == full[i].extent));
+        for (uint8_t p = 0; p < q->numPhases; p++)
+        {
+            for (uint8_t m = 0; m < q->numMargins; m++)
+                TEST_CHECK(q->ber[p * q->numMargins + m] == full[i].ber[p * AFE_SERDES_EYE_QUICK_STEP * AFE_SERDES_EYE_NUM_MARGINS + m * AFE_SERDES_EYE_QUICK_STEP]);
+        }
+        /*  The model eye is open over phases -5..5 and margins -19..19.   */
+        TEST_CHECK((full[i].eyeWidth == 11) && (full[i].eyeHeight == 39));
+        TEST_CHECK(abs(q->eyeWidth - full[i].eyeWidth) <= AFE_SERDES_EYE_QUICK_STEP);
+        TEST_CHECK(abs(q->eyeHeight - full[i].eyeHeight) <= AFE_SERDES_EYE_QUICK_STEP);
+    }
+}
+
+/*  A lane whose em_start is never answered is cancelled on its instance before the next lane starts. The other instance goes on meanwhile.   */
+static void testTimeoutCancel(void)
+{
+    static uint16_t ber[AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS];
+    static AfeSerdesEye_t eye[3];
+    uint8_t jesdToSerdesLaneMappingLocal[8] = jesdToSerdesLaneMapping;
+    uint16_t extent = 0;
+    uint32_t cancelIdx = MAX_LOGGED_CMDS;
+    uint32_t count, timeouts, reads, maxUs;
+    uint64_t totalUs;
+
+    setup();
+    TEST_CHECK(getSerdesEye(0, 1, ber, &extent) == RET_OK);
+    setup();
+    monitor[0].stuckLane = jesdToSerdesLaneMappingLocal[0];
+    TEST_CHECK(getSerdesEyeMulti(0, 0x13, 0, eye) == RET_EXEC_FAIL);
+    TEST_CHECK((eye[0].result == RET_EXEC_FAIL) && (eye[1].result == RET_OK) && (eye[2].result == RET_OK));
+    TEST_CHECK((monitor[0].cancels == 1) && (monitor[1].cancels == 0));
+    TEST_CHECK(memcmp(eye[1].ber, ber, sizeof(ber)) == 0);
+    for (uint32_t i = 0; i < numLoggedCmds; i++)
+    {
+        if (loggedCmds[i] == 0x4000)
+            cancelIdx = i;
+    }
+    /*  On instance 0: the stuck start, the cancel, then the start of the next lane.   */
+    TEST_CHECK(cancelIdx < numLoggedCmds - 1);
+    for (uint32_t i = 0, n = 0; i < numLoggedCmds; i++)
+    {
+        if ((loggedCmds[i] >> 15) != 0)
+            continue;
+        if (n == 1)
+            TEST_CHECK(i == cancelIdx);
+        if (n == 2)
+            TEST_CHECK((loggedCmds[i] >> 12) == 1);
+        n++;
+    }
+    TEST_CHECK(afeSerdesMailboxGetStats(0, 4, &count, &timeouts, &reads, &totalUs, &maxUs) == RET_OK);
+    TEST_CHECK((count == 1) && (timeouts == 0));
+    TEST_CHECK(afeSerdesMailboxGetStats(0, 1, &count, &timeouts, &reads, &totalUs, &maxUs) == RET_OK);
+    TEST_CHECK((count == 2) && (timeouts == 1));
+}
+
+static uint8_t sameEye(const AfeSerdesEye_t *a, const AfeSerdesEye_t *b)
+{
+    if ((a->laneNo != b->laneNo) || (a->result != b->result) || (a->numPhases != b->numPhases) || (a->numMargins != b->numMargins))
+        return 0;
+    if ((a->firstPhase != b->firstPhase) || (a->phaseStep != b->phaseStep) || (a->firstMargin != b->firstMargin) || (a->marginStep != b->marginStep))
+        return 0;
+    if ((a->extent != b->extent) || (a->scanTimeUs != b->scanTimeUs) || (a->threshold != b->threshold))
+        return 0;
+    if ((a->eyeHeight != b->eyeHeight) || (a->eyeWidth != b->eyeWidth) || (a->openArea != b->openArea))
+        return 0;
+    return memcmp(a->ber, b->ber, (size_t)a->numPhases * a->numMargins * sizeof(a->ber[0])) == 0;
+}
+
+static void testSaveLoad(void)
+{
+    static AfeSerdesEye_t eye[3];
+    static AfeSerdesEye_t loaded[3];
+    uint32_t boardId = 0;
+    uint8_t numEyes = 0;
+    FILE *fp;
+    long size;
+
+    setup();
+    TEST_CHECK(getSerdesEyeMulti(0, 0x11, 0, eye) == RET_OK);
+    TEST_CHECK(getSerdesEyeMulti(0, 0x04, 1, &eye[2]) == RET_OK);
+    TEST_CHECK(afeSerdesEyeMetrics(&eye[1], 200) == RET_OK);
+    TEST_CHECK(afeSerdesEyeSave("testSerdesEye.bin", "testSerdesEye.csv", 0x12345678, eye, 3) == RET_OK);
+    TEST_CHECK(afeSerdesEyeLoad("testSerdesEye.bin", &boardId, loaded, 3, &numEyes) == RET_OK);
+    TEST_CHECK((boardId == 0x12345678) && (numEyes == 3));
+    for (uint8_t i = 0; i < 3; i++)
+        TEST_CHECK(sameEye(&eye[i], &loaded[i]));
+
+    /*  Header, two full and one quick eye.   */
+    fp = fopen("testSerdesEye.bin", "rb");
+    TEST_CHECK(fp != NULL);
+    if (fp != NULL)
+    {
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fclose(fp);
+        TEST_CHECK(size == 16 + 2 * 6294 + 456);
+    }
+    TEST_CHECK(afeSerdesEyeLoad("testSerdesEye.bin", &boardId, loaded, 2, &numEyes) == RET_EXEC_FAIL);
+    TEST_CHECK(afeSerdesEyeLoad("testSerdesEye.csv", &boardId, loaded, 3, &numEyes) == RET_EXEC_FAIL);
+}
+
+int main(void)
+{
+    testMultiMatchesSingle();
+    testQuickGrid();
+    testTimeoutCancel();
+    testSaveLoad();
+    printf("testSerdesEye: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,136 @@
+/** @file testSerdesMailbox.c
+ * 	@brief	Checks that the SerDes eye monitor mailbox waits end when the mailbox stays busy, with the frozen clock of the user template and with a running clock.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "serDes.h"
+#include "mockDevice.h"
+
+/*  SPI address of the upper byte of the mailbox command register 0x9815, bits 15:12 are the busy command type. A SerDes read reads each byte twice.   */
+#define MAILBOX_CMD_HIGH_SPI_ADDR ((((0x9815 + 0x2000) << 1) + 1) & 0x7fff)
+#define SPI_READS_PER_SERDES_READ 2
+
+/*  SPI reads of the mailbox command register, and the response read from which the slow mailbox answers.   */
+static uint32_t busyReads = 0;
+static uint32_t readsUntilDone = 0;
+
+static uint8_t stuckBusyRead(uint16_t addr, uint8_t *value)
+{
+    if (addr != MAILBOX_CMD_HIGH_SPI_ADDR)
+        return 0;
+    *value = 0x20;
+    busyReads++;
+    return 1;
+}
+
+static uint8_t slowMailboxRead(uint16_t addr, uint8_t *value)
+{
+    if (addr != MAILBOX_CMD_HIGH_SPI_ADDR)
+        return 0;
+    busyReads++;
+    *value = (busyReads < readsUntilDone * SPI_READS_PER_SERDES_READ) ? 0x20 : 0x00;
+    return 1;
+}
+
+static void setup(uint32_t usPerAccess, uint8_t waitAdvancesClock, uint8_t (*readHook)(uint16_t, uint8_t *))
+{
+    mockDeviceReset();
+    mockDevice.usPerAccess = usPerAccess;
+    mockDevice.waitAdvancesClock = waitAdvancesClock;
+    mockDevice.readHook = readHook;
+    mockDevice.quiet = 1;
+    busyReads = 0;
+    afeSerdesMailboxClearStats(0);
+}
+
+/*  getTimeUs always 0 and waitMs without effect: the wait has to end on the read limit and the counted sleeps alone.   */
+static void testStuckBusyFrozenClock(void)
+{
+    uint16_t ber[AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS];
+    uint16_t extent = 0;
+    uint32_t count, timeouts, reads, maxUs;
+    uint64_t totalUs;
+
+    setup(0, 0, stuckBusyRead);
+    TEST_CHECK(getSerdesEye(0, 0, ber, &extent) == RET_EXEC_FAIL);
+    TEST_CHECK(afeSerdesMailboxGetStats(0, 1, &count, &timeouts, &reads, &totalUs, &maxUs) == RET_OK);
+    TEST_CHECK((count == 0) && (timeouts == 1));
+    TEST_CHECK(reads == busyReads / SPI_READS_PER_SERDES_READ);
+    TEST_CHECK(reads < 120);
+    TEST_CHECK((mockDevice.waitedMs > 500) && (mockDevice.waitedMs < 520));
+    printf("stuck busy, frozen clock: %u response reads, %u ms slept in %u waits\n", reads, (unsigned int)mockDevice.waitedMs, mockDevice.waits);
+}
+
+/*  Running clock: the back-to-back reads count towards the 500 ms too.   */
+static void testStuckBusyRunningClock(void)
+{
+    uint16_t ber[AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS];
+    uint16_t extent = 0;
+
+    setup(100, 1, stuckBusyRead);
+    TEST_CHECK(getSerdesEye(0, 0, ber, &extent) == RET_EXEC_FAIL);
+    TEST_CHECK((mockDevice.timeUs > 500000) && (mockDevice.timeUs < 600000));
+    printf("stuck busy, running clock: failed after %u us\n", (unsigned int)mockDevice.timeUs);
+}
+
+/*  Spinning alone must also end: a clock that only moves with the SPI accesses, and sleeps that don't.   */
+static void testStuckBusySpinClock(void)
+{
+    uint16_t ber[AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS];
+    uint16_t extent = 0;
+
+    setup(1000, 0, stuckBusyRead);
+    TEST_CHECK(getSerdesEye(0, 0, ber, &extent) == RET_EXEC_FAIL);
+    TEST_CHECK(mockDevice.timeUs < 600000);
+}
+
+/*  Each instance waits for its start command and then for the em_cancel of it, the instances at the same time. The other lanes of a hung instance are given up.   */
+static void testStuckBusyMultiLane(void)
+{
+    static AfeSerdesEye_t eye[4];
+    uint32_t count, timeouts, reads, maxUs;
+    uint64_t totalUs;
+
+    setup(0, 0, stuckBusyRead);
+    TEST_CHECK(getSerdesEyeMulti(0, 0x33, 1, eye) == RET_EXEC_FAIL);
+    TEST_CHECK((eye[0].result == RET_EXEC_FAIL) && (eye[1].result == RET_EXEC_FAIL) && (eye[2].result == RET_EXEC_FAIL) && (eye[3].result == RET_EXEC_FAIL));
+    TEST_CHECK(afeSerdesMailboxGetStats(0, 1, &count, &timeouts, &reads, &totalUs, &maxUs) == RET_OK);
+    TEST_CHECK((count == 0) && (timeouts == 2));
+    TEST_CHECK(afeSerdesMailboxGetStats(0, 4, &count, &timeouts, &reads, &totalUs, &maxUs) == RET_OK);
+    TEST_CHECK((count == 0) && (timeouts == 2));
+    TEST_CHECK(busyReads / SPI_READS_PER_SERDES_READ < 480);
+    printf("stuck busy, four lanes, frozen clock: %u response reads\n", busyReads / SPI_READS_PER_SERDES_READ);
+
+    setup(100, 1, stuckBusyRead);
+    TEST_CHECK(getSerdesEyeMulti(0, 0x33, 1, eye) == RET_EXEC_FAIL);
+    TEST_CHECK(mockDevice.timeUs < 1200000);
+}
+
+static void testSlowResponse(void)
+{
+    uint32_t count, timeouts, reads, maxUs;
+    uint64_t totalUs;
+    uint16_t ber[AFE_SERDES_EYE_NUM_PHASES * AFE_SERDES_EYE_NUM_MARGINS];
+    uint16_t extent = 0;
+
+    setup(0, 0, slowMailboxRead);
+    readsUntilDone = 50;
+    getSerdesEye(0, 0, ber, &extent);
+    TEST_CHECK(afeSerdesMailboxGetStats(0, 1, &count, &timeouts, &reads, &totalUs, &maxUs) == RET_OK);
+    TEST_CHECK((count == 1) && (timeouts == 0) && (reads == readsUntilDone));
+}
+
+int main(void)
+{
+    testStuckBusyFrozenClock();
+    testStuckBusyRunningClock();
+    testStuckBusySpinClock();
+    testStuckBusyMultiLane();
+    testSlowResponse();
+    printf("testSerdesMailbox: %d failures\n", testFailures);
+    return testFailures != 0;
+}
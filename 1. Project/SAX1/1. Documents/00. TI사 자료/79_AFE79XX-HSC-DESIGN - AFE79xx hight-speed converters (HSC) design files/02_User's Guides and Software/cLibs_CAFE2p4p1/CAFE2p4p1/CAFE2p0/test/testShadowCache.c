@@ -0,0 +1,140 @@
+/** @file testShadowCache.c
+ * 	@brief	Checks that the shadow register cache serves the read of the read-modify-writes of the registers marked with afeShadowCacheAddRange,
+ * 		counts its hits and misses, and forgets the cached values when the page selection changes, on closeAllPages and on afeShadowCacheInvalidate.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "basicFunctions.h"
+#include "mockDevice.h"
+
+#define CACHED_ADDR 0x0120
+#define UNCACHED_ADDR 0x0220
+#define SERDES_ADDR 0x1234
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.quiet = 1;
+    afePageTrackingSetMode(0, AFE_PAGE_TRACK_OFF);
+    afeShadowCacheClearRanges(0);
+    afeShadowCacheEnable(0, 1);
+    afeShadowCacheAddRange(0, 0x0100, 0x01FF);
+}
+
+/*  Writes a field and returns the SPI reads it took.   */
+static uint32_t fieldWriteReads(uint16_t addr, uint8_t data, uint8_t lsb, uint8_t msb)
+{
+    uint32_t reads = mockDevice.reads;
+    TEST_CHECK(afeSpiWriteWrapper(0, addr, data, lsb, msb) == RET_OK);
+    return mockDevice.reads - reads;
+}
+
+static void checkStats(uint32_t expectedHits, uint32_t expectedMisses)
+{
+    uint32_t hits = 0, misses = 0;
+    TEST_CHECK(afeShadowCacheGetStats(0, &hits, &misses) == RET_OK);
+    TEST_CHECK(hits == expectedHits);
+    TEST_CHECK(misses == expectedMisses);
+}
+
+/*  The first field write reads the register, the next ones use the value the cache kept of the last write.   */
+static void testHit(void)
+{
+    setup();
+    mockDevice.regs[CACHED_ADDR] = 0x5A;
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x3, 0, 1) == 1);
+    checkStats(0, 1);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x20, 4, 5) == 0);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x0, 7, 7) == 0);
+    checkStats(2, 1);
+    TEST_CHECK(mockDevice.regs[CACHED_ADDR] == 0x6B);
+
+    /*  A read through the wrapper also fills the cache.   */
+    mockDevice.regs[CACHED_ADDR + 1] = 0xC3;
+    {
+        uint8_t value = 0;
+        TEST_CHECK(afeSpiReadWrapper(0, CACHED_ADDR + 1, 0, 7, &value) == RET_OK);
+        TEST_CHECK(value == 0xC3);
+    }
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR + 1, 0x0, 0, 0) == 0);
+    TEST_CHECK(mockDevice.regs[CACHED_ADDR + 1] == 0xC2);
+    checkStats(3, 1);
+
+    /*  Registers outside the ranges are always read and not counted.   */
+    TEST_CHECK(fieldWriteReads(UNCACHED_ADDR, 0x1, 0, 0) == 1);
+    TEST_CHECK(fieldWriteReads(UNCACHED_ADDR, 0x1, 1, 1) == 1);
+    checkStats(3, 1);
+}
+
+/*  The SerDes read-modify-write of serdesWriteWrapper reads both bytes once, then uses the cache.   */
+static void testSerdesHit(void)
+{
+    uint16_t value = 0;
+
+    setup();
+    afeShadowCacheAddRange(0, 0x4000, 0x7FFF);
+    TEST_CHECK(serdesRawWrite(0, SERDES_ADDR, 0x1234) == RET_OK);
+    mockDevice.reads = 0;
+    TEST_CHECK(serdesWriteWrapper(0, SERDES_ADDR, 0xF0, 4, 7) == RET_OK);
+    TEST_CHECK(serdesWriteWrapper(0, SERDES_ADDR, 0x0, 12, 15) == RET_OK);
+    TEST_CHECK(mockDevice.reads == 0);
+    TEST_CHECK(serdesRawRead(0, SERDES_ADDR, &value) == RET_OK);
+    TEST_CHECK(value == 0x02F4);
+}
+
+/*  Cached values belong to the page selection they were filled in, and are not trusted after closeAllPages or an invalidate.   */
+static void testInvalidation(void)
+{
+    uint32_t epoch = 0;
+
+    setup();
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 0, 0) == 1);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 1, 1) == 0);
+
+    /*  Rewriting the same page keeps the cache, another page clears it.   */
+    TEST_CHECK(afeSpiWriteWrapper(0, AFE_PAGE_START_ADDR, 0x01, 0, 7) == RET_OK);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 2, 2) == 1);
+    TEST_CHECK(afeSpiWriteWrapper(0, AFE_PAGE_START_ADDR, 0x01, 0, 7) == RET_OK);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 3, 3) == 0);
+    TEST_CHECK(afeSpiWriteWrapper(0, AFE_PAGE_START_ADDR, 0x02, 0, 7) == RET_OK);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 4, 4) == 1);
+
+    /*  The device may have been reset behind closeAllPages, even if it only rewrites the pages that are already closed.   */
+    for (uint16_t addr = AFE_PAGE_START_ADDR; addr <= AFE_PAGE_END_ADDR; addr++)
+        TEST_CHECK(afeSpiWriteWrapper(0, addr, 0x00, 0, 7) == RET_OK);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 5, 5) == 1);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 6, 6) == 0);
+    epoch = afeGetDeviceStateEpoch(0);
+    TEST_CHECK(closeAllPages(0) == RET_OK);
+    TEST_CHECK(afeGetDeviceStateEpoch(0) != epoch);
+    mockDevice.regs[CACHED_ADDR] = 0x80;
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 0, 0) == 1);
+    TEST_CHECK(mockDevice.regs[CACHED_ADDR] == 0x81);
+
+    TEST_CHECK(afeShadowCacheInvalidate(0) == RET_OK);
+    mockDevice.regs[CACHED_ADDR] = 0x40;
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 0, 0) == 1);
+    TEST_CHECK(mockDevice.regs[CACHED_ADDR] == 0x41);
+    checkStats(3, 6);
+
+    /*  Disabling clears the counters and reads every time again.   */
+    TEST_CHECK(afeShadowCacheEnable(0, 0) == RET_OK);
+    checkStats(0, 0);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 1, 1) == 1);
+    TEST_CHECK(fieldWriteReads(CACHED_ADDR, 0x1, 2, 2) == 1);
+    checkStats(0, 0);
+}
+
+int main(void)
+{
+    testHit();
+    testSerdesHit();
+    testInvalidation();
+    afeShadowCacheClearRanges(0);
+    printf("testShadowCache: %d failures\n", testFailures);
+    return testFailures != 0;
+}
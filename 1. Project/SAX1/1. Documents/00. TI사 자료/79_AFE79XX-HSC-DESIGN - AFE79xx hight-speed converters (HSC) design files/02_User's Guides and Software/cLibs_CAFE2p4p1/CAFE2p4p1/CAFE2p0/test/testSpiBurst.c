@@ -0,0 +1,130 @@
+/** @file testSpiBurst.c
+ * 	@brief	Checks that the SPI burst wrappers send one frame per register until afeMacroOperandBurstCheck has seen the AFE step the address,
+ * 		and that the check leaves the bursts disabled on an AFE that does not. Also checks the macro operands, macro results and MCU memory reads built on the wrappers.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "basicFunctions.h"
+#include "hMacro.h"
+#include "mockDevice.h"
+
+#define TEST_BLOCK_ADDR 0x0100
+#define TEST_BLOCK_LEN 16
+
+static void setup(uint8_t burstFixedAddr)
+{
+    mockDeviceReset();
+    mockDevice.burstFixedAddr = burstFixedAddr;
+    mockDevice.quiet = 1;
+    afeSpiBurstEnable(0, 0);
+}
+
+/*  Writes a block with the burst wrapper, reads it back with the burst wrapper and checks both against the register array.   */
+static void checkBlock(uint8_t seed)
+{
+    uint8_t data[TEST_BLOCK_LEN];
+    uint8_t readBack[TEST_BLOCK_LEN];
+
+    for (uint8_t i = 0; i < TEST_BLOCK_LEN; i++)
+    {
+        data[i] = (uint8_t)(seed + 3 * i);
+        readBack[i] = 0;
+    }
+    TEST_CHECK(afeSpiBurstWriteWrapper(0, TEST_BLOCK_ADDR, data, TEST_BLOCK_LEN) == RET_OK);
+    TEST_CHECK(afeSpiBurstReadWrapper(0, TEST_BLOCK_ADDR, readBack, TEST_BLOCK_LEN) == RET_OK);
+    for (uint8_t i = 0; i < TEST_BLOCK_LEN; i++)
+    {
+        TEST_CHECK(mockDevice.regs[TEST_BLOCK_ADDR + i] == data[i]);
+        TEST_CHECK(readBack[i] == data[i]);
+    }
+}
+
+/*  Bursts are off by default: even an AFE that does not step the address gets the right registers.   */
+static void testDefaultFallback(void)
+{
+    setup(1);
+    checkBlock(0x11);
+    TEST_CHECK(mockDevice.bursts == 0);
+    TEST_CHECK(mockDevice.reads == TEST_BLOCK_LEN);
+}
+
+static void testCheckEnablesBursts(void)
+{
+    uint32_t singleTransactions = 0, burstTransactions = 0;
+
+    setup(0);
+    TEST_CHECK(afeMacroOperandBurstCheck(0, 32, &singleTransactions, &burstTransactions) == RET_OK);
+    TEST_CHECK(burstTransactions < singleTransactions);
+    mockDevice.bursts = 0;
+    checkBlock(0x22);
+    TEST_CHECK(mockDevice.bursts == 2);
+    printf("burst check: %u transactions register by register, %u with bursts\n", singleTransactions, burstTransactions);
+}
+
+/*  The check fails on an AFE that does not step the address, and the wrappers keep sending one frame per register.   */
+static void testCheckRejectsFixedAddress(void)
+{
+    uint32_t singleTransactions = 0, burstTransactions = 0;
+
+    setup(1);
+    afeSpiBurstEnable(0, 1);
+    TEST_CHECK(afeMacroOperandBurstCheck(0, 32, &singleTransactions, &burstTransactions) == RET_EXEC_FAIL);
+    mockDevice.bursts = 0;
+    checkBlock(0x33);
+    TEST_CHECK(mockDevice.bursts == 0);
+}
+
+/*  Macro operands, macro results and MCU memory reads give the same values with and without bursts, in fewer transactions with them.   */
+static void testBlockUsers(uint8_t bursts)
+{
+    uint8_t operands[5] = {0x11, 0x22, 0x33, 0x44, 0x55};
+    uint32_t result = 0xFFFFFFFF;
+    uint64_t memValue = 0;
+    uint32_t count = 0;
+
+    setup(0);
+    afeSpiBurstEnable(0, bursts);
+    afeSpiGetTransactionCount(0, &count, 1);
+    for (uint8_t i = 0; i < 8; i++)
+        mockDevice.regs[AFE_MACRO_OPERAND_START_REG_ADDR + i] = 0xEE;
+    TEST_CHECK(writeOperandList(0, operands, 5) == RET_OK);
+    for (uint8_t i = 0; i < 8; i++)
+        TEST_CHECK(mockDevice.regs[AFE_MACRO_OPERAND_START_REG_ADDR + i] == ((i < 5) ? operands[i] : 0));
+    afeSpiGetTransactionCount(0, &count, 1);
+    TEST_CHECK(count == (bursts ? 3 : 10));
+
+    mockDevice.regs[AFE_MACRO_RESULT_START_REG_ADDR + 4] = 0x78;
+    mockDevice.regs[AFE_MACRO_RESULT_START_REG_ADDR + 5] = 0x56;
+    mockDevice.regs[AFE_MACRO_RESULT_START_REG_ADDR + 6] = 0x34;
+    mockDevice.regs[AFE_MACRO_RESULT_START_REG_ADDR + 7] = 0x12;
+    TEST_CHECK(readResultRegSpi(0, 1, &result) == RET_OK);
+    TEST_CHECK(result == 0x12345678);
+    afeSpiGetTransactionCount(0, &count, 1);
+    TEST_CHECK(count == (bursts ? 3 : 6));
+
+    /*  Address 0x10 of the first 0x7fe0 byte window is at SPI address 0x30.   */
+    for (uint8_t i = 0; i < 8; i++)
+        mockDevice.regs[0x30 + i] = (uint8_t)(0x10 * i + i);
+    TEST_CHECK(readTopMem(0, 0x10, &memValue, 8) == RET_OK);
+    TEST_CHECK(memValue == 0x7766554433221100ULL);
+    TEST_CHECK(readTopMem(0, 0x10, &memValue, 3) == RET_OK);
+    TEST_CHECK(memValue == 0x221100);
+    afeSpiGetTransactionCount(0, &count, 1);
+    TEST_CHECK(count == (bursts ? 12 : 21));
+    afeSpiBurstEnable(0, 0);
+}
+
+int main(void)
+{
+    testDefaultFallback();
+    testCheckEnablesBursts();
+    testCheckRejectsFixedAddress();
+    testBlockUsers(0);
+    testBlockUsers(1);
+    printf("testSpiBurst: %d failures\n", testFailures);
+    return testFailures != 0;
+}
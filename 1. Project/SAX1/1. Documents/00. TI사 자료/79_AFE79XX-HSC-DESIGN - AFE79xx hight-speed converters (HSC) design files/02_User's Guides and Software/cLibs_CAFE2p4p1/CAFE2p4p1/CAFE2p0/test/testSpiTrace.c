@@ -0,0 +1,234 @@
+/** @file testSpiTrace.c
+ * 	@brief	SPI trace capture and decoder on the mock AFE. The wrappers record one entry per operation while the trace is enabled,
+ * 		the saved capture holds them oldest first, and the script afeSpiTraceDecode makes of it replays exactly the SPI accesses
+ * 		of the traced run. Also checks the counters and the capture once the ring has wrapped.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "baseFunc.h"
+#include "basicFunctions.h"
+#include "init.h"
+#include "spiTrace.h"
+#include "mockDevice.h"
+
+#define TRACE_FILE "testSpiTrace.bin"
+#define SCRIPT_FILE "testSpiTrace.txt"
+#define HEADER_LEN 16
+#define ENTRY_LEN 16
+#define MAX_ACCESSES 256
+
+typedef struct
+{
+    uint8_t write;
+    uint16_t addr;
+    uint8_t value;
+} Access_t;
+
+static Access_t accesses[MAX_ACCESSES];
+static uint32_t numAccesses;
+static Access_t refAccesses[MAX_ACCESSES];
+static uint32_t refNumAccesses;
+static uint8_t refRegs[0x8000];
+static uint8_t capture[HEADER_LEN + ENTRY_LEN * AFE_SPI_TRACE_DEPTH + 1];
+
+static void recordAccess(uint8_t write, uint16_t addr, uint8_t value)
+{
+    if (numAccesses < MAX_ACCESSES)
+    {
+        accesses[numAccesses].write = write;
+        accesses[numAccesses].addr = addr;
+        accesses[numAccesses].value = value;
+    }
+    numAccesses++;
+}
+
+static uint8_t accessRead(uint16_t addr, uint8_t *value)
+{
+    (void)value;
+    recordAccess(0, addr, mockDevice.regs[addr & 0x7fff]);
+    return 0;
+}
+
+static uint8_t accessWrite(uint16_t addr, uint8_t value)
+{
+    recordAccess(1, addr, value);
+    return 0;
+}
+
+static void setup(void)
+{
+    mockDeviceReset();
+    mockDevice.quiet = 1;
+    mockDevice.usPerAccess = 0;
+    mockDevice.waitAdvancesClock = 1;
+    mockDevice.readHook = accessRead;
+    mockDevice.writeHook = accessWrite;
+    numAccesses = 0;
+    for (uint16_t i = 0; i < 0x8000; i++)
+        mockDevice.regs[i] = (uint8_t)(i * 13);
+    afeSpiTraceEnable(0, 0);
+    afeSpiTraceClear(0);
+}
+
+static uint32_t readCapture(const char *file)
+{
+    FILE *fp = fopen(file, "rb");
+    uint32_t len;
+    if (fp == NULL)
+        return 0;
+    len = (uint32_t)fread(capture, 1, sizeof(capture), fp);
+    fclose(fp);
+    return len;
+}
+
+static uint16_t get16(const uint8_t *buf)
+{
+    return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *buf)
+{
+    return get16(buf) | ((uint32_t)get16(buf + 2) << 16);
+}
+
+static uint8_t fileContains(const char *file, const char *text)
+{
+    char line[256];
+    uint8_t found = 0;
+    FILE *fp = fopen(file, "r");
+    if (fp == NULL)
+        return 0;
+    while (!found && fgets(line, sizeof(line), fp) != NULL)
+        found = (strstr(line, text) != NULL);
+    fclose(fp);
+    return found;
+}
+
+/*  Every kind of operation, with a page select around them, a failing check and a gap the decoder turns into a wait.   */
+static void runOperations(void)
+{
+    uint16_t batchAddr[3] = {0x30, 0x31, 0x32};
+    uint8_t batchData[3] = {0x11, 0x22, 0x33};
+    uint8_t value = 0;
+    uint8_t same = 0;
+    uint16_t serdesValue = 0;
+
+    TEST_CHECK(afeSpiWriteWrapper(0, 0x10, 0x01, 0, 7) == RET_OK);
+    TEST_CHECK(afeSpiWriteWrapper(0, 0x20, 0xA5, 0, 7) == RET_OK);
+    TEST_CHECK(afeSpiWriteWrapper(0, 0x21, 0x0C, 2, 3) == RET_OK);
+    TEST_CHECK(afeSpiReadWrapper(0, 0x20, 0, 7, &value) == RET_OK);
+    TEST_CHECK(afeSpiCheckWrapper(0, 0x20, 0, 7, 0xA5, &same) == RET_OK);
+    TEST_CHECK(same == 0);
+    TEST_CHECK(afeSpiCheckWrapper(0, 0x21, 2, 3, 0x00, &same) == RET_OK);
+    TEST_CHECK(same != 0);
+    waitMs(250);
+    TEST_CHECK(afeSpiPollWrapper(0, 0x20, 0xA5, 0, 7) == RET_OK);
+    TEST_CHECK(afeSpiWriteBatchWrapper(0, batchAddr, batchData, 3) == RET_OK);
+    TEST_CHECK(serdesRawWrite(0, 0x1234, 0xBEEF) == RET_OK);
+    TEST_CHECK(serdesRawRead(0, 0x1234, &serdesValue) == RET_OK);
+    TEST_CHECK(serdesValue == 0xBEEF);
+    TEST_CHECK(afeSpiWriteWrapper(0, 0x10, 0x00, 0, 7) == RET_OK);
+}
+
+static void testCaptureAndDecode(void)
+{
+    static const uint8_t expectedOps[] = {AFE_SPI_TRACE_OP_WRITE, AFE_SPI_TRACE_OP_WRITE, AFE_SPI_TRACE_OP_WRITE, AFE_SPI_TRACE_OP_READ,
+                                          AFE_SPI_TRACE_OP_CHECK, AFE_SPI_TRACE_OP_CHECK, AFE_SPI_TRACE_OP_POLL, AFE_SPI_TRACE_OP_WRITE,
+                                          AFE_SPI_TRACE_OP_WRITE, AFE_SPI_TRACE_OP_WRITE, AFE_SPI_TRACE_OP_SERDES_WRITE, AFE_SPI_TRACE_OP_SERDES_READ,
+                                          AFE_SPI_TRACE_OP_WRITE};
+    static const uint16_t expectedAddrs[] = {0x10, 0x20, 0x21, 0x20, 0x20, 0x21, 0x20, 0x30, 0x31, 0x32, 0x1234, 0x1234, 0x10};
+    uint32_t numOps = sizeof(expectedOps) / sizeof(expectedOps[0]);
+    uint32_t recorded = 0, dropped = 0;
+    uint32_t len;
+    uint64_t waitedMs;
+
+    setup();
+    TEST_CHECK(afeSpiTraceEnable(0, 1) == RET_OK);
+    runOperations();
+    TEST_CHECK(afeSpiTraceEnable(0, 0) == RET_OK);
+    /*  Nothing is recorded while the trace is disabled.   */
+    TEST_CHECK(afeSpiWriteWrapper(0, 0x40, 0x01, 0, 7) == RET_OK);
+    numAccesses--;
+    mockDevice.regs[0x40] = (uint8_t)(0x40 * 13);
+    TEST_CHECK(afeSpiTraceGetStats(0, &recorded, &dropped) == RET_OK);
+    TEST_CHECK(recorded == numOps);
+    TEST_CHECK(dropped == 0);
+    TEST_CHECK(numAccesses <= MAX_ACCESSES);
+    memcpy(refAccesses, accesses, sizeof(accesses));
+    refNumAccesses = numAccesses;
+    memcpy(refRegs, mockDevice.regs, sizeof(refRegs));
+    waitedMs = mockDevice.waitedMs;
+
+    TEST_CHECK(afeSpiTraceSave(0, TRACE_FILE) == RET_OK);
+    len = readCapture(TRACE_FILE);
+    TEST_CHECK(len == HEADER_LEN + ENTRY_LEN * numOps);
+    TEST_CHECK(memcmp(capture, "AFET", 4) == 0);
+    TEST_CHECK(get32(capture + 8) == numOps);
+    TEST_CHECK(get32(capture + 12) == 0);
+    for (uint32_t i = 0; (i < numOps) && (HEADER_LEN + ENTRY_LEN * (i + 1) <= len); i++)
+    {
+        const uint8_t *entry = capture + HEADER_LEN + ENTRY_LEN * i;
+        TEST_CHECK(entry[9] == expectedOps[i]);
+        TEST_CHECK(get16(entry + 4) == expectedAddrs[i]);
+        TEST_CHECK(entry[8] == 0);
+        TEST_CHECK((entry[12] & ~AFE_SPI_TRACE_RESULT_MISMATCH) == RET_OK);
+        TEST_CHECK(((entry[12] & AFE_SPI_TRACE_RESULT_MISMATCH) != 0) == (i == 5));
+    }
+    /*  The check keeps the expected value in the low byte and the read one in the high byte.   */
+    TEST_CHECK(get16(capture + HEADER_LEN + ENTRY_LEN * 5 + 6) == 0xAD00);
+
+    TEST_CHECK(afeSpiTraceDecode(TRACE_FILE, SCRIPT_FILE, 1000) == RET_OK);
+    TEST_CHECK(fileContains(SCRIPT_FILE, "// pages: 0x0010=0x01"));
+    TEST_CHECK(fileContains(SCRIPT_FILE, "wait 0.250"));
+    TEST_CHECK(fileContains(SCRIPT_FILE, "// read 0xad, mismatch"));
+
+    /*  The replay fails the same check and makes the same accesses.   */
+    setup();
+    TEST_CHECK(configAfeFromFile(0, 0, SCRIPT_FILE, 1, 0) == RET_EXEC_FAIL);
+    TEST_CHECK(numAccesses == refNumAccesses);
+    TEST_CHECK(memcmp(accesses, refAccesses, refNumAccesses * sizeof(Access_t)) == 0);
+    TEST_CHECK(memcmp(mockDevice.regs, refRegs, sizeof(refRegs)) == 0);
+    TEST_CHECK(mockDevice.waitedMs == waitedMs);
+}
+
+/*  Once the ring has wrapped, the capture holds the newest AFE_SPI_TRACE_DEPTH entries and counts the others as dropped.   */
+static void testWrap(void)
+{
+    uint32_t total = AFE_SPI_TRACE_DEPTH + 300;
+    uint32_t recorded = 0, dropped = 0;
+
+    setup();
+    TEST_CHECK(afeSpiTraceEnable(0, 1) == RET_OK);
+    for (uint32_t i = 0; i < total; i++)
+        afeSpiWriteWrapper(0, (uint16_t)(0x100 + i), (uint8_t)i, 0, 7);
+    TEST_CHECK(afeSpiTraceGetStats(0, &recorded, &dropped) == RET_OK);
+    TEST_CHECK(recorded == total);
+    TEST_CHECK(dropped == total - AFE_SPI_TRACE_DEPTH);
+    TEST_CHECK(afeSpiTraceSave(0, TRACE_FILE) == RET_OK);
+    TEST_CHECK(readCapture(TRACE_FILE) == HEADER_LEN + ENTRY_LEN * AFE_SPI_TRACE_DEPTH);
+    TEST_CHECK(get32(capture + 8) == AFE_SPI_TRACE_DEPTH);
+    TEST_CHECK(get32(capture + 12) == total - AFE_SPI_TRACE_DEPTH);
+    for (uint32_t i = 0; i < AFE_SPI_TRACE_DEPTH; i++)
+        TEST_CHECK(get16(capture + HEADER_LEN + ENTRY_LEN * i + 4) == 0x100 + total - AFE_SPI_TRACE_DEPTH + i);
+
+    TEST_CHECK(afeSpiTraceClear(0) == RET_OK);
+    TEST_CHECK(afeSpiTraceGetStats(0, &recorded, &dropped) == RET_OK);
+    TEST_CHECK((recorded == 0) && (dropped == 0));
+    TEST_CHECK(afeSpiTraceEnable(0, 0) == RET_OK);
+
+    /*  A capture that is not a trace is rejected.   */
+    TEST_CHECK(afeSpiTraceDecode(SCRIPT_FILE, TRACE_FILE, 0) == RET_EXEC_FAIL);
+}
+
+int main(void)
+{
+    testCaptureAndDecode();
+    testWrap();
+    printf("testSpiTrace: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,103 @@
+/** @file testSpiTransactionCount.c
+ * 	@brief	Checks that afeSpiGetTransactionCount counts the transactions of the driver calls that completed, and none of a call that failed,
+ * 		for single accesses, batches and bursts. A failed call also makes the library forget what it knows of the device.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "basicFunctions.h"
+#include "mockDevice.h"
+
+#define BLOCK_ADDR 0x0100
+#define BLOCK_LEN 8
+
+static uint32_t transactionCount(void)
+{
+    uint32_t count = 0;
+    TEST_CHECK(afeSpiGetTransactionCount(0, &count, 0) == RET_OK);
+    return count;
+}
+
+static void setup(void)
+{
+    uint32_t count = 0;
+    mockDeviceReset();
+    mockDevice.quiet = 1;
+    afeSpiBurstEnable(0, 0);
+    afeSpiGetTransactionCount(0, &count, 1);
+}
+
+static void testSingle(void)
+{
+    uint8_t value = 0;
+    uint32_t epoch;
+
+    setup();
+    TEST_CHECK(afeSpiWriteWrapper(0, BLOCK_ADDR, 0x12, 0, 7) == RET_OK);
+    TEST_CHECK(transactionCount() == 1);
+    epoch = afeGetDeviceStateEpoch(0);
+    mockDevice.failTransaction = mockDevice.transactions + 1;
+    TEST_CHECK(afeSpiWriteWrapper(0, BLOCK_ADDR, 0x34, 0, 7) == RET_EXEC_FAIL);
+    TEST_CHECK(transactionCount() == 1);
+    TEST_CHECK(afeGetDeviceStateEpoch(0) != epoch);
+    mockDevice.failTransaction = mockDevice.transactions + 1;
+    TEST_CHECK(afeSpiReadWrapper(0, BLOCK_ADDR, 0, 7, &value) == RET_EXEC_FAIL);
+    TEST_CHECK(transactionCount() == 1);
+    TEST_CHECK(afeSpiReadWrapper(0, BLOCK_ADDR, 0, 7, &value) == RET_OK);
+    TEST_CHECK(value == 0x12);
+    TEST_CHECK(transactionCount() == 2);
+}
+
+/*  The driver does not say how much of a failed batch was sent, so the batch counts nothing.   */
+static void testBatch(void)
+{
+    uint16_t addr[BLOCK_LEN];
+    uint8_t data[BLOCK_LEN];
+
+    setup();
+    for (uint8_t i = 0; i < BLOCK_LEN; i++)
+    {
+        addr[i] = BLOCK_ADDR + i;
+        data[i] = i;
+    }
+    TEST_CHECK(afeSpiWriteBatchWrapper(0, addr, data, BLOCK_LEN) == RET_OK);
+    TEST_CHECK(transactionCount() == BLOCK_LEN);
+    mockDevice.failTransaction = mockDevice.transactions + 1;
+    TEST_CHECK(afeSpiWriteBatchWrapper(0, addr, data, BLOCK_LEN) == RET_EXEC_FAIL);
+    TEST_CHECK(transactionCount() == BLOCK_LEN);
+}
+
+static void testBurst(void)
+{
+    uint8_t data[BLOCK_LEN] = {0};
+
+    setup();
+    /*  Without bursts, the reads before the failing one are counted.   */
+    mockDevice.failTransaction = 4;
+    TEST_CHECK(afeSpiBurstReadWrapper(0, BLOCK_ADDR, data, BLOCK_LEN) == RET_EXEC_FAIL);
+    TEST_CHECK(transactionCount() == 3);
+
+    setup();
+    TEST_CHECK(afeSpiBurstEnable(0, 1) == RET_OK);
+    TEST_CHECK(afeSpiBurstWriteWrapper(0, BLOCK_ADDR, data, BLOCK_LEN) == RET_OK);
+    TEST_CHECK(afeSpiBurstReadWrapper(0, BLOCK_ADDR, data, BLOCK_LEN) == RET_OK);
+    TEST_CHECK(transactionCount() == 2);
+    mockDevice.failTransaction = mockDevice.transactions + 1;
+    TEST_CHECK(afeSpiBurstWriteWrapper(0, BLOCK_ADDR, data, BLOCK_LEN) == RET_EXEC_FAIL);
+    mockDevice.failTransaction = mockDevice.transactions + 1;
+    TEST_CHECK(afeSpiBurstReadWrapper(0, BLOCK_ADDR, data, BLOCK_LEN) == RET_EXEC_FAIL);
+    TEST_CHECK(transactionCount() == 2);
+    afeSpiBurstEnable(0, 0);
+}
+
+int main(void)
+{
+    testSingle();
+    testBatch();
+    testBurst();
+    printf("testSpiTransactionCount: %d failures\n", testFailures);
+    return testFailures != 0;
+}
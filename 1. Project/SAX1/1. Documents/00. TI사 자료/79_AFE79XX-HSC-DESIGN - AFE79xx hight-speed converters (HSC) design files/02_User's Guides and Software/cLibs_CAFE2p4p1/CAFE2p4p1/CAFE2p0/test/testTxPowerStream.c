@@ -0,0 +1,79 @@
+/** @file testTxPowerStream.c
+ * 	@brief	Runs the TX power stream with the reader in a second thread. Every sample must come out once, in order and complete, and the captured count must match what was read and dropped.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "controls.h"
+#include "mockDevice.h"
+
+#define NUM_SAMPLE_CALLS 5000
+
+static int producerDone = 0;
+static uint32_t samplesRead = 0;
+static uint32_t orderErrors = 0;
+
+static void *streamReader(void *arg)
+{
+    AfeTxPowerSample_t samples[16];
+    uint32_t lastTimeUs[AFE_NUM_TX_CHANNELS] = {0};
+    uint16_t numSamples;
+    int lastPass = 0;
+
+    (void)arg;
+    while (!lastPass)
+    {
+        /*  One more pass after the producer stops, for what it wrote last.   */
+        lastPass = __atomic_load_n(&producerDone, __ATOMIC_ACQUIRE);
+        do
+        {
+            afeTxPowerStreamRead(0, samples, 16, &numSamples);
+            for (uint16_t i = 0; i < numSamples; i++)
+            {
+                if ((samples[i].chNo >= AFE_NUM_TX_CHANNELS) || (samples[i].timeUs <= lastTimeUs[samples[i].chNo]))
+                    orderErrors++;
+                else
+                    lastTimeUs[samples[i].chNo] = samples[i].timeUs;
+            }
+            samplesRead += numSamples;
+        } while (numSamples != 0);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t reader;
+    uint32_t captured, dropped;
+    uint8_t txChList;
+
+    mockDeviceReset();
+    /*  Every sample gets a later time stamp than the one before.   */
+    mockDevice.usPerAccess = 1;
+    TEST_CHECK(afeTxPowerStreamStart(0, 0x5, 0) == RET_OK);
+    TEST_CHECK(pthread_create(&reader, NULL, streamReader, NULL) == 0);
+    for (uint32_t n = 0; n < NUM_SAMPLE_CALLS; n++)
+    {
+        TEST_CHECK(afeTxPowerStreamSample(0) == RET_OK);
+        /*  Lets the reader in often enough to catch up with the ring.   */
+        if ((n & 0x3f) == 0)
+            sched_yield();
+    }
+    __atomic_store_n(&producerDone, 1, __ATOMIC_RELEASE);
+    pthread_join(reader, NULL);
+    TEST_CHECK(afeTxPowerStreamGetStats(0, &captured, &dropped, &txChList) == RET_OK);
+    TEST_CHECK(afeTxPowerStreamStop(0) == RET_OK);
+
+    TEST_CHECK(orderErrors == 0);
+    TEST_CHECK(txChList == 0x5);
+    TEST_CHECK(captured + dropped == 2 * NUM_SAMPLE_CALLS);
+    TEST_CHECK(samplesRead == captured);
+    printf("TX power stream, 2 channels: %u samples read, %u dropped\n", samplesRead, dropped);
+    printf("testTxPowerStream: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -9,6 +9,48 @@
 
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof(arr[0]))
 
+/// Maximum number of writes collected on the stack before a batch is handed to dev_spi_write_batch.
+#define AFE_SPI_BATCH_MAX_LEN 256
+
+/// Number of registers held by the shadow register cache of each AFE. The cache is direct mapped on the SPI address.
+#define AFE_SHADOW_CACHE_SIZE 256
+/// Maximum number of non-volatile register ranges per AFE for the shadow register cache.
+#define AFE_SHADOW_CACHE_MAX_RANGES 16
+
+/// Number of entries in the SPI trace ring of each AFE (spiTrace.c). Should be a power of 2, each entry takes 16 bytes.
+#define AFE_SPI_TRACE_DEPTH 1024
+
+/// Number of different macro opcodes whose latency is kept per AFE (afeMacroGetLatencyStats).
+#define AFE_MACRO_LATENCY_MAX_OPCODES 32
+/// Number of latency histogram bins. Bin n counts the macros that took from 2^n to 2^(n+1) micro seconds, the last bin everything longer.
+#define AFE_MACRO_LATENCY_BINS 20
+/// Number of macros that can be submitted with macroSubmit and not yet collected with macroWait or macroPoll, per AFE.
+#define AFE_MACRO_QUEUE_DEPTH 4
+
+/// Number of frequencies held by the NCO hop table of each AFE (afeNcoHopTableAddTx, afeNcoHopTableAddRx and afeNcoHopTableAddFb).
+#define AFE_NCO_HOP_MAX_ENTRIES 32
+/// Number of hop latencies kept per AFE for afeNcoHopGetLatency. The oldest ones are overwritten.
+#define AFE_NCO_HOP_LATENCY_SAMPLES 256
+
+/// Number of checks run by each afeHealthMonitorTick until afeHealthMonitorConfig is called.
+#define AFE_HEALTH_CHECKS_PER_TICK 2
+
+/// Number of samples held by the TX power stream of each AFE (afeTxPowerStreamSample). Should be a power of 2.
+#define AFE_TX_POWER_STREAM_DEPTH 256
+
+/** Loads and stores of the counters of the rings shared by a producer and a consumer thread, the TX power stream (controls.c) and the SPI trace (spiTrace.c).
+ *  The acquire load sees everything written before the matching release store. The __atomic builtins also build with -std=c99, stdatomic.h would need C11.*/
+#if defined(__GNUC__) || defined(__clang__)
+#define AFE_RING_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define AFE_RING_STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define AFE_RING_LOAD_ACQUIRE(ptr) ((uint32_t)_InterlockedCompareExchange((volatile long *)(ptr), 0, 0))
+#define AFE_RING_STORE_RELEASE(ptr, value) ((void)_InterlockedExchange((volatile long *)(ptr), (long)(value)))
+#else
+#error Define AFE_RING_LOAD_ACQUIRE and AFE_RING_STORE_RELEASE for this compiler.
+#endif
+
 /// This C Macro has the operation on what to do when the input parameters to AFE function are invalid. It is not recommended to change its contents.
 #define AFE_PARAMS_VALID(args)                                           \
     if (!(args))                                                         \
@@ -0,0 +1,12 @@
+#ifndef _AFE_MULTI_EXEC_H
+#define _AFE_MULTI_EXEC_H
+
+#include <stdint.h>
+
+typedef uint8_t (*afeMultiExecFunc_t)(uint8_t afeId, void *ctx);
+
+uint8_t afeMultiExecRun(uint32_t afeMask, afeMultiExecFunc_t func, void *ctx, uint8_t *results);
+uint8_t afeMultiExecBarrier(uint8_t afeId, afeMultiExecFunc_t leaderFunc, void *ctx);
+uint8_t afeMultiConfigFromFile(uint32_t afeMask, uint8_t logFormat, char **files, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint8_t *results);
+uint8_t afeMultiConfigFromBinary(uint32_t afeMask, char **files, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint8_t *results);
+#endif
@@ -0,0 +1,10 @@
+#ifndef _AFE_TIMER_H
+#define _AFE_TIMER_H
+
+#include <stdint.h>
+
+uint64_t afeTimerNowNs(void);
+uint64_t afeTimerCpuNs(void);
+void afeTimerWaitNs(uint64_t wait_ns);
+void afeTimerReleaseThread(void);
+#endif
@@ -0,0 +1,333 @@
+/** @file afeMultiExec.c
+ * 	@brief	Runs a bring-up script or calibration on several AFEs at the same time, one host thread per AFE.<br>
+ * 		The library keeps its state per afeId, so AFEs can run in parallel when each one has its own transport, opened
+ * 		with ftdi_openDevice(afeId, ...). The interface only locks single SPI calls, so the page selects and writes of two
+ * 		AFEs on one transport would interleave. Runs with AFEs that share a transport are refused. Steps that must be
+ * 		aligned across devices, like sendSysref or adcDacSync, are fenced with afeMultiExecBarrier.
+*/
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+#include <windows.h>
+#else
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <pthread.h>
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "afe79xxTypes.h"
+#include "afe79xxLog.h"
+#include "afeCommonMacros.h"
+#include "baseFunc.h"
+#include "init.h"
+#include "afeTimer.h"
+#include "interface.h"
+#include "afeMultiExec.h"
+
+#ifdef _WIN32
+typedef HANDLE afeMultiThread_t;
+/* Statically initialized like the pthread objects, so there is no first-use initialization to race on. */
+static SRWLOCK afeMultiLock = SRWLOCK_INIT;
+static CONDITION_VARIABLE afeMultiCond = CONDITION_VARIABLE_INIT;
+#define AFE_MULTI_LOCK() AcquireSRWLockExclusive(&afeMultiLock)
+#define AFE_MULTI_UNLOCK() ReleaseSRWLockExclusive(&afeMultiLock)
+#define AFE_MULTI_WAIT() SleepConditionVariableSRW(&afeMultiCond, &afeMultiLock, INFINITE, 0)
+#define AFE_MULTI_WAKE_ALL() WakeAllConditionVariable(&afeMultiCond)
+#else
+typedef pthread_t afeMultiThread_t;
+static pthread_mutex_t afeMultiLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t afeMultiCond = PTHREAD_COND_INITIALIZER;
+#define AFE_MULTI_LOCK() pthread_mutex_lock(&afeMultiLock)
+#define AFE_MULTI_UNLOCK() pthread_mutex_unlock(&afeMultiLock)
+#define AFE_MULTI_WAIT() pthread_cond_wait(&afeMultiCond, &afeMultiLock)
+#define AFE_MULTI_WAKE_ALL() pthread_cond_broadcast(&afeMultiCond)
+#endif
+
+/* State of the run in progress. Everything below func and ctx is protected by afeMultiLock. */
+static struct
+{
+    afeMultiExecFunc_t func;
+    void *ctx;
+    uint8_t running;
+    uint32_t afeMask;
+    uint8_t participants;
+    uint8_t arrived;
+    uint8_t exited;
+    uint8_t failedExits;
+    uint32_t generation;
+    uint8_t barrierStatus;
+    afeMultiExecFunc_t leaderFunc;
+    void *leaderCtx;
+    uint8_t leaderAfeId;
+    uint8_t results[NUM_OF_AFE];
+} afeMulti;
+
+static uint8_t afeMultiIds[NUM_OF_AFE];
+
+/* Completes the barrier once every AFE has arrived or finished and lets the waiting threads go. Called with the
+   lock held. */
+static void afeMultiReleaseBarrier(void)
+{
+    uint8_t status = (afeMulti.failedExits == 0) ? RET_OK : RET_EXEC_FAIL;
+    if (status == RET_OK && afeMulti.leaderFunc != NULL)
+        status = afeMulti.leaderFunc(afeMulti.leaderAfeId, afeMulti.leaderCtx);
+    afeMulti.barrierStatus = status;
+    afeMulti.arrived = 0;
+    afeMulti.generation++;
+    AFE_MULTI_WAKE_ALL();
+}
+
+static void afeMultiWorker(uint8_t afeId)
+{
+    uint8_t ret = afeMulti.func(afeId, afeMulti.ctx);
+    afeTimerReleaseThread();
+
+    AFE_MULTI_LOCK();
+    afeMulti.results[afeId] = ret;
+    afeMulti.exited++;
+    if (ret != RET_OK)
+        afeMulti.failedExits++;
+    /* A finished AFE isn't waited for. If it failed, the barrier fails for the others. */
+    if (afeMulti.arrived > 0 && afeMulti.arrived + afeMulti.exited == afeMulti.participants)
+        afeMultiReleaseBarrier();
+    AFE_MULTI_UNLOCK();
+}
+
+#ifdef _WIN32
+static DWORD WINAPI afeMultiThreadProc(LPVOID arg)
+{
+    afeMultiWorker(*(uint8_t *)arg);
+    return 0;
+}
+
+static uint8_t afeMultiStartThread(afeMultiThread_t *thread, uint8_t *afeId)
+{
+    *thread = CreateThread(NULL, 0, afeMultiThreadProc, afeId, 0, NULL);
+    return (*thread != NULL) ? RET_OK : RET_EXEC_FAIL;
+}
+
+static void afeMultiJoinThread(afeMultiThread_t thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+static void *afeMultiThreadProc(void *arg)
+{
+    afeMultiWorker(*(uint8_t *)arg);
+    return NULL;
+}
+
+static uint8_t afeMultiStartThread(afeMultiThread_t *thread, uint8_t *afeId)
+{
+    return (pthread_create(thread, NULL, afeMultiThreadProc, afeId) == 0) ? RET_OK : RET_EXEC_FAIL;
+}
+
+static void afeMultiJoinThread(afeMultiThread_t thread)
+{
+    pthread_join(thread, NULL);
+}
+#endif
+
+/**
+    @brief Runs a Function on Several AFEs in Parallel
+    @details Calls func(afeId, ctx) for every AFE in afeMask, each on its own thread, and waits until all of them have returned. The failures are collected per AFE, one failing AFE doesn't stop the others.<br>
+        Only one run can be active at a time. func may call afeMultiExecBarrier to line up with the other AFEs of the run.<br>
+        Every AFE of the run must have its own transport, see ftdi_getDeviceTransport. AFEs without one would share device 0, the run is then refused.
+    @param afeMask Bit n set runs AFE n. Only AFE IDs below NUM_OF_AFE are allowed.
+    @param func Function to run for each AFE.
+    @param ctx Passed to func unchanged.
+    @param results Array of NUM_OF_AFE entries returning the result of each AFE. Entries of AFEs not in afeMask are set to RET_OK. Can be NULL.
+    @return Returns RET_OK if func passed for all the AFEs.
+*/
+uint8_t afeMultiExecRun(uint32_t afeMask, afeMultiExecFunc_t func, void *ctx, uint8_t *results)
+{
+    uint8_t errorStatus = 0;
+    afeMultiThread_t threads[NUM_OF_AFE];
+    uint8_t started[NUM_OF_AFE] = {0};
+    int transports[NUM_OF_AFE];
+
+    AFE_PARAMS_VALID((func != NULL) && (afeMask != 0) && ((afeMask >> NUM_OF_AFE) == 0));
+    for (uint8_t afeId = 0; afeId < NUM_OF_AFE; afeId++)
+    {
+        if (!(afeMask & (1u << afeId)))
+            continue;
+        transports[afeId] = ftdi_getDeviceTransport(afeId);
+        for (uint8_t otherId = 0; otherId < afeId; otherId++)
+        {
+            if ((afeMask & (1u << otherId)) && (transports[otherId] == transports[afeId]))
+            {
+                afeLogErr("AFE %d and AFE %d share the transport of device %d, open one per AFE with ftdi_openDevice.", otherId, afeId, transports[afeId]);
+                return RET_EXEC_FAIL;
+            }
+        }
+    }
+    AFE_MULTI_LOCK();
+    if (afeMulti.running)
+    {
+        AFE_MULTI_UNLOCK();
+        afeLogErr("%s", "Another multi AFE run is in progress.");
+        return RET_EXEC_FAIL;
+    }
+    memset(&afeMulti, 0, sizeof(afeMulti));
+    afeMulti.func = func;
+    afeMulti.ctx = ctx;
+    afeMulti.running = 1;
+    afeMulti.afeMask = afeMask;
+    for (uint8_t afeId = 0; afeId < NUM_OF_AFE; afeId++)
+    {
+        if (afeMask & (1u << afeId))
+            afeMulti.participants++;
+    }
+    AFE_MULTI_UNLOCK();
+
+    for (uint8_t afeId = 0; afeId < NUM_OF_AFE; afeId++)
+    {
+        if (!(afeMask & (1u << afeId)))
+            continue;
+        afeMultiIds[afeId] = afeId;
+        started[afeId] = (afeMultiStartThread(&threads[afeId], &afeMultiIds[afeId]) == RET_OK);
+        if (!started[afeId])
+        {
+            afeLogErr("Could not start the thread of AFE %d.", afeId);
+            AFE_MULTI_LOCK();
+            afeMulti.results[afeId] = RET_EXEC_FAIL;
+            afeMulti.exited++;
+            afeMulti.failedExits++;
+            if (afeMulti.arrived > 0 && afeMulti.arrived + afeMulti.exited == afeMulti.participants)
+                afeMultiReleaseBarrier();
+            AFE_MULTI_UNLOCK();
+        }
+    }
+    for (uint8_t afeId = 0; afeId < NUM_OF_AFE; afeId++)
+    {
+        if (started[afeId])
+            afeMultiJoinThread(threads[afeId]);
+    }
+
+    AFE_MULTI_LOCK();
+    afeMulti.running = 0;
+    AFE_MULTI_UNLOCK();
+    for (uint8_t afeId = 0; afeId < NUM_OF_AFE; afeId++)
+    {
+        if (afeMulti.results[afeId] != RET_OK)
+        {
+            afeLogErr("AFE %d failed in the multi AFE run.", afeId);
+            errorStatus |= 1;
+        }
+        if (results != NULL)
+            results[afeId] = afeMulti.results[afeId];
+    }
+    if (errorStatus)
+        return RET_EXEC_FAIL;
+    else
+        return RET_OK;
+}
+
+/**
+    @brief Lines up the AFEs of a Multi AFE Run
+    @details Called by func of afeMultiExecRun. Blocks until every AFE of the run has reached the barrier, then leaderFunc is called once while all of them still wait. Use it before steps that must happen together on all devices, for example to give one board level sysref pulse after every AFE has armed for it.<br>
+        AFEs whose func has already returned are not waited for. If one of them failed, the barrier fails for everyone and leaderFunc is not called. All the AFEs should pass the same leaderFunc and ctx.
+    @param afeId AFE ID of the calling thread.
+    @param leaderFunc Called once when all the AFEs have arrived, with the afeId of the last one to arrive. Can be NULL.
+    @param ctx Passed to leaderFunc unchanged.
+    @return Returns RET_OK if all the AFEs arrived and leaderFunc passed.
+*/
+uint8_t afeMultiExecBarrier(uint8_t afeId, afeMultiExecFunc_t leaderFunc, void *ctx)
+{
+    uint8_t status;
+    uint32_t generation;
+
+    AFE_ID_VALIDITY();
+    AFE_MULTI_LOCK();
+    if (!afeMulti.running || !(afeMulti.afeMask & (1u << afeId)))
+    {
+        AFE_MULTI_UNLOCK();
+        afeLogErr("AFE %d is not part of a multi AFE run.", afeId);
+        return RET_EXEC_FAIL;
+    }
+    generation = afeMulti.generation;
+    afeMulti.arrived++;
+    afeMulti.leaderFunc = leaderFunc;
+    afeMulti.leaderCtx = ctx;
+    afeMulti.leaderAfeId = afeId;
+    if (afeMulti.arrived + afeMulti.exited == afeMulti.participants)
+        afeMultiReleaseBarrier();
+    else
+    {
+        while (generation == afeMulti.generation)
+            AFE_MULTI_WAIT();
+    }
+    status = afeMulti.barrierStatus;
+    AFE_MULTI_UNLOCK();
+    return status;
+}
+
+/* Arguments of the configAfeFromFile and configAfeFromBinary runs. */
+typedef struct
+{
+    uint8_t logFormat;
+    char **files;
+    uint8_t breakAtPollFail;
+    uint8_t breakAtReadCheckFail;
+} afeMultiConfigArgs_t;
+
+static uint8_t afeMultiConfigFromFileFunc(uint8_t afeId, void *ctx)
+{
+    afeMultiConfigArgs_t *args = (afeMultiConfigArgs_t *)ctx;
+    return (configAfeFromFile(afeId, args->logFormat, args->files[afeId], args->breakAtPollFail, args->breakAtReadCheckFail) == RET_OK) ? RET_OK : RET_EXEC_FAIL;
+}
+
+static uint8_t afeMultiConfigFromBinaryFunc(uint8_t afeId, void *ctx)
+{
+    afeMultiConfigArgs_t *args = (afeMultiConfigArgs_t *)ctx;
+    return (configAfeFromBinary(afeId, args->files[afeId], args->breakAtPollFail, args->breakAtReadCheckFail, NULL, NULL) == RET_OK) ? RET_OK : RET_EXEC_FAIL;
+}
+
+/**
+    @brief Parallel Bringup from Log Files
+    @details Runs configAfeFromFile for every AFE in afeMask at the same time.
+    @param afeMask Bit n set configures AFE n.
+    @param logFormat Choose the format between 0 and 5.
+    @param files Array of NUM_OF_AFE log file paths as generated by Latte, indexed by afeId.
+    @param breakAtPollFail If this is 0, then configuration will continue when some poll fails. If it is 1, configuration will stop when some poll fails.
+    @param breakAtReadCheckFail If this is 0, then configuration will continue when some SPI Read Check fails. If it is 1, configuration will stop when some SPI Read Checks fails.
+    @param results Array of NUM_OF_AFE entries returning the result of each AFE. Can be NULL.
+    @return Returns RET_OK if all the AFEs were configured.
+*/
+uint8_t afeMultiConfigFromFile(uint32_t afeMask, uint8_t logFormat, char **files, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint8_t *results)
+{
+    afeMultiConfigArgs_t args;
+    AFE_PARAMS_VALID(files != NULL);
+    args.logFormat = logFormat;
+    args.files = files;
+    args.breakAtPollFail = breakAtPollFail;
+    args.breakAtReadCheckFail = breakAtReadCheckFail;
+    return afeMultiExecRun(afeMask, afeMultiConfigFromFileFunc, &args, results);
+}
+
+/**
+    @brief Parallel Bringup from Compiled Scripts
+    @details Runs configAfeFromBinary for every AFE in afeMask at the same time.
+    @param afeMask Bit n set configures AFE n.
+    @param files Array of NUM_OF_AFE compiled script paths, indexed by afeId.
+    @param breakAtPollFail If this is 0, then configuration will continue when some poll fails. If it is 1, configuration will stop when some poll fails.
+    @param breakAtReadCheckFail If this is 0, then configuration will continue when some SPI Read Check fails. If it is 1, configuration will stop when some SPI Read Checks fails.
+    @param results Array of NUM_OF_AFE entries returning the result of each AFE. Can be NULL.
+    @return Returns RET_OK if all the AFEs were configured.
+*/
+uint8_t afeMultiConfigFromBinary(uint32_t afeMask, char **files, uint8_t breakAtPollFail, uint8_t breakAtReadCheckFail, uint8_t *results)
+{
+    afeMultiConfigArgs_t args;
+    AFE_PARAMS_VALID(files != NULL);
+    args.logFormat = 0;
+    args.files = files;
+    args.breakAtPollFail = breakAtPollFail;
+    args.breakAtReadCheckFail = breakAtReadCheckFail;
+    return afeMultiExecRun(afeMask, afeMultiConfigFromBinaryFunc, &args, results);
+}
@@ -0,0 +1,169 @@
+/** @file afeTimer.c
+ * 	@brief	Wall clock waits for the host. waitMs and wait in baseFunc.c use these.<br>
+ * 		A wait sleeps on the OS timer until it is close to the deadline and spins on the monotonic clock for the rest.
+ * 		The spin margin follows the wake-up latency seen on the previous sleeps, so short waits stay accurate without
+ * 		burning a core during long polls.
+*/
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+/* clock_nanosleep and CLOCK_MONOTONIC are POSIX, the Linaro build uses -std=c99. */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <time.h>
+#include <errno.h>
+#endif
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afe79xxLog.h"
+#include "afeCommonMacros.h"
+#include "baseFunc.h"
+#include "afeTimer.h"
+
+#define AFE_TIMER_NS_PER_SEC 1000000000ULL
+/* Waits up to this long are spun completely, a sleep can't be that short. */
+#define AFE_TIMER_SPIN_ONLY_NS 100000ULL
+#define AFE_TIMER_SPIN_MIN_NS 50000ULL
+#define AFE_TIMER_SPIN_MAX_NS 2000000ULL
+#ifdef _WIN32
+#define AFE_TIMER_LATENCY_START_NS 500000ULL
+#else
+#define AFE_TIMER_LATENCY_START_NS 100000ULL
+#endif
+
+/* Waits run on the threads of afeMultiExecRun too, so the timer state is per thread. */
+#if defined(_MSC_VER)
+#define AFE_TIMER_THREAD_LOCAL __declspec(thread)
+#else
+#define AFE_TIMER_THREAD_LOCAL __thread
+#endif
+
+/* Running average of how late the OS wakes us up. */
+static AFE_TIMER_THREAD_LOCAL uint64_t afeTimerLatencyNs = AFE_TIMER_LATENCY_START_NS;
+#ifdef _WIN32
+static AFE_TIMER_THREAD_LOCAL HANDLE afeTimerHandle = NULL;
+#endif
+
+/**
+    @brief Monotonic Clock
+    @details Returns a monotonic wall clock in nanoseconds. It doesn't jump with system time changes.
+    @return Time in nanoseconds from an arbitrary start point.
+*/
+uint64_t afeTimerNowNs(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * AFE_TIMER_NS_PER_SEC + (uint64_t)(now.QuadPart % freq.QuadPart) * AFE_TIMER_NS_PER_SEC / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * AFE_TIMER_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+    @brief Process CPU Time
+    @details Returns the CPU time used by the process in nanoseconds, user and kernel.
+    @return CPU time in nanoseconds.
+*/
+uint64_t afeTimerCpuNs(void)
+{
+#ifdef _WIN32
+    FILETIME createTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &createTime, &exitTime, &kernelTime, &userTime))
+        return 0;
+    return ((((uint64_t)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime) + (((uint64_t)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime)) * 100;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * AFE_TIMER_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void afeTimerSleepUntilNs(uint64_t deadline)
+{
+#ifdef _WIN32
+    LARGE_INTEGER due;
+    uint64_t now = afeTimerNowNs();
+    if (deadline <= now)
+        return;
+    if (afeTimerHandle == NULL)
+    {
+        afeTimerHandle = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        /* High resolution timers need Windows 10 1803 or later. */
+        if (afeTimerHandle == NULL)
+            afeTimerHandle = CreateWaitableTimerW(NULL, TRUE, NULL);
+    }
+    /* Relative due time in 100 ns units. */
+    due.QuadPart = -(LONGLONG)((deadline - now) / 100);
+    if ((afeTimerHandle != NULL) && SetWaitableTimer(afeTimerHandle, &due, 0, NULL, NULL, FALSE))
+        WaitForSingleObject(afeTimerHandle, INFINITE);
+    else
+        Sleep((DWORD)((deadline - now) / 1000000));
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline / AFE_TIMER_NS_PER_SEC);
+    ts.tv_nsec = (long)(deadline % AFE_TIMER_NS_PER_SEC);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+    }
+#endif
+}
+
+/**
+    @brief Releases the Timer of the Calling Thread
+    @details Frees the OS timer a thread created for its waits. Threads that end, like the workers of afeMultiExecRun, should call it before returning.
+*/
+void afeTimerReleaseThread(void)
+{
+#ifdef _WIN32
+    if (afeTimerHandle != NULL)
+    {
+        CloseHandle(afeTimerHandle);
+        afeTimerHandle = NULL;
+    }
+#endif
+}
+
+/**
+    @brief Wait in nano Seconds
+    @details Waits for wait_ns of wall time. Sleeps until the spin margin before the deadline and spins for the rest.
+        The margin is twice the average wake-up latency of the previous sleeps, but at most half the wait, so long polls mostly sleep.
+    @param wait_ns Wait time in nano seconds.
+*/
+void afeTimerWaitNs(uint64_t wait_ns)
+{
+    uint64_t deadline = afeTimerNowNs() + wait_ns;
+    if (wait_ns > AFE_TIMER_SPIN_ONLY_NS)
+    {
+        uint64_t spinNs = 2 * afeTimerLatencyNs;
+        uint64_t wakeTarget;
+        uint64_t now;
+        if (spinNs < AFE_TIMER_SPIN_MIN_NS)
+            spinNs = AFE_TIMER_SPIN_MIN_NS;
+        if (spinNs > AFE_TIMER_SPIN_MAX_NS)
+            spinNs = AFE_TIMER_SPIN_MAX_NS;
+        if (spinNs > wait_ns / 2)
+            spinNs = wait_ns / 2;
+        wakeTarget = deadline - spinNs;
+        afeTimerSleepUntilNs(wakeTarget);
+        now = afeTimerNowNs();
+        afeTimerLatencyNs = (7 * afeTimerLatencyNs + ((now > wakeTarget) ? (now - wakeTarget) : 0)) / 8;
+    }
+    while (afeTimerNowNs() < deadline)
+    {
+    }
+}
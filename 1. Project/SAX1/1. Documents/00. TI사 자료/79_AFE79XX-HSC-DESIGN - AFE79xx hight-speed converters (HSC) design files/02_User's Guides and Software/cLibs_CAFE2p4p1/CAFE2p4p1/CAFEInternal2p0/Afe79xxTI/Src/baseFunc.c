@@ -9,7 +9,6 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <string.h>
-#include <time.h>
 
 #include "afe79xxTypes.h"
 #include "afe79xxLog.h"
@@ -18,6 +17,7 @@
 #include "afeCommonMacros.h"
 
 #include "interface.h"
+#include "afeTimer.h"
 
 static FILE *logfp = NULL;
 
@@ -33,7 +33,7 @@ uint8_t dev_spi_write(uint8_t afeId, uint16_t addr, uint8_t data)
 {
     afeLogDbg("WRITE: afeId: %d, addr: 0x%X, data: 0x%X", afeId, addr, data);
     /* TBD: User domain */
-    uint8_t status = ftdi_writeReg(addr, data);
+    uint8_t status = ftdi_writeRegDevice(afeId, addr, data);
     //AFE_FUNC_EXEC(waitMs(20);
     if (status == 0)
         return RET_OK;
@@ -41,6 +41,36 @@ uint8_t dev_spi_write(uint8_t afeId, uint16_t addr, uint8_t data)
         return RET_EXEC_FAIL;
 }
 
+/**
+    @brief AFE SPI batch write driver function.
+    @details Writes a list of registers in order. The FTDI wrapper sends each chunk of the list as one USB transfer.
+    @param afeId AFE ID
+	@param addr Array of addresses to be written to.
+	@param data Array of values to be written.
+	@param count Number of entries in addr and data.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t dev_spi_write_batch(uint8_t afeId, const uint16_t *addr, const uint8_t *data, uint16_t count)
+{
+    int addrList[AFE_SPI_BATCH_MAX_LEN];
+    int dataList[AFE_SPI_BATCH_MAX_LEN];
+    uint16_t done = 0;
+    afeLogDbg("WRITE BATCH: afeId: %d, count: %d", afeId, count);
+    while (done < count)
+    {
+        uint16_t n = 0;
+        for (; (n < AFE_SPI_BATCH_MAX_LEN) && (done + n < count); n++)
+        {
+            addrList[n] = addr[done + n];
+            dataList[n] = data[done + n];
+        }
+        if (ftdi_writeRegBatchDevice(afeId, addrList, dataList, n) != 0)
+            return RET_EXEC_FAIL;
+        done += n;
+    }
+    return RET_OK;
+}
+
 /**
     @brief AFE SPI read driver function.
     @details AFE SPI read driver function and returns the read value as pointer. The contents of this function should be replaced by host SPI driver function.
@@ -55,7 +85,63 @@ uint8_t dev_spi_read(uint8_t afeId, uint16_t addr, uint8_t *readVal)
     *readVal = 0;
     afeLogDbg("READ: AFEID:%d: ADDR: 0X%X, Read Val: 0X%X", afeId, addr, *readVal);
     //AFE_FUNC_EXEC(waitMs(20);
-    *readVal = ftdi_readReg(0x8000 | addr);
+    *readVal = ftdi_readRegDevice(afeId, 0x8000 | addr);
+    return RET_OK;
+}
+
+/**
+    @brief AFE SPI burst write driver function.
+    @details Writes count bytes to the consecutive addresses starting at addr. The FTDI wrapper sends each chunk of AFE_SPI_BATCH_MAX_LEN bytes as one streaming frame: the address followed by all the data bytes in one chip select window.
+    @param afeId AFE ID
+	@param addr Address of the first byte.
+	@param data Array of values to be written.
+	@param count Number of bytes in data.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t dev_spi_write_burst(uint8_t afeId, uint16_t addr, const uint8_t *data, uint16_t count)
+{
+    int dataList[AFE_SPI_BATCH_MAX_LEN];
+    uint16_t done = 0;
+    afeLogDbg("WRITE BURST: afeId: %d, addr: 0x%X, count: %d", afeId, addr, count);
+    while (done < count)
+    {
+        uint16_t n = 0;
+        for (; (n < AFE_SPI_BATCH_MAX_LEN) && (done + n < count); n++)
+        {
+            dataList[n] = data[done + n];
+        }
+        if (ftdi_writeRegBurstDevice(afeId, addr + done, dataList, n) != 0)
+            return RET_EXEC_FAIL;
+        done += n;
+    }
+    return RET_OK;
+}
+
+/**
+    @brief AFE SPI burst read driver function.
+    @details Reads count bytes from the consecutive addresses starting at addr. The FTDI wrapper reads each chunk of AFE_SPI_BATCH_MAX_LEN bytes in one chip select window where the backend supports it.
+    @param afeId AFE ID
+	@param addr Address of the first byte.
+	@param data Array returning the values read.
+	@param count Number of bytes to read.
+	@return Returns if the function execution passed or failed.
+*/
+uint8_t dev_spi_read_burst(uint8_t afeId, uint16_t addr, uint8_t *data, uint16_t count)
+{
+    int dataList[AFE_SPI_BATCH_MAX_LEN];
+    uint16_t done = 0;
+    afeLogDbg("READ BURST: afeId: %d, addr: 0x%X, count: %d", afeId, addr, count);
+    while (done < count)
+    {
+        uint16_t n = ((count - done) < AFE_SPI_BATCH_MAX_LEN) ? (count - done) : AFE_SPI_BATCH_MAX_LEN;
+        if (ftdi_readRegBurstDevice(afeId, 0x8000 | (addr + done), dataList, n) != 0)
+            return RET_EXEC_FAIL;
+        for (uint16_t i = 0; i < n; i++)
+        {
+            data[done + i] = (uint8_t)dataList[i];
+        }
+        done += n;
+    }
     return RET_OK;
 }
 
@@ -134,32 +220,49 @@ uint8_t connectAfeTxToFb(uint8_t afeId, uint8_t txChNo, uint8_t fbChNo, uint8_t
 uint8_t wait(uint32_t wait_s)
 {
     afeLogSpiLog("WAIT: %d", wait_s);
-    /* TBD: User domain */
-    return waitMs(100);
+    return waitMs(wait_s * 1000);
 }
 
 /**
     @brief Wait in milli Seconds
-    @details Wait in milli Seconds. The contents of this function should be replaced by host driver function.
-    @param wait_ms Wait time in seconds.
+    @details Wait in milli Seconds of wall time. Sleeps instead of spinning, see afeTimer.c.
+    @param wait_ms Wait time in milli seconds.
 	@return Returns if the function execution passed or failed.
 */
 uint8_t waitMs(uint32_t wait_ms)
 {
     afeLogSpiLog("WAITms: %d", wait_ms);
-    long pause;
-    clock_t now, then;
-
-    pause = wait_ms * (CLOCKS_PER_SEC / 1000);
-    now = then = clock();
-    while ((now - then) < pause)
-    {
-        now = clock();
-    }
+    /* Writes queued by the pipelined transport have to reach the device before the wait starts. */
+    ftdi_flush();
+    afeTimerWaitNs((uint64_t)wait_ms * 1000000);
     afeLogSpiLog("delay of %d", wait_ms);
     return RET_OK;
 }
 
+/**
+    @brief Monotonic Time in micro Seconds
+    @details Returns a monotonic time stamp in micro seconds, used only to report execution times.
+	@return Time in micro seconds from an arbitrary start point.
+*/
+uint64_t getTimeUs(void)
+{
+    return afeTimerNowNs() / 1000;
+}
+
+/**
+    @brief Wait for the AFE Alarm Pin
+    @details Blocks until the AFE alarm GPIO assigned to the macro status is asserted, or until the timeout. The FTDI interface has no access to the alarm pins, so the macro status is always polled.
+    @param afeId AFE ID
+    @param timeout_ms Maximum wait in milli seconds.
+	@return Always AFE_ALARM_PIN_UNSUPPORTED.
+*/
+uint8_t waitForAfeAlarmPin(uint8_t afeId, uint32_t timeout_ms)
+{
+    (void)afeId;
+    (void)timeout_ms;
+    return AFE_ALARM_PIN_UNSUPPORTED;
+}
+
 static uint32_t AFE_CURRENT_LOG_LEVEL = AFE_LOG_LEVEL_INFO;
 
 /**
@@ -226,17 +329,16 @@ void afeLogmsg(uint32_t level, const char *pcLogFmt, ...)
        below codes are example */
     char output[1024];
     va_list args;
+    /* Filtered messages return before anything is formatted. */
+    if (level > AFE_CURRENT_LOG_LEVEL)
+        return;
     va_start(args, pcLogFmt);
-    vsprintf(output, pcLogFmt, args);
-
-    if (level <= AFE_CURRENT_LOG_LEVEL)
+    vsnprintf(output, sizeof(output), pcLogFmt, args);
+    va_end(args);
+    printf("%s", output);
+    if (logfp != NULL)
     {
-        printf(output);
-        if (logfp != NULL)
-        {
-            fprintf(logfp, output);
-        }
+        fprintf(logfp, "%s", output);
     }
-    va_end(args);
 }
 
@@ -0,0 +1,90 @@
+/** @file mockInterface.c
+ * 	@brief	Mock FTDI interface for the host tests of the TI build. Each device id has its own register array. Calls with an id that
+ * 		has no device open go to device 0, as in interface.cpp.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "interface.h"
+#include "mockInterface.h"
+
+MockInterfaceDevice_t mockInterface[FTDI_MAX_DEVICES];
+int testFailures = 0;
+
+void mockInterfaceReset(void)
+{
+    memset(mockInterface, 0, sizeof(mockInterface));
+}
+
+static MockInterfaceDevice_t *mockInterfaceDevice(int id)
+{
+    return &mockInterface[ftdi_getDeviceTransport(id)];
+}
+
+int ftdi_openDevice(int id, char *name, int backend)
+{
+    (void)name;
+    (void)backend;
+    if (id < 0 || id >= FTDI_MAX_DEVICES)
+        return 1;
+    mockInterface[id].open = 1;
+    return 0;
+}
+
+int ftdi_closeDevice(int id)
+{
+    if (id < 0 || id >= FTDI_MAX_DEVICES)
+        return 1;
+    mockInterface[id].open = 0;
+    return 0;
+}
+
+int ftdi_getDeviceTransport(int id)
+{
+    if (id > 0 && id < FTDI_MAX_DEVICES && mockInterface[id].open)
+        return id;
+    return 0;
+}
+
+int ftdi_readRegDevice(int id, int addr)
+{
+    MockInterfaceDevice_t *dev = mockInterfaceDevice(id);
+    dev->reads++;
+    return dev->regs[addr & 0x7fff];
+}
+
+int ftdi_writeRegDevice(int id, int addr, int val)
+{
+    MockInterfaceDevice_t *dev = mockInterfaceDevice(id);
+    dev->writes++;
+    dev->regs[addr & 0x7fff] = (uint8_t)val;
+    return 0;
+}
+
+int ftdi_writeRegBatchDevice(int id, int *addr, int *val, int n)
+{
+    for (int i = 0; i < n; i++)
+        ftdi_writeRegDevice(id, addr[i], val[i]);
+    return 0;
+}
+
+int ftdi_writeRegBurstDevice(int id, int addr, int *val, int n)
+{
+    for (int i = 0; i < n; i++)
+        ftdi_writeRegDevice(id, addr + i, val[i]);
+    return 0;
+}
+
+int ftdi_readRegBurstDevice(int id, int addr, int *val, int n)
+{
+    for (int i = 0; i < n; i++)
+        val[i] = ftdi_readRegDevice(id, addr + i);
+    return 0;
+}
+
+int ftdi_flush()
+{
+    return 0;
+}
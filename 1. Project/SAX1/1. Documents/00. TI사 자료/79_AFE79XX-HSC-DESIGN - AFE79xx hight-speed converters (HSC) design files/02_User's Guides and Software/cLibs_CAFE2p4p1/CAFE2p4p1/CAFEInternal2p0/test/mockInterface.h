@@ -0,0 +1,38 @@
+/** @file mockInterface.h
+ * 	@brief	Mock FTDI interface for the host tests of the TI build. Replaces the ftdi_* calls of interface.h with one register array per device.
+*/
+
+#ifndef MOCK_INTERFACE_H
+#define MOCK_INTERFACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "interface.h"
+
+typedef struct MOCK_INTERFACE_DEVICE
+{
+    /// 1 once the device was opened with ftdi_openDevice.
+    uint8_t open;
+    /// Register values, by SPI address.
+    uint8_t regs[0x8000];
+    uint32_t reads;
+    uint32_t writes;
+} MockInterfaceDevice_t;
+
+extern MockInterfaceDevice_t mockInterface[FTDI_MAX_DEVICES];
+extern int testFailures;
+
+void mockInterfaceReset(void);
+
+#define TEST_CHECK(cond)                                                          \
+    do                                                                            \
+    {                                                                             \
+        if (!(cond))                                                              \
+        {                                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);       \
+            testFailures++;                                                       \
+        }                                                                         \
+    } while (0)
+
+#endif
@@ -0,0 +1,95 @@
+/** @file testMultiExec.c
+ * 	@brief	Checks afeMultiExecRun on the mock interface: runs with AFEs that share a transport are refused, AFEs on their own
+ * 		transports run in parallel, each on its own registers, and the barrier calls its leader once.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "afe79xxTypes.h"
+#include "afe79xxLog.h"
+#include "afeCommonMacros.h"
+#include "baseFunc.h"
+#include "basicFunctions.h"
+#include "afeMultiExec.h"
+#include "mockInterface.h"
+
+#define TEST_REG_ADDR 0x10
+#define TEST_REG_COUNT 64
+
+static uint32_t funcCalls;
+static uint32_t leaderCalls;
+
+static uint8_t leaderFunc(uint8_t afeId, void *ctx)
+{
+    (void)afeId;
+    (void)ctx;
+    leaderCalls++;
+    return RET_OK;
+}
+
+/*  Writes the AFE ID to its test registers, lines up with the other AFEs, and reads them back.   */
+static uint8_t writeIdFunc(uint8_t afeId, void *ctx)
+{
+    uint8_t errorStatus = 0;
+    uint8_t readVal;
+    (void)ctx;
+    __sync_fetch_and_add(&funcCalls, 1);
+    for (uint16_t i = 0; i < TEST_REG_COUNT; i++)
+    {
+        AFE_FUNC_EXEC(afeSpiWriteWrapper(afeId, TEST_REG_ADDR + i, afeId + 1, 0, 7));
+    }
+    AFE_FUNC_EXEC(afeMultiExecBarrier(afeId, leaderFunc, NULL));
+    for (uint16_t i = 0; i < TEST_REG_COUNT; i++)
+    {
+        AFE_FUNC_EXEC(afeSpiReadWrapper(afeId, TEST_REG_ADDR + i, 0, 7, &readVal));
+        if (readVal != afeId + 1)
+            return RET_EXEC_FAIL;
+    }
+    return RET_OK;
+}
+
+static void testSharedTransportRefused(void)
+{
+    uint8_t results[NUM_OF_AFE];
+
+    /*  Only device 0 is open, so both AFEs would go through it.   */
+    mockInterfaceReset();
+    funcCalls = 0;
+    ftdi_openDevice(0, "mock", FTDI_BACKEND_BITBANG);
+    TEST_CHECK(afeMultiExecRun(0x3, writeIdFunc, NULL, results) == RET_EXEC_FAIL);
+    TEST_CHECK(funcCalls == 0);
+    TEST_CHECK(mockInterface[0].writes == 0);
+
+    /*  One AFE alone is fine on the shared transport.   */
+    TEST_CHECK(afeMultiExecRun(0x2, writeIdFunc, NULL, results) == RET_OK);
+    TEST_CHECK((funcCalls == 1) && (mockInterface[0].regs[TEST_REG_ADDR] == 2));
+}
+
+static void testOwnTransports(void)
+{
+    uint8_t results[NUM_OF_AFE] = {RET_EXEC_FAIL, RET_EXEC_FAIL};
+
+    mockInterfaceReset();
+    funcCalls = 0;
+    leaderCalls = 0;
+    ftdi_openDevice(0, "mock", FTDI_BACKEND_BITBANG);
+    ftdi_openDevice(1, "mock", FTDI_BACKEND_BITBANG);
+    TEST_CHECK(afeMultiExecRun(0x3, writeIdFunc, NULL, results) == RET_OK);
+    TEST_CHECK((results[0] == RET_OK) && (results[1] == RET_OK));
+    TEST_CHECK((funcCalls == 2) && (leaderCalls == 1));
+    for (uint16_t i = 0; i < TEST_REG_COUNT; i++)
+    {
+        TEST_CHECK(mockInterface[0].regs[TEST_REG_ADDR + i] == 1);
+        TEST_CHECK(mockInterface[1].regs[TEST_REG_ADDR + i] == 2);
+    }
+}
+
+int main(void)
+{
+    setAfeLogLvl(AFE_LOG_LEVEL_ERROR);
+    testSharedTransportRefused();
+    testOwnTransports();
+    printf("testMultiExec: %d failures\n", testFailures);
+    return testFailures != 0;
+}
@@ -0,0 +1,87 @@
+/** @file testTimer.c
+ * 	@brief	Checks the waitMs of the host build against the monotonic clock: no wait ends early, the waits are late by little,
+ * 		and waits of a millisecond and more mostly sleep instead of spinning.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "afe79xxTypes.h"
+#include "afeCommonMacros.h"
+#include "baseFunc.h"
+#include "afeTimer.h"
+#include "mockInterface.h"
+
+/*  Median lateness allowed. The average and the worst case are only printed, a loaded host preempts single waits by tens of ms.   */
+#define MAX_MEDIAN_LATE_US 200
+#define MAX_WAITS 200
+
+typedef struct WAIT_CHECK
+{
+    uint32_t waitUs;
+    uint32_t count;
+    /// Most CPU time the waits may use, as a percentage of their wall time. 100 for the waits that only spin.
+    uint32_t maxCpuPercent;
+} WaitCheck_t;
+
+/*  Waits of 1 ms spin at most half the wait, longer waits at most AFE_TIMER_SPIN_MAX_NS. Waits up to 100 us are spun.   */
+static const WaitCheck_t waitChecks[] = {
+    {50, 200, 100},
+    {1000, 200, 75},
+    {5000, 40, 50},
+    {20000, 20, 30},
+};
+
+static int compareLate(const void *a, const void *b)
+{
+    uint64_t lateA = *(const uint64_t *)a;
+    uint64_t lateB = *(const uint64_t *)b;
+    return (lateA > lateB) - (lateA < lateB);
+}
+
+static void checkWait(const WaitCheck_t *check)
+{
+    static uint64_t lateNs[MAX_WAITS];
+    uint64_t wallStart = afeTimerNowNs();
+    uint64_t cpuStart = afeTimerCpuNs();
+    uint64_t lateTotalNs = 0;
+    uint32_t early = 0;
+    uint32_t cpuPercent;
+
+    for (uint32_t i = 0; i < check->count; i++)
+    {
+        uint64_t start = afeTimerNowNs();
+        uint64_t elapsed;
+        if ((check->waitUs % 1000) == 0)
+            TEST_CHECK(waitMs(check->waitUs / 1000) == RET_OK);
+        else
+            afeTimerWaitNs((uint64_t)check->waitUs * 1000);
+        elapsed = afeTimerNowNs() - start;
+        if (elapsed < (uint64_t)check->waitUs * 1000)
+        {
+            early++;
+            lateNs[i] = 0;
+            continue;
+        }
+        lateNs[i] = elapsed - (uint64_t)check->waitUs * 1000;
+        lateTotalNs += lateNs[i];
+    }
+    cpuPercent = (uint32_t)((afeTimerCpuNs() - cpuStart) * 100 / (afeTimerNowNs() - wallStart));
+    qsort(lateNs, check->count, sizeof(lateNs[0]), compareLate);
+
+    printf("wait %u us x %u: median %u us late, average %u us, worst %u us, CPU %u%%\n", check->waitUs, check->count, (uint32_t)(lateNs[check->count / 2] / 1000),
+           (uint32_t)(lateTotalNs / check->count / 1000), (uint32_t)(lateNs[check->count - 1] / 1000), cpuPercent);
+    TEST_CHECK(early == 0);
+    TEST_CHECK(lateNs[check->count / 2] / 1000 <= MAX_MEDIAN_LATE_US);
+    if (check->maxCpuPercent < 100)
+        TEST_CHECK(cpuPercent <= check->maxCpuPercent);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(waitChecks); i++)
+        checkWait(&waitChecks[i]);
+    printf("testTimer: %d failures\n", testFailures);
+    return testFailures != 0;
+}
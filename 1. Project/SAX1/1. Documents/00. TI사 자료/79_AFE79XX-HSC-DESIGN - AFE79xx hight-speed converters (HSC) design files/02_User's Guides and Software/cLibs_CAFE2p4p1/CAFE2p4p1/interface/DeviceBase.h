@@ -9,7 +9,44 @@ class DeviceBase
 public:
 	virtual int readReg(int addr) = 0;
 	virtual int writeReg(int addr, int data) = 0;
+	//Writes n address/data pairs in order. Interfaces that can send them in one transfer should override this.
+	virtual int writeRegs(const int *addr, const int *data, int n)
+	{
+		int status = 0;
+		for (int i = 0; i < n && status == 0; i++)
+		{
+			status = writeReg(addr[i], data[i]);
+		}
+		return status;
+	}
+	//Writes n values to the consecutive addresses from addr. Interfaces that can stream them after one address should override this.
+	//A streamed burst only lands on consecutive registers when the device auto-increments the address within a frame. The interface
+	//does not set that mode, so callers must know it is on. The CAFE library only calls the burst functions after
+	//afeMacroOperandBurstCheck has confirmed it (afeSpiBurstEnable) and falls back to single accesses otherwise.
+	virtual int writeBurst(int addr, const int *data, int n)
+	{
+		int status = 0;
+		for (int i = 0; i < n && status == 0; i++)
+		{
+			status = writeReg(addr + i, data[i]);
+		}
+		return status;
+	}
+	//Reads n values from the consecutive addresses from addr. addr carries the read flag the same way as for readReg.
+	//Same auto-increment precondition as writeBurst.
+	virtual int readBurst(int addr, int *data, int n)
+	{
+		for (int i = 0; i < n; i++)
+		{
+			data[i] = readReg(addr + i);
+		}
+		return 0;
+	}
 	virtual int open(char* name) = 0;
+	virtual int close()
+	{
+		return 0;
+	}
 };
 
 #endif
\ No newline at end of file
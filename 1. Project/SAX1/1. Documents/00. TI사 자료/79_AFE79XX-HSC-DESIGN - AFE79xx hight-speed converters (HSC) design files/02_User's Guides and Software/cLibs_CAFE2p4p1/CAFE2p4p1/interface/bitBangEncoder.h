@@ -0,0 +1,176 @@
+/***Allocation-free encoder for the synchronous bit-bang SPI waveform.
+Every data bit costs two GPIO bytes (first and second clock phase). The bytes only depend on the pin map, so they are computed once
+per configuration and a frame is emitted by copying 8 bytes per nibble into a caller-provided buffer.
+The byte stream is identical to the one built by FTDIRegProgrammer::setWritePacketString and readReg.
+***/
+#ifndef BIT_BANG_ENCODER_H
+#define BIT_BANG_ENCODER_H
+
+#include <cstdint>
+#include <cstring>
+
+//Longest frame the encoder handles. Longer packets go through the string based path.
+#define BITBANG_MAX_FRAME_BITS 32
+//Worst case stream: idle + 2 bytes per address bit + turnaround + 2 bytes per data bit + idle + disable.
+#define BITBANG_MAX_STREAM_BYTES (2 * BITBANG_MAX_FRAME_BITS + 4)
+
+class BitBangEncoder
+{
+private:
+	unsigned char idleEnabled, idleDisabled;
+	unsigned char writeBit[2][2];
+	unsigned char readBit[2][2];
+	unsigned char msbNibble[16][8];
+	unsigned char lsbNibble[16][8];
+	int msbFirst;
+
+	inline int emitBits(uint32_t bits, int len, unsigned char *out) const
+	{
+		int n = 0;
+		if (msbFirst)
+		{
+			int i = len;
+			for (; i % 4; i--)
+			{
+				int b = (bits >> (i - 1)) & 1;
+				out[n++] = writeBit[b][0];
+				out[n++] = writeBit[b][1];
+			}
+			for (; i > 0; i -= 4)
+			{
+				memcpy(out + n, msbNibble[(bits >> (i - 4)) & 0xF], 8);
+				n += 8;
+			}
+		}
+		else
+		{
+			int i = 0;
+			for (; i + 4 <= len; i += 4)
+			{
+				memcpy(out + n, lsbNibble[(bits >> i) & 0xF], 8);
+				n += 8;
+			}
+			for (; i < len; i++)
+			{
+				int b = (bits >> i) & 1;
+				out[n++] = writeBit[b][0];
+				out[n++] = writeBit[b][1];
+			}
+		}
+		return n;
+	}
+
+public:
+	BitBangEncoder()
+	{
+		configure(0, 1, 3, 0, 1, 1, 1, 0);
+	}
+
+	//baseValue holds the static pins. The clock, data and enable bits of it are ignored.
+	void configure(int clkBit, int dataBit, int enableBit, int enableHigh, int clkEdge, int readClkEdge, int msbFirstIn, unsigned char baseValue)
+	{
+		unsigned char clk = (unsigned char)(1 << clkBit);
+		unsigned char data = (unsigned char)(1 << dataBit);
+		unsigned char enable = (unsigned char)(1 << enableBit);
+		unsigned char base = baseValue & (unsigned char)~(clk | data | enable);
+
+		msbFirst = msbFirstIn;
+		idleEnabled = base | (enableHigh ? enable : 0);
+		idleDisabled = base | (enableHigh ? 0 : enable);
+		for (int b = 0; b < 2; b++)
+		{
+			unsigned char d = b ? data : 0;
+			writeBit[b][0] = idleEnabled | d | (clkEdge ? 0 : clk);
+			writeBit[b][1] = idleEnabled | d | (clkEdge ? clk : 0);
+			readBit[b][0] = idleEnabled | d | (readClkEdge ? 0 : clk);
+			readBit[b][1] = idleEnabled | d | (readClkEdge ? clk : 0);
+		}
+		for (int v = 0; v < 16; v++)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				int msbBit = (v >> (3 - i)) & 1;
+				int lsbBit = (v >> i) & 1;
+				msbNibble[v][2 * i] = writeBit[msbBit][0];
+				msbNibble[v][2 * i + 1] = writeBit[msbBit][1];
+				lsbNibble[v][2 * i] = writeBit[lsbBit][0];
+				lsbNibble[v][2 * i + 1] = writeBit[lsbBit][1];
+			}
+		}
+	}
+
+	static int writeStreamLen(int frameLen)
+	{
+		return 2 * frameLen + 3;
+	}
+
+	static int readStreamLen(int addressLen, int dataLen)
+	{
+		return 2 * addressLen + 2 * dataLen + 4;
+	}
+
+	//Emits the stream for one write frame of frameLen bits. out must hold writeStreamLen(frameLen) bytes.
+	inline int encodeWrite(uint32_t frame, int frameLen, unsigned char *out) const
+	{
+		int n = 0;
+		out[n++] = idleEnabled;
+		n += emitBits(frame, frameLen, out + n);
+		out[n++] = idleEnabled;
+		out[n++] = idleDisabled;
+		return n;
+	}
+
+	static int burstStreamLen(int addressLen, int dataLen, int n)
+	{
+		return 2 * addressLen + 2 * dataLen * n + 3;
+	}
+
+	//Emits one streaming write: the address once, then n data words of dataLen bits under the same enable.
+	//Both fields are at most BITBANG_MAX_FRAME_BITS. out must hold burstStreamLen(addressLen, dataLen, n) bytes.
+	inline int encodeBurstWrite(uint32_t addr, int addressLen, const int *data, int dataLen, int n, unsigned char *out) const
+	{
+		int len = 0;
+		out[len++] = idleEnabled;
+		len += emitBits(addr, addressLen, out + len);
+		for (int i = 0; i < n; i++)
+		{
+			len += emitBits((uint32_t)data[i], dataLen, out + len);
+		}
+		out[len++] = idleEnabled;
+		out[len++] = idleDisabled;
+		return len;
+	}
+
+	//Emits the stream for one read frame. The data phase clocks the same dummy 0101.. pattern as readReg.
+	inline int encodeRead(uint32_t addr, int addressLen, int dataLen, unsigned char *out) const
+	{
+		int n = 0;
+		out[n++] = idleEnabled;
+		n += emitBits(addr, addressLen, out + n);
+		out[n++] = idleEnabled;
+		for (int i = 0; i < dataLen; i++)
+		{
+			out[n++] = readBit[i % 2][0];
+			out[n++] = readBit[i % 2][1];
+		}
+		out[n++] = idleEnabled;
+		out[n++] = idleDisabled;
+		return n;
+	}
+
+	//Picks the data bits out of the echo of a read frame, MSB first, the same samples readReg uses.
+	static int decodeRead(const unsigned char *rx, int rxLen, int dataLen, int dataOutBit, int readClkEdge)
+	{
+		int start = rxLen - 2 + readClkEdge - 2 * dataLen;
+		int val = 0;
+		if (start < 0)
+			return -1;
+		for (int i = 0; i < dataLen; i++)
+		{
+			val = (val << 1) | ((rx[start + 2 * i] >> dataOutBit) & 1);
+		}
+		return val;
+	}
+};
+
+#endif
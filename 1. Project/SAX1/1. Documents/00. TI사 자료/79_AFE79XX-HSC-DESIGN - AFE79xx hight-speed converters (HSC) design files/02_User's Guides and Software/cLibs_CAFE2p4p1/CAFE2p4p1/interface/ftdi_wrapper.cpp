@@ -13,6 +13,9 @@ int FTDIRegProgrammer::open(char *name)
 
 FTDIRegProgrammer::FTDIRegProgrammer(char *name,int *status)
 {
+	transportMode = FTDI_TRANSPORT_LEGACY;
+	transactionCount = 0;
+	transportSeconds = 0;
 	ftStatus =  open(name);
 	if (ftStatus != FT_OK){
 		std::cout<< name << " device not found" << std::endl;
@@ -38,6 +41,8 @@ FTDIRegProgrammer::FTDIRegProgrammer(char *name,int *status)
 	packetOrder = 0;
 	FT_SetChars(ftHandle, 'a', 0, 'a', 0);
 	setMask();
+	txQueue.reserve(FTDI_PIPELINE_MAX_BYTES + BITBANG_MAX_STREAM_BYTES);
+	updateEncoder();
 	// FT_SetBaudRate(ftHandle, 9600);
 	// FT_SetDivisor(ftHandle, 0);
 	// FT_SetTimeouts(ftHandle, 2000, 2000);
@@ -46,19 +51,34 @@ FTDIRegProgrammer::FTDIRegProgrammer(char *name,int *status)
 
 
 std::string FTDIRegProgrammer::readFromFTDI(std::string data)
+{
+	unsigned char RxBuffer[1024];
+	DWORD BytesReceived = 0;
+	ftStatus = readBytesFromFTDI((const unsigned char *)data.data(), data.size(), RxBuffer, sizeof(RxBuffer), &BytesReceived);
+	if (ftStatus != FT_OK || BytesReceived == 0)
+		return "ERROR";
+	return std::string((char *)RxBuffer, BytesReceived);
+}
+
+int FTDIRegProgrammer::readBytesFromFTDI(const unsigned char *data, DWORD len, unsigned char *rx, DWORD rxSize, DWORD *rxLen)
 {
 	//purge();
-	char data_char[1024];
-	// strcpy(data_char, data.c_str());
-	for(int i = 0; i<data.size(); i++){
-		data_char[i] = data[i];
-	}
 	DWORD bytesWritten;
-	ftStatus = FT_Write(ftHandle, data_char, data.size(), &bytesWritten);
+	*rxLen = 0;
+	ftStatus = FT_Write(ftHandle, (LPVOID)data, len, &bytesWritten);
+	if (ftStatus == FT_OK && transportMode == FTDI_TRANSPORT_PIPELINED)
+	{
+		//Sync bit-bang returns one byte per byte written, so the read is complete once all of them are back.
+		DWORD RxBytes;
+		ftStatus = waitForRxBytes(bytesWritten, &RxBytes);
+		if (ftStatus != FT_OK)
+			return ftStatus;
+		ftStatus = FT_Read(ftHandle, rx, std::min(RxBytes, rxSize), rxLen);
+		return ftStatus;
+	}
 	if (ftStatus == FT_OK)
 	{
-		DWORD EventDWord, TxBytes, RxBytes, BytesReceived;
-		char RxBuffer[256];
+		DWORD EventDWord, TxBytes, RxBytes;
 		 std::this_thread::sleep_for(std::chrono::milliseconds(20));
 		ftStatus=FT_GetStatus(ftHandle,&RxBytes,&TxBytes,&EventDWord);
 		//std::cout<<"TxBytes "<<TxBytes<<"RxBYtes "<< RxBytes<<std::endl;
@@ -70,54 +90,42 @@ std::string FTDIRegProgrammer::readFromFTDI(std::string data)
 		
 		if(RxBytes > 0)
 		{
-			ftStatus = FT_Read(ftHandle,RxBuffer,RxBytes,&BytesReceived);
+			ftStatus = FT_Read(ftHandle,rx,std::min(RxBytes, rxSize),rxLen);
 			if(ftStatus == FT_OK)
 			{
-				std::string retVal;
-				for (int i = 0; i < RxBytes; i++)
-				{
-					retVal += RxBuffer[i];
-				}
-				return (retVal); 
+				return ftStatus;
 			}
 
 			std::cout << "Cannot read" << std::endl;
 			
-			return ("ERROR");
+			return ftStatus;
 
 		}
 
 		std::cout << "Nothing to read" << std::endl;
-
-	std::string errorString = "ERROR";
-
-	return errorString;
 		
 	}
 
-	return "ERROR";
+	return ftStatus;
 
 }
 
 
 int FTDIRegProgrammer::writeToFTDI(std::string data)
 {
-	//std::cout << data << "data in write ftdi" << std::endl;
-	char data_char[1024]; 
-	// strcpy(data_char, data.c_str());
-	for (int a = 0 ; a<data.size() ; a++){
-		data_char[a] = data[a];
+	return writeBytesToFTDI((const unsigned char *)data.data(), data.size());
+}
+
+int FTDIRegProgrammer::writeBytesToFTDI(const unsigned char *data, DWORD len)
+{
+	if (transportMode == FTDI_TRANSPORT_PIPELINED)
+	{
+		txQueue.append((const char *)data, len);
+		return flushQueue();
 	}
-	// data_char = "1010101010";
-	// for (int a = 0 ; a<data.size() ; a++){
-		// std::cout << int(data_char[a])<< " bit " <<myConvertToBin(int(data_char[a]),8) <<" data ";
-		// std::cout << int(data[a]) << std::endl;
-	// }
-	data_char[data.size()] = '\0';
-	// std::cout << data_char << "is sent to ftdi" << std::endl;
-	std::string retVal;
+	//std::cout << data << "data in write ftdi" << std::endl;
 	DWORD bytesWritten;
-	FT_STATUS retStatus = FT_Write(ftHandle, data_char, data.size(), &bytesWritten);
+	FT_STATUS retStatus = FT_Write(ftHandle, (LPVOID)data, len, &bytesWritten);
 	DWORD EventDWord, TxBytes, RxBytes;
 	ftStatus = FT_GetStatus(ftHandle,&RxBytes,&TxBytes,&EventDWord);
 	//std::cout<<"TxBytes "<<TxBytes<<"RxBYtes "<< RxBytes<<std::endl;
@@ -150,6 +158,7 @@ int FTDIRegProgrammer::reset()
 	readOutMode = 0;
 	packetOrder = 0;
 	msbFirst = 0;
+	updateEncoder();
 
 	ftStatus = FT_ResetDevice(ftHandle);
 	return ftStatus;
@@ -191,6 +200,7 @@ FTDIRegProgrammer::~FTDIRegProgrammer()
 
 int FTDIRegProgrammer::close()
 {
+	flushQueue();
 	//If there is an error, we don't care about it
 	ftStatus=FT_Close(ftHandle);
 	return ftStatus;
@@ -234,6 +244,7 @@ int FTDIRegProgrammer::setPin(int index, int val)
 
 	setMask();
 	writeValue();
+	updateEncoder();
 	return ftStatus;
 }
 
@@ -273,6 +284,13 @@ int FTDIRegProgrammer::setWritePacket(int val)
 }
 
 int FTDIRegProgrammer::setWritePacketString(std::string data)
+{
+	std::string stringArray = buildWritePacketString(data);
+	ftStatus = sendPacket((const unsigned char *)stringArray.data(), stringArray.size());
+	return ftStatus;
+}
+
+std::string FTDIRegProgrammer::buildWritePacketString(std::string data)
 {
 	// std::cout << "enable:clk:data" << enableBit << clkBit << dataBit << std::endl;
 	if(msbFirst == 0)
@@ -311,8 +329,7 @@ int FTDIRegProgrammer::setWritePacketString(std::string data)
 		// std::cout << int(a);
 	// }
 	// std::cout <<std::endl<< " to FTDI string array" << stringArray << std::endl;
-	ftStatus = writeToFTDI(stringArray);
-	return ftStatus;
+	return stringArray;
 }
 
 int FTDIRegProgrammer::rawWritePins(int data)
@@ -324,6 +341,58 @@ int FTDIRegProgrammer::rawWritePins(int data)
 
 int FTDIRegProgrammer::writeReg(int addr, int val)
 {
+	auto start = std::chrono::steady_clock::now();
+	int ret = encodeWrite(addr, val);
+	addTransactionTime(start, ret == FT_OK ? 1 : 0);
+	return ret;
+}
+
+int FTDIRegProgrammer::writeRegs(const int *addr, const int *data, int n)
+{
+	auto start = std::chrono::steady_clock::now();
+	int savedMode = transportMode;
+	int ret = FT_OK;
+	//The whole batch goes through the pipelined queue, so it leaves as one FT_Write regardless of the mode set.
+	setTransportMode(FTDI_TRANSPORT_PIPELINED);
+	for (int i = 0; i < n && ret == FT_OK; i++)
+	{
+		ret = encodeWrite(addr[i], data[i]);
+	}
+	int flushRet = setTransportMode(savedMode);
+	if (ret == FT_OK)
+		ret = flushRet;
+	//A failed flush doesn't say which of the queued writes reached the device, so the batch counts only once it all went out.
+	addTransactionTime(start, ret == FT_OK ? n : 0);
+	return ret;
+}
+
+int FTDIRegProgrammer::writeBurst(int addr, const int *data, int n)
+{
+	//A streaming frame is the address followed by all the data, so it needs the address first and one bit order for the whole frame.
+	int dataLen = packetLen - addressLen;
+	if (packetOrder || msbFirst == 0 || clkBit < 0 || dataBit < 0 || enableBit < 0 || addressLen > BITBANG_MAX_FRAME_BITS || dataLen > BITBANG_MAX_FRAME_BITS)
+		return DeviceBase::writeBurst(addr, data, n);
+	if (n <= 0)
+		return FT_OK;
+	auto start = std::chrono::steady_clock::now();
+	burstStream.resize(BitBangEncoder::burstStreamLen(addressLen, dataLen, n));
+	int len = encoder.encodeBurstWrite(addr & fieldMask(addressLen), addressLen, data, dataLen, n, burstStream.data());
+	setFrameEndState();
+	ftStatus = sendPacket(burstStream.data(), len);
+	addTransactionTime(start, ftStatus == FT_OK ? 1 : 0);
+	return ftStatus;
+}
+
+int FTDIRegProgrammer::encodeWrite(int addr, int val)
+{
+	if (packetLen <= BITBANG_MAX_FRAME_BITS)
+	{
+		unsigned char stream[BITBANG_MAX_STREAM_BYTES];
+		int len = encoder.encodeWrite(writeFrameBits(addr, val), packetLen, stream);
+		setFrameEndState();
+		ftStatus = sendPacket(stream, len);
+		return ftStatus;
+	}
 	std::string addresstoWrite = myConvertToBin(addr, addressLen);
 	std::string valueToWrite = myConvertToBin(val, packetLen - addressLen);
 	std::string data;
@@ -347,6 +416,76 @@ int FTDIRegProgrammer::readReg(int addr)
 		std::cout << "One of the bits is not set. Check" << std::endl; 
 		return FT_OTHER_ERROR;
 	}
+	auto start = std::chrono::steady_clock::now();
+	//Queued writes must reach the device before the read is clocked out.
+	flushQueue();
+	int ret;
+	if (packetLen <= BITBANG_MAX_FRAME_BITS)
+	{
+		ret = readRegEncoded(addr);
+	}
+	else
+	{
+		ret = readRegString(addr);
+	}
+	addTransactionTime(start, ftStatus == FT_OK ? 1 : 0);
+	return ret;
+}
+
+int FTDIRegProgrammer::readRegEncoded(int addr)
+{
+	unsigned char stream[BITBANG_MAX_STREAM_BYTES];
+	unsigned char rx[256];
+	DWORD rxLen = 0;
+	int dataLen = packetLen - addressLen;
+	int len = encoder.encodeRead(addr & fieldMask(addressLen), addressLen, dataLen, stream);
+	setFrameEndState();
+	setMask();
+	ftStatus=purge();
+	if(ftStatus){
+		std::cout<<"some error in purging"<<std::endl;
+	}
+	purgeRX();
+
+	ftStatus = readBytesFromFTDI(stream, len, rx, sizeof(rx), &rxLen);
+	if (ftStatus != FT_OK || rxLen < (DWORD)BitBangEncoder::readStreamLen(addressLen, dataLen))
+	{
+		std::cout << "Cannot read" << std::endl;
+		return FT_OTHER_ERROR;
+	}
+	return BitBangEncoder::decodeRead(rx, rxLen, dataLen, dataOutBit, readClkEdge);
+}
+
+int FTDIRegProgrammer::readRegString(int addr)
+{
+	std::string stringArray = buildReadPacketString(addr);
+	setMask();
+	ftStatus=purge();
+	if(ftStatus){
+		std::cout<<"some error in purging"<<std::endl;
+	}else{
+		//std::cout<<"correctly purging 11"<<std::endl;
+	}
+	purgeRX();
+
+	std::string output = readFromFTDI(stringArray);
+	std::string r = output.substr(output.size() - 2 + readClkEdge-2*(packetLen -addressLen), 2*(packetLen - addressLen));
+	std::string ret = "";
+	for (int i = 0; i < r.size(); i+=2)
+	{
+		// std::cout << myConvertToBin(int(r[i]),8)<<"   "<<int(r[i])<< " r of i dataout :"<< dataOutBit<< std::endl;
+		ret += std::to_string((int(r[i]) >> dataOutBit) & 1);
+	}
+	// std::cout << "ret string is : " << ret << std::endl;
+	// return bin2dec(ret);
+	// return convertBinaryArrayToInt<int>(retArray);
+	return stoi(ret, 0, 2);
+
+
+}
+
+std::string FTDIRegProgrammer::buildReadPacketString(int addr)
+{
 	std::string data = myConvertToBin(addr, addressLen);
 	//for (auto i :data){
 	// 	std::cout << i ;
@@ -406,29 +545,7 @@ int FTDIRegProgrammer::readReg(int addr)
 	stringArray += char(convertBinaryArrayToInt<int>(valueArray));
 	valueArray[enableBit] = !(enableHigh);
 	stringArray += char(convertBinaryArrayToInt<int>(valueArray));
-	setMask();
-	ftStatus=purge();
-	if(ftStatus){
-		std::cout<<"some error in purging"<<std::endl;
-	}else{
-		//std::cout<<"correctly purging 11"<<std::endl;
-	}
-	purgeRX();
-
-	std::string output = readFromFTDI(stringArray);
-	std::string r = output.substr(output.size() - 2 + readClkEdge-2*(packetLen -addressLen), 2*(packetLen - addressLen));
-	std::string ret = "";
-	for (int i = 0; i < r.size(); i+=2)
-	{
-		// std::cout << myConvertToBin(int(r[i]),8)<<"   "<<int(r[i])<< " r of i dataout :"<< dataOutBit<< std::endl;
-		ret += std::to_string((int(r[i]) >> dataOutBit) & 1);
-	}
-	// std::cout << "ret string is : " << ret << std::endl;
-	// return bin2dec(ret);
-	// return convertBinaryArrayToInt<int>(retArray);
-	return stoi(ret, 0, 2);
-
-
+	return stringArray;
 }
 
 void FTDIRegProgrammer::setAddressLen(int value)
@@ -449,16 +566,19 @@ void FTDIRegProgrammer::setPacketOrder(int value)
 void FTDIRegProgrammer::setMsbFirst(int value)
 {
 	msbFirst= value;
+	updateEncoder();
 }
 
 void FTDIRegProgrammer::setEnableType(int value)
 {
 	enableHigh = value;
+	updateEncoder();
 }
 
 void FTDIRegProgrammer::setClkEdge(int value)
 {
 	clkEdge = value;
+	updateEncoder();
 }
 
 std::string FTDIRegProgrammer::readSerialData(int size)
@@ -501,4 +621,172 @@ int FTDIRegProgrammer::setBaudRate(uint32_t baudRate)
 int FTDIRegProgrammer::setDivisor(uint8_t divisor)
 {
 	return FT_SetDivisor(ftHandle, divisor);
-}
\ No newline at end of file
+}
+
+int FTDIRegProgrammer::sendPacket(const unsigned char *stream, DWORD len)
+{
+	if (transportMode != FTDI_TRANSPORT_PIPELINED)
+	{
+		return writeBytesToFTDI(stream, len);
+	}
+	if (txQueue.size() + len > FTDI_PIPELINE_MAX_BYTES)
+	{
+		ftStatus = flushQueue();
+		if (ftStatus != FT_OK)
+			return ftStatus;
+	}
+	txQueue.append((const char *)stream, len);
+	return FT_OK;
+}
+
+int FTDIRegProgrammer::waitForRxBytes(DWORD expected, DWORD *rxBytes)
+{
+	DWORD txBytes, eventDWord;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(FTDI_COMPLETION_TIMEOUT_MS);
+	*rxBytes = 0;
+	while (true)
+	{
+		ftStatus = FT_GetStatus(ftHandle, rxBytes, &txBytes, &eventDWord);
+		if (ftStatus != FT_OK || *rxBytes >= expected)
+			return ftStatus;
+		if (std::chrono::steady_clock::now() > deadline)
+		{
+			std::cout << "Timed out waiting for the FTDI transfer to complete" << std::endl;
+			return FT_OTHER_ERROR;
+		}
+		std::this_thread::yield();
+	}
+}
+
+int FTDIRegProgrammer::flushQueue()
+{
+	size_t offset = 0;
+	FT_STATUS status = FT_OK;
+	while (offset < txQueue.size())
+	{
+		DWORD chunk = std::min<size_t>(txQueue.size() - offset, FTDI_PIPELINE_MAX_BYTES);
+		DWORD bytesWritten = 0, rxBytes = 0, bytesRead = 0;
+		status = FT_Write(ftHandle, &txQueue[offset], chunk, &bytesWritten);
+		if (status != FT_OK)
+			break;
+		//The chunk is done once its echo is back. Reading it also keeps the RX buffer from stalling the next chunk.
+		status = waitForRxBytes(bytesWritten, &rxBytes);
+		if (status != FT_OK)
+			break;
+		std::string echo(rxBytes, '\0');
+		status = FT_Read(ftHandle, &echo[0], rxBytes, &bytesRead);
+		if (status != FT_OK)
+			break;
+		offset += chunk;
+	}
+	txQueue.clear();
+	ftStatus = status;
+	return status;
+}
+
+void FTDIRegProgrammer::addTransactionTime(std::chrono::steady_clock::time_point start, int count)
+{
+	transactionCount += count;
+	transportSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int FTDIRegProgrammer::setTransportMode(int mode)
+{
+	if (mode != FTDI_TRANSPORT_LEGACY && mode != FTDI_TRANSPORT_PIPELINED)
+		return FT_INVALID_PARAMETER;
+	int status = flushQueue();
+	if (mode == FTDI_TRANSPORT_PIPELINED && transportMode != FTDI_TRANSPORT_PIPELINED)
+	{
+		//Legacy writes never read their echo back. Drop it so completion counts start from zero.
+		purgeRX();
+	}
+	transportMode = mode;
+	return status;
+}
+
+int FTDIRegProgrammer::getTransportMode()
+{
+	return transportMode;
+}
+
+int FTDIRegProgrammer::flush()
+{
+	auto start = std::chrono::steady_clock::now();
+	int ret = flushQueue();
+	transportSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return ret;
+}
+
+double FTDIRegProgrammer::getTransactionsPerSecond()
+{
+	if (transportSeconds <= 0)
+		return 0;
+	return transactionCount / transportSeconds;
+}
+
+void FTDIRegProgrammer::resetTransportStats()
+{
+	transactionCount = 0;
+	transportSeconds = 0;
+}
+
+uint32_t FTDIRegProgrammer::fieldMask(int len)
+{
+	if (len >= 32)
+		return 0xFFFFFFFF;
+	return (1u << len) - 1;
+}
+
+uint32_t FTDIRegProgrammer::writeFrameBits(int addr, int val)
+{
+	int dataLen = packetLen - addressLen;
+	uint64_t a = (uint32_t)addr & fieldMask(addressLen);
+	uint64_t v = (uint32_t)val & fieldMask(dataLen);
+	if (packetOrder)
+		return (uint32_t)((v << addressLen) | a);
+	return (uint32_t)((a << dataLen) | v);
+}
+
+void FTDIRegProgrammer::setFrameEndState()
+{
+	//Same pin state the string based path leaves behind after a frame.
+	valueArray[clkBit] = 0;
+	valueArray[dataBit] = 0;
+	valueArray[enableBit] = !enableHigh;
+}
+
+void FTDIRegProgrammer::updateEncoder()
+{
+	if (clkBit < 0 || dataBit < 0 || enableBit < 0)
+		return;
+	encoder.configure(clkBit, dataBit, enableBit, enableHigh, clkEdge, readClkEdge, msbFirst, convertBinaryArrayToInt<UCHAR>(valueArray));
+}
+
+int FTDIRegProgrammer::benchmarkEncoder(int frames, double *legacyFramesPerSec, double *encoderFramesPerSec)
+{
+	unsigned char stream[BITBANG_MAX_STREAM_BYTES];
+	volatile size_t sink = 0;
+	if (frames <= 0 || packetLen > BITBANG_MAX_FRAME_BITS || clkBit < 0 || dataBit < 0 || enableBit < 0)
+		return FT_INVALID_PARAMETER;
+
+	//Encoding only, nothing is sent. Both loops produce the same bytes for the same frames.
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; i++)
+	{
+		std::string data = myConvertToBin(i & fieldMask(addressLen), addressLen) + myConvertToBin(i & fieldMask(packetLen - addressLen), packetLen - addressLen);
+		sink = sink + buildWritePacketString(data).size();
+	}
+	auto mid = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; i++)
+	{
+		sink = sink + encoder.encodeWrite(writeFrameBits(i, i), packetLen, stream) + stream[1];
+	}
+	auto end = std::chrono::steady_clock::now();
+	setFrameEndState();
+
+	double legacySeconds = std::chrono::duration<double>(mid - start).count();
+	double encoderSeconds = std::chrono::duration<double>(end - mid).count();
+	*legacyFramesPerSec = legacySeconds > 0 ? frames / legacySeconds : 0;
+	*encoderFramesPerSec = encoderSeconds > 0 ? frames / encoderSeconds : 0;
+	return FT_OK;
+}
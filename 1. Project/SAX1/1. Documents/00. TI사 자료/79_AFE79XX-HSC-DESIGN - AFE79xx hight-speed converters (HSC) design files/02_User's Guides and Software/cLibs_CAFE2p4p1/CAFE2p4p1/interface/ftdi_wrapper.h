@@ -10,7 +10,17 @@
 #include <bitset>
 #include<algorithm>
 #include"DeviceBase.h"
+#include "bitBangEncoder.h"
+#include <chrono>
+#include <vector>
 
+/*Transport modes. Legacy mode writes every transaction and sleeps 20 ms after it.
+Pipelined mode queues the bit-bang stream of many writes and sends it as one FT_Write, waiting only for completion.*/
+#define FTDI_TRANSPORT_LEGACY 0
+#define FTDI_TRANSPORT_PIPELINED 1
+/*Max bytes per FT_Write in pipelined mode. Sync bit-bang echoes every byte back, so this is kept within the RX buffer.*/
+#define FTDI_PIPELINE_MAX_BYTES 4096
+#define FTDI_COMPLETION_TIMEOUT_MS 1000
 
 class FTDIRegProgrammer: public DeviceBase
 {
@@ -18,6 +28,23 @@ private:
 	int clkBit, dataBit, enableBit, addressLen, packetLen, dataFirst, msbFirst, enableHigh, clkEdge, dataOutBit, readClkEdge, readOutMode, packetOrder;
 	std::array<bool, 8> maskArray;
 	std::array<bool, 8> valueArray;
+	int transportMode;
+	std::string txQueue;
+	unsigned long long transactionCount;
+	double transportSeconds;
+	BitBangEncoder encoder;
+	std::vector<unsigned char> burstStream;
+	int sendPacket(const unsigned char *stream, DWORD len);
+	int flushQueue();
+	int encodeWrite(int addr, int val);
+	int readRegEncoded(int addr);
+	int readRegString(int addr);
+	static uint32_t fieldMask(int len);
+	uint32_t writeFrameBits(int addr, int val);
+	void setFrameEndState();
+	void updateEncoder();
+	int waitForRxBytes(DWORD expected, DWORD *rxBytes);
+	void addTransactionTime(std::chrono::steady_clock::time_point start, int count = 1);
 public:
 	FT_HANDLE ftHandle;
 	FT_STATUS ftStatus;;
@@ -25,22 +52,29 @@ public:
 	virtual int open(char *name) override;
 
 	int writeToFTDI(std::string data);
+	int writeBytesToFTDI(const unsigned char *data, DWORD len);
 	std::string readFromFTDI(std::string data);
+	int readBytesFromFTDI(const unsigned char *data, DWORD len, unsigned char *rx, DWORD rxSize, DWORD *rxLen);
 	int reset();
 	virtual int readReg(int addr) override;
 	virtual int writeReg(int addr, int val) override;
+	virtual int writeRegs(const int *addr, const int *data, int n) override;
+	//Streams the data after one address. Only valid when the device auto-increments the address, see DeviceBase::writeBurst.
+	virtual int writeBurst(int addr, const int *data, int n) override;
 	int purge();
 	int purgeRX();
 	int purgeTX();
 	FTDIRegProgrammer(char *name,int *status);
 	~FTDIRegProgrammer();
-	int close();
+	virtual int close() override;
 	int setPin(int index, int val);
 	int setMask();
 	int writeValue();
 
 	int setWritePacket(int val);
 	int setWritePacketString(std::string data);
+	std::string buildWritePacketString(std::string data);
+	std::string buildReadPacketString(int addr);
 
 	int rawWritePins(int data);
 	void setAddressLen(int value);
@@ -53,6 +87,13 @@ public:
 	int setBaudRate(uint32_t baudRate);
 	int setDivisor(uint8_t divisor);
 
+	int setTransportMode(int mode);
+	int getTransportMode();
+	int flush();
+	double getTransactionsPerSecond();
+	void resetTransportStats();
+	int benchmarkEncoder(int frames, double *legacyFramesPerSec, double *encoderFramesPerSec);
+
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <cstdlib>
+#include <mutex>
 
 #include "interface.h"
 #include "ftdi_wrapper.h"
+#include "mpsse_wrapper.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -13,43 +15,257 @@ extern "C"
     //   the regular C++ behavior, which allows defining multiple functions with the same name
     //   (overloading) and hence uses function signature hashing to enforce unique IDs),
 
-    static FTDIRegProgrammer *ftdi_instance = NULL;
-    void lazyftdi(char *name)
+    // One transport per device id. AFEs whose id has no transport of its own share device 0. Calls on a device are
+    //   serialized by its lock, so AFEs on separate transports can be driven from separate threads.
+    static DeviceBase *ftdi_devices[FTDI_MAX_DEVICES] = {NULL};
+    static FTDIRegProgrammer *ftdi_instances[FTDI_MAX_DEVICES] = {NULL};
+    static std::mutex ftdi_locks[FTDI_MAX_DEVICES];
+
+    // Locks the transport that serves id and returns its index. ftdi_devices[id] is only read with ftdi_locks[id] held,
+    //   so a device that is being opened or closed on another thread isn't picked up half way.
+    static int lockDevice(int id, std::unique_lock<std::mutex> &lock)
+    {
+        if (id > 0 && id < FTDI_MAX_DEVICES)
+        {
+            lock = std::unique_lock<std::mutex>(ftdi_locks[id]);
+            if (ftdi_devices[id] != NULL)
+            {
+                return id;
+            }
+            lock.unlock();
+        }
+        lock = std::unique_lock<std::mutex>(ftdi_locks[0]);
+        return 0;
+    }
+
+    void lazyftdi(int id, char *name, int backend)
     {
         int status = 0;
-        if (ftdi_instance == NULL)
+        if (ftdi_devices[id] == NULL)
         {
-            ftdi_instance = new FTDIRegProgrammer(name, &status);
+            if (backend == FTDI_BACKEND_MPSSE)
+            {
+                ftdi_devices[id] = new FTDIMpsseProgrammer(name, &status);
+            }
+            else
+            {
+                ftdi_instances[id] = new FTDIRegProgrammer(name, &status);
+                ftdi_devices[id] = ftdi_instances[id];
+            }
             if (status == 1)
             {
-                ftdi_instance = NULL;
+                ftdi_devices[id] = NULL;
+                ftdi_instances[id] = NULL;
             }
         }
     }
 
     int ftdi_open(char *name)
     {
-        lazyftdi(name);
+        return ftdi_openBackend(name, FTDI_BACKEND_BITBANG);
+    }
+
+    int ftdi_openBackend(char *name, int backend)
+    {
+        return ftdi_openDevice(0, name, backend);
+    }
+
+    int ftdi_openDevice(int id, char *name, int backend)
+    {
+        if (backend != FTDI_BACKEND_BITBANG && backend != FTDI_BACKEND_MPSSE)
+        {
+            return 1;
+        }
+        if (id < 0 || id >= FTDI_MAX_DEVICES)
+        {
+            return 1;
+        }
+        std::lock_guard<std::mutex> lock(ftdi_locks[id]);
+        lazyftdi(id, name, backend);
         // int status =  ftdi_instance->open(name);
         return 0;
     }
 
     int ftdi_readReg(int addr)
+    {
+        return ftdi_readRegDevice(0, addr);
+    }
+
+    int ftdi_writeReg(int addr, int val)
+    {
+        return ftdi_writeRegDevice(0, addr, val);
+    }
+
+    int ftdi_writeRegBatch(int *addr, int *val, int n)
+    {
+        return ftdi_writeRegBatchDevice(0, addr, val, n);
+    }
+
+    int ftdi_readRegDevice(int id, int addr)
     {
         int val = 0;
-        if (ftdi_instance != NULL)
+        std::unique_lock<std::mutex> lock;
+        int index = lockDevice(id, lock);
+        if (ftdi_devices[index] != NULL)
         {
-            val = ftdi_instance->readReg(addr);
+            val = ftdi_devices[index]->readReg(addr);
         }
         return val;
     }
 
-    int ftdi_writeReg(int addr, int val)
+    int ftdi_writeRegDevice(int id, int addr, int val)
+    {
+        int retval = 0;
+        std::unique_lock<std::mutex> lock;
+        int index = lockDevice(id, lock);
+        if (ftdi_devices[index] != NULL)
+        {
+            retval = ftdi_devices[index]->writeReg(addr, val);
+        }
+        return retval;
+    }
+
+    int ftdi_writeRegBatchDevice(int id, int *addr, int *val, int n)
+    {
+        int retval = 0;
+        std::unique_lock<std::mutex> lock;
+        int index = lockDevice(id, lock);
+        if (ftdi_devices[index] != NULL)
+        {
+            retval = ftdi_devices[index]->writeRegs(addr, val, n);
+        }
+        return retval;
+    }
+
+    int ftdi_writeRegBurstDevice(int id, int addr, int *val, int n)
+    {
+        int retval = 0;
+        std::unique_lock<std::mutex> lock;
+        int index = lockDevice(id, lock);
+        if (ftdi_devices[index] != NULL)
+        {
+            retval = ftdi_devices[index]->writeBurst(addr, val, n);
+        }
+        return retval;
+    }
+
+    int ftdi_readRegBurstDevice(int id, int addr, int *val, int n)
+    {
+        int retval = 0;
+        std::unique_lock<std::mutex> lock;
+        int index = lockDevice(id, lock);
+        if (ftdi_devices[index] != NULL)
+        {
+            retval = ftdi_devices[index]->readBurst(addr, val, n);
+        }
+        return retval;
+    }
+
+    int ftdi_getDeviceTransport(int id)
+    {
+        std::unique_lock<std::mutex> lock;
+        return lockDevice(id, lock);
+    }
+
+    int ftdi_setTransportMode(int mode)
+    {
+        return ftdi_setTransportModeDevice(0, mode);
+    }
+
+    int ftdi_setTransportModeDevice(int id, int mode)
+    {
+        int retval = 0;
+        if (id < 0 || id >= FTDI_MAX_DEVICES)
+        {
+            return 1;
+        }
+        std::lock_guard<std::mutex> lock(ftdi_locks[id]);
+        if (ftdi_instances[id] != NULL)
+        {
+            retval = ftdi_instances[id]->setTransportMode(mode);
+        }
+        return retval;
+    }
+
+    int ftdi_flush()
+    {
+        int retval = 0;
+        for (int id = 0; id < FTDI_MAX_DEVICES; id++)
+        {
+            retval |= ftdi_flushDevice(id);
+        }
+        return retval;
+    }
+
+    int ftdi_flushDevice(int id)
+    {
+        int retval = 0;
+        if (id < 0 || id >= FTDI_MAX_DEVICES)
+        {
+            return 1;
+        }
+        std::lock_guard<std::mutex> lock(ftdi_locks[id]);
+        if (ftdi_instances[id] != NULL)
+        {
+            retval = ftdi_instances[id]->flush();
+        }
+        return retval;
+    }
+
+    double ftdi_getTransactionsPerSecond()
+    {
+        return ftdi_getTransactionsPerSecondDevice(0);
+    }
+
+    double ftdi_getTransactionsPerSecondDevice(int id)
+    {
+        double val = 0;
+        if (id < 0 || id >= FTDI_MAX_DEVICES)
+        {
+            return val;
+        }
+        std::lock_guard<std::mutex> lock(ftdi_locks[id]);
+        if (ftdi_instances[id] != NULL)
+        {
+            val = ftdi_instances[id]->getTransactionsPerSecond();
+        }
+        return val;
+    }
+
+    void ftdi_resetTransportStats()
+    {
+        ftdi_resetTransportStatsDevice(0);
+    }
+
+    void ftdi_resetTransportStatsDevice(int id)
+    {
+        if (id < 0 || id >= FTDI_MAX_DEVICES)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(ftdi_locks[id]);
+        if (ftdi_instances[id] != NULL)
+        {
+            ftdi_instances[id]->resetTransportStats();
+        }
+    }
+
+    int ftdi_benchmarkEncoder(int frames, double *legacyFramesPerSec, double *encoderFramesPerSec)
+    {
+        return ftdi_benchmarkEncoderDevice(0, frames, legacyFramesPerSec, encoderFramesPerSec);
+    }
+
+    int ftdi_benchmarkEncoderDevice(int id, int frames, double *legacyFramesPerSec, double *encoderFramesPerSec)
     {
         int retval = 0;
-        if (ftdi_instance != NULL)
+        if (id < 0 || id >= FTDI_MAX_DEVICES)
+        {
+            return 1;
+        }
+        std::lock_guard<std::mutex> lock(ftdi_locks[id]);
+        if (ftdi_instances[id] != NULL)
         {
-            retval = ftdi_instance->writeReg(addr, val);
+            retval = ftdi_instances[id]->benchmarkEncoder(frames, legacyFramesPerSec, encoderFramesPerSec);
         }
         return retval;
     }
@@ -57,10 +273,26 @@ extern "C"
     int ftdi_close()
     {
         int retval = 0;
-        if (ftdi_instance != NULL)
+        for (int id = FTDI_MAX_DEVICES - 1; id >= 0; id--)
+        {
+            retval |= ftdi_closeDevice(id);
+        }
+        return retval;
+    }
+
+    int ftdi_closeDevice(int id)
+    {
+        int retval = 0;
+        if (id < 0 || id >= FTDI_MAX_DEVICES)
+        {
+            return 1;
+        }
+        std::lock_guard<std::mutex> lock(ftdi_locks[id]);
+        if (ftdi_devices[id] != NULL)
         {
-            retval = ftdi_instance->close();
-            ftdi_instance = NULL;
+            retval = ftdi_devices[id]->close();
+            ftdi_devices[id] = NULL;
+            ftdi_instances[id] = NULL;
         }
         return retval;
     }
@@ -1,14 +1,48 @@
 #ifndef ftdi_C_CONNECTOR_H 
 #define ftdi_C_CONNECTOR_H 
 
+/*Modes for ftdi_setTransportMode. Must match FTDI_TRANSPORT_* in ftdi_wrapper.h*/
+#define FTDI_TRANSPORT_MODE_LEGACY 0
+#define FTDI_TRANSPORT_MODE_PIPELINED 1
+
+/*Backends for ftdi_openBackend. ftdi_open uses FTDI_BACKEND_BITBANG.
+The transport mode, stats and encoder benchmark calls only apply to the bit-bang backend.*/
+#define FTDI_BACKEND_BITBANG 0
+#define FTDI_BACKEND_MPSSE 1
+
+/*Transports that can be open at the same time, one per device id. The plain calls use device 0.
+Calls with a device id that has no transport open go to device 0. The transport mode, stats and encoder benchmark calls with a device id
+apply to that device only, the plain ones to device 0. ftdi_getDeviceTransport returns the device whose transport a call with that id uses.*/
+#define FTDI_MAX_DEVICES 4
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 int ftdi_open(char *name);
+int ftdi_openBackend(char *name, int backend);
 int ftdi_readReg(int addr);
 int ftdi_writeReg(int addr, int val);
+int ftdi_writeRegBatch(int *addr, int *val, int n);
 int ftdi_close();
+int ftdi_openDevice(int id, char *name, int backend);
+int ftdi_readRegDevice(int id, int addr);
+int ftdi_writeRegDevice(int id, int addr, int val);
+int ftdi_writeRegBatchDevice(int id, int *addr, int *val, int n);
+int ftdi_writeRegBurstDevice(int id, int addr, int *val, int n);
+int ftdi_readRegBurstDevice(int id, int addr, int *val, int n);
+int ftdi_flushDevice(int id);
+int ftdi_getDeviceTransport(int id);
+int ftdi_closeDevice(int id);
+int ftdi_setTransportMode(int mode);
+int ftdi_flush();
+double ftdi_getTransactionsPerSecond();
+void ftdi_resetTransportStats();
+int ftdi_benchmarkEncoder(int frames, double *legacyFramesPerSec, double *encoderFramesPerSec);
+int ftdi_setTransportModeDevice(int id, int mode);
+double ftdi_getTransactionsPerSecondDevice(int id);
+void ftdi_resetTransportStatsDevice(int id);
+int ftdi_benchmarkEncoderDevice(int id, int frames, double *legacyFramesPerSec, double *encoderFramesPerSec);
 
 #ifdef __cplusplus
 }
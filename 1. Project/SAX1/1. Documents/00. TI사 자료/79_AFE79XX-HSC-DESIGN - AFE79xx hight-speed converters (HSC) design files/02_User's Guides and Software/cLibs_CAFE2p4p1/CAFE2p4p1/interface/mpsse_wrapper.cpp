@@ -0,0 +1,389 @@
+#include "mpsse_wrapper.h"
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+int FTDIMpsseProgrammer::open(char *name)
+{
+	FT_STATUS Status = FT_OpenEx(name, FT_OPEN_BY_DESCRIPTION, &ftHandle);
+	return Status;
+}
+
+FTDIMpsseProgrammer::FTDIMpsseProgrammer(char *name, int *status)
+{
+	addressLen = 16;
+	packetLen = 24;
+	msbFirst = 1;
+	clkEdge = 1;
+	readClkEdge = 1;
+	packetOrder = 0;
+	cmdQueue.reserve(MPSSE_MAX_BATCH_BYTES + 16);
+	ftStatus = open(name);
+	if (ftStatus != FT_OK){
+		std::cout<< name << " device not found" << std::endl;
+		*status=1;
+		return;
+	}
+	ftStatus = FT_ResetDevice(ftHandle);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_SetUSBParameters(ftHandle, 65536, 65535);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_SetChars(ftHandle, 0, 0, 0, 0);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_SetTimeouts(ftHandle, MPSSE_TIMEOUT_MS, MPSSE_TIMEOUT_MS);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_SetLatencyTimer(ftHandle, 1);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_SetBitMode(ftHandle, 0, 0x0);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_SetBitMode(ftHandle, 0, 0x2);
+	if (ftStatus == FT_OK)
+		ftStatus = syncMpsse();
+	if (ftStatus == FT_OK)
+	{
+		cmdQueue += char(MPSSE_CMD_DIV5_OFF);
+		cmdQueue += char(MPSSE_CMD_ADAPTIVE_OFF);
+		cmdQueue += char(MPSSE_CMD_3PHASE_OFF);
+		cmdQueue += char(MPSSE_CMD_LOOPBACK_OFF);
+		appendCs(0);
+		ftStatus = setClockDivisor(MPSSE_DEFAULT_DIVISOR);
+	}
+	if (ftStatus != FT_OK)
+	{
+		std::cout<< name << " MPSSE setup failed" << std::endl;
+		FT_Close(ftHandle);
+		*status=1;
+	}
+}
+
+FTDIMpsseProgrammer::~FTDIMpsseProgrammer()
+{
+	//If there is an error, we don't care about it
+	FT_Close(ftHandle);
+}
+
+int FTDIMpsseProgrammer::close()
+{
+	sendQueue();
+	//If there is an error, we don't care about it
+	ftStatus=FT_Close(ftHandle);
+	return ftStatus;
+}
+
+int FTDIMpsseProgrammer::syncMpsse()
+{
+	//An invalid opcode is answered with 0xFA followed by the opcode. Seeing that pair means the engine is in sync.
+	unsigned char cmd = MPSSE_CMD_BAD;
+	unsigned char rx[64];
+	DWORD bytesWritten, rxBytes, rxLen = 0;
+	ftStatus = FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_Write(ftHandle, &cmd, 1, &bytesWritten);
+	if (ftStatus == FT_OK)
+		ftStatus = waitForRxBytes(2, &rxBytes);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_Read(ftHandle, rx, std::min<DWORD>(rxBytes, sizeof(rx)), &rxLen);
+	if (ftStatus != FT_OK)
+		return ftStatus;
+	for (DWORD i = 0; i + 1 < rxLen; i++)
+	{
+		if (rx[i] == MPSSE_BAD_CMD_RESPONSE && rx[i + 1] == MPSSE_CMD_BAD)
+			return FT_OK;
+	}
+	std::cout << "MPSSE did not answer the sync command" << std::endl;
+	return FT_OTHER_ERROR;
+}
+
+int FTDIMpsseProgrammer::setClockDivisor(int divisor)
+{
+	if (divisor < 0 || divisor > 0xFFFF)
+		return FT_INVALID_PARAMETER;
+	cmdQueue += char(MPSSE_CMD_SET_DIVISOR);
+	cmdQueue += char(divisor & 0xFF);
+	cmdQueue += char((divisor >> 8) & 0xFF);
+	return sendQueue();
+}
+
+void FTDIMpsseProgrammer::appendCs(int active)
+{
+	//SCLK idles low, SEN is active low.
+	cmdQueue += char(MPSSE_CMD_SET_LOW_BYTE);
+	cmdQueue += char(active ? 0 : MPSSE_PIN_CS);
+	cmdQueue += char(MPSSE_PIN_DIRECTION);
+}
+
+void FTDIMpsseProgrammer::appendOut(uint32_t bits, int len)
+{
+	//clkEdge is the edge the AFE samples on, so data is driven on the opposite one.
+	unsigned char op = clkEdge ? MPSSE_CMD_OUT_BYTES_NEG : MPSSE_CMD_OUT_BYTES_POS;
+	int bytes = len / 8;
+	int rem = len % 8;
+	if (!msbFirst)
+		op |= MPSSE_CMD_LSB_FIRST;
+	if (bytes)
+	{
+		cmdQueue += char(op);
+		cmdQueue += char(bytes - 1);
+		cmdQueue += char(0);
+		for (int i = 0; i < bytes; i++)
+		{
+			if (msbFirst)
+				cmdQueue += char((bits >> (len - 8 * (i + 1))) & 0xFF);
+			else
+				cmdQueue += char((bits >> (8 * i)) & 0xFF);
+		}
+	}
+	if (rem)
+	{
+		//Bit commands shift out from bit 7 (MSB first) or bit 0 (LSB first).
+		cmdQueue += char(op | MPSSE_CMD_BITS);
+		cmdQueue += char(rem - 1);
+		if (msbFirst)
+			cmdQueue += char((bits << (8 - rem)) & 0xFF);
+		else
+			cmdQueue += char((bits >> (8 * bytes)) & ((1 << rem) - 1));
+	}
+}
+
+int FTDIMpsseProgrammer::appendIn(int len)
+{
+	unsigned char op = readClkEdge ? MPSSE_CMD_IN_BYTES_POS : MPSSE_CMD_IN_BYTES_NEG;
+	int bytes = len / 8;
+	int rem = len % 8;
+	if (!msbFirst)
+		op |= MPSSE_CMD_LSB_FIRST;
+	if (bytes)
+	{
+		cmdQueue += char(op);
+		cmdQueue += char(bytes - 1);
+		cmdQueue += char(0);
+	}
+	if (rem)
+	{
+		cmdQueue += char(op | MPSSE_CMD_BITS);
+		cmdQueue += char(rem - 1);
+	}
+	return bytes + (rem ? 1 : 0);
+}
+
+int FTDIMpsseProgrammer::decodeIn(const unsigned char *rx, int len)
+{
+	int bytes = len / 8;
+	int rem = len % 8;
+	uint32_t val = 0;
+	if (msbFirst)
+	{
+		for (int i = 0; i < bytes; i++)
+			val = (val << 8) | rx[i];
+		//Bits read MSB first are shifted in from bit 0.
+		if (rem)
+			val = (val << rem) | (rx[bytes] & ((1 << rem) - 1));
+	}
+	else
+	{
+		for (int i = 0; i < bytes; i++)
+			val |= uint32_t(rx[i]) << (8 * i);
+		//Bits read LSB first are shifted in from bit 7.
+		if (rem)
+			val |= uint32_t(rx[bytes] >> (8 - rem)) << (8 * bytes);
+	}
+	return int(val);
+}
+
+uint32_t FTDIMpsseProgrammer::writeFrameBits(int addr, int val)
+{
+	int dataLen = packetLen - addressLen;
+	uint64_t a = (uint32_t)addr & (uint32_t)((1ull << addressLen) - 1);
+	uint64_t v = (uint32_t)val & (uint32_t)((1ull << dataLen) - 1);
+	if (packetOrder)
+		return (uint32_t)((v << addressLen) | a);
+	return (uint32_t)((a << dataLen) | v);
+}
+
+int FTDIMpsseProgrammer::appendWrite(int addr, int val)
+{
+	if (packetLen > MPSSE_MAX_FRAME_BITS || addressLen > packetLen)
+	{
+		std::cout << "Packet length not supported by MPSSE" << std::endl;
+		return FT_INVALID_PARAMETER;
+	}
+	appendCs(1);
+	appendOut(writeFrameBits(addr, val), packetLen);
+	appendCs(0);
+	return FT_OK;
+}
+
+int FTDIMpsseProgrammer::sendQueue()
+{
+	DWORD bytesWritten = 0;
+	if (cmdQueue.empty())
+		return FT_OK;
+	ftStatus = FT_Write(ftHandle, (LPVOID)cmdQueue.data(), cmdQueue.size(), &bytesWritten);
+	if (ftStatus == FT_OK && bytesWritten != cmdQueue.size())
+	{
+		std::cout << "MPSSE write incomplete" << std::endl;
+		ftStatus = FT_IO_ERROR;
+	}
+	cmdQueue.clear();
+	return ftStatus;
+}
+
+int FTDIMpsseProgrammer::waitForRxBytes(DWORD expected, DWORD *rxBytes)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(MPSSE_TIMEOUT_MS);
+	*rxBytes = 0;
+	while (true)
+	{
+		ftStatus = FT_GetQueueStatus(ftHandle, rxBytes);
+		if (ftStatus != FT_OK || *rxBytes >= expected)
+			return ftStatus;
+		if (std::chrono::steady_clock::now() > deadline)
+		{
+			std::cout << "Timed out waiting for MPSSE data" << std::endl;
+			return FT_OTHER_ERROR;
+		}
+		std::this_thread::yield();
+	}
+}
+
+int FTDIMpsseProgrammer::writeReg(int addr, int val)
+{
+	ftStatus = appendWrite(addr, val);
+	if (ftStatus != FT_OK)
+		return ftStatus;
+	return sendQueue();
+}
+
+int FTDIMpsseProgrammer::writeRegs(const int *addr, const int *data, int n)
+{
+	//MPSSE writes return nothing, so the whole batch only costs the USB transfers.
+	for (int i = 0; i < n; i++)
+	{
+		ftStatus = appendWrite(addr[i], data[i]);
+		if (ftStatus == FT_OK && cmdQueue.size() >= MPSSE_MAX_BATCH_BYTES)
+			ftStatus = sendQueue();
+		if (ftStatus != FT_OK)
+		{
+			cmdQueue.clear();
+			return ftStatus;
+		}
+	}
+	return sendQueue();
+}
+
+int FTDIMpsseProgrammer::readReg(int addr)
+{
+	unsigned char rx[8];
+	DWORD rxBytes, rxLen = 0;
+	int dataLen = packetLen - addressLen;
+	if (packetLen > MPSSE_MAX_FRAME_BITS || dataLen <= 0)
+	{
+		std::cout << "Packet length not supported by MPSSE" << std::endl;
+		return FT_INVALID_PARAMETER;
+	}
+	appendCs(1);
+	appendOut((uint32_t)addr & (uint32_t)((1ull << addressLen) - 1), addressLen);
+	int expected = appendIn(dataLen);
+	appendCs(0);
+	cmdQueue += char(MPSSE_CMD_SEND_IMMEDIATE);
+	ftStatus = sendQueue();
+	if (ftStatus == FT_OK)
+		ftStatus = waitForRxBytes(expected, &rxBytes);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_Read(ftHandle, rx, expected, &rxLen);
+	if (ftStatus != FT_OK || rxLen != (DWORD)expected)
+	{
+		std::cout << "Cannot read" << std::endl;
+		return FT_OTHER_ERROR;
+	}
+	return decodeIn(rx, dataLen);
+}
+
+int FTDIMpsseProgrammer::writeBurst(int addr, const int *data, int n)
+{
+	int dataLen = packetLen - addressLen;
+	//Streaming needs the address first, the device then takes every following data word for the next address.
+	//A single frame sent LSB first starts with the data, so that order can't be streamed.
+	if (packetOrder || msbFirst == 0)
+		return DeviceBase::writeBurst(addr, data, n);
+	if (packetLen > MPSSE_MAX_FRAME_BITS || dataLen <= 0)
+	{
+		std::cout << "Packet length not supported by MPSSE" << std::endl;
+		return FT_INVALID_PARAMETER;
+	}
+	if (n <= 0)
+		return FT_OK;
+	appendCs(1);
+	appendOut((uint32_t)addr & (uint32_t)((1ull << addressLen) - 1), addressLen);
+	for (int i = 0; i < n; i++)
+		appendOut((uint32_t)data[i] & (uint32_t)((1ull << dataLen) - 1), dataLen);
+	appendCs(0);
+	return sendQueue();
+}
+
+int FTDIMpsseProgrammer::readBurst(int addr, int *data, int n)
+{
+	DWORD rxBytes, rxLen = 0;
+	int dataLen = packetLen - addressLen;
+	int bytesPerValue = 0;
+	if (packetLen > MPSSE_MAX_FRAME_BITS || dataLen <= 0)
+	{
+		std::cout << "Packet length not supported by MPSSE" << std::endl;
+		return FT_INVALID_PARAMETER;
+	}
+	if (n <= 0)
+		return FT_OK;
+	appendCs(1);
+	appendOut((uint32_t)addr & (uint32_t)((1ull << addressLen) - 1), addressLen);
+	//One read command per value keeps each value byte aligned in the answer.
+	for (int i = 0; i < n; i++)
+		bytesPerValue = appendIn(dataLen);
+	appendCs(0);
+	cmdQueue += char(MPSSE_CMD_SEND_IMMEDIATE);
+	int expected = bytesPerValue * n;
+	std::vector<unsigned char> rx(expected);
+	ftStatus = sendQueue();
+	if (ftStatus == FT_OK)
+		ftStatus = waitForRxBytes(expected, &rxBytes);
+	if (ftStatus == FT_OK)
+		ftStatus = FT_Read(ftHandle, rx.data(), expected, &rxLen);
+	if (ftStatus != FT_OK || rxLen != (DWORD)expected)
+	{
+		std::cout << "Cannot read" << std::endl;
+		return FT_OTHER_ERROR;
+	}
+	for (int i = 0; i < n; i++)
+		data[i] = decodeIn(&rx[i * bytesPerValue], dataLen);
+	return FT_OK;
+}
+
+void FTDIMpsseProgrammer::setAddressLen(int value)
+{
+	addressLen = value;
+}
+
+void FTDIMpsseProgrammer::setPacketLen(int value)
+{
+	packetLen = value;
+}
+
+void FTDIMpsseProgrammer::setPacketOrder(int value)
+{
+	packetOrder = value;
+}
+
+void FTDIMpsseProgrammer::setMsbFirst(int value)
+{
+	msbFirst = value;
+}
+
+void FTDIMpsseProgrammer::setClkEdge(int value)
+{
+	clkEdge = value;
+}
+
+void FTDIMpsseProgrammer::setReadClkEdge(int value)
+{
+	readClkEdge = value;
+}
@@ -0,0 +1,84 @@
+/***SPI master on the FTDI MPSSE engine. Instead of bit-banging two USB bytes per bit, a register access is sent as
+clocked byte/bit commands, so a 24 bit write is 12 command bytes. Pins are the fixed MPSSE ones:
+ADBUS0 SCLK, ADBUS1 SDIO (out), ADBUS2 SDO (in), ADBUS3 SEN (active low). This is the same pin map as the
+default FTDIRegProgrammer setup.
+***/
+#ifndef TI_MPSSE_WRAPPER
+#define TI_MPSSE_WRAPPER
+
+#include <ftd2xx.h>
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include "DeviceBase.h"
+
+#define MPSSE_PIN_SCLK 0x01
+#define MPSSE_PIN_DO 0x02
+#define MPSSE_PIN_DI 0x04
+#define MPSSE_PIN_CS 0x08
+#define MPSSE_PIN_DIRECTION (MPSSE_PIN_SCLK | MPSSE_PIN_DO | MPSSE_PIN_CS)
+
+/*MPSSE opcodes, see FTDI AN_108. The bit variants are the byte opcode + 0x02, LSB first is the opcode | 0x08.*/
+#define MPSSE_CMD_OUT_BYTES_POS 0x10
+#define MPSSE_CMD_OUT_BYTES_NEG 0x11
+#define MPSSE_CMD_IN_BYTES_POS 0x20
+#define MPSSE_CMD_IN_BYTES_NEG 0x24
+#define MPSSE_CMD_BITS 0x02
+#define MPSSE_CMD_LSB_FIRST 0x08
+#define MPSSE_CMD_SET_LOW_BYTE 0x80
+#define MPSSE_CMD_LOOPBACK_OFF 0x85
+#define MPSSE_CMD_SET_DIVISOR 0x86
+#define MPSSE_CMD_SEND_IMMEDIATE 0x87
+#define MPSSE_CMD_DIV5_OFF 0x8A
+#define MPSSE_CMD_3PHASE_OFF 0x8D
+#define MPSSE_CMD_ADAPTIVE_OFF 0x97
+#define MPSSE_CMD_BAD 0xAA
+#define MPSSE_BAD_CMD_RESPONSE 0xFA
+
+/*SCLK = 60 MHz / ((1 + divisor) * 2). 5 gives 5 MHz.*/
+#define MPSSE_DEFAULT_DIVISOR 5
+/*Longest frame handled in one transaction.*/
+#define MPSSE_MAX_FRAME_BITS 32
+/*writeRegs sends the queued commands once they reach this size.*/
+#define MPSSE_MAX_BATCH_BYTES 4096
+#define MPSSE_TIMEOUT_MS 1000
+
+class FTDIMpsseProgrammer: public DeviceBase
+{
+private:
+	int addressLen, packetLen, msbFirst, clkEdge, readClkEdge, packetOrder;
+	std::string cmdQueue;
+	void appendCs(int active);
+	void appendOut(uint32_t bits, int len);
+	int appendIn(int len);
+	int decodeIn(const unsigned char *rx, int len);
+	uint32_t writeFrameBits(int addr, int val);
+	int appendWrite(int addr, int val);
+	int sendQueue();
+	int waitForRxBytes(DWORD expected, DWORD *rxBytes);
+	int syncMpsse();
+public:
+	FT_HANDLE ftHandle;
+	FT_STATUS ftStatus;
+
+	FTDIMpsseProgrammer(char *name, int *status);
+	~FTDIMpsseProgrammer();
+	virtual int open(char *name) override;
+	virtual int close() override;
+	virtual int readReg(int addr) override;
+	virtual int writeReg(int addr, int val) override;
+	virtual int writeRegs(const int *addr, const int *data, int n) override;
+	//Stream the data after one address. Only valid when the device auto-increments the address, see DeviceBase::writeBurst.
+	virtual int writeBurst(int addr, const int *data, int n) override;
+	virtual int readBurst(int addr, int *data, int n) override;
+
+	int setClockDivisor(int divisor);
+	void setAddressLen(int value);
+	void setPacketLen(int value);
+	void setPacketOrder(int value);
+	void setMsbFirst(int value);
+	void setClkEdge(int value);
+	void setReadClkEdge(int value);
+};
+
+#endif
@@ -0,0 +1,60 @@
+/***Windows types used by ftd2xx.h, for building the tests on hosts without windows.h. ftd2xx.h includes this file
+instead of windows.h when _WIN32 is not defined.
+***/
+#ifndef TI_TEST_WINTYPES_H
+#define TI_TEST_WINTYPES_H
+
+#include <stdint.h>
+#include <wchar.h>
+
+typedef unsigned int DWORD;
+typedef DWORD *LPDWORD;
+typedef unsigned int ULONG;
+typedef unsigned long *PULONG;
+typedef unsigned short USHORT;
+typedef unsigned short WORD;
+typedef WORD *LPWORD;
+typedef unsigned char UCHAR;
+typedef unsigned char BYTE;
+typedef BYTE *PUCHAR;
+typedef BYTE *LPBYTE;
+typedef void VOID;
+typedef void *PVOID;
+typedef void *LPVOID;
+typedef void *HANDLE;
+typedef int BOOL;
+typedef int INT;
+typedef unsigned int UINT;
+typedef char CHAR;
+typedef char *PCHAR;
+typedef char *LPSTR;
+typedef const char *LPCSTR;
+typedef const char *LPCTSTR;
+typedef wchar_t *LPWSTR;
+typedef const wchar_t *LPCWSTR;
+typedef short SHORT;
+typedef long LONG;
+typedef long *LPLONG;
+typedef unsigned long long ULONGLONG;
+typedef uint64_t ULONG_PTR;
+
+#define TRUE 1
+#define FALSE 0
+#define WINAPI
+
+typedef struct _OVERLAPPED
+{
+	int unused;
+} OVERLAPPED, *LPOVERLAPPED;
+
+typedef struct _SECURITY_ATTRIBUTES
+{
+	int unused;
+} SECURITY_ATTRIBUTES, *LPSECURITY_ATTRIBUTES;
+
+typedef struct _SYSTEMTIME
+{
+	int unused;
+} SYSTEMTIME, *LPSYSTEMTIME;
+
+#endif
@@ -0,0 +1,349 @@
+#include "mockFtd2xx.h"
+#include <algorithm>
+#include <cstring>
+
+MockFtdi mockFtdi;
+int testFailures = 0;
+
+void mockFtdiReset()
+{
+	mockFtdi.present = 1;
+	mockFtdi.answerSync = 1;
+	mockFtdi.respond = 1;
+	mockFtdi.failCall.clear();
+	mockFtdi.failWriteAt = -1;
+	mockFtdi.writeShort = 0;
+	mockFtdi.readShort = 0;
+	mockFtdi.addressBits = 16;
+	mockFtdi.dataBits = 8;
+	mockFtdi.bitBangEcho = nullptr;
+	memset(mockFtdi.regs, 0, sizeof(mockFtdi.regs));
+	mockFtdi.isOpen = 0;
+	mockFtdi.bitMode = 0;
+	mockFtdi.divisor = -1;
+	mockFtdi.baudRate = 0;
+	mockFtdi.pins = 0;
+	mockFtdi.written.clear();
+	mockFtdi.rx.clear();
+	mockFtdi.writeCalls = 0;
+	mockFtdi.frames = 0;
+	mockFtdi.closes = 0;
+	mockFtdi.pending.clear();
+	mockFtdi.frameBit = 0;
+	mockFtdi.word = 0;
+	mockFtdi.regAddr = 0;
+	mockFtdi.readFrame = 0;
+}
+
+static int mockFail(const char *call)
+{
+	return mockFtdi.failCall == call;
+}
+
+//One SCLK period with SEN low. Returns the bit driven by the slave.
+static int slaveClock(int mosi)
+{
+	int miso = 0;
+	int bit = mockFtdi.frameBit++;
+	if (bit == 0)
+		mockFtdi.frames++;
+	if (bit < mockFtdi.addressBits)
+	{
+		mockFtdi.word = (mockFtdi.word << 1) | mosi;
+		if (bit == mockFtdi.addressBits - 1)
+		{
+			mockFtdi.readFrame = (mockFtdi.word >> (mockFtdi.addressBits - 1)) & 1;
+			mockFtdi.regAddr = mockFtdi.word & ((1u << (mockFtdi.addressBits - 1)) - 1);
+			mockFtdi.word = 0;
+		}
+		return 0;
+	}
+	int dataBit = (bit - mockFtdi.addressBits) % mockFtdi.dataBits;
+	uint32_t reg = mockFtdi.regAddr % MOCK_FTDI_NUM_REGS;
+	if (mockFtdi.readFrame)
+		miso = (mockFtdi.regs[reg] >> (mockFtdi.dataBits - 1 - dataBit)) & 1;
+	else
+		mockFtdi.word = (mockFtdi.word << 1) | mosi;
+	if (dataBit == mockFtdi.dataBits - 1)
+	{
+		if (!mockFtdi.readFrame)
+			mockFtdi.regs[reg] = (uint8_t)mockFtdi.word;
+		mockFtdi.word = 0;
+		//The AFE moves on to the next address after every data word.
+		mockFtdi.regAddr++;
+	}
+	return miso;
+}
+
+static int selected()
+{
+	return (mockFtdi.pins & 0x08) == 0;
+}
+
+static void setPins(uint8_t value)
+{
+	if (!selected() && (value & 0x08) == 0)
+	{
+		mockFtdi.frameBit = 0;
+		mockFtdi.word = 0;
+	}
+	mockFtdi.pins = value;
+}
+
+//Clocks n bits out of data (and in, if read is set) the way the MPSSE shift commands do.
+static void shiftBits(unsigned char op, const unsigned char *data, int n)
+{
+	int lsbFirst = op & 0x08;
+	int bitMode = op & 0x02;
+	int write = op & 0x10;
+	int read = op & 0x20;
+	unsigned char in = 0;
+	for (int i = 0; i < n; i++)
+	{
+		int pos = bitMode ? i : (i % 8);
+		int mosi = 0;
+		if (write)
+		{
+			const unsigned char byte = bitMode ? data[0] : data[i / 8];
+			mosi = lsbFirst ? ((byte >> pos) & 1) : ((byte >> (7 - pos)) & 1);
+		}
+		int miso = selected() ? slaveClock(mosi) : 0;
+		if (!read)
+			continue;
+		//Bytes fill from bit 7 (MSB first) or bit 0. Bits shift in from bit 0 (MSB first) or from bit 7.
+		if (bitMode)
+			in = lsbFirst ? (unsigned char)((in >> 1) | (miso << 7)) : (unsigned char)((in << 1) | miso);
+		else
+			in |= lsbFirst ? (miso << pos) : (miso << (7 - pos));
+		if ((!bitMode && pos == 7) || (bitMode && i == n - 1))
+		{
+			if (mockFtdi.respond)
+				mockFtdi.rx.push_back(in);
+			in = 0;
+		}
+	}
+}
+
+//Runs the complete commands in pending and keeps a partial one for the next write.
+static void runCommands()
+{
+	std::vector<unsigned char> &cmd = mockFtdi.pending;
+	size_t i = 0;
+	while (i < cmd.size())
+	{
+		unsigned char op = cmd[i];
+		size_t left = cmd.size() - i;
+		size_t used = 1;
+		if (op == 0x80 || op == 0x86)
+		{
+			if (left < 3)
+				break;
+			if (op == 0x80)
+				setPins(cmd[i + 1]);
+			else
+				mockFtdi.divisor = cmd[i + 1] | (cmd[i + 2] << 8);
+			used = 3;
+		}
+		else if (op == 0x85 || op == 0x87 || op == 0x8A || op == 0x8D || op == 0x97)
+		{
+		}
+		else if ((op & 0x80) == 0 && (op & 0x30) != 0)
+		{
+			if (op & 0x02)
+			{
+				size_t need = (op & 0x10) ? 3 : 2;
+				if (left < need)
+					break;
+				shiftBits(op, &cmd[i + 2], cmd[i + 1] + 1);
+				used = need;
+			}
+			else
+			{
+				if (left < 3)
+					break;
+				size_t bytes = (cmd[i + 1] | (cmd[i + 2] << 8)) + 1;
+				size_t need = 3 + ((op & 0x10) ? bytes : 0);
+				if (left < need)
+					break;
+				shiftBits(op, &cmd[i + 3], (int)bytes * 8);
+				used = need;
+			}
+		}
+		else if (mockFtdi.answerSync)
+		{
+			mockFtdi.rx.push_back(0xFA);
+			mockFtdi.rx.push_back(op);
+		}
+		i += used;
+	}
+	cmd.erase(cmd.begin(), cmd.begin() + i);
+}
+
+FT_STATUS WINAPI FT_OpenEx(PVOID pArg1, DWORD Flags, FT_HANDLE *pHandle)
+{
+	(void)pArg1;
+	(void)Flags;
+	if (!mockFtdi.present || mockFail("FT_OpenEx"))
+		return FT_DEVICE_NOT_FOUND;
+	mockFtdi.isOpen = 1;
+	*pHandle = &mockFtdi;
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_Close(FT_HANDLE ftHandle)
+{
+	(void)ftHandle;
+	mockFtdi.closes++;
+	mockFtdi.isOpen = 0;
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_ResetDevice(FT_HANDLE ftHandle)
+{
+	(void)ftHandle;
+	return mockFail("FT_ResetDevice") ? FT_IO_ERROR : FT_OK;
+}
+
+FT_STATUS WINAPI FT_SetUSBParameters(FT_HANDLE ftHandle, ULONG ulInTransferSize, ULONG ulOutTransferSize)
+{
+	(void)ftHandle;
+	(void)ulInTransferSize;
+	(void)ulOutTransferSize;
+	return mockFail("FT_SetUSBParameters") ? FT_IO_ERROR : FT_OK;
+}
+
+FT_STATUS WINAPI FT_SetChars(FT_HANDLE ftHandle, UCHAR EventChar, UCHAR EventCharEnabled, UCHAR ErrorChar, UCHAR ErrorCharEnabled)
+{
+	(void)ftHandle;
+	(void)EventChar;
+	(void)EventCharEnabled;
+	(void)ErrorChar;
+	(void)ErrorCharEnabled;
+	return mockFail("FT_SetChars") ? FT_IO_ERROR : FT_OK;
+}
+
+FT_STATUS WINAPI FT_SetTimeouts(FT_HANDLE ftHandle, ULONG ReadTimeout, ULONG WriteTimeout)
+{
+	(void)ftHandle;
+	(void)ReadTimeout;
+	(void)WriteTimeout;
+	return mockFail("FT_SetTimeouts") ? FT_IO_ERROR : FT_OK;
+}
+
+FT_STATUS WINAPI FT_SetLatencyTimer(FT_HANDLE ftHandle, UCHAR ucLatency)
+{
+	(void)ftHandle;
+	(void)ucLatency;
+	return mockFail("FT_SetLatencyTimer") ? FT_IO_ERROR : FT_OK;
+}
+
+FT_STATUS WINAPI FT_SetBitMode(FT_HANDLE ftHandle, UCHAR ucMask, UCHAR ucEnable)
+{
+	(void)ftHandle;
+	(void)ucMask;
+	if (mockFail("FT_SetBitMode"))
+		return FT_IO_ERROR;
+	mockFtdi.bitMode = ucEnable;
+	mockFtdi.pending.clear();
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_GetBitMode(FT_HANDLE ftHandle, PUCHAR pucMode)
+{
+	(void)ftHandle;
+	if (mockFail("FT_GetBitMode"))
+		return FT_IO_ERROR;
+	*pucMode = mockFtdi.pins;
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_SetBaudRate(FT_HANDLE ftHandle, ULONG BaudRate)
+{
+	(void)ftHandle;
+	if (mockFail("FT_SetBaudRate"))
+		return FT_IO_ERROR;
+	mockFtdi.baudRate = BaudRate;
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_SetDivisor(FT_HANDLE ftHandle, USHORT Divisor)
+{
+	(void)ftHandle;
+	if (mockFail("FT_SetDivisor"))
+		return FT_IO_ERROR;
+	mockFtdi.divisor = Divisor;
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_Purge(FT_HANDLE ftHandle, ULONG Mask)
+{
+	(void)ftHandle;
+	if (mockFail("FT_Purge"))
+		return FT_IO_ERROR;
+	if (Mask & FT_PURGE_RX)
+		mockFtdi.rx.clear();
+	if (Mask & FT_PURGE_TX)
+		mockFtdi.pending.clear();
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_Write(FT_HANDLE ftHandle, LPVOID lpBuffer, DWORD dwBytesToWrite, LPDWORD lpBytesWritten)
+{
+	(void)ftHandle;
+	const unsigned char *data = (const unsigned char *)lpBuffer;
+	*lpBytesWritten = 0;
+	if (mockFail("FT_Write") || mockFtdi.writeCalls++ == mockFtdi.failWriteAt)
+		return FT_IO_ERROR;
+	DWORD n = dwBytesToWrite - std::min(dwBytesToWrite, mockFtdi.writeShort);
+	mockFtdi.written.insert(mockFtdi.written.end(), data, data + n);
+	if (mockFtdi.bitMode == 0x2)
+	{
+		mockFtdi.pending.insert(mockFtdi.pending.end(), data, data + n);
+		runCommands();
+	}
+	else if (mockFtdi.bitMode == 0x4 && mockFtdi.respond)
+	{
+		for (DWORD i = 0; i < n; i++)
+			mockFtdi.rx.push_back(mockFtdi.bitBangEcho ? mockFtdi.bitBangEcho(data[i]) : data[i]);
+	}
+	*lpBytesWritten = n;
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_GetQueueStatus(FT_HANDLE ftHandle, DWORD *dwRxBytes)
+{
+	(void)ftHandle;
+	if (mockFail("FT_GetQueueStatus"))
+		return FT_IO_ERROR;
+	*dwRxBytes = (DWORD)mockFtdi.rx.size();
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_GetStatus(FT_HANDLE ftHandle, DWORD *dwRxBytes, DWORD *dwTxBytes, DWORD *dwEventDWord)
+{
+	(void)ftHandle;
+	if (mockFail("FT_GetStatus"))
+		return FT_IO_ERROR;
+	*dwRxBytes = (DWORD)mockFtdi.rx.size();
+	*dwTxBytes = 0;
+	*dwEventDWord = 0;
+	return FT_OK;
+}
+
+FT_STATUS WINAPI FT_Read(FT_HANDLE ftHandle, LPVOID lpBuffer, DWORD dwBytesToRead, LPDWORD lpBytesReturned)
+{
+	(void)ftHandle;
+	unsigned char *data = (unsigned char *)lpBuffer;
+	*lpBytesReturned = 0;
+	if (mockFail("FT_Read"))
+		return FT_IO_ERROR;
+	DWORD n = std::min<DWORD>(dwBytesToRead, (DWORD)mockFtdi.rx.size());
+	n -= std::min(n, mockFtdi.readShort);
+	for (DWORD i = 0; i < n; i++)
+	{
+		data[i] = mockFtdi.rx.front();
+		mockFtdi.rx.pop_front();
+	}
+	*lpBytesReturned = n;
+	return FT_OK;
+}
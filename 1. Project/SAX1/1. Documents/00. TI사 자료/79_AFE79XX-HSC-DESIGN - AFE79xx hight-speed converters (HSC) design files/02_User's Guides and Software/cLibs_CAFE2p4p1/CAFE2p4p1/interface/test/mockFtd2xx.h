@@ -0,0 +1,70 @@
+/***Mock of the D2XX functions used by the wrappers, for testing them without an FTDI device. Link mockFtd2xx.cpp
+instead of the ftd2xx library.
+In synchronous bit-bang mode every written pin byte is read back, through bitBangEcho when the test sets one.
+In MPSSE mode the written commands are run on a model of the engine, clocking an SPI slave that behaves like the AFE:
+an address word whose top bit is the read flag, then data words for consecutive addresses while SEN stays low.
+The clock edges are not modelled.
+***/
+#ifndef TI_MOCK_FTD2XX_H
+#define TI_MOCK_FTD2XX_H
+
+#include <ftd2xx.h>
+#include <cstdio>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define MOCK_FTDI_NUM_REGS 0x8000
+
+struct MockFtdi
+{
+	//Behaviour, set by the test.
+	int present;					//FT_OpenEx finds the device
+	int answerSync;					//the engine answers the bad opcode with 0xFA and the opcode
+	int respond;					//clocked in bits are returned to FT_Read
+	std::string failCall;			//this FT_* function returns FT_IO_ERROR
+	int failWriteAt;				//FT_Write call number that returns FT_IO_ERROR, -1 for none
+	DWORD writeShort;				//bytes FT_Write reports as not written
+	DWORD readShort;				//bytes FT_Read holds back
+	int addressBits, dataBits;		//SPI frame of the slave
+	std::function<unsigned char(unsigned char)> bitBangEcho;	//sync bit-bang slave, maps a written byte to the one read back
+	uint8_t regs[MOCK_FTDI_NUM_REGS];
+
+	//State and counters, read by the test.
+	int isOpen;
+	UCHAR bitMode;
+	int divisor;
+	ULONG baudRate;
+	uint8_t pins;
+	std::vector<unsigned char> written;	//all the bytes accepted by FT_Write
+	std::deque<unsigned char> rx;
+	int writeCalls;
+	int frames;						//SEN low periods that clocked bits
+	int closes;
+
+	//SPI slave and command parser state.
+	std::vector<unsigned char> pending;
+	int frameBit;
+	uint32_t word;
+	uint32_t regAddr;
+	int readFrame;
+};
+
+extern MockFtdi mockFtdi;
+extern int testFailures;
+
+void mockFtdiReset();
+
+#define TEST_CHECK(cond)                                                          \
+    do                                                                            \
+    {                                                                             \
+        if (!(cond))                                                              \
+        {                                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);       \
+            testFailures++;                                                       \
+        }                                                                         \
+    } while (0)
+
+#endif
@@ -0,0 +1,50 @@
+/***Tests of the streaming write of BitBangEncoder against the single frame encoder it has to stay byte identical to.
+***/
+#include "mockFtd2xx.h"
+#include "bitBangEncoder.h"
+#include <cstring>
+
+//A one word burst is exactly one write frame.
+static void testSingleWord()
+{
+	BitBangEncoder encoder;
+	unsigned char burst[BITBANG_MAX_STREAM_BYTES];
+	unsigned char frame[BITBANG_MAX_STREAM_BYTES];
+	int data = 0xA5;
+	encoder.configure(0, 1, 3, 0, 1, 1, 1, 0xF0);
+	int burstLen = encoder.encodeBurstWrite(0x1234, 16, &data, 8, 1, burst);
+	int frameLen = encoder.encodeWrite(0x1234A5, 24, frame);
+	TEST_CHECK(burstLen == BitBangEncoder::burstStreamLen(16, 8, 1));
+	TEST_CHECK(burstLen == frameLen);
+	TEST_CHECK(memcmp(burst, frame, frameLen) == 0);
+}
+
+//Every data word follows the previous one under the same enable, the address is sent once.
+static void testStream()
+{
+	BitBangEncoder encoder;
+	unsigned char burst[BITBANG_MAX_STREAM_BYTES * 4];
+	unsigned char frame[BITBANG_MAX_STREAM_BYTES];
+	int data[4] = {0x01, 0x80, 0x3C, 0xFF};
+	encoder.configure(2, 0, 5, 1, 0, 1, 1, 0x42);
+	int burstLen = encoder.encodeBurstWrite(0x0ABC, 16, data, 8, 4, burst);
+	TEST_CHECK(burstLen == BitBangEncoder::burstStreamLen(16, 8, 4));
+
+	//The address and first word match a single frame up to its trailing idle bytes.
+	int frameLen = encoder.encodeWrite(0x0ABC01, 24, frame);
+	TEST_CHECK(memcmp(burst, frame, frameLen - 2) == 0);
+	for (int i = 1; i < 4; i++)
+	{
+		encoder.encodeWrite((uint32_t)data[i], 8, frame);
+		TEST_CHECK(memcmp(burst + 1 + 2 * 16 + 2 * 8 * i, frame + 1, 2 * 8) == 0);
+	}
+	TEST_CHECK(memcmp(burst + burstLen - 2, frame + BitBangEncoder::writeStreamLen(8) - 2, 2) == 0);
+}
+
+int main()
+{
+	testSingleWord();
+	testStream();
+	printf("testBitBangEncoder: %d failures\n", testFailures);
+	return testFailures != 0;
+}
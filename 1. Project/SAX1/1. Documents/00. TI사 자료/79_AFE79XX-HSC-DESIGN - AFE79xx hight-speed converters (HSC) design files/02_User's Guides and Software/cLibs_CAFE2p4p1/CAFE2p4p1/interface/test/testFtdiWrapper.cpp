@@ -0,0 +1,161 @@
+/***Tests of the bit-bang FTDIRegProgrammer on the mock D2XX device.
+The streams of the BitBangEncoder path have to stay byte identical to the legacy string builders, for every pin map.
+The read data is driven by a bit-bang slave model on the data out pin. Also runs benchmarkEncoder.
+***/
+#include "mockFtd2xx.h"
+#include "ftdi_wrapper.h"
+#include <cstdlib>
+#include <cstring>
+
+struct PinMap
+{
+	int clk, data, enable, dataOut, staticHigh;
+	int msbFirst, enableHigh, clkEdge;
+	int addressLen, packetLen;
+};
+
+//SPI slave on the sync bit-bang pins: after the address clocks it drives the data bits MSB first, one per rising clock edge.
+static struct
+{
+	PinMap map;
+	uint32_t value;
+	int edges;
+	int lastClk;
+} slave;
+
+static unsigned char slaveEcho(unsigned char pins)
+{
+	int clk = (pins >> slave.map.clk) & 1;
+	int enabled = ((pins >> slave.map.enable) & 1) == slave.map.enableHigh;
+	int dataLen = slave.map.packetLen - slave.map.addressLen;
+	int bit = slave.edges - slave.map.addressLen;
+	unsigned char echo = pins & (unsigned char)~(1 << slave.map.dataOut);
+	if (enabled && bit >= 0 && bit < dataLen)
+		echo |= (unsigned char)(((slave.value >> (dataLen - 1 - bit)) & 1) << slave.map.dataOut);
+	if (!enabled)
+		slave.edges = 0;
+	else if (clk && !slave.lastClk)
+		slave.edges++;
+	slave.lastClk = clk;
+	return echo;
+}
+
+static void applyPinMap(FTDIRegProgrammer &dev, const PinMap &map)
+{
+	dev.setPin(map.clk, 0);
+	dev.setPin(map.data, 1);
+	dev.setPin(map.enable, 2);
+	dev.setPin(map.dataOut, 6);
+	dev.setPin(map.staticHigh, 4);
+	dev.setMsbFirst(map.msbFirst);
+	dev.setEnableType(map.enableHigh);
+	dev.setClkEdge(map.clkEdge);
+	dev.setAddressLen(map.addressLen);
+	dev.setPacketLen(map.packetLen);
+}
+
+static uint32_t fieldMask(int len)
+{
+	return len >= 32 ? 0xFFFFFFFF : (1u << len) - 1;
+}
+
+static const PinMap pinMaps[] = {
+	//clk data enable dataOut staticHigh msbFirst enableHigh clkEdge addressLen packetLen
+	{0, 1, 3, 2, 7, 1, 0, 1, 16, 24},
+	{0, 1, 3, 2, 7, 0, 0, 1, 16, 24},
+	{4, 2, 6, 0, 1, 1, 1, 0, 16, 24},
+	{7, 5, 1, 3, 0, 0, 1, 0, 8, 16},
+	{1, 0, 2, 5, 6, 1, 0, 0, 15, 32},
+};
+
+//Writes and reads through the encoder send exactly what buildWritePacketString and buildReadPacketString build.
+static void testEncoderMatchesLegacy(FTDIRegProgrammer &dev)
+{
+	srand(7);
+	for (const PinMap &map : pinMaps)
+	{
+		int dataLen = map.packetLen - map.addressLen;
+		applyPinMap(dev, map);
+		slave.map = map;
+		for (int i = 0; i < 200; i++)
+		{
+			int addr = (int)((((uint32_t)rand() << 16) ^ (uint32_t)rand()) & fieldMask(map.addressLen));
+			int val = (int)((((uint32_t)rand() << 16) ^ (uint32_t)rand()) & fieldMask(dataLen));
+
+			mockFtdi.written.clear();
+			TEST_CHECK(dev.writeReg(addr, val) == FT_OK);
+			TEST_CHECK(dev.flush() == FT_OK);
+			std::string expected = dev.buildWritePacketString(myConvertToBin(addr, map.addressLen) + myConvertToBin(val, dataLen));
+			TEST_CHECK(mockFtdi.written.size() == expected.size());
+			TEST_CHECK(std::equal(mockFtdi.written.begin(), mockFtdi.written.end(), (const unsigned char *)expected.data()));
+
+			slave.value = (uint32_t)val;
+			slave.edges = 0;
+			slave.lastClk = 0;
+			mockFtdi.written.clear();
+			TEST_CHECK(dev.readReg(addr) == val);
+			expected = dev.buildReadPacketString(addr);
+			TEST_CHECK(mockFtdi.written.size() == expected.size());
+			TEST_CHECK(std::equal(mockFtdi.written.begin(), mockFtdi.written.end(), (const unsigned char *)expected.data()));
+		}
+	}
+}
+
+//Frames longer than BITBANG_MAX_FRAME_BITS still go through the legacy string path and decode the same slave data.
+static void testLegacyRead(FTDIRegProgrammer &dev)
+{
+	PinMap map = {0, 1, 3, 2, 7, 1, 0, 1, 16, 40};
+	applyPinMap(dev, map);
+	slave.map = map;
+	for (uint32_t val : {0x000000u, 0xFFFFFFu, 0xA5C30Fu, 0x123456u})
+	{
+		slave.value = val;
+		slave.edges = 0;
+		slave.lastClk = 0;
+		TEST_CHECK(dev.readReg(0x1234) == (int)val);
+	}
+}
+
+//A batch whose transfer fails is not counted in the transport statistics, as the wrapper can't tell which of its writes went out.
+static void testFailedBatchNotCounted(FTDIRegProgrammer &dev)
+{
+	int addr[4] = {0x10, 0x11, 0x12, 0x13};
+	int data[4] = {1, 2, 3, 4};
+	applyPinMap(dev, pinMaps[0]);
+	dev.resetTransportStats();
+	mockFtdi.failWriteAt = mockFtdi.writeCalls;
+	TEST_CHECK(dev.writeRegs(addr, data, 4) != FT_OK);
+	mockFtdi.failWriteAt = -1;
+	TEST_CHECK(dev.getTransactionsPerSecond() == 0);
+	TEST_CHECK(dev.writeRegs(addr, data, 4) == FT_OK);
+	TEST_CHECK(dev.getTransactionsPerSecond() > 0);
+}
+
+static void testBenchmark(FTDIRegProgrammer &dev)
+{
+	double legacyFramesPerSec = 0, encoderFramesPerSec = 0;
+	applyPinMap(dev, pinMaps[0]);
+	mockFtdi.written.clear();
+	TEST_CHECK(dev.benchmarkEncoder(100000, &legacyFramesPerSec, &encoderFramesPerSec) == FT_OK);
+	TEST_CHECK(mockFtdi.written.empty());
+	TEST_CHECK(encoderFramesPerSec > legacyFramesPerSec);
+	printf("benchmarkEncoder: legacy %.0f frames/s, encoder %.0f frames/s\n", legacyFramesPerSec, encoderFramesPerSec);
+}
+
+int main()
+{
+	int status = 0;
+	mockFtdiReset();
+	mockFtdi.bitBangEcho = slaveEcho;
+	FTDIRegProgrammer dev((char *)"mock", &status);
+	TEST_CHECK(status == 0);
+	//The completion wait of the pipelined mode replaces the 20 ms sleep after every legacy transfer.
+	TEST_CHECK(dev.setTransportMode(FTDI_TRANSPORT_PIPELINED) == FT_OK);
+
+	testEncoderMatchesLegacy(dev);
+	testLegacyRead(dev);
+	testFailedBatchNotCounted(dev);
+	testBenchmark(dev);
+	printf("testFtdiWrapper: %d failures\n", testFailures);
+	return testFailures != 0;
+}
@@ -0,0 +1,209 @@
+/***Tests of FTDIMpsseProgrammer against the mock D2XX layer: setup, the write and read paths and their errors.
+***/
+#include "mockFtd2xx.h"
+#include "mpsse_wrapper.h"
+#include <cstring>
+
+static char deviceName[] = "AFE79xx EVM A";
+
+//Clears what the setup of an opened device left in the counters.
+static void clearCounters(int status)
+{
+	TEST_CHECK(status == 0);
+	mockFtdi.written.clear();
+	mockFtdi.writeCalls = 0;
+	mockFtdi.frames = 0;
+}
+
+static void testSetup()
+{
+	int status = 0;
+	mockFtdiReset();
+	{
+		FTDIMpsseProgrammer dev(deviceName, &status);
+		TEST_CHECK(status == 0);
+		TEST_CHECK(mockFtdi.bitMode == 0x2);
+		TEST_CHECK(mockFtdi.written.size() > 0 && mockFtdi.written[0] == MPSSE_CMD_BAD);
+		TEST_CHECK(mockFtdi.divisor == MPSSE_DEFAULT_DIVISOR);
+		TEST_CHECK(mockFtdi.pins == MPSSE_PIN_CS);
+		TEST_CHECK(mockFtdi.rx.empty());
+	}
+
+	mockFtdiReset();
+	mockFtdi.present = 0;
+	{
+		status = 0;
+		FTDIMpsseProgrammer dev(deviceName, &status);
+		TEST_CHECK(status == 1);
+	}
+
+	//An engine that never answers the sync command is not MPSSE capable.
+	mockFtdiReset();
+	mockFtdi.answerSync = 0;
+	{
+		status = 0;
+		FTDIMpsseProgrammer dev(deviceName, &status);
+		TEST_CHECK(status == 1);
+		TEST_CHECK(mockFtdi.closes == 1);
+	}
+
+	mockFtdiReset();
+	mockFtdi.failCall = "FT_SetBitMode";
+	{
+		status = 0;
+		FTDIMpsseProgrammer dev(deviceName, &status);
+		TEST_CHECK(status == 1);
+	}
+}
+
+static void testWrite()
+{
+	int status = 0;
+	mockFtdiReset();
+	FTDIMpsseProgrammer dev(deviceName, &status);
+	clearCounters(status);
+	//SEN low, 3 bytes out on the falling edge, SEN high.
+	const unsigned char expected[] = {0x80, 0x00, 0x0B, 0x11, 0x02, 0x00, 0x00, 0x12, 0x34, 0x80, 0x08, 0x0B};
+	TEST_CHECK(dev.writeReg(0x0012, 0x34) == FT_OK);
+	TEST_CHECK(mockFtdi.regs[0x12] == 0x34);
+	TEST_CHECK(mockFtdi.written.size() == sizeof(expected) && memcmp(mockFtdi.written.data(), expected, sizeof(expected)) == 0);
+	TEST_CHECK(mockFtdi.writeCalls == 1);
+
+	//A batch is queued and sent in MPSSE_MAX_BATCH_BYTES pieces.
+	const int n = 1000;
+	int addr[n], data[n];
+	for (int i = 0; i < n; i++)
+	{
+		addr[i] = 0x1000 + 3 * i;
+		data[i] = (i * 7) & 0xFF;
+	}
+	mockFtdi.writeCalls = 0;
+	TEST_CHECK(dev.writeRegs(addr, data, n) == FT_OK);
+	int mismatches = 0;
+	for (int i = 0; i < n; i++)
+		mismatches += mockFtdi.regs[addr[i]] != data[i];
+	TEST_CHECK(mismatches == 0);
+	TEST_CHECK(mockFtdi.writeCalls == (n * (int)sizeof(expected) + MPSSE_MAX_BATCH_BYTES - 1) / MPSSE_MAX_BATCH_BYTES);
+
+	//A burst is one frame, the slave takes the data words for consecutive addresses.
+	int burst[16];
+	for (int i = 0; i < 16; i++)
+		burst[i] = 0xA0 + i;
+	mockFtdi.frames = 0;
+	TEST_CHECK(dev.writeBurst(0x0200, burst, 16) == FT_OK);
+	TEST_CHECK(mockFtdi.frames == 1);
+	mismatches = 0;
+	for (int i = 0; i < 16; i++)
+		mismatches += mockFtdi.regs[0x200 + i] != burst[i];
+	TEST_CHECK(mismatches == 0);
+
+	//A frame that isn't a multiple of 8 bits ends with a bit command.
+	dev.setAddressLen(15);
+	dev.setPacketLen(23);
+	mockFtdi.addressBits = 15;
+	TEST_CHECK(dev.writeReg(0x0034, 0x5A) == FT_OK);
+	TEST_CHECK(mockFtdi.regs[0x34] == 0x5A);
+}
+
+static void testRead()
+{
+	int status = 0;
+	mockFtdiReset();
+	FTDIMpsseProgrammer dev(deviceName, &status);
+	clearCounters(status);
+	mockFtdi.regs[0x123] = 0xA5;
+	TEST_CHECK(dev.readReg(0x8123) == 0xA5);
+	TEST_CHECK(mockFtdi.rx.empty());
+
+	for (int i = 0; i < 16; i++)
+		mockFtdi.regs[0x300 + i] = (uint8_t)(0x3C ^ i);
+	int burst[16] = {0};
+	mockFtdi.frames = 0;
+	TEST_CHECK(dev.readBurst(0x8300, burst, 16) == FT_OK);
+	TEST_CHECK(mockFtdi.frames == 1);
+	int mismatches = 0;
+	for (int i = 0; i < 16; i++)
+		mismatches += burst[i] != (0x3C ^ i);
+	TEST_CHECK(mismatches == 0);
+
+	//7 data bits are read with a bit command.
+	dev.setAddressLen(15);
+	dev.setPacketLen(22);
+	mockFtdi.addressBits = 15;
+	mockFtdi.dataBits = 7;
+	mockFtdi.regs[0x45] = 0x5B;
+	TEST_CHECK(dev.readReg(0x4045) == 0x5B);
+}
+
+static void testErrors()
+{
+	int status = 0;
+	mockFtdiReset();
+	FTDIMpsseProgrammer dev(deviceName, &status);
+	clearCounters(status);
+	int addr[1000], data[1000];
+	int value;
+
+	mockFtdi.failCall = "FT_Write";
+	TEST_CHECK(dev.writeReg(0x0010, 0x01) == FT_IO_ERROR);
+	mockFtdi.failCall.clear();
+	mockFtdi.writeShort = 1;
+	TEST_CHECK(dev.writeReg(0x0010, 0x01) == FT_IO_ERROR);
+	mockFtdi.writeShort = 0;
+
+	//A failed batch is dropped, nothing of it is sent with the next access.
+	for (int i = 0; i < 1000; i++)
+	{
+		addr[i] = i;
+		data[i] = 0x55;
+	}
+	mockFtdi.writeCalls = 0;
+	mockFtdi.failWriteAt = 1;
+	TEST_CHECK(dev.writeRegs(addr, data, 1000) == FT_IO_ERROR);
+	mockFtdi.failWriteAt = -1;
+	mockFtdi.written.clear();
+	TEST_CHECK(dev.writeReg(0x0010, 0x02) == FT_OK);
+	TEST_CHECK(mockFtdi.written.size() == 12);
+	TEST_CHECK(mockFtdi.regs[0x10] == 0x02);
+
+	//Frames longer than MPSSE_MAX_FRAME_BITS are refused before anything is queued.
+	dev.setPacketLen(MPSSE_MAX_FRAME_BITS + 8);
+	TEST_CHECK(dev.writeReg(0x0010, 0x03) == FT_INVALID_PARAMETER);
+	TEST_CHECK(dev.readReg(0x8010) == FT_INVALID_PARAMETER);
+	TEST_CHECK(dev.readBurst(0x8010, &value, 1) == FT_INVALID_PARAMETER);
+	dev.setPacketLen(24);
+	mockFtdi.written.clear();
+	TEST_CHECK(dev.writeReg(0x0010, 0x04) == FT_OK);
+	TEST_CHECK(mockFtdi.written.size() == 12);
+
+	mockFtdi.readShort = 1;
+	TEST_CHECK(dev.readReg(0x8010) == FT_OTHER_ERROR);
+	mockFtdi.readShort = 0;
+	mockFtdi.rx.clear();
+	mockFtdi.failCall = "FT_Read";
+	TEST_CHECK(dev.readBurst(0x8010, data, 4) == FT_OTHER_ERROR);
+	mockFtdi.failCall = "FT_GetQueueStatus";
+	TEST_CHECK(dev.readReg(0x8010) == FT_OTHER_ERROR);
+	mockFtdi.failCall.clear();
+	mockFtdi.rx.clear();
+
+	//No answer times out after MPSSE_TIMEOUT_MS.
+	mockFtdi.respond = 0;
+	TEST_CHECK(dev.readReg(0x8010) == FT_OTHER_ERROR);
+	mockFtdi.respond = 1;
+	mockFtdi.regs[0x10] = 0x77;
+	TEST_CHECK(dev.readReg(0x8010) == 0x77);
+
+	TEST_CHECK(dev.close() == FT_OK);
+	TEST_CHECK(!mockFtdi.isOpen);
+}
+
+int main()
+{
+	testSetup();
+	testWrite();
+	testRead();
+	testErrors();
+	printf("testMpsse: %d failures\n", testFailures);
+	return testFailures != 0;
+}